@@ -25,11 +25,40 @@ echo "开始编译 arXmlTool..."
 # Source files
 SRC_FILES="src/main/arxml_tool.c \
           src/main/options.c \
+          src/main/serve.c \
+          src/main/watch.c \
+          src/main/batch.c \
           src/command/command.c \
           src/operations/merge.c \
           src/operations/format.c \
+          src/operations/compare.c \
+          src/operations/patch.c \
+          src/operations/generate.c \
+          src/operations/synth.c \
+          src/operations/index.c \
+          src/operations/extract.c \
+          src/operations/check_refs.c \
+          src/operations/split.c \
+          src/operations/rename.c \
+          src/operations/stats.c \
+          src/operations/snapshot.c \
           src/utils/fs_utils.c \
-          src/utils/xml_utils.c"
+          src/utils/xml_utils.c \
+          src/utils/ar_path.c \
+          src/utils/json_utils.c \
+          src/utils/hash_utils.c \
+          src/utils/thread_pool.c \
+          src/utils/arxml_scanner.c \
+          src/utils/arxml_index.c \
+          src/utils/perf_utils.c \
+          src/utils/mem_stats.c \
+          src/utils/xml_arena.c \
+          src/utils/dir_walk.c \
+          src/utils/doc_cache.c \
+          src/utils/result_cache.c \
+          src/utils/arxml_snapshot.c \
+          src/utils/compressed_io.c \
+          src/utils/ar_path_filter.c"
 
 # Include directories
 INCLUDE_DIRS="-Isrc/main -Isrc/command -Isrc/operations -Isrc/utils"
@@ -47,13 +76,13 @@ if [ "$OS" = "Windows_NT" ]; then
         -o build/arXmlTool.exe $SRC_FILES \
         -L"mingw64/lib" \
         -static \
-        -lxml2 -lz -llzma -liconv -lws2_32 \
+        -lxml2 -lz -llzma -liconv -lws2_32 -lpthread \
         -DLIBXML_STATIC
 else
     # Linux/Unix 环境
     CFLAGS=$(pkg-config --cflags libxml-2.0)
     LIBS=$(pkg-config --libs libxml-2.0)
-    gcc -Wall -Wextra $INCLUDE_DIRS $CFLAGS -o build/arXmlTool.exe $SRC_FILES $LIBS
+    gcc -Wall -Wextra $INCLUDE_DIRS $CFLAGS -o build/arXmlTool.exe $SRC_FILES $LIBS -lz -llzma -pthread
 fi
 
 # 检查编译结果
@@ -63,4 +92,66 @@ if [ $? -eq 0 ]; then
 else
     echo "编译失败！"
     exit 1
-fi
\ No newline at end of file
+fi
+
+# 2. Compile benchmark, all sources except the tool's main and option parsing
+rm -f build/arXmlBench.exe
+echo "开始编译 arXmlBench..."
+BENCH_FILES="src/bench/arxml_bench.c"
+for f in $SRC_FILES; do
+    case $f in
+        src/main/*) ;;
+        *) BENCH_FILES="$BENCH_FILES $f" ;;
+    esac
+done
+
+if [ "$OS" = "Windows_NT" ]; then
+    gcc -Wall -Wextra \
+        $INCLUDE_DIRS \
+        -I"mingw64/include" \
+        -I"mingw64/include/libxml2" \
+        -o build/arXmlBench.exe $BENCH_FILES \
+        -L"mingw64/lib" \
+        -static \
+        -lxml2 -lz -llzma -liconv -lws2_32 -lpthread \
+        -DLIBXML_STATIC
+else
+    gcc -Wall -Wextra $INCLUDE_DIRS $CFLAGS -o build/arXmlBench.exe $BENCH_FILES $LIBS -lz -llzma -pthread
+fi
+
+if [ $? -eq 0 ]; then
+    echo "生成性能测试程序: build/arXmlBench.exe"
+else
+    echo "编译失败！"
+    exit 1
+fi
+
+# 3. Build library, the benchmark sources with the C API instead of the benchmark's main
+rm -f build/libarxmltool.a
+echo "开始编译 libarxmltool..."
+mkdir -p build/obj
+LIB_OBJS=""
+for f in src/lib/arxmltool.c $BENCH_FILES; do
+    case $f in
+        src/bench/*) continue ;;
+    esac
+    obj="build/obj/$(basename "$f" .c).o"
+    if [ "$OS" = "Windows_NT" ]; then
+        gcc -Wall -Wextra \
+            $INCLUDE_DIRS \
+            -I"mingw64/include" \
+            -I"mingw64/include/libxml2" \
+            -DLIBXML_STATIC \
+            -c "$f" -o "$obj" || { echo "编译失败！"; exit 1; }
+    else
+        gcc -Wall -Wextra -fPIC $INCLUDE_DIRS $CFLAGS -c "$f" -o "$obj" || { echo "编译失败！"; exit 1; }
+    fi
+    LIB_OBJS="$LIB_OBJS $obj"
+done
+
+if ar rcs build/libarxmltool.a $LIB_OBJS; then
+    echo "生成库: build/libarxmltool.a (头文件: src/lib/arxmltool.h, src/lib/arxmltool.hpp)"
+else
+    echo "编译失败！"
+    exit 1
+fi
@@ -25,11 +25,40 @@ echo "开始编译 arXmlTool..."
 # Source files
 SRC_FILES="src/main/arxml_tool.c \
           src/main/options.c \
+          src/main/serve.c \
+          src/main/watch.c \
+          src/main/batch.c \
           src/command/command.c \
           src/operations/merge.c \
           src/operations/format.c \
+          src/operations/compare.c \
+          src/operations/patch.c \
+          src/operations/generate.c \
+          src/operations/synth.c \
+          src/operations/index.c \
+          src/operations/extract.c \
+          src/operations/check_refs.c \
+          src/operations/split.c \
+          src/operations/rename.c \
+          src/operations/stats.c \
+          src/operations/snapshot.c \
           src/utils/fs_utils.c \
-          src/utils/xml_utils.c"
+          src/utils/xml_utils.c \
+          src/utils/ar_path.c \
+          src/utils/json_utils.c \
+          src/utils/hash_utils.c \
+          src/utils/thread_pool.c \
+          src/utils/arxml_scanner.c \
+          src/utils/arxml_index.c \
+          src/utils/perf_utils.c \
+          src/utils/mem_stats.c \
+          src/utils/xml_arena.c \
+          src/utils/dir_walk.c \
+          src/utils/doc_cache.c \
+          src/utils/result_cache.c \
+          src/utils/arxml_snapshot.c \
+          src/utils/compressed_io.c \
+          src/utils/ar_path_filter.c"
 
 # Include directories
 INCLUDE_DIRS="-Isrc/main -Isrc/command -Isrc/operations -Isrc/utils"
@@ -47,13 +76,13 @@ if [ "$OS" = "Windows_NT" ]; then
         -o build/arXmlTool.exe $SRC_FILES \
         -L"mingw64/lib" \
         -static \
-        -lxml2 -lz -llzma -liconv -lws2_32 \
+        -lxml2 -lz -llzma -liconv -lws2_32 -lpthread \
         -DLIBXML_STATIC
 else
     # Linux/Unix 环境
     CFLAGS=$(pkg-config --cflags libxml-2.0)
     LIBS=$(pkg-config --libs libxml-2.0)
-    gcc -Wall -Wextra $INCLUDE_DIRS $CFLAGS -o build/arXmlTool.exe $SRC_FILES $LIBS
+    gcc -Wall -Wextra $INCLUDE_DIRS $CFLAGS -o build/arXmlTool.exe $SRC_FILES $LIBS -lz -llzma -pthread
 fi
 
 # 检查编译结果
@@ -65,6 +94,68 @@ else
     exit 1
 fi
 
+# 2. Compile benchmark, all sources except the tool's main and option parsing
+rm -f build/arXmlBench.exe
+echo "开始编译 arXmlBench..."
+BENCH_FILES="src/bench/arxml_bench.c"
+for f in $SRC_FILES; do
+    case $f in
+        src/main/*) ;;
+        *) BENCH_FILES="$BENCH_FILES $f" ;;
+    esac
+done
+
+if [ "$OS" = "Windows_NT" ]; then
+    gcc -Wall -Wextra \
+        $INCLUDE_DIRS \
+        -I"mingw64/include" \
+        -I"mingw64/include/libxml2" \
+        -o build/arXmlBench.exe $BENCH_FILES \
+        -L"mingw64/lib" \
+        -static \
+        -lxml2 -lz -llzma -liconv -lws2_32 -lpthread \
+        -DLIBXML_STATIC
+else
+    gcc -Wall -Wextra $INCLUDE_DIRS $CFLAGS -o build/arXmlBench.exe $BENCH_FILES $LIBS -lz -llzma -pthread
+fi
+
+if [ $? -eq 0 ]; then
+    echo "生成性能测试程序: build/arXmlBench.exe"
+else
+    echo "编译失败！"
+    exit 1
+fi
+
+# 3. Build library, the benchmark sources with the C API instead of the benchmark's main
+rm -f build/libarxmltool.a
+echo "开始编译 libarxmltool..."
+mkdir -p build/obj
+LIB_OBJS=""
+for f in src/lib/arxmltool.c $BENCH_FILES; do
+    case $f in
+        src/bench/*) continue ;;
+    esac
+    obj="build/obj/$(basename "$f" .c).o"
+    if [ "$OS" = "Windows_NT" ]; then
+        gcc -Wall -Wextra \
+            $INCLUDE_DIRS \
+            -I"mingw64/include" \
+            -I"mingw64/include/libxml2" \
+            -DLIBXML_STATIC \
+            -c "$f" -o "$obj" || { echo "编译失败！"; exit 1; }
+    else
+        gcc -Wall -Wextra -fPIC $INCLUDE_DIRS $CFLAGS -c "$f" -o "$obj" || { echo "编译失败！"; exit 1; }
+    fi
+    LIB_OBJS="$LIB_OBJS $obj"
+done
+
+if ar rcs build/libarxmltool.a $LIB_OBJS; then
+    echo "生成库: build/libarxmltool.a (头文件: src/lib/arxmltool.h, src/lib/arxmltool.hpp)"
+else
+    echo "编译失败！"
+    exit 1
+fi
+
 # Test counters
 TOTAL_TESTS=0
 PASSED_TESTS=0
@@ -76,6 +167,24 @@ run_command() {
     echo ""
 }
 
+# Count a check, status 0 passes | 统计一项检查，状态为0表示通过
+check_result() {
+    TOTAL_TESTS=$((TOTAL_TESTS + 1))
+    if [ "$1" -eq 0 ]; then
+        PASSED_TESTS=$((PASSED_TESTS + 1))
+        echo -e "${GREEN}PASS${NC}: $2"
+    else
+        echo -e "${RED}FAIL${NC}: $2"
+    fi
+    echo ""
+}
+
+# Check that compare reports two files as identical | 检查compare报告两个文件相同
+check_identical() {
+    ./build/arXmlTool.exe compare -a "$1" -a "$2" | grep -q "Files are identical"
+    check_result $? "$3"
+}
+
 rm -rf testbench/results
 echo "开始测试..."
 
@@ -221,3 +330,447 @@ run_command ./build/arXmlTool.exe merge \
     -a testbench/cases/5.2/noconflict1.arxml \
     -a testbench/cases/5.2/noconflict2.arxml \
     -m output.arxml -o testbench/results/5.2
+
+echo "-------------------"
+echo "Test Case 6: Compare and Patch Tests"
+echo "-------------------"
+
+echo "Test Case 6.1: Compare Writes Expected Patch, Patch Writes Expected File"
+mkdir -p testbench/results/6.1
+run_command ./build/arXmlTool.exe compare \
+    -a testbench/cases/6.1/base.arxml \
+    -a testbench/cases/6.1/new.arxml \
+    -p testbench/results/6.1/changes.jsonl
+cmp -s testbench/results/6.1/changes.jsonl testbench/cases/6.1/changes.jsonl
+check_result $? "6.1 compare writes the expected patch file"
+# Apply the checked-in patch, so compare and patch are checked independently | 应用已提交的补丁，使compare和patch分别得到检查
+run_command ./build/arXmlTool.exe patch \
+    -a testbench/cases/6.1/base.arxml \
+    -p testbench/cases/6.1/changes.jsonl \
+    -m testbench/results/6.1/patched.arxml
+cmp -s testbench/results/6.1/patched.arxml testbench/cases/6.1/expected.arxml
+check_result $? "6.1 patched base equals expected file"
+
+echo "Test Case 6.2: Patch Files Are Reproducible"
+./build/arXmlTool.exe compare \
+    -a testbench/cases/6.1/base.arxml \
+    -a testbench/cases/6.1/new.arxml \
+    -p testbench/results/6.1/changes_again.jsonl > /dev/null
+cmp -s testbench/results/6.1/changes.jsonl testbench/results/6.1/changes_again.jsonl
+check_result $? "6.2 same inputs give the same patch file"
+
+echo "-------------------"
+echo "Test Case 7: Extract Tests"
+echo "-------------------"
+
+echo "Test Case 7.1: Extract With and Without Index"
+mkdir -p testbench/results/7.1
+cp testbench/cases/7.1/model.arxml testbench/results/7.1/model.arxml
+run_command ./build/arXmlTool.exe extract \
+    -a testbench/results/7.1/model.arxml \
+    -e /Vehicle/Components/Dashboard \
+    -e /Vehicle/Interfaces/SpeedIf \
+    -m testbench/results/7.1/extract_scan.arxml
+run_command ./build/arXmlTool.exe index -a testbench/results/7.1/model.arxml
+./build/arXmlTool.exe extract \
+    -a testbench/results/7.1/model.arxml \
+    -e /Vehicle/Components/Dashboard \
+    -e /Vehicle/Interfaces/SpeedIf \
+    -m testbench/results/7.1/extract_index.arxml | grep -q "(2 paths, index)"
+check_result $? "7.1 extract uses the index"
+cmp -s testbench/results/7.1/extract_scan.arxml testbench/results/7.1/extract_index.arxml
+check_result $? "7.1 extract with index equals extract without index"
+grep -q "<SHORT-NAME>Dashboard</SHORT-NAME>" testbench/results/7.1/extract_index.arxml && \
+    ! grep -q "<SHORT-NAME>SpeedSensor</SHORT-NAME>" testbench/results/7.1/extract_index.arxml && \
+    ! grep -q "<SHORT-NAME>DoorIf</SHORT-NAME>" testbench/results/7.1/extract_index.arxml
+check_result $? "7.1 extract keeps only the requested paths"
+
+echo "-------------------"
+echo "Test Case 8: Reference Check Tests"
+echo "-------------------"
+
+echo "Test Case 8.1: Known Broken References"
+mkdir -p testbench/results/8.1
+./build/arXmlTool.exe check-refs \
+    -a testbench/cases/8.1/components.arxml \
+    -a testbench/cases/8.1/interfaces.arxml > testbench/results/8.1/check_refs.txt
+[ $? -ne 0 ]
+check_result $? "8.1 check-refs fails when references are broken"
+cat testbench/results/8.1/check_refs.txt
+grep -q "components.arxml:16: Unresolved reference '/Interfaces/DoorIf'" testbench/results/8.1/check_refs.txt && \
+    grep -q "components.arxml:20: Unresolved reference '/Body/LightIf'" testbench/results/8.1/check_refs.txt
+check_result $? "8.1 broken references are reported with file and line"
+! grep -q "'/Interfaces/SpeedIf'" testbench/results/8.1/check_refs.txt && \
+    grep -q "3 references, 2 broken" testbench/results/8.1/check_refs.txt
+check_result $? "8.1 reference across files resolves"
+
+echo "Test Case 8.2: All References Resolve"
+mkdir -p testbench/results/8.2
+./build/arXmlTool.exe check-refs \
+    -a testbench/cases/8.2/components.arxml \
+    -a testbench/cases/8.1/interfaces.arxml > testbench/results/8.2/check_refs.txt
+check_result $? "8.2 check-refs succeeds when all references resolve"
+cat testbench/results/8.2/check_refs.txt
+grep -q "1 references, 0 broken" testbench/results/8.2/check_refs.txt
+check_result $? "8.2 no broken references reported"
+
+echo "-------------------"
+echo "Test Case 9: Split and Merge Tests"
+echo "-------------------"
+
+echo "Test Case 9.1: Split per Package Then Merge"
+mkdir -p testbench/results/9.1
+run_command ./build/arXmlTool.exe split \
+    -a testbench/cases/9.1/model.arxml \
+    -o testbench/results/9.1/parts
+run_command ./build/arXmlTool.exe merge \
+    -d testbench/results/9.1/parts \
+    -m testbench/results/9.1/merged.arxml
+check_identical testbench/cases/9.1/model.arxml testbench/results/9.1/merged.arxml "9.1 merged packages equal the split file"
+
+echo "Test Case 9.2: Split by Size Then Merge"
+mkdir -p testbench/results/9.2
+run_command ./build/arXmlTool.exe split \
+    -a testbench/cases/9.1/model.arxml \
+    --size 1K \
+    -o testbench/results/9.2/parts \
+    -m part
+ls testbench/results/9.2/parts/part_0000.arxml testbench/results/9.2/parts/part_0001.arxml > /dev/null
+check_result $? "9.2 size split writes zero-padded file names"
+run_command ./build/arXmlTool.exe merge \
+    -d testbench/results/9.2/parts \
+    -m testbench/results/9.2/merged.arxml
+check_identical testbench/cases/9.1/model.arxml testbench/results/9.2/merged.arxml "9.2 merged pieces equal the split file"
+
+echo "-------------------"
+echo "Test Case 10: Compressed File Tests"
+echo "-------------------"
+
+echo "Test Case 10.1: Compressed Output Equals Plain Output"
+mkdir -p testbench/results/10.1
+for output in merged.arxml merged.arxml.gz merged.arxml.xz; do
+    run_command ./build/arXmlTool.exe merge \
+        -a testbench/cases/10.1/interfaces.arxml \
+        -a testbench/cases/10.1/components.arxml \
+        -m testbench/results/10.1/$output
+done
+gzip -dc testbench/results/10.1/merged.arxml.gz | cmp -s - testbench/results/10.1/merged.arxml
+check_result $? "10.1 gz output equals plain output"
+xz -dc testbench/results/10.1/merged.arxml.xz | cmp -s - testbench/results/10.1/merged.arxml
+check_result $? "10.1 xz output equals plain output"
+
+echo "Test Case 10.2: Compressed Input Equals Plain Input"
+mkdir -p testbench/results/10.2
+gzip -c testbench/cases/10.1/interfaces.arxml > testbench/results/10.2/interfaces.arxml.gz
+xz -c testbench/cases/10.1/components.arxml > testbench/results/10.2/components.arxml.xz
+run_command ./build/arXmlTool.exe merge \
+    -a testbench/results/10.2/interfaces.arxml.gz \
+    -a testbench/results/10.2/components.arxml.xz \
+    -m testbench/results/10.2/merged.arxml
+cmp -s testbench/results/10.2/merged.arxml testbench/results/10.1/merged.arxml
+check_result $? "10.2 merge of gz and xz inputs equals merge of plain inputs"
+
+echo "-------------------"
+echo "Test Case 11: Standard Input and Output Tests"
+echo "-------------------"
+
+echo "Test Case 11.1: Format From Standard Input to Standard Output"
+mkdir -p testbench/results/11.1/dir
+run_command ./build/arXmlTool.exe format \
+    -a testbench/cases/11.1/model.arxml \
+    -o testbench/results/11.1/dir \
+    -i 2
+./build/arXmlTool.exe format -a - -i 2 \
+    < testbench/cases/11.1/model.arxml \
+    > testbench/results/11.1/stdout.arxml
+cmp -s testbench/results/11.1/stdout.arxml testbench/results/11.1/dir/model.arxml
+check_result $? "11.1 format of '-' equals format of the file path"
+
+echo "Test Case 11.2: Merge From Standard Input to Standard Output"
+mkdir -p testbench/results/11.2
+run_command ./build/arXmlTool.exe merge \
+    -a testbench/cases/10.1/interfaces.arxml \
+    -a testbench/cases/10.1/components.arxml \
+    -m testbench/results/11.2/merged.arxml
+./build/arXmlTool.exe merge -a - -a testbench/cases/10.1/components.arxml -m - \
+    < testbench/cases/10.1/interfaces.arxml \
+    > testbench/results/11.2/stdout.arxml
+cmp -s testbench/results/11.2/stdout.arxml testbench/results/11.2/merged.arxml
+check_result $? "11.2 merge of '-' equals merge of the file path"
+
+echo "-------------------"
+echo "Test Case 12: Path Filter Tests"
+echo "-------------------"
+
+echo "Test Case 12.1: Format With --only-path and --skip-path"
+mkdir -p testbench/results/12.1
+run_command ./build/arXmlTool.exe format \
+    -a testbench/cases/12.1/model.arxml \
+    --only-path '/Vehicle/**' \
+    --skip-path '/**/Door*' \
+    --skip-path /Vehicle/Components/SpeedSensor \
+    -o testbench/results/12.1
+cmp -s testbench/results/12.1/model.arxml testbench/cases/12.1/expected.arxml
+check_result $? "12.1 filtered format equals expected file"
+grep -q "<SHORT-NAME>Dashboard</SHORT-NAME>" testbench/results/12.1/model.arxml && \
+    grep -q "<SHORT-NAME>SpeedIf</SHORT-NAME>" testbench/results/12.1/model.arxml && \
+    ! grep -q "<SHORT-NAME>Legacy</SHORT-NAME>" testbench/results/12.1/model.arxml && \
+    ! grep -q "<SHORT-NAME>DoorIf</SHORT-NAME>" testbench/results/12.1/model.arxml && \
+    ! grep -q "<SHORT-NAME>SpeedSensor</SHORT-NAME>" testbench/results/12.1/model.arxml
+check_result $? "12.1 matching paths kept, skipped paths dropped"
+
+echo "Test Case 12.2: Merge With --only-path and --skip-path"
+mkdir -p testbench/results/12.2
+run_command ./build/arXmlTool.exe merge \
+    -a testbench/cases/12.1/model.arxml \
+    --only-path '/Vehicle/**' \
+    --skip-path '/**/Door*' \
+    --skip-path /Vehicle/Components/SpeedSensor \
+    -m testbench/results/12.2/merged.arxml
+check_identical testbench/results/12.2/merged.arxml testbench/cases/12.1/expected.arxml "12.2 filtered merge equals expected file"
+
+echo "-------------------"
+echo "Test Case 13: Rename and Move Tests"
+echo "-------------------"
+
+# Copy the rename inputs, files are rewritten in place | 复制重命名输入文件，文件会被原地改写
+prepare_rename_case() {
+    mkdir -p testbench/results/$1
+    cp testbench/cases/13.1/components.arxml testbench/cases/13.1/interfaces.arxml \
+        testbench/cases/13.1/types.arxml testbench/results/$1/
+    touch -d "2020-01-01 00:00:00" testbench/results/$1/types.arxml
+}
+
+# Check rewritten files, the untouched file and the references | 检查改写的文件、未改动的文件以及引用
+check_rename_case() {
+    cmp -s testbench/results/$1/components.arxml testbench/cases/$1/expected/components.arxml && \
+        cmp -s testbench/results/$1/interfaces.arxml testbench/cases/$1/expected/interfaces.arxml
+    check_result $? "$1 rewritten files equal expected files"
+    cmp -s testbench/results/$1/types.arxml testbench/cases/13.1/types.arxml && \
+        [ "$(date -r testbench/results/$1/types.arxml +%Y)" = "2020" ]
+    check_result $? "$1 file without edits keeps content and modification time"
+    ./build/arXmlTool.exe check-refs \
+        -a testbench/results/$1/components.arxml \
+        -a testbench/results/$1/interfaces.arxml \
+        -a testbench/results/$1/types.arxml
+    check_result $? "$1 all references resolve after rewrite"
+}
+
+echo "Test Case 13.1: Rename Element In Place"
+prepare_rename_case 13.1
+run_command ./build/arXmlTool.exe rename \
+    -a testbench/results/13.1/components.arxml \
+    -a testbench/results/13.1/interfaces.arxml \
+    -a testbench/results/13.1/types.arxml \
+    -r /Interfaces/SpeedIf=/Interfaces/VehicleSpeedIf
+check_rename_case 13.1
+
+echo "Test Case 13.2: Move Element Into Package Without ELEMENTS"
+prepare_rename_case 13.2
+run_command ./build/arXmlTool.exe rename \
+    -a testbench/results/13.2/components.arxml \
+    -a testbench/results/13.2/interfaces.arxml \
+    -a testbench/results/13.2/types.arxml \
+    -r /Interfaces/SpeedIf=/Interfaces/Shared/SpeedIf
+check_rename_case 13.2
+
+echo "-------------------"
+echo "Test Case 14: Directory Compare Tests"
+echo "-------------------"
+
+echo "Test Case 14.1: Compare Two Directory Trees"
+mkdir -p testbench/results/14.1
+./build/arXmlTool.exe compare \
+    -a testbench/cases/14.1/base \
+    -a testbench/cases/14.1/new \
+    -p testbench/results/14.1/patches > testbench/results/14.1/compare.txt
+check_result $? "14.1 directory compare succeeds"
+cat testbench/results/14.1/compare.txt
+grep -q "Only in testbench/cases/14.1/base: removed.arxml" testbench/results/14.1/compare.txt && \
+    grep -q "Only in testbench/cases/14.1/new: added.arxml" testbench/results/14.1/compare.txt && \
+    grep -q "Differ: changed.arxml (3 added, 2 removed, 1 replaced)" testbench/results/14.1/compare.txt && \
+    ! grep -q "same.arxml\|reformatted.arxml" testbench/results/14.1/compare.txt
+check_result $? "14.1 only-in-base, only-in-new and differing files are reported"
+grep -q "5 files, 2 identical (1 by hash), 1 differ, 1 only in base, 1 only in new, 0 failed" \
+    testbench/results/14.1/compare.txt
+check_result $? "14.1 identical files counted, reformatted file compared by content"
+[ -f testbench/results/14.1/patches/changed.arxml.jsonl ] && \
+    [ ! -f testbench/results/14.1/patches/same.arxml.jsonl ] && \
+    [ ! -f testbench/results/14.1/patches/sub/reformatted.arxml.jsonl ]
+check_result $? "14.1 patch written only for the differing file"
+
+echo "-------------------"
+echo "Test Case 15: Generate Tests"
+echo "-------------------"
+
+echo "Test Case 15.1: Generate From CSV and JSON Rows"
+mkdir -p testbench/results/15.1
+run_command ./build/arXmlTool.exe generate \
+    -a testbench/cases/15.1/spec.csv \
+    -m testbench/results/15.1/generated.arxml
+cmp -s testbench/results/15.1/generated.arxml testbench/cases/15.1/expected.arxml
+check_result $? "15.1 generated file equals expected file"
+
+echo "Test Case 15.2: Rows of a Package Split Apart"
+mkdir -p testbench/results/15.2
+./build/arXmlTool.exe generate \
+    -a testbench/cases/15.2/spec.csv \
+    -m testbench/results/15.2/generated.arxml > testbench/results/15.2/generate.txt
+[ $? -ne 0 ] && [ ! -f testbench/results/15.2/generated.arxml ] && \
+    grep -q "Spec line 4: rows of package 'Interfaces' must be contiguous" testbench/results/15.2/generate.txt
+check_result $? "15.2 split package rows are rejected without output"
+
+echo "-------------------"
+echo "Test Case 16: Synth Tests"
+echo "-------------------"
+
+echo "Test Case 16.1: Same Seed Gives Identical Files With Any Thread Count"
+mkdir -p testbench/results/16.1
+for jobs in 1 4; do
+    run_command ./build/arXmlTool.exe synth \
+        -o testbench/results/16.1/j$jobs \
+        --files 3 --elements 300 --duplicates 0.2 --seed 7 \
+        -j $jobs
+done
+ls testbench/results/16.1/j1/corpus_0000.arxml testbench/results/16.1/j1/corpus_0002.arxml > /dev/null && \
+    cmp -s testbench/results/16.1/j1/corpus_0000.arxml testbench/results/16.1/j4/corpus_0000.arxml && \
+    cmp -s testbench/results/16.1/j1/corpus_0001.arxml testbench/results/16.1/j4/corpus_0001.arxml && \
+    cmp -s testbench/results/16.1/j1/corpus_0002.arxml testbench/results/16.1/j4/corpus_0002.arxml
+check_result $? "16.1 -j 1 and -j 4 write byte-identical files"
+
+echo "Test Case 16.2: Different Seed Gives Different Files"
+mkdir -p testbench/results/16.2
+run_command ./build/arXmlTool.exe synth \
+    -o testbench/results/16.2 \
+    --files 1 --elements 300 --duplicates 0.2 --seed 8
+! cmp -s testbench/results/16.2/corpus_0000.arxml testbench/results/16.1/j1/corpus_0000.arxml
+check_result $? "16.2 another seed changes the corpus"
+
+
+# 17. 命令文件和压缩输入目录 | Command file and compressed input directories
+echo "Test Case 17.1: Command File With Quotes, Comments and Globs"
+mkdir -p testbench/results/17.1
+rm -f "testbench/results/17.1/merged file.arxml"
+run_command ./build/arXmlTool.exe merge -f testbench/cases/17.1/command.txt
+cmp -s "testbench/results/17.1/merged file.arxml" testbench/cases/17.1/expected.arxml
+check_result $? "17.1 command file merge equals expected file"
+
+echo "Test Case 17.2: Directory Input Picks Up .arxml.gz and .arxml.xz"
+rm -rf testbench/results/17.2
+mkdir -p testbench/results/17.2/in
+gzip -c testbench/cases/17.1/model/ComPdus.arxml > testbench/results/17.2/in/ComPdus.arxml.gz
+xz -c testbench/cases/17.1/model/ComSignals.arxml > testbench/results/17.2/in/ComSignals.ARXML.xz
+cp testbench/cases/17.1/model/Other.arxml testbench/results/17.2/in/Other.arxml
+gzip -c testbench/cases/17.1/model/skip/ComOld.arxml > testbench/results/17.2/in/ComOld.xml.gz
+run_command ./build/arXmlTool.exe merge -d testbench/results/17.2/in -m testbench/results/17.2/compressed.arxml
+run_command ./build/arXmlTool.exe merge -d testbench/cases/17.1/model --exclude skip -m testbench/results/17.2/plain.arxml
+cmp -s testbench/results/17.2/compressed.arxml testbench/results/17.2/plain.arxml
+check_result $? "17.2 merge -d of compressed files equals merge of plain files"
+
+
+# 18. 批处理 | Batch
+echo "Test Case 18.1: Batch Runs a Dependency Chain"
+rm -rf testbench/results/18.1
+mkdir -p testbench/results/18.1/seq
+./build/arXmlTool.exe batch -a testbench/cases/18.1/jobs.txt -j 4 > testbench/results/18.1/batch.log
+check_result $? "18.1 batch exits 0"
+# 依赖顺序：第5行的任务先完成，然后第4行，最后第3行 | Line 5 finishes first, then line 4, then line 3
+grep -o "Job at line [0-9]*: [a-z]* done" testbench/results/18.1/batch.log | tr '\n' ';' | \
+    grep -qx "Job at line 5: merge done;Job at line 4: merge done;Job at line 3: format done;"
+check_result $? "18.1 jobs run in dependency order"
+grep -q "3 done, 0 failed, 0 skipped, 2 outputs passed in memory, 3 files parsed" testbench/results/18.1/batch.log
+check_result $? "18.1 intermediate results are passed in memory"
+# 与逐个运行的结果相同 | Same result as running the jobs one by one
+run_command ./build/arXmlTool.exe merge -a testbench/cases/17.1/model/ComPdus.arxml -a testbench/cases/17.1/model/ComSignals.arxml -m testbench/results/18.1/seq/com.arxml
+run_command ./build/arXmlTool.exe merge -a testbench/results/18.1/seq/com.arxml -a "testbench/cases/17.1/input dir/types.arxml" -m testbench/results/18.1/seq/merged.arxml
+run_command ./build/arXmlTool.exe format -a testbench/results/18.1/seq/merged.arxml -o testbench/results/18.1/seq/release -i 2
+cmp -s testbench/results/18.1/release/merged.arxml testbench/results/18.1/seq/release/merged.arxml
+check_result $? "18.1 batch output equals jobs run one by one"
+
+echo "Test Case 18.2: Batch Rejects a Dependency Cycle"
+rm -rf testbench/results/18.2
+mkdir -p testbench/results/18.2
+./build/arXmlTool.exe batch -a testbench/cases/18.2/jobs.txt > testbench/results/18.2/batch.log
+[ $? -ne 0 ] && grep -q "Error: Jobs read each other's outputs in a cycle" testbench/results/18.2/batch.log && \
+    [ ! -e testbench/results/18.2/a.arxml ] && [ ! -e testbench/results/18.2/b.arxml ]
+check_result $? "18.2 cycle fails before running any job"
+
+
+echo "Test Case 18.3: Profile in Batch Labels Peak Memory as Process-Wide"
+rm -rf testbench/results/18.3
+mkdir -p testbench/results/18.3
+echo "merge -a testbench/cases/17.1/model/ComPdus.arxml -m testbench/results/18.3/batch.arxml --profile=testbench/results/18.3/batch.json" \
+    > testbench/results/18.3/jobs.txt
+run_command ./build/arXmlTool.exe batch -a testbench/results/18.3/jobs.txt
+run_command ./build/arXmlTool.exe merge -a testbench/cases/17.1/model/ComPdus.arxml -m testbench/results/18.3/single.arxml \
+    --profile=testbench/results/18.3/single.json
+grep -q '"peak_rss_shared":true' testbench/results/18.3/batch.json && \
+    grep -q '"peak_rss_shared":false' testbench/results/18.3/single.json
+check_result $? "18.3 batch profile reports shared peak, single run does not"
+
+# 19. 结果缓存 | Result cache
+echo "Test Case 19.1: Second Merge Hits the Result Cache"
+rm -rf testbench/results/19.1
+mkdir -p testbench/results/19.1
+cp testbench/cases/17.1/model/ComSignals.arxml testbench/results/19.1/signals.arxml
+for run in 1 2; do
+    ./build/arXmlTool.exe merge -a testbench/cases/17.1/model/ComPdus.arxml -a testbench/results/19.1/signals.arxml \
+        -m testbench/results/19.1/run$run.arxml --result-cache testbench/results/19.1/cache > testbench/results/19.1/run$run.log
+done
+! grep -q "from result cache" testbench/results/19.1/run1.log && \
+    grep -q "Merge completed, output file: testbench/results/19.1/run2.arxml (from result cache)" testbench/results/19.1/run2.log
+check_result $? "19.1 first run misses, second run hits the cache"
+cmp -s testbench/results/19.1/run1.arxml testbench/results/19.1/run2.arxml
+check_result $? "19.1 cached output equals the merged output"
+# 修改输入内容后不能命中 | Changed input content must miss
+sed -i 's/SpeedSig/WheelSig/' testbench/results/19.1/signals.arxml
+./build/arXmlTool.exe merge -a testbench/cases/17.1/model/ComPdus.arxml -a testbench/results/19.1/signals.arxml \
+    -m testbench/results/19.1/run3.arxml --result-cache testbench/results/19.1/cache > testbench/results/19.1/run3.log
+! grep -q "from result cache" testbench/results/19.1/run3.log && grep -q "WheelSig" testbench/results/19.1/run3.arxml
+check_result $? "19.1 changed input is merged again"
+
+
+# 20. 快照 | Snapshot
+echo "Test Case 20.1: Merge From Snapshot Equals Plain Merge"
+rm -rf testbench/results/20.1
+mkdir -p testbench/results/20.1
+cp testbench/cases/9.1/model.arxml testbench/results/20.1/base.arxml
+run_command ./build/arXmlTool.exe snapshot -a testbench/results/20.1/base.arxml
+for sort in keep asc; do
+    sort_option=""
+    [ $sort = asc ] && sort_option="-s asc"
+    run_command ./build/arXmlTool.exe merge -a testbench/results/20.1/base.arxml \
+        -a testbench/cases/13.1/interfaces.arxml -a testbench/cases/17.1/model/ComPdus.arxml \
+        $sort_option -m testbench/results/20.1/plain_$sort.arxml
+    run_command ./build/arXmlTool.exe merge --load-snapshot testbench/results/20.1/base.arxml.snap \
+        -a testbench/cases/13.1/interfaces.arxml -a testbench/cases/17.1/model/ComPdus.arxml \
+        $sort_option -m testbench/results/20.1/snap_$sort.arxml
+done
+[ -s testbench/results/20.1/base.arxml.snap ] && \
+    cmp -s testbench/results/20.1/plain_keep.arxml testbench/results/20.1/snap_keep.arxml && \
+    cmp -s testbench/results/20.1/plain_asc.arxml testbench/results/20.1/snap_asc.arxml
+check_result $? "20.1 --load-snapshot merge equals plain merge byte for byte"
+
+
+# 21. 统计 | Stats
+echo "Test Case 21.1: Stats Text and JSON Reports Match Expected Files"
+rm -rf testbench/results/21.1
+mkdir -p testbench/results/21.1
+run_command ./build/arXmlTool.exe stats -a testbench/cases/9.1/model.arxml -a testbench/cases/13.1/interfaces.arxml \
+    --top 10 -m testbench/results/21.1/report.txt
+cmp -s testbench/results/21.1/report.txt testbench/cases/21.1/expected.txt
+check_result $? "21.1 text report equals expected file"
+# -m - 只把报告写到标准输出，不创建名为"-"的文件 | -m - writes only the report to standard output, no file named "-"
+(cd testbench/results/21.1 && ../../../build/arXmlTool.exe stats -a ../../cases/9.1/model.arxml \
+    -a ../../cases/13.1/interfaces.arxml --json -m - > report.json 2> stats.log)
+sed 's#"file":"../../cases/#"file":"testbench/cases/#' testbench/results/21.1/report.json | \
+    cmp -s - testbench/cases/21.1/expected.json && [ ! -e testbench/results/21.1/- ] && \
+    grep -q "Stats completed: 2 files" testbench/results/21.1/stats.log
+check_result $? "21.1 JSON report on standard output equals expected file"
+
+echo "-------------------"
+echo "测试完成: $PASSED_TESTS / $TOTAL_TESTS 项检查通过"
+echo "-------------------"
+if [ $PASSED_TESTS -ne $TOTAL_TESTS ]; then
+    exit 1
+fi
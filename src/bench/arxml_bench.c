@@ -0,0 +1,494 @@
+/* Benchmark harness: runs merge, format and xml_utils phases on synthetic corpora | 性能测试程序：在合成语料上运行merge、format和xml_utils各阶段
+ * Results are written as JSON so runs of different versions can be compared
+ * 结果以JSON格式输出，便于比较不同版本的运行结果 */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <libxml/parser.h>
+#include "../main/common.h"
+#include "../operations/merge.h"
+#include "../operations/format.h"
+#include "../operations/synth.h"
+#include "../utils/xml_utils.h"
+#include "../utils/fs_utils.h"
+#include "../utils/perf_utils.h"
+
+#ifdef _WIN32
+#include <io.h>
+#define dup _dup
+#define dup2 _dup2
+#define close _close
+#define open _open
+#define NULL_DEVICE "NUL"
+#else
+#include <unistd.h>
+#define NULL_DEVICE "/dev/null"
+#endif
+
+#define BENCH_MAX_CORPORA 16
+#define BENCH_MAX_FILES 64
+#define BENCH_WORK_DIR_LEN 128
+#define BENCH_DIR_LEN 192       /* Work directory plus corpus name | 工作目录加语料名 */
+
+/* Benchmark settings | 性能测试设置 */
+typedef struct {
+    char sizes[BENCH_MAX_CORPORA][32];
+    uint64_t size_bytes[BENCH_MAX_CORPORA];
+    int size_count;
+    int files;
+    int repeat;
+    uint64_t seed;
+    int jobs;
+    int keep;
+    char work_dir[BENCH_WORK_DIR_LEN];
+    char output_file[MAX_PATH];
+} BenchOptions;
+
+/* Generated corpus of one size | 单个大小的生成语料 */
+typedef struct {
+    const BenchOptions* bench;
+    const char* name;
+    char dir[BENCH_DIR_LEN];
+    char formatted_dir[BENCH_DIR_LEN + 16];
+    char files[BENCH_MAX_FILES][MAX_PATH];
+    int file_count;
+    uint64_t bytes;
+    xmlDocPtr docs[BENCH_MAX_FILES];
+    ProgramOptions* opts;       /* Scratch options passed to operations | 传给操作函数的临时选项 */
+} BenchCorpus;
+
+/* One measured phase, prepare and finish are not timed | 一个被测阶段，prepare和finish不计时
+ * run returns processed bytes, or 0 on failure | run返回处理的字节数，失败时返回0 */
+typedef struct {
+    const char* name;
+    int (*prepare)(BenchCorpus* corpus);
+    uint64_t (*run)(BenchCorpus* corpus);
+    void (*finish)(BenchCorpus* corpus);
+} BenchPhase;
+
+/* Measurements of one phase over all runs | 一个阶段所有运行的测量结果 */
+typedef struct {
+    uint64_t bytes;
+    int runs;
+    double best;
+    double total;
+    uint64_t peak_rss;
+} PhaseResult;
+
+static int quiet_fd = -1;
+
+/* Silence operation messages on stdout | 屏蔽操作函数在stdout上的输出 */
+static void quiet_begin(void) {
+    fflush(stdout);
+    int null_fd = open(NULL_DEVICE, O_WRONLY);
+    if (null_fd < 0) return;
+    quiet_fd = dup(fileno(stdout));
+    dup2(null_fd, fileno(stdout));
+    close(null_fd);
+}
+
+static void quiet_end(void) {
+    if (quiet_fd < 0) return;
+    fflush(stdout);
+    dup2(quiet_fd, fileno(stdout));
+    close(quiet_fd);
+    quiet_fd = -1;
+}
+
+/* Reset scratch options to the defaults of main() | 将临时选项重置为main()中的默认值 */
+static void reset_options(ProgramOptions* opts) {
+    path_list_free(&opts->input_files);
+    memset(opts, 0, sizeof(ProgramOptions));
+    opts->indent_style = INDENT_DEFAULT;
+    opts->indent_width = 4;
+    opts->sort_order = SORT_NONE;
+    opts->output_file = "";
+    opts->output_dir = ".";
+    opts->patch_file = "";
+    opts->profile_file = "";
+}
+
+static int set_inputs(BenchCorpus* corpus) {
+    for (int i = 0; i < corpus->file_count; i++) {
+        if (!path_list_add(&corpus->opts->input_files, corpus->files[i])) return 0;
+    }
+    return 1;
+}
+
+static void free_docs(BenchCorpus* corpus) {
+    for (int i = 0; i < corpus->file_count; i++) {
+        if (corpus->docs[i]) xmlFreeDoc(corpus->docs[i]);
+        corpus->docs[i] = NULL;
+    }
+}
+
+static int parse_docs(BenchCorpus* corpus, int count) {
+    for (int i = 0; i < count; i++) {
+        corpus->docs[i] = xmlReadFile(corpus->files[i], NULL, XML_PARSE_NOBLANKS);
+        if (!corpus->docs[i]) return 0;
+    }
+    return 1;
+}
+
+static int prepare_first_doc(BenchCorpus* corpus) {
+    return parse_docs(corpus, 1);
+}
+
+static int prepare_all_docs(BenchCorpus* corpus) {
+    return parse_docs(corpus, corpus->file_count);
+}
+
+static uint64_t run_detect_indent(BenchCorpus* corpus) {
+    for (int i = 0; i < corpus->file_count; i++) {
+        detect_indent_style(corpus->files[i]);
+    }
+    return corpus->bytes;
+}
+
+static uint64_t run_parse(BenchCorpus* corpus) {
+    return parse_docs(corpus, corpus->file_count) ? corpus->bytes : 0;
+}
+
+static uint64_t run_sort(BenchCorpus* corpus) {
+    uint64_t size = 0;
+    xmlNodePtr root = xmlDocGetRootElement(corpus->docs[0]);
+    if (!root || !get_file_size(corpus->files[0], &size)) return 0;
+    sort_nodes_by_short_name(root, SORT_ASC);
+    return size;
+}
+
+static uint64_t run_serialize(BenchCorpus* corpus) {
+    char path[MAX_PATH];
+    uint64_t size = 0;
+    snprintf(path, sizeof(path), "%s/serialized.arxml", corpus->dir);
+    reset_options(corpus->opts);
+    set_output_indent(corpus->opts, detect_indent_style(corpus->files[0]));
+    if (xmlSaveFormatFileEnc(path, corpus->docs[0], "UTF-8", 1) < 0) return 0;
+    return get_file_size(path, &size) ? size : 0;
+}
+
+static uint64_t run_free(BenchCorpus* corpus) {
+    free_docs(corpus);
+    return corpus->bytes;
+}
+
+static uint64_t run_merge(BenchCorpus* corpus) {
+    reset_options(corpus->opts);
+    if (!set_inputs(corpus)) return 0;
+    corpus->opts->output_file = "merged.arxml";
+    corpus->opts->output_dir = corpus->dir;
+    quiet_begin();
+    int ok = merge_arxml_files(corpus->opts);
+    quiet_end();
+    return ok ? corpus->bytes : 0;
+}
+
+static uint64_t run_format(BenchCorpus* corpus) {
+    reset_options(corpus->opts);
+    if (!set_inputs(corpus)) return 0;
+    corpus->opts->output_dir = corpus->formatted_dir;
+    quiet_begin();
+    int ok = format_arxml_files(corpus->opts);
+    quiet_end();
+    return ok ? corpus->bytes : 0;
+}
+
+static const BenchPhase bench_phases[] = {
+    {"detect_indent", NULL, run_detect_indent, NULL},
+    {"parse", NULL, run_parse, free_docs},
+    {"sort", prepare_first_doc, run_sort, free_docs},
+    {"serialize", prepare_first_doc, run_serialize, free_docs},
+    {"free", prepare_all_docs, run_free, free_docs},
+    {"merge", NULL, run_merge, NULL},
+    {"format", NULL, run_format, NULL}
+};
+
+#define BENCH_PHASE_COUNT ((int)(sizeof(bench_phases) / sizeof(bench_phases[0])))
+
+/* Generate corpus with synth mode | 使用synth模式生成语料 */
+static int generate_corpus(BenchCorpus* corpus, uint64_t target_size) {
+    const BenchOptions* bench = corpus->bench;
+    ProgramOptions* opts = corpus->opts;
+    reset_options(opts);
+    synth_default_params(&opts->synth);
+    opts->synth.seed = bench->seed;
+    opts->synth.file_count = bench->files;
+    opts->synth.target_size = target_size;
+    opts->synth.duplicate_ratio = 0.25;  /* Let merge find duplicates | 让merge处理重复元素 */
+    opts->jobs = bench->jobs;
+    opts->output_dir = corpus->dir;
+    opts->output_file = "bench";
+
+    quiet_begin();
+    int ok = synth_arxml_corpus(opts);
+    quiet_end();
+    if (!ok) return 0;
+
+    corpus->file_count = bench->files;
+    corpus->bytes = 0;
+    for (int i = 0; i < corpus->file_count; i++) {
+        uint64_t size = 0;
+        snprintf(corpus->files[i], MAX_PATH, "%s/bench_%04d.arxml", corpus->dir, i);
+        if (!get_file_size(corpus->files[i], &size)) return 0;
+        corpus->bytes += size;
+    }
+    return 1;
+}
+
+/* Run one phase repeatedly | 重复运行一个阶段 */
+static int run_phase(BenchCorpus* corpus, const BenchPhase* phase, PhaseResult* result) {
+    memset(result, 0, sizeof(PhaseResult));
+    for (int r = 0; r < corpus->bench->repeat; r++) {
+        if (phase->prepare && !phase->prepare(corpus)) {
+            if (phase->finish) phase->finish(corpus);
+            return 0;
+        }
+        perf_reset_peak_rss();
+        double start = perf_now();
+        uint64_t bytes = phase->run(corpus);
+        double elapsed = perf_now() - start;
+        uint64_t peak = perf_peak_rss();
+        if (phase->finish) phase->finish(corpus);
+        if (bytes == 0) return 0;
+
+        result->bytes = bytes;
+        result->total += elapsed;
+        if (result->runs == 0 || elapsed < result->best) result->best = elapsed;
+        if (peak > result->peak_rss) result->peak_rss = peak;
+        result->runs++;
+    }
+    return 1;
+}
+
+/* Delete generated files unless --keep | 除非指定--keep，否则删除生成的文件 */
+static void remove_corpus(const BenchCorpus* corpus) {
+    char path[MAX_PATH];
+    for (int i = 0; i < corpus->file_count; i++) {
+        snprintf(path, sizeof(path), "%s/formatted/bench_%04d.arxml", corpus->dir, i);
+        remove(path);
+        remove(corpus->files[i]);
+    }
+    snprintf(path, sizeof(path), "%s/formatted", corpus->dir);
+    remove(path);
+    snprintf(path, sizeof(path), "%s/merged.arxml", corpus->dir);
+    remove(path);
+    snprintf(path, sizeof(path), "%s/serialized.arxml", corpus->dir);
+    remove(path);
+    remove(corpus->dir);
+}
+
+static int parse_size_value(const char* value, uint64_t* size) {
+    char* endptr;
+    double number = strtod(value, &endptr);
+    double unit = 1.0;
+    if (*endptr == 'K' || *endptr == 'k') {
+        unit = 1024.0;
+        endptr++;
+    } else if (*endptr == 'M' || *endptr == 'm') {
+        unit = 1024.0 * 1024.0;
+        endptr++;
+    } else if (*endptr == 'G' || *endptr == 'g') {
+        unit = 1024.0 * 1024.0 * 1024.0;
+        endptr++;
+    }
+    if (*endptr != '\0' || endptr == value || number <= 0) {
+        printf("Error: Invalid size '%s'. Use a number with optional K, M or G suffix\n", value);
+        return 0;
+    }
+    *size = (uint64_t)(number * unit);
+    return 1;
+}
+
+/* Parse comma separated corpus sizes | 解析以逗号分隔的语料大小 */
+static int parse_sizes(const char* value, BenchOptions* bench) {
+    char list[256];
+    strncpy(list, value, sizeof(list) - 1);
+    list[sizeof(list) - 1] = '\0';
+    bench->size_count = 0;
+    for (char* token = strtok(list, ","); token; token = strtok(NULL, ",")) {
+        if (bench->size_count >= BENCH_MAX_CORPORA || strlen(token) >= sizeof(bench->sizes[0])) {
+            printf("Error: Too many or too long sizes in '%s' (at most %d)\n", value, BENCH_MAX_CORPORA);
+            return 0;
+        }
+        if (!parse_size_value(token, &bench->size_bytes[bench->size_count])) return 0;
+        strcpy(bench->sizes[bench->size_count], token);
+        bench->size_count++;
+    }
+    if (bench->size_count == 0) {
+        printf("Error: No corpus sizes given\n");
+        return 0;
+    }
+    return 1;
+}
+
+static int parse_int_range(const char* name, const char* value, long min, long max, long* result) {
+    char* endptr;
+    long number = strtol(value, &endptr, 10);
+    if (*endptr != '\0' || endptr == value || number < min || number > max) {
+        printf("Error: Invalid %s '%s' (expected %ld..%ld)\n", name, value, min, max);
+        return 0;
+    }
+    *result = number;
+    return 1;
+}
+
+static void print_bench_usage(void) {
+    printf("Usage:\n");
+    printf("  arXmlBench.exe [options]\n\n");
+    printf("Options:\n");
+    printf("  --sizes <list>   Corpus sizes, comma separated (default: 1M,8M,32M)\n");
+    printf("  --files <n>      Files per corpus, merged together (default: 2)\n");
+    printf("  --repeat <n>     Runs per phase, best and mean are reported (default: 3)\n");
+    printf("  --seed <n>       Synth seed (default: 1)\n");
+    printf("  --keep           Keep generated files\n");
+    printf("  -o <directory>   Work directory for corpora and outputs (default: bench_work)\n");
+    printf("  -m <file.json>   Write results to file, progress goes to the console (optional, default: console)\n");
+    printf("  -j <n>           Worker threads for corpus generation (optional, default: one per CPU)\n");
+}
+
+static int parse_bench_options(int argc, char* argv[], BenchOptions* bench) {
+    static const struct option long_options[] = {
+        {"sizes", required_argument, NULL, 'S'},
+        {"files", required_argument, NULL, 'F'},
+        {"repeat", required_argument, NULL, 'R'},
+        {"seed", required_argument, NULL, 'E'},
+        {"keep", no_argument, NULL, 'K'},
+        {"help", no_argument, NULL, 'H'},
+        {NULL, 0, NULL, 0}
+    };
+    long number;
+    int opt;
+
+    memset(bench, 0, sizeof(BenchOptions));
+    bench->files = 2;
+    bench->repeat = 3;
+    bench->seed = 1;
+    strcpy(bench->work_dir, "bench_work");
+    if (!parse_sizes("1M,8M,32M", bench)) return 0;
+
+    while ((opt = getopt_long(argc, argv, "o:m:j:", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 'S':
+                if (!parse_sizes(optarg, bench)) return 0;
+                break;
+            case 'F':
+                if (!parse_int_range("files", optarg, 1, BENCH_MAX_FILES, &number)) return 0;
+                bench->files = (int)number;
+                break;
+            case 'R':
+                if (!parse_int_range("repeat", optarg, 1, 1000, &number)) return 0;
+                bench->repeat = (int)number;
+                break;
+            case 'E':
+                bench->seed = strtoull(optarg, NULL, 10);
+                break;
+            case 'K':
+                bench->keep = 1;
+                break;
+            case 'o':
+                if (strlen(optarg) >= sizeof(bench->work_dir)) {
+                    printf("Error: Work directory '%s' is too long\n", optarg);
+                    return 0;
+                }
+                strcpy(bench->work_dir, optarg);
+                break;
+            case 'm':
+                strncpy(bench->output_file, optarg, MAX_PATH - 1);
+                break;
+            case 'j':
+                if (!parse_int_range("number of jobs", optarg, 0, 1024, &number)) return 0;
+                bench->jobs = (int)number;
+                break;
+            case 'H':
+                print_bench_usage();
+                return 0;
+            default:
+                printf("Error: Invalid option or missing argument\n");
+                return 0;
+        }
+    }
+    return 1;
+}
+
+int main(int argc, char* argv[]) {
+    BenchOptions bench;
+    if (!parse_bench_options(argc, argv, &bench)) {
+        return 1;
+    }
+
+    FILE* out = stdout;
+    int progress = bench.output_file[0] != '\0';
+    if (progress && !(out = fopen(bench.output_file, "w"))) {
+        printf("Error: Cannot create output file '%s'\n", bench.output_file);
+        return 1;
+    }
+    BenchCorpus* corpus = (BenchCorpus*)calloc(1, sizeof(BenchCorpus));
+    ProgramOptions* opts = (ProgramOptions*)calloc(1, sizeof(ProgramOptions));
+    if (!corpus || !opts) {
+        printf("Error: Memory allocation failed\n");
+        return 1;
+    }
+    xmlInitParser();
+
+    fprintf(out, "{\"tool\":\"arXmlTool\",\"version\":\"%s\",\"seed\":%llu,\"repeat\":%d,\"peak_rss_per_phase\":%s,\"corpora\":[",
+            ARXML_TOOL_VERSION, (unsigned long long)bench.seed, bench.repeat, perf_reset_peak_rss() ? "true" : "false");
+    int ok = 1;
+    for (int c = 0; ok && c < bench.size_count; c++) {
+        memset(corpus, 0, sizeof(BenchCorpus));
+        corpus->bench = &bench;
+        corpus->name = bench.sizes[c];
+        corpus->opts = opts;
+        snprintf(corpus->dir, sizeof(corpus->dir), "%s/corpus_%s", bench.work_dir, corpus->name);
+        snprintf(corpus->formatted_dir, sizeof(corpus->formatted_dir), "%s/formatted", corpus->dir);
+        if (!generate_corpus(corpus, bench.size_bytes[c])) {
+            printf("Error: Cannot generate corpus '%s' in '%s'\n", corpus->name, corpus->dir);
+            ok = 0;
+            break;
+        }
+        if (progress) {
+            printf("Corpus %s: %d files, %llu bytes\n", corpus->name, corpus->file_count,
+                   (unsigned long long)corpus->bytes);
+        }
+
+        fprintf(out, "%s\n{\"name\":\"%s\",\"files\":%d,\"bytes\":%llu,\"phases\":[", c ? "," : "",
+                corpus->name, corpus->file_count, (unsigned long long)corpus->bytes);
+        for (int p = 0; p < BENCH_PHASE_COUNT; p++) {
+            PhaseResult result;
+            if (!run_phase(corpus, &bench_phases[p], &result)) {
+                printf("Error: Phase '%s' failed on corpus '%s'\n", bench_phases[p].name, corpus->name);
+                ok = 0;
+                break;
+            }
+            double mean = result.total / result.runs;
+            fprintf(out, "%s\n {\"phase\":\"%s\",\"bytes\":%llu,\"runs\":%d,\"best_s\":%.6f,\"mean_s\":%.6f,"
+                    "\"mb_per_s\":%.2f,\"peak_rss\":%llu}", p ? "," : "", bench_phases[p].name,
+                    (unsigned long long)result.bytes, result.runs, result.best, mean,
+                    perf_mb_per_s(result.bytes, result.best), (unsigned long long)result.peak_rss);
+            if (progress) {
+                printf("  %-14s %9.3f s %9.2f MB/s  peak %llu MB\n", bench_phases[p].name, result.best,
+                       perf_mb_per_s(result.bytes, result.best),
+                       (unsigned long long)(result.peak_rss / (1024 * 1024)));
+            }
+        }
+        fprintf(out, "]}");
+        if (!bench.keep) remove_corpus(corpus);
+    }
+    fprintf(out, "\n]}\n");
+    if (!bench.keep) remove(bench.work_dir);
+
+    if (out != stdout && fclose(out) != 0) {
+        printf("Error: Cannot write output file '%s'\n", bench.output_file);
+        ok = 0;
+    }
+    if (ok && progress) {
+        printf("Benchmark completed, results: %s\n", bench.output_file);
+    }
+    free_docs(corpus);
+    free(corpus);
+    path_list_free(&opts->input_files);
+    free(opts);
+    xmlCleanupParser();
+    return ok ? 0 : 1;
+}
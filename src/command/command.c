@@ -4,81 +4,161 @@
 #include <stdlib.h>
 #include <string.h>
 
-/* Read command line from file | 从文件读取命令行参数 */
-char** read_command_from_file(const char* filename, int* argc) {
-    FILE* file = fopen(filename, "r");
-    if (!file) {
-        printf("Error: Cannot open command file '%s'\n", filename);
-        return NULL;
+/* Growing buffer for one token | 单个参数的增长缓冲区 */
+typedef struct {
+    char* data;
+    size_t len;
+    size_t capacity;
+} Token;
+
+static int token_push(Token* token, char c) {
+    if (token->len + 1 >= token->capacity) {
+        size_t capacity = token->capacity ? token->capacity * 2 : 64;
+        char* grown = (char*)realloc(token->data, capacity);
+        if (!grown) return 0;
+        token->data = grown;
+        token->capacity = capacity;
     }
+    token->data[token->len++] = c;
+    token->data[token->len] = '\0';
+    return 1;
+}
+
+/* Append finished token to argument array | 将完成的参数追加到参数数组 */
+static int argv_push(char*** argv, int* count, int* capacity, const char* value) {
+    if (*count + 2 > *capacity) {
+        int new_capacity = *capacity ? *capacity * 2 : 16;
+        char** grown = (char**)realloc(*argv, (size_t)new_capacity * sizeof(char*));
+        if (!grown) return 0;
+        *argv = grown;
+        *capacity = new_capacity;
+    }
+    char* copy = strdup(value);
+    if (!copy) return 0;
+    (*argv)[(*count)++] = copy;
+    (*argv)[*count] = NULL;
+    return 1;
+}
 
-    /* Read all lines and merge them into one line | 读取所有行并合并成一行 */
-    char buffer[MAX_BUFFER_SIZE] = {0};
-    char line[MAX_CMD_LENGTH];
-    while (fgets(line, sizeof(line), file)) {
-        /* Remove trailing newline | 移除行尾的换行符 */
-        line[strcspn(line, "\r\n")] = 0;
-        
-        /* Skip empty lines | 跳过空行 */
-        if (strlen(line) == 0) {
+/* Read arguments from stream until end of file, or with line set until the end of the next non-empty line | 从流中读取参数直到文件结束，line不为NULL时读到下一个非空行的末尾
+ * Arguments are separated by whitespace or newlines. "..." may contain spaces and
+ * the escapes \" and \\, '...' is taken literally, other backslashes are kept as-is
+ * so Windows paths work. A line starting with # is a comment.
+ * 参数以空白或换行分隔；"..."中可以包含空格以及转义\"和\\，'...'按原样读取，
+ * 其余反斜杠保持不变以支持Windows路径；以#开头的行为注释 */
+static char** read_arguments(FILE* file, const char* name, int* argc, int* line) {
+    char** argv = NULL;
+    int count = 0;
+    int capacity = 0;
+    Token token = {NULL, 0, 0};
+    int ok = argv_push(&argv, &count, &capacity, "arXmlTool.exe");
+
+    char quote = 0;         /* Open quote character, 0 outside quotes | 当前引号字符，不在引号内时为0 */
+    int in_token = 0;       /* Token started, also for "" | 参数已开始，""同样算作参数 */
+    int line_start = 1;
+    int new_line = 1;       /* Next character is the first of a line | 下一个字符是一行的第一个字符 */
+    int c;
+    while (ok && (c = fgetc(file)) != EOF) {
+        if (line && new_line) (*line)++;
+        new_line = c == '\n';
+        if (quote) {
+            if (line && c == '\n') {
+                break;
+            }
+            if (c == quote) {
+                quote = 0;
+            } else if (quote == '"' && c == '\\') {
+                int next = fgetc(file);
+                if (next != '"' && next != '\\') {
+                    ok = token_push(&token, '\\');
+                }
+                if (ok && next != EOF) {
+                    ok = token_push(&token, (char)next);
+                }
+            } else {
+                ok = token_push(&token, (char)c);
+            }
             continue;
         }
-        
-        /* Add space as separator if buffer is not empty | 如果buffer不为空，添加空格作为分隔符 */
-        if (strlen(buffer) > 0) {
-            strcat(buffer, " ");
-        }
-        
-        /* Check if buffer has enough space | 检查buffer是否有足够空间 */
-        if (strlen(buffer) + strlen(line) >= MAX_BUFFER_SIZE - 1) {
-            printf("Error: Command line too long\n");
-            fclose(file);
-            return NULL;
+
+        if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+            if (in_token) {
+                ok = argv_push(&argv, &count, &capacity, token.data ? token.data : "");
+                token.len = 0;
+                if (token.data) token.data[0] = '\0';
+                in_token = 0;
+            }
+            if (c == '\n') {
+                line_start = 1;
+                if (line && count > 1) break;
+            }
+            continue;
         }
-        
-        /* Append current line to buffer | 添加当前行到buffer */
-        strcat(buffer, line);
-    }
-    fclose(file);
 
-    if (strlen(buffer) == 0) {
-        printf("Error: Command file is empty\n");
-        return NULL;
+        /* Skip comment up to end of line | 跳过注释直到行尾 */
+        if (c == '#' && line_start) {
+            while ((c = fgetc(file)) != EOF && c != '\n') {
+            }
+            new_line = 1;
+            continue;
+        }
+        line_start = 0;
+        in_token = 1;
+        if (c == '"' || c == '\'') {
+            quote = (char)c;
+        } else {
+            ok = token_push(&token, (char)c);
+        }
     }
 
-    /* Count arguments | 计算参数个数 */
-    int count = 1; /* Program name takes first position | 程序名占用第一个位置 */
-    char* p = buffer;
-    while (*p) {
-        if (*p == ' ' || *p == '\t') {
-            count++;
-            while (*p && (*p == ' ' || *p == '\t')) p++;
+    if (ok && quote) {
+        if (line) {
+            printf("Error: Unterminated quote in '%s' line %d\n", name, *line);
         } else {
-            p++;
+            printf("Error: Unterminated quote in '%s'\n", name);
         }
+        free(token.data);
+        free_command_args(argv);
+        return NULL;
     }
+    if (ok && in_token) {
+        ok = argv_push(&argv, &count, &capacity, token.data ? token.data : "");
+    }
+    free(token.data);
 
-    /* Allocate memory for argument array | 为参数数组分配内存 */
-    char** argv = (char**)malloc((count + 1) * sizeof(char*));
-    if (!argv) {
+    if (!ok) {
         printf("Error: Memory allocation failed\n");
+        free_command_args(argv);
         return NULL;
     }
 
-    /* Set program name as first argument | 设置程序名为第一个参数 */
-    argv[0] = strdup("arXmlTool.exe");
+    *argc = count;
+    return argv;
+}
+
+char** read_command_stream(FILE* file, const char* name, int* argc) {
+    return read_arguments(file, name, argc, NULL);
+}
+
+char** read_command_line(FILE* file, const char* name, int* argc, int* line) {
+    return read_arguments(file, name, argc, line);
+}
 
-    /* Split command line into arguments | 将命令行分割为参数 */
-    int i = 1;
-    char* token = strtok(buffer, " \t");
-    while (token) {
-        argv[i] = strdup(token);
-        token = strtok(NULL, " \t");
-        i++;
+/* Read command line from file | 从文件读取命令行参数 */
+char** read_command_from_file(const char* filename, int* argc) {
+    FILE* file = fopen(filename, "r");
+    if (!file) {
+        printf("Error: Cannot open command file '%s'\n", filename);
+        return NULL;
     }
-    argv[i] = NULL;
-    *argc = i;
 
+    char** argv = read_command_stream(file, filename, argc);
+    fclose(file);
+    if (argv && *argc <= 1) {
+        printf("Error: Command file is empty\n");
+        free_command_args(argv);
+        return NULL;
+    }
     return argv;
 }
 
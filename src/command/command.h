@@ -1,10 +1,16 @@
 #ifndef COMMAND_H
 #define COMMAND_H
 
+#include <stdio.h>
 #include "../main/common.h"
 
-#define MAX_BUFFER_SIZE (MAX_PATH * MAX_FILES)
-#define MAX_CMD_LENGTH MAX_PATH
+/* Read arguments from stream, argv[0] is the program name | 从流中读取参数，argv[0]为程序名
+ * Quoting as in command files, name is used in messages | 引号规则与命令文件相同，name用于提示信息 */
+char** read_command_stream(FILE* file, const char* name, int* argc);
+
+/* Read arguments of the next non-empty line, argc is 1 at end of file | 读取下一个非空行的参数，文件结束时argc为1
+ * *line counts lines read and ends on the line returned, quotes may not span lines | *line统计已读取的行数，返回时为该参数行的行号，引号不能跨行 */
+char** read_command_line(FILE* file, const char* name, int* argc, int* line);
 
 /* Read commands from file | 从文件读取命令 */
 char** read_command_from_file(const char* filename, int* argc);
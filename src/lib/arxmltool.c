@@ -0,0 +1,237 @@
+#include "arxmltool.h"
+#include "../main/common.h"
+#include "../operations/merge.h"
+#include "../utils/xml_utils.h"
+#include "../utils/ar_path.h"
+#include "../utils/fs_utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <libxml/parser.h>
+#include <libxml/xmlerror.h>
+
+/* Parse flags of the tool, quiet as errors are reported through arxml_last_error | 与工具相同的解析选项，错误通过arxml_last_error报告，不打印 */
+#define LIB_PARSE_OPTIONS (XML_PARSE_NOBLANKS | XML_PARSE_NOERROR | XML_PARSE_NOWARNING)
+
+struct ArxmlDoc {
+    xmlDocPtr doc;
+    ArPathIndex* index;      /* Built on first arxml_find, dropped when the tree changes | 首次调用arxml_find时建立，文档树变化时丢弃 */
+};
+
+static _Thread_local char last_error[512];
+
+static void set_error(const char* format, const char* detail) {
+    snprintf(last_error, sizeof(last_error), format, detail ? detail : "");
+}
+
+/* Take libxml2 message of the failed parse, without its trailing newline | 获取libxml2解析失败的信息，去掉末尾换行 */
+static void set_parse_error(const char* name) {
+    const xmlError* error = xmlGetLastError();
+    int len = snprintf(last_error, sizeof(last_error), "Cannot parse '%s'%s%s", name,
+                       error && error->message ? ": " : "", error && error->message ? error->message : "");
+    while (len > 0 && (size_t)len < sizeof(last_error) && last_error[len - 1] == '\n') {
+        last_error[--len] = '\0';
+    }
+}
+
+static xmlNodePtr node_of(const ArxmlElement* element) {
+    return (xmlNodePtr)element;
+}
+
+static const char* with_length(const xmlChar* value, size_t* len) {
+    if (len) *len = value ? strlen((const char*)value) : 0;
+    return (const char*)value;
+}
+
+const char* arxml_version(void) {
+    return ARXML_TOOL_VERSION;
+}
+
+const char* arxml_last_error(void) {
+    return last_error;
+}
+
+static ArxmlDoc* wrap_document(xmlDocPtr xml, const char* name) {
+    if (!xml) {
+        set_parse_error(name);
+        return NULL;
+    }
+    ArxmlDoc* doc = (ArxmlDoc*)calloc(1, sizeof(ArxmlDoc));
+    if (!doc) {
+        set_error("Memory allocation failed%s", NULL);
+        xmlFreeDoc(xml);
+        return NULL;
+    }
+    doc->doc = xml;
+    return doc;
+}
+
+ArxmlDoc* arxml_parse_file(const char* path) {
+    xmlInitParser();
+    return wrap_document(xmlReadFile(path, NULL, LIB_PARSE_OPTIONS), path);
+}
+
+ArxmlDoc* arxml_parse_buffer(const char* data, size_t size, const char* name) {
+    xmlInitParser();
+    if (size > 0x7fffffff) {
+        set_error("Buffer '%s' is larger than 2 GB", name);
+        return NULL;
+    }
+    return wrap_document(xmlReadMemory(data, (int)size, name, NULL, LIB_PARSE_OPTIONS), name);
+}
+
+static void drop_index(ArxmlDoc* doc) {
+    if (doc->index) {
+        ar_path_index_free(doc->index);
+        doc->index = NULL;
+    }
+}
+
+void arxml_free(ArxmlDoc* doc) {
+    if (!doc) return;
+    drop_index(doc);
+    xmlFreeDoc(doc->doc);
+    free(doc);
+}
+
+int arxml_merge(ArxmlDoc* base, const ArxmlDoc* other) {
+    drop_index(base);
+    if (!merge_arxml_documents(base->doc, other->doc)) {
+        set_error("Cannot merge an empty document%s", NULL);
+        return 0;
+    }
+    return 1;
+}
+
+int arxml_sort(ArxmlDoc* doc, int descending, const char* tag) {
+    xmlNodePtr root = xmlDocGetRootElement(doc->doc);
+    if (!root) {
+        set_error("Empty document%s", NULL);
+        return 0;
+    }
+    if (tag && strlen(tag) >= MAX_PATH) {
+        set_error("Tag name '%s' is too long", tag);
+        return 0;
+    }
+    drop_index(doc);
+    SortOrder order = descending ? SORT_DESC : SORT_ASC;
+    if (tag) {
+        sort_specific_tag_children(root, tag, order);
+    } else {
+        sort_nodes_by_short_name(root, order);
+    }
+    return 1;
+}
+
+int arxml_format(const ArxmlDoc* doc, int indent, char** out, size_t* size) {
+    xmlChar* buffer = NULL;
+    int len = 0;
+    set_output_indent_style(indent == 0 ? 't' : 's', indent);
+    xmlDocDumpFormatMemoryEnc(doc->doc, &buffer, &len, "UTF-8", 1);
+    if (!buffer) {
+        set_error("Cannot serialize document%s", NULL);
+        return 0;
+    }
+    *out = (char*)buffer;
+    if (size) *size = (size_t)len;
+    return 1;
+}
+
+void arxml_free_buffer(char* buffer) {
+    if (buffer) xmlFree(buffer);
+}
+
+int arxml_save(const ArxmlDoc* doc, const char* path, int indent) {
+    if (!create_parent_directories(path)) {
+        set_error("Cannot create output directory for file '%s'", path);
+        return 0;
+    }
+    set_output_indent_style(indent == 0 ? 't' : 's', indent);
+    if (xmlSaveFormatFileEnc(path, doc->doc, "UTF-8", 1) < 0) {
+        set_error("Cannot save file '%s'", path);
+        return 0;
+    }
+    return 1;
+}
+
+const ArxmlElement* arxml_root(const ArxmlDoc* doc) {
+    return (const ArxmlElement*)xmlDocGetRootElement(doc->doc);
+}
+
+const ArxmlElement* arxml_find(ArxmlDoc* doc, const char* path) {
+    if (!doc->index && !(doc->index = ar_path_index_new(doc->doc))) {
+        set_error("Memory allocation failed%s", NULL);
+        return NULL;
+    }
+    return (const ArxmlElement*)ar_path_index_lookup(doc->index, path);
+}
+
+static xmlNodePtr element_from(xmlNodePtr node) {
+    while (node && node->type != XML_ELEMENT_NODE) {
+        node = node->next;
+    }
+    return node;
+}
+
+const ArxmlElement* arxml_first_child(const ArxmlElement* element) {
+    return (const ArxmlElement*)element_from(node_of(element)->children);
+}
+
+const ArxmlElement* arxml_next_sibling(const ArxmlElement* element) {
+    return (const ArxmlElement*)element_from(node_of(element)->next);
+}
+
+const ArxmlElement* arxml_next_identifiable(const ArxmlElement* scope, const ArxmlElement* current) {
+    xmlNodePtr top = node_of(scope);
+    xmlNodePtr node = current ? node_of(current) : top;
+    for (;;) {
+        /* Element after node in document order, not leaving scope | 按文档顺序取node之后的元素，不离开scope */
+        xmlNodePtr next = element_from(node->children);
+        while (!next && node != top) {
+            next = element_from(node->next);
+            if (!next) node = node->parent;
+        }
+        if (!next) return NULL;
+        if (peek_short_name(next)) return (const ArxmlElement*)next;
+        node = next;
+    }
+}
+
+const char* arxml_tag(const ArxmlElement* element, size_t* len) {
+    return with_length(node_of(element)->name, len);
+}
+
+const char* arxml_short_name(const ArxmlElement* element, size_t* len) {
+    return with_length(peek_short_name(node_of(element)), len);
+}
+
+const char* arxml_text(const ArxmlElement* element, size_t* len) {
+    for (xmlNodePtr child = node_of(element)->children; child; child = child->next) {
+        if ((child->type == XML_TEXT_NODE || child->type == XML_CDATA_SECTION_NODE) && child->content) {
+            return with_length(child->content, len);
+        }
+    }
+    return with_length(NULL, len);
+}
+
+const char* arxml_attribute(const ArxmlElement* element, const char* name, size_t* len) {
+    xmlAttrPtr attr = xmlHasProp(node_of(element), (const xmlChar*)name);
+    if (attr && attr->children && attr->children->type == XML_TEXT_NODE) {
+        return with_length(attr->children->content, len);
+    }
+    return with_length(NULL, len);
+}
+
+size_t arxml_path(const ArxmlElement* element, char* buffer, size_t size) {
+    xmlChar* path = get_ar_path(node_of(element));
+    if (!path) {
+        if (size > 0) buffer[0] = '\0';
+        return 0;
+    }
+    size_t len = strlen((const char*)path);
+    if (size > 0) {
+        snprintf(buffer, size, "%s", (const char*)path);
+    }
+    xmlFree(path);
+    return len;
+}
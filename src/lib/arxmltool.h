@@ -0,0 +1,88 @@
+#ifndef ARXMLTOOL_H
+#define ARXMLTOOL_H
+
+/* libarxmltool: in-process API of arXmlTool | libarxmltool：arXmlTool的进程内接口
+ * Link build/libarxmltool.a together with libxml2 and pthread. | 与libxml2和pthread一起链接build/libarxmltool.a。
+ * Functions returning int give 1 on success and 0 on failure, see arxml_last_error. | 返回int的函数成功时返回1，失败时返回0，详见arxml_last_error。
+ * A document may be used by one thread at a time, different documents in parallel. | 同一文档同一时间只能由一个线程使用，不同文档可以并行使用。 */
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Parsed ARXML document | 已解析的ARXML文档 */
+typedef struct ArxmlDoc ArxmlDoc;
+
+/* Element of a document, valid until the document is modified or freed | 文档中的元素，在文档被修改或释放前有效 */
+typedef struct ArxmlElement ArxmlElement;
+
+/* Library version, same as the tool | 库版本，与工具相同 */
+const char* arxml_version(void);
+
+/* Message of the last failure in this thread | 当前线程最近一次失败的信息 */
+const char* arxml_last_error(void);
+
+/* Parse file, NULL on failure | 解析文件，失败时返回NULL */
+ArxmlDoc* arxml_parse_file(const char* path);
+
+/* Parse document held in memory, name is used in messages | 解析内存中的文档，name用于提示信息 */
+ArxmlDoc* arxml_parse_buffer(const char* data, size_t size, const char* name);
+
+/* Free document, NULL is ignored | 释放文档，忽略NULL */
+void arxml_free(ArxmlDoc* doc);
+
+/* Merge elements of other into base like merge mode, other is not changed | 与merge模式相同，将other中的元素合并到base，other不变 */
+int arxml_merge(ArxmlDoc* base, const ArxmlDoc* other);
+
+/* Sort by SHORT-NAME like -s, tag NULL sorts all nodes recursively | 与-s相同，按SHORT-NAME排序，tag为NULL时递归排序所有节点 */
+int arxml_sort(ArxmlDoc* doc, int descending, const char* tag);
+
+/* Serialize document as UTF-8, indent 0 uses tab, otherwise that many spaces | 将文档序列化为UTF-8，indent为0时使用tab，否则使用相应数量的空格
+ * *out must be released with arxml_free_buffer | *out需用arxml_free_buffer释放 */
+int arxml_format(const ArxmlDoc* doc, int indent, char** out, size_t* size);
+
+/* Release buffer returned by arxml_format | 释放arxml_format返回的缓冲区 */
+void arxml_free_buffer(char* buffer);
+
+/* Save document to file, creating its directory | 将文档保存到文件，并创建所在目录 */
+int arxml_save(const ArxmlDoc* doc, const char* path, int indent);
+
+/* Root element (AUTOSAR), NULL for an empty document | 根元素（AUTOSAR），空文档时返回NULL */
+const ArxmlElement* arxml_root(const ArxmlDoc* doc);
+
+/* Find identifiable by AUTOSAR path, e.g. "/Pkg/Sub/MySwc", NULL if absent | 按AUTOSAR路径查找可标识元素，例如"/Pkg/Sub/MySwc"，不存在时返回NULL
+ * Packages are indexed on first use, lookups cost only the touched packages | 包在首次使用时建立索引，查找开销只与涉及的包有关 */
+const ArxmlElement* arxml_find(ArxmlDoc* doc, const char* path);
+
+/* Next identifiable below scope in document order, current NULL gives the first | 按文档顺序返回scope下的下一个可标识元素，current为NULL时返回第一个
+ * Nested identifiables are visited too, NULL after the last | 也会访问嵌套的可标识元素，最后一个之后返回NULL */
+const ArxmlElement* arxml_next_identifiable(const ArxmlElement* scope, const ArxmlElement* current);
+
+/* First child element and next sibling element, NULL if none | 第一个子元素和下一个兄弟元素，不存在时返回NULL */
+const ArxmlElement* arxml_first_child(const ArxmlElement* element);
+const ArxmlElement* arxml_next_sibling(const ArxmlElement* element);
+
+/* Accessors below point into the document without copying, len may be NULL | 以下访问函数直接指向文档内部，不复制，len可以为NULL
+ * Tag names are interned in the document dictionary | 标签名保存在文档的字典中 */
+const char* arxml_tag(const ArxmlElement* element, size_t* len);
+
+/* SHORT-NAME, NULL if element is not identifiable | SHORT-NAME，元素不可标识时返回NULL */
+const char* arxml_short_name(const ArxmlElement* element, size_t* len);
+
+/* Text of a leaf element such as a reference, NULL if it has none | 叶子元素（如引用）的文本，没有文本时返回NULL */
+const char* arxml_text(const ArxmlElement* element, size_t* len);
+
+/* Attribute value such as DEST, NULL if absent | 属性值（如DEST），不存在时返回NULL */
+const char* arxml_attribute(const ArxmlElement* element, const char* name, size_t* len);
+
+/* Write AUTOSAR path of element into buffer like snprintf | 与snprintf相同，将元素的AUTOSAR路径写入buffer
+ * Returns the full length, the root element has the empty path | 返回完整长度，根元素路径为空 */
+size_t arxml_path(const ArxmlElement* element, char* buffer, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ARXMLTOOL_H */
@@ -0,0 +1,132 @@
+#ifndef ARXMLTOOL_HPP
+#define ARXMLTOOL_HPP
+
+/* C++17 wrapper of libarxmltool | libarxmltool的C++17封装
+ * Documents free themselves, failures throw arxml::Error, string_views point into the document. | 文档自动释放，失败时抛出arxml::Error，string_view直接指向文档内部。 */
+
+#include "arxmltool.h"
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace arxml {
+
+/* Failure reported by the library | 库报告的错误 */
+class Error : public std::runtime_error {
+public:
+    Error() : std::runtime_error(arxml_last_error()) {}
+};
+
+namespace detail {
+inline std::string_view view(const char* data, size_t len) {
+    return data ? std::string_view(data, len) : std::string_view();
+}
+inline void check(int ok) {
+    if (!ok) throw Error();
+}
+}
+
+/* Non-owning handle of an element, valid while its document is unchanged | 元素的非拥有句柄，在文档未变化时有效 */
+class Element {
+public:
+    Element(const ArxmlElement* element = nullptr) : element_(element) {}
+
+    explicit operator bool() const { return element_ != nullptr; }
+    const ArxmlElement* get() const { return element_; }
+
+    std::string_view tag() const { size_t len; const char* s = arxml_tag(element_, &len); return detail::view(s, len); }
+    std::string_view short_name() const { size_t len; const char* s = arxml_short_name(element_, &len); return detail::view(s, len); }
+    std::string_view text() const { size_t len; const char* s = arxml_text(element_, &len); return detail::view(s, len); }
+    std::string_view attribute(const char* name) const { size_t len; const char* s = arxml_attribute(element_, name, &len); return detail::view(s, len); }
+
+    /* AUTOSAR path is built, not stored, so it is returned by value | AUTOSAR路径需要构建，并未保存在文档中，因此按值返回 */
+    std::string path() const {
+        std::string path(arxml_path(element_, nullptr, 0), '\0');
+        arxml_path(element_, &path[0], path.size() + 1);
+        return path;
+    }
+
+    Element first_child() const { return arxml_first_child(element_); }
+    Element next_sibling() const { return arxml_next_sibling(element_); }
+
+    bool operator==(const Element& other) const { return element_ == other.element_; }
+    bool operator!=(const Element& other) const { return element_ != other.element_; }
+
+private:
+    const ArxmlElement* element_;
+};
+
+/* Identifiables below a scope in document order, for range-for | 按文档顺序排列的scope下的可标识元素，可用于范围for */
+class Identifiables {
+public:
+    class iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Element;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Element*;
+        using reference = Element;
+
+        iterator(const ArxmlElement* scope, const ArxmlElement* current) : scope_(scope), current_(current) {}
+        Element operator*() const { return current_; }
+        iterator& operator++() { current_ = arxml_next_identifiable(scope_, current_); return *this; }
+        bool operator==(const iterator& other) const { return current_ == other.current_; }
+        bool operator!=(const iterator& other) const { return current_ != other.current_; }
+
+    private:
+        const ArxmlElement* scope_;
+        const ArxmlElement* current_;
+    };
+
+    explicit Identifiables(Element scope) : scope_(scope.get()) {}
+    iterator begin() const { return iterator(scope_, scope_ ? arxml_next_identifiable(scope_, nullptr) : nullptr); }
+    iterator end() const { return iterator(scope_, nullptr); }
+
+private:
+    const ArxmlElement* scope_;
+};
+
+/* Owning handle of a parsed document | 已解析文档的拥有句柄 */
+class Document {
+public:
+    static Document parse_file(const std::string& path) { return Document(arxml_parse_file(path.c_str())); }
+    static Document parse_buffer(std::string_view data, const std::string& name = "buffer") {
+        return Document(arxml_parse_buffer(data.data(), data.size(), name.c_str()));
+    }
+
+    void merge(const Document& other) { detail::check(arxml_merge(doc_.get(), other.doc_.get())); }
+    void sort(bool descending = false, const char* tag = nullptr) { detail::check(arxml_sort(doc_.get(), descending, tag)); }
+
+    std::string format(int indent = 4) const {
+        char* buffer = nullptr;
+        size_t size = 0;
+        detail::check(arxml_format(doc_.get(), indent, &buffer, &size));
+        std::string text(buffer, size);
+        arxml_free_buffer(buffer);
+        return text;
+    }
+    void save(const std::string& path, int indent = 4) const { detail::check(arxml_save(doc_.get(), path.c_str(), indent)); }
+
+    Element root() const { return arxml_root(doc_.get()); }
+    Element find(const std::string& path) { return arxml_find(doc_.get(), path.c_str()); }
+    Identifiables identifiables() const { return Identifiables(root()); }
+
+    ArxmlDoc* get() const { return doc_.get(); }
+
+private:
+    struct Deleter {
+        void operator()(ArxmlDoc* doc) const { arxml_free(doc); }
+    };
+
+    explicit Document(ArxmlDoc* doc) : doc_(doc) {
+        if (!doc) throw Error();
+    }
+
+    std::unique_ptr<ArxmlDoc, Deleter> doc_;
+};
+
+}  // namespace arxml
+
+#endif /* ARXMLTOOL_HPP */
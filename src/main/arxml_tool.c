@@ -8,6 +8,9 @@
 #include <getopt.h>
 #include "arxml_tool.h"
 #include "options.h"
+#include "serve.h"
+#include "watch.h"
+#include "batch.h"
 
 /* Parse operation mode from string | 从字符串解析操作模式 */
 OperationMode parse_mode(const char* mode_str) {
@@ -15,6 +18,18 @@ OperationMode parse_mode(const char* mode_str) {
     if (strcmp(mode_str, "compare") == 0) return MODE_COMPARE;
     if (strcmp(mode_str, "generate") == 0) return MODE_GENERATE;
     if (strcmp(mode_str, "format") == 0) return MODE_FORMAT;
+    if (strcmp(mode_str, "patch") == 0) return MODE_PATCH;
+    if (strcmp(mode_str, "synth") == 0) return MODE_SYNTH;
+    if (strcmp(mode_str, "index") == 0) return MODE_INDEX;
+    if (strcmp(mode_str, "extract") == 0) return MODE_EXTRACT;
+    if (strcmp(mode_str, "check-refs") == 0) return MODE_CHECK_REFS;
+    if (strcmp(mode_str, "split") == 0) return MODE_SPLIT;
+    if (strcmp(mode_str, "rename") == 0) return MODE_RENAME;
+    if (strcmp(mode_str, "stats") == 0) return MODE_STATS;
+    if (strcmp(mode_str, "serve") == 0) return MODE_SERVE;
+    if (strcmp(mode_str, "client") == 0) return MODE_CLIENT;
+    if (strcmp(mode_str, "batch") == 0) return MODE_BATCH;
+    if (strcmp(mode_str, "snapshot") == 0) return MODE_SNAPSHOT;
     return MODE_UNKNOWN;
 }
 
@@ -27,12 +42,27 @@ void print_usage(void) {
     printf("  arXmlTool.exe --help\n\n");
     printf("Modes:\n");
     printf("  merge    - Merge multiple ARXML files\n");
-    printf("  compare  - Compare ARXML files (Not implemented yet)\n");
-    printf("  generate - Generate ARXML file (Not implemented yet)\n");
-    printf("  format   - Format ARXML files\n\n");
+    printf("  compare  - Compare two ARXML files, optionally writing a patch\n");
+    printf("  generate - Generate ARXML file from a CSV / JSON lines spec\n");
+    printf("  format   - Format ARXML files\n");
+    printf("  patch    - Apply a patch written by compare to a base file\n");
+    printf("  synth    - Generate a deterministic synthetic ARXML corpus for benchmarks\n");
+    printf("  index    - Write a path to byte offset index beside ARXML files\n");
+    printf("  extract  - Extract subtrees by AUTOSAR path into a new ARXML file\n");
+    printf("  check-refs - Check that all references resolve across the input files\n");
+    printf("  split    - Split one ARXML file per package or by size, inverse of merge\n");
+    printf("  rename   - Rename or move elements and rewrite all references to them\n");
+    printf("  stats    - Report element, package, depth and reference statistics of ARXML files\n");
+    printf("  serve    - Run merge, format and compare jobs from a Unix socket, keeping documents parsed\n");
+    printf("  client   - Send a merge, format or compare job to a running server\n");
+    printf("  batch    - Run the merge, format and compare jobs of a job file in dependency order\n");
+    printf("  snapshot - Write a binary snapshot beside ARXML files, loaded by merge without parsing\n\n");
     printf("Merge mode options:\n");
     printf("  -a <file.arxml>  Specify input file (can be used multiple times)\n");
-    printf("  -m <file.arxml>  Specify output file\n");
+    printf("                   - .arxml.gz and .arxml.xz files are decompressed while parsing\n");
+    printf("                   - '-' reads standard input (once), gzip or xz data is decompressed\n");
+    printf("  -m <file.arxml>  Specify output file, compressed if it ends in .gz or .xz\n");
+    printf("                   - '-' writes standard output, messages then go to standard error\n");
     printf("  -o <directory>   Specify output directory (optional)\n");
     printf("  -i <style>       Specify indentation style (optional)\n");
     printf("                   - If not specified: Keep source file indentation\n");
@@ -43,10 +73,31 @@ void print_usage(void) {
     printf("                   - 'desc': Sort in descending\n");
     printf("  -t <tag>        Specify tag name for sorting its children (optional)\n");
     printf("                   - If not specified: Sort all nodes recursively\n");
-    printf("                   - If specified: Only sort children of specified tag\n\n");
+    printf("                   - If specified: Only sort children of specified tag\n");
+    printf("  --profile[=<file.json>] Print time, bytes, MB/s and peak memory per file and phase,\n");
+    printf("                   or write them as JSON (optional)\n");
+    printf("  --alloc-stats    Also count libxml2 allocations, bytes, high-water mark and size classes\n");
+    printf("                   per phase (optional, implies --profile)\n");
+    printf("  --arena          Allocate documents from an arena and skip freeing the merged tree\n");
+    printf("                   at exit (optional, faster, slightly higher peak memory)\n");
+    printf("  --watch          Merge again whenever an input changes, unchanged inputs stay parsed\n");
+    printf("                   (optional, until Ctrl+C)\n");
+    printf("  --result-cache <directory> Reuse the output of an earlier merge with identical inputs\n");
+    printf("                   and options, shared by processes (optional, default $ARXML_RESULT_CACHE)\n");
+    printf("  --result-cache-size <size> Bytes kept in the result cache, least recently used outputs\n");
+    printf("                   are removed first (optional, default 1G)\n");
+    printf("  --load-snapshot <file.snap> Use snapshot as the first input instead of parsing it,\n");
+    printf("                   -a files are merged into it (optional)\n");
+    printf("  --only-path <pattern> Keep only AUTOSAR paths matching pattern, e.g. /Com/Pdu* or /**/Swc*\n");
+    printf("                   (optional, can be used multiple times, '**' matches any number of packages)\n");
+    printf("  --skip-path <pattern> Drop AUTOSAR paths matching pattern while parsing (optional, can be used multiple times)\n");
+    printf("  -j <n>           Threads compressing a .gz or .xz output (optional, default: one per CPU)\n\n");
     printf("Format mode options:\n");
     printf("  -a <file.arxml>  Specify input file (can be used multiple times)\n");
+    printf("                   - .arxml.gz and .arxml.xz files are decompressed and written back compressed\n");
+    printf("                   - '-' reads standard input and writes the result to standard output\n");
     printf("  -o <directory>   Specify output directory (optional, will overwrite source files if not specified)\n");
+    printf("                   - '-' writes the only input file to standard output\n");
     printf("  -i <style>       Specify indentation style (optional)\n");
     printf("                   - If not specified: Keep source file indentation\n");
     printf("                   - 'tab': Use tab for indentation\n");
@@ -57,6 +108,115 @@ void print_usage(void) {
     printf("  -t <tag>        Specify tag name for sorting its children (optional)\n");
     printf("                   - If not specified: Sort all nodes recursively\n");
     printf("                   - If specified: Only sort children of specified tag\n");
+    printf("  --profile[=<file.json>] Print time, bytes, MB/s and peak memory per file and phase,\n");
+    printf("                   or write them as JSON (optional)\n");
+    printf("  --alloc-stats    Also count libxml2 allocations, bytes, high-water mark and size classes\n");
+    printf("                   per phase (optional, implies --profile)\n");
+    printf("  --arena          Allocate each file from an arena reset after saving it (optional, faster)\n");
+    printf("  --watch          Format changed inputs again whenever they are saved (optional, until Ctrl+C)\n");
+    printf("  --only-path <pattern> Keep only AUTOSAR paths matching pattern (optional, same as merge, needs -o)\n");
+    printf("  --skip-path <pattern> Drop AUTOSAR paths matching pattern (optional, same as merge, needs -o)\n");
+    printf("  -j <n>           Threads compressing .gz or .xz outputs (optional, default: one per CPU)\n\n");
+    printf("Compare mode options:\n");
+    printf("  -a <file.arxml>  Specify base file, then new file (exactly two), .gz and .xz files are decompressed\n");
+    printf("                   - Two directories compare all *.arxml paired by relative path\n");
+    printf("                   - '-' reads one of the two files from standard input\n");
+    printf("  -p <patch.jsonl> Write differences as patch file (optional), '-' writes standard output\n");
+    printf("                   - For directories: patch directory, one <file>.jsonl per differing pair\n");
+    printf("  -j <n>           Worker threads for directory compare (optional, default: one per CPU)\n\n");
+    printf("Patch mode options:\n");
+    printf("  -a <file.arxml>  Specify base file\n");
+    printf("  -p <patch.jsonl> Specify patch file written by compare\n");
+    printf("  -m <file.arxml>  Specify output file\n");
+    printf("  -o <directory>   Specify output directory (optional)\n");
+    printf("  -i <style>       Specify indentation style (optional, same as merge)\n\n");
+    printf("Generate mode options:\n");
+    printf("  -a <spec>        Specify spec file, CSV or JSON lines (kind,path,tag,dest,value)\n");
+    printf("                   - 'package': AR-PACKAGE at path\n");
+    printf("                   - 'element': element <tag> at path inside its package\n");
+    printf("                   - 'ref' / 'value': child <tag> of the element at path\n");
+    printf("                   - Rows of a package are contiguous, its elements come before its sub-packages\n");
+    printf("  -m <file.arxml>  Specify output file\n");
+    printf("  -o <directory>   Specify output directory (optional)\n");
+    printf("  -i <style>       Specify indentation style (optional, default: 4 spaces)\n\n");
+    printf("Synth mode options:\n");
+    printf("  -o <directory>   Specify output directory (optional)\n");
+    printf("  -m <prefix>      Specify file name prefix, files are <prefix>_0000.arxml,\n");
+    printf("                   <prefix>_0001.arxml, ... (optional, default: corpus)\n");
+    printf("  -i <style>       Specify indentation style (optional, default: 4 spaces)\n");
+    printf("  -j <n>           Worker threads (optional, default: one per CPU)\n");
+    printf("  --seed <n>       Random seed, same seed gives identical files (default: 1)\n");
+    printf("  --depth <n>      AR-PACKAGE nesting depth (default: 3)\n");
+    printf("  --fanout <n>     Sub-packages per package (default: 4)\n");
+    printf("  --elements <n>   Elements per file (default: 10000)\n");
+    printf("  --name-length <n> SHORT-NAME length (default: 16)\n");
+    printf("  --ref-density <x> Average references per element (default: 1.0)\n");
+    printf("  --duplicates <x> Ratio of elements shared by all files, 0..1 (default: 0)\n");
+    printf("  --files <n>      Number of files (default: 1)\n");
+    printf("  --size <size>    Total corpus size, e.g. 100M or 10G, overrides --elements\n\n");
+    printf("Index mode options:\n");
+    printf("  -a <file.arxml>  Specify input file (can be used multiple times), writes <file.arxml>.idx\n");
+    printf("  -j <n>           Worker threads (optional, default: one per CPU)\n\n");
+    printf("Extract mode options:\n");
+    printf("  -a <file.arxml>  Specify input file\n");
+    printf("  -e <path>        AUTOSAR path to extract, e.g. /Pkg/Sub/MySwc (can be used multiple times)\n");
+    printf("  -m <file.arxml>  Specify output file\n");
+    printf("  -o <directory>   Specify output directory (optional)\n");
+    printf("  -i <style>       Specify indentation style (optional, same as merge)\n\n");
+    printf("Check-refs mode options:\n");
+    printf("  -a <file.arxml>  Specify input file (can be used multiple times), all files form one model\n");
+    printf("  -j <n>           Worker threads (optional, default: one per CPU)\n\n");
+    printf("Split mode options:\n");
+    printf("  -a <file.arxml>  Specify input file\n");
+    printf("  -o <directory>   Specify output directory (optional)\n");
+    printf("  -m <prefix>      Specify file name prefix (optional)\n");
+    printf("  -j <n>           Worker threads writing files (optional, default: one per CPU)\n");
+    printf("  --depth <n>      One file per AR-PACKAGE at depth n (default: 1, top-level packages)\n");
+    printf("  --size <size>    Cut into files of about size bytes, e.g. 50M, files are <prefix>_0000.arxml, ...\n");
+    printf("                   - Without --depth, cuts between elements, ignoring package borders\n\n");
+    printf("Rename mode options:\n");
+    printf("  -a <file.arxml>  Specify input file (can be used multiple times), all files form one model\n");
+    printf("  -r <old>=<new>   Rename element, e.g. /Pkg/OldSwc=/Pkg/NewSwc (can be used multiple times)\n");
+    printf("                   - A different parent package moves the element there\n");
+    printf("  -o <directory>   Write changed files here instead of in place (optional)\n");
+    printf("  -j <n>           Worker threads (optional, default: one per CPU)\n\n");
+    printf("Stats mode options:\n");
+    printf("  -a <file.arxml>  Specify input file (can be used multiple times)\n");
+    printf("  -m <file>        Write report to file instead of the console (optional)\n");
+    printf("                   - '-' writes standard output, messages then go to standard error\n");
+    printf("  -o <directory>   Specify output directory (optional)\n");
+    printf("  -j <n>           Worker threads (optional, default: one per CPU)\n");
+    printf("  --json           Write JSON with all tags instead of text\n");
+    printf("  --top <n>        Tags and largest subtrees listed (default: 20)\n\n");
+    printf("Serve mode options:\n");
+    printf("  --socket <path>  Unix socket to listen on\n");
+    printf("  -j <n>           Jobs run at the same time (optional, default: one per CPU)\n");
+    printf("  --cache-size <size> Source bytes of parsed documents kept between jobs, e.g. 1G (default: 256M)\n");
+    printf("                   - Documents are checked by size, modification time and content hash\n\n");
+    printf("Client mode options:\n");
+    printf("  --socket <path>  Unix socket of the server\n");
+    printf("  <mode> [options] merge, format or compare job with the usual options,\n");
+    printf("                   e.g. client --socket /tmp/arxml.sock merge -a a.arxml -a b.arxml -m out.arxml\n\n");
+    printf("Batch mode options:\n");
+    printf("  -a <jobs.txt>    Job file, one merge, format or compare job per line with the usual options,\n");
+    printf("                   e.g. merge -a a.arxml -a b.arxml -m build/ab.arxml\n");
+    printf("                   - A job reading a file written by another job runs after it\n");
+    printf("                   - Outputs stay parsed in memory for the jobs reading them\n");
+    printf("  -j <n>           Jobs run at the same time (optional, default: one per CPU)\n");
+    printf("  --cache-size <size> Source bytes of parsed documents kept between jobs, e.g. 1G (default: 256M)\n\n");
+    printf("Snapshot mode options:\n");
+    printf("  -a <file.arxml>  Specify input file (can be used multiple times), writes <file.arxml>.snap\n");
+    printf("  -j <n>           Worker threads (optional, default: one per CPU)\n\n");
+    printf("Input directory options (merge, format, index, check-refs, rename, stats, snapshot):\n");
+    printf("  -d <directory>   Add all *.arxml below directory, sorted (can be used multiple times)\n");
+    printf("                   - merge and format also add *.arxml.gz and *.arxml.xz\n");
+    printf("  --include <glob> Only add files matching glob (can be used multiple times)\n");
+    printf("  --exclude <glob> Skip files and directories matching glob (can be used multiple times)\n");
+    printf("                   - '*' and '?' stay inside one path segment, '**' spans directories\n");
+    printf("                   - Glob without '/' matches the file name, otherwise the path below -d\n\n");
+    printf("Command file:\n");
+    printf("  Options separated by spaces or lines, lines starting with # are comments.\n");
+    printf("  \"...\" keeps spaces and allows \\\" and \\\\, '...' is taken literally.\n");
 }
 
 /* Program entry point | 程序入口点 */
@@ -67,12 +227,7 @@ int main(int argc, char *argv[]) {
     int result = 0;
 
     /* Initialize options | 初始化选项 */
-    memset(&opts, 0, sizeof(ProgramOptions));
-    opts.mode = MODE_UNKNOWN;
-    opts.indent_style = INDENT_DEFAULT;
-    opts.indent_width = 4;  /* Default to 4 spaces | 默认使用4空格缩进 */
-    opts.sort_order = SORT_NONE;
-    strncpy(opts.output_dir, ".", MAX_PATH - 1);
+    init_options(&opts);
 
     /* Process command file if specified | 如果指定了命令文件则处理 */
     if (argc == 4 && strcmp(argv[2], "-f") == 0) {
@@ -84,46 +239,111 @@ int main(int argc, char *argv[]) {
         
         /* Parse options from command file | 从命令文件解析选项 */
         opts.mode = parse_mode(argv[1]);
-        if (opts.mode == MODE_MERGE) {
-            if (!parse_merge_options(cmd_argc, cmd_argv, &opts)) {
-                free_command_args(cmd_argv);
-                return 1;
-            }
-        } else if (opts.mode == MODE_FORMAT) {
-            if (!parse_format_options(cmd_argc, cmd_argv, &opts)) {
-                free_command_args(cmd_argv);
-                return 1;
-            }
-        } else {
-            printf("Error: Invalid operation mode\n");
+        if (!parse_mode_options(opts.mode, cmd_argc, cmd_argv, &opts)) {
+            free_options(&opts);
             free_command_args(cmd_argv);
             return 1;
         }
     } else {
         /* Parse options from command line | 从命令行解析选项 */
         if (!parse_options(argc, argv, &opts)) {
+            free_options(&opts);
             return 1;
         }
     }
 
+    /* Document data written to "-" owns standard output, messages move to standard error | 写入"-"的文档数据独占标准输出，消息改为输出到标准错误 */
+    if (options_write_stdout(opts.mode, &opts) && !reserve_stdout()) {
+        printf("Error: Cannot write standard output\n");
+        free_options(&opts);
+        if (cmd_argv) {
+            free_command_args(cmd_argv);
+        }
+        return 1;
+    }
+
+    /* Arena first, so counting hooks wrap it | 先安装arena，使计数钩子包装在其外层 */
+    if (opts.arena && !xml_arena_install()) {
+        printf("Error: Cannot install allocation hooks\n");
+        free_options(&opts);
+        if (cmd_argv) {
+            free_command_args(cmd_argv);
+        }
+        return 1;
+    }
+
+    /* Count libxml2 allocations, hooks must be set before its first allocation | 统计libxml2内存分配，钩子必须在其首次分配之前设置 */
+    if (opts.alloc_stats && !mem_stats_install()) {
+        printf("Error: Cannot install allocation hooks\n");
+        free_options(&opts);
+        if (cmd_argv) {
+            free_command_args(cmd_argv);
+        }
+        return 1;
+    }
+
     /* Process according to operation mode | 根据操作模式处理 */
     switch (opts.mode) {
         case MODE_MERGE:
-            result = merge_arxml_files(&opts);
+            result = opts.watch ? watch_arxml_files(&opts) : merge_arxml_files(&opts);
             break;
         case MODE_FORMAT:
-            result = format_arxml_files(&opts);
+            result = opts.watch ? watch_arxml_files(&opts) : format_arxml_files(&opts);
+            break;
+        case MODE_COMPARE:
+            result = compare_arxml_files(&opts);
+            break;
+        case MODE_PATCH:
+            result = patch_arxml_file(&opts);
+            break;
+        case MODE_GENERATE:
+            result = generate_arxml_file(&opts);
+            break;
+        case MODE_SYNTH:
+            result = synth_arxml_corpus(&opts);
+            break;
+        case MODE_INDEX:
+            result = index_arxml_files(&opts);
+            break;
+        case MODE_EXTRACT:
+            result = extract_arxml_subtrees(&opts);
+            break;
+        case MODE_CHECK_REFS:
+            result = check_arxml_references(&opts);
+            break;
+        case MODE_SPLIT:
+            result = split_arxml_file(&opts);
+            break;
+        case MODE_RENAME:
+            result = rename_arxml_elements(&opts);
+            break;
+        case MODE_STATS:
+            result = stats_arxml_files(&opts);
+            break;
+        case MODE_SERVE:
+            result = serve_arxml_jobs(&opts);
+            break;
+        case MODE_CLIENT:
+            result = send_arxml_job(&opts);
+            break;
+        case MODE_BATCH:
+            result = run_arxml_batch(&opts);
+            break;
+        case MODE_SNAPSHOT:
+            result = snapshot_arxml_files(&opts);
             break;
         default:
             printf("Error: Invalid operation mode\n");
-            result = 1;
+            result = 0;
             break;
     }
 
-    /* Free command file arguments after processing | 处理完成后释放命令文件参数 */
+    /* Free options and command file arguments after processing, options point into them | 处理完成后释放选项和命令文件参数，选项指向这些参数 */
+    free_options(&opts);
     if (cmd_argv) {
         free_command_args(cmd_argv);
     }
 
-    return result;
+    /* Operations return 1 on success, the process exits 0 on success | 操作成功返回1，进程成功时退出码为0 */
+    return result ? 0 : 1;
 }
\ No newline at end of file
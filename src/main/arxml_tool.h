@@ -6,6 +6,20 @@
 #include "../command/command.h"
 #include "../operations/merge.h"
 #include "../operations/format.h"
+#include "../operations/compare.h"
+#include "../operations/patch.h"
+#include "../operations/generate.h"
+#include "../operations/synth.h"
+#include "../operations/index.h"
+#include "../operations/extract.h"
+#include "../operations/check_refs.h"
+#include "../operations/split.h"
+#include "../operations/rename.h"
+#include "../operations/stats.h"
+#include "../operations/snapshot.h"
+#include "../utils/mem_stats.h"
+#include "../utils/xml_arena.h"
+#include "../utils/compressed_io.h"
 
 /* Parse operation mode from string | 从字符串解析操作模式 */
 OperationMode parse_mode(const char* mode_str);
@@ -0,0 +1,461 @@
+#include "batch.h"
+#include "options.h"
+#include "../command/command.h"
+#include "../operations/merge.h"
+#include "../operations/format.h"
+#include "../operations/compare.h"
+#include "../utils/doc_cache.h"
+#include "../utils/thread_pool.h"
+#include "../utils/perf_utils.h"
+#include "../utils/compressed_io.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <pthread.h>
+
+typedef struct Batch Batch;
+
+/* One job, a line of the job file | 一个任务，即任务文件中的一行 */
+typedef struct {
+    int line;
+    char** argv;             /* Options point into it | 选项指向这些参数 */
+    ProgramOptions opts;
+    PathList owned;          /* Normalized option paths | 规范化后的选项路径 */
+    PathList outputs;        /* Files written, absolute and normalized like the inputs | 写出的文件，与输入一样为规范化的绝对路径 */
+    int* dependents;         /* Jobs reading an output of this one, reused for ready jobs when it ends | 读取本任务输出的任务，本任务结束时复用于存放就绪任务 */
+    int dependent_count;
+    int waiting;             /* Unfinished jobs this one reads from | 本任务读取的未完成任务数 */
+    int failed_line;         /* Line of a failed job this one reads from, 0 if none | 本任务读取的失败任务所在行，没有时为0 */
+    Batch* batch;
+} BatchJob;
+
+struct Batch {
+    BatchJob* jobs;
+    int count;
+    ThreadPool* pool;
+    pthread_mutex_t lock;    /* Guards waiting, failed_line and the counters | 保护waiting、failed_line和计数 */
+    int done;
+    int failed;
+    int skipped;
+};
+
+/* File written by a job, sorted by path to find the job producing an input | 任务写出的文件，按路径排序以查找生成某个输入的任务 */
+typedef struct {
+    const char* path;
+    int job;
+} BatchOutput;
+
+static int is_separator(char c) {
+#ifdef _WIN32
+    return c == '/' || c == '\\';
+#else
+    return c == '/';
+#endif
+}
+
+/* Absolute path without ".", ".." and repeated separators, caller frees it | 去掉"."、".."和重复分隔符的绝对路径，由调用者释放
+ * Only the text is changed, so paths of files not written yet work too | 只处理文本，因此尚未写出的文件路径同样适用 */
+static char* normalize_path(const char* cwd, const char* path) {
+    size_t root = 0;
+#ifdef _WIN32
+    if (isalpha((unsigned char)path[0]) && path[1] == ':' && is_separator(path[2])) root = 2;
+#endif
+    int absolute = root > 0 || is_separator(path[0]);
+    size_t size = strlen(cwd) + strlen(path) + 3;
+    char* result = (char*)malloc(size);
+    if (!result) return NULL;
+    if (absolute) {
+        snprintf(result, size, "%s", path);
+    } else {
+        snprintf(result, size, "%s/%s", cwd, path);
+#ifdef _WIN32
+        if (isalpha((unsigned char)cwd[0]) && cwd[1] == ':') root = 2;
+#endif
+    }
+
+    /* Copy segments in place, the write position never passes the read position | 原地复制各段，写位置不会超过读位置 */
+    char* read = result + root;
+    char* write = result + root;
+    *write++ = '/';
+    char* top = write;
+    while (*read) {
+        while (*read && is_separator(*read)) read++;
+        char* segment = read;
+        while (*read && !is_separator(*read)) read++;
+        size_t len = (size_t)(read - segment);
+        if (len == 0 || (len == 1 && segment[0] == '.')) {
+            continue;
+        }
+        if (len == 2 && segment[0] == '.' && segment[1] == '.') {
+            while (write > top && write[-1] != '/') write--;
+            if (write > top) write--;
+            continue;
+        }
+        if (write > top) *write++ = '/';
+        memmove(write, segment, len);
+        write += len;
+    }
+    *write = '\0';
+    return result;
+}
+
+static int add_normalized(PathList* list, const char* cwd, const char* path) {
+    char* normalized = normalize_path(cwd, path);
+    int ok = normalized && path_list_add(list, normalized);
+    free(normalized);
+    return ok;
+}
+
+/* Normalized option path kept by the job, empty stays empty | 由任务保存的规范化选项路径，空路径保持不变 */
+static const char* owned_path(BatchJob* job, const char* cwd, const char* path) {
+    if (path[0] == '\0') {
+        return path;
+    }
+    return add_normalized(&job->owned, cwd, path) ? job->owned.items[job->owned.count - 1] : NULL;
+}
+
+/* Normalize paths of the job and record the files it writes | 规范化任务的路径并记录其写出的文件
+ * Equal files get equal paths, so outputs are found again in the document cache | 相同的文件得到相同的路径，从而能在文档缓存中找到输出 */
+static int collect_paths(BatchJob* job, const char* cwd) {
+    ProgramOptions* opts = &job->opts;
+    for (int i = 0; i < opts->input_files.count; i++) {
+        char* normalized = normalize_path(cwd, opts->input_files.items[i]);
+        if (!normalized) return 0;
+        free(opts->input_files.items[i]);
+        opts->input_files.items[i] = normalized;
+    }
+    /* "." means no -o, so only an explicit directory is normalized | "."表示未指定-o，只规范化明确指定的目录 */
+    if (strcmp(opts->output_dir, ".") != 0 && !(opts->output_dir = owned_path(job, cwd, opts->output_dir))) return 0;
+    if (!(opts->output_file = owned_path(job, cwd, opts->output_file))) return 0;
+    if (!(opts->patch_file = owned_path(job, cwd, opts->patch_file))) return 0;
+
+    if (opts->mode == MODE_COMPARE) {
+        return opts->patch_file[0] == '\0' || path_list_add(&job->outputs, opts->patch_file);
+    }
+
+    /* Merge writes one file, format one per input | merge写出一个文件，format每个输入写出一个文件 */
+    int count = opts->mode == MODE_MERGE ? 1 : opts->input_files.count;
+    for (int i = 0; i < count; i++) {
+        char* output = build_output_path(opts->mode == MODE_MERGE ? opts->output_file : opts->input_files.items[i],
+                                         opts->output_dir);
+        int ok = output && path_list_add(&job->outputs, output);
+        free(output);
+        if (!ok) return 0;
+    }
+    return 1;
+}
+
+/* Parse options of one job | 解析一个任务的选项 */
+static int parse_job(BatchJob* job, int argc, const char* job_file) {
+    ProgramOptions* opts = &job->opts;
+    opts->mode = parse_mode(job->argv[1]);
+    if (opts->mode != MODE_MERGE && opts->mode != MODE_FORMAT && opts->mode != MODE_COMPARE) {
+        printf("Error: Batch runs merge, format and compare jobs, not '%s' ('%s' line %d)\n",
+               job->argv[1], job_file, job->line);
+        return 0;
+    }
+    if (!parse_mode_options(opts->mode, argc - 1, job->argv + 1, opts)) {
+        printf("Error: Invalid job in '%s' line %d\n", job_file, job->line);
+        return 0;
+    }
+    if (opts->arena || opts->alloc_stats || opts->watch) {
+        printf("Error: --arena, --alloc-stats and --watch are not available in batch jobs ('%s' line %d)\n",
+               job_file, job->line);
+        return 0;
+    }
+    /* Jobs run side by side, none can own standard input or output | 任务并行运行，任何任务都不能独占标准输入或输出 */
+    if (has_stdio_path(&opts->input_files) || options_write_stdout(opts->mode, opts)) {
+        printf("Error: Standard input and output ('-') are not available in batch jobs ('%s' line %d)\n",
+               job_file, job->line);
+        return 0;
+    }
+    return 1;
+}
+
+/* Read all jobs, options are parsed here as getopt is not thread safe | 读取所有任务，由于getopt不是线程安全的，选项在此处解析 */
+static int load_jobs(const char* job_file, const char* cwd, Batch* batch) {
+    FILE* file = fopen(job_file, "r");
+    if (!file) {
+        printf("Error: Cannot open job file '%s'\n", job_file);
+        return 0;
+    }
+
+    int capacity = 0;
+    int line = 0;
+    int ok = 1;
+    while (ok) {
+        int argc = 0;
+        char** argv = read_command_line(file, job_file, &argc, &line);
+        if (!argv) {
+            ok = 0;
+            break;
+        }
+        if (argc <= 1) {
+            free_command_args(argv);
+            break;
+        }
+        if (batch->count == capacity) {
+            int new_capacity = capacity ? capacity * 2 : 64;
+            BatchJob* grown = (BatchJob*)realloc(batch->jobs, (size_t)new_capacity * sizeof(BatchJob));
+            if (!grown) {
+                printf("Error: Memory allocation failed\n");
+                free_command_args(argv);
+                ok = 0;
+                break;
+            }
+            batch->jobs = grown;
+            capacity = new_capacity;
+        }
+
+        BatchJob* job = &batch->jobs[batch->count++];
+        memset(job, 0, sizeof(BatchJob));
+        init_options(&job->opts);
+        job->line = line;
+        job->argv = argv;
+        ok = parse_job(job, argc, job_file);
+        if (ok && !collect_paths(job, cwd)) {
+            printf("Error: Memory allocation failed\n");
+            ok = 0;
+        }
+    }
+    fclose(file);
+
+    if (ok && batch->count == 0) {
+        printf("Error: Job file '%s' has no jobs\n", job_file);
+        ok = 0;
+    }
+    return ok;
+}
+
+static int compare_outputs(const void* a, const void* b) {
+    return strcmp(((const BatchOutput*)a)->path, ((const BatchOutput*)b)->path);
+}
+
+/* Make job wait for producer, once per pair | 使任务等待生成其输入的任务，每对任务只记录一次 */
+static int add_dependency(Batch* batch, int producer, int job) {
+    BatchJob* from = &batch->jobs[producer];
+    if (from->dependent_count > 0 && from->dependents[from->dependent_count - 1] == job) {
+        return 1;
+    }
+    int* grown = (int*)realloc(from->dependents, (size_t)(from->dependent_count + 1) * sizeof(int));
+    if (!grown) return 0;
+    from->dependents = grown;
+    from->dependents[from->dependent_count++] = job;
+    batch->jobs[job].waiting++;
+    return 1;
+}
+
+/* Check that all jobs can run, a job waits for nothing that waits for it | 检查所有任务都能运行，即任务之间没有循环等待 */
+static int check_cycles(const Batch* batch) {
+    int* waiting = (int*)malloc((size_t)batch->count * sizeof(int));
+    int* ready = (int*)malloc((size_t)batch->count * sizeof(int));
+    if (!waiting || !ready) {
+        printf("Error: Memory allocation failed\n");
+        free(waiting);
+        free(ready);
+        return 0;
+    }
+    int ready_count = 0;
+    for (int i = 0; i < batch->count; i++) {
+        waiting[i] = batch->jobs[i].waiting;
+        if (waiting[i] == 0) ready[ready_count++] = i;
+    }
+    for (int r = 0; r < ready_count; r++) {
+        const BatchJob* job = &batch->jobs[ready[r]];
+        for (int d = 0; d < job->dependent_count; d++) {
+            if (--waiting[job->dependents[d]] == 0) ready[ready_count++] = job->dependents[d];
+        }
+    }
+
+    int ok = ready_count == batch->count;
+    for (int i = 0; !ok && i < batch->count; i++) {
+        if (waiting[i] > 0) {
+            printf("Error: Jobs read each other's outputs in a cycle, e.g. the job at line %d\n", batch->jobs[i].line);
+            break;
+        }
+    }
+    free(waiting);
+    free(ready);
+    return ok;
+}
+
+/* Find the job producing each input, a file may be written by one job only | 查找生成每个输入的任务，一个文件只能由一个任务写出
+ * Outputs read by other jobs are announced to the document cache | 被其他任务读取的输出会告知文档缓存 */
+static int link_jobs(Batch* batch, const char* job_file) {
+    int total = 0;
+    for (int i = 0; i < batch->count; i++) {
+        total += batch->jobs[i].outputs.count;
+    }
+    BatchOutput* outputs = (BatchOutput*)malloc((size_t)(total > 0 ? total : 1) * sizeof(BatchOutput));
+    if (!outputs) {
+        printf("Error: Memory allocation failed\n");
+        return 0;
+    }
+    int n = 0;
+    for (int i = 0; i < batch->count; i++) {
+        for (int k = 0; k < batch->jobs[i].outputs.count; k++) {
+            outputs[n].path = batch->jobs[i].outputs.items[k];
+            outputs[n++].job = i;
+        }
+    }
+    qsort(outputs, (size_t)n, sizeof(BatchOutput), compare_outputs);
+
+    int ok = 1;
+    for (int i = 1; ok && i < n; i++) {
+        if (strcmp(outputs[i - 1].path, outputs[i].path) == 0) {
+            printf("Error: '%s' is written by the jobs at line %d and %d of '%s'\n", outputs[i].path,
+                   batch->jobs[outputs[i - 1].job].line, batch->jobs[outputs[i].job].line, job_file);
+            ok = 0;
+        }
+    }
+
+    for (int j = 0; ok && j < batch->count; j++) {
+        const PathList* inputs = &batch->jobs[j].opts.input_files;
+        for (int k = 0; ok && k < inputs->count; k++) {
+            BatchOutput key = {inputs->items[k], 0};
+            const BatchOutput* found = (const BatchOutput*)bsearch(&key, outputs, (size_t)n, sizeof(BatchOutput),
+                                                                    compare_outputs);
+            /* Formatting in place reads its own output | 原地格式化读取自身的输出 */
+            if (found && found->job != j &&
+                (!add_dependency(batch, found->job, j) || !doc_cache_expect(inputs->items[k], 1))) {
+                printf("Error: Memory allocation failed\n");
+                ok = 0;
+            }
+        }
+    }
+    free(outputs);
+    return ok && check_cycles(batch);
+}
+
+static void run_batch_job(void* arg);
+
+/* Start job on the pool, or right here if it cannot be queued | 在线程池中启动任务，无法加入队列时直接运行 */
+static void start_job(BatchJob* job) {
+    if (!thread_pool_submit(job->batch->pool, run_batch_job, job)) {
+        run_batch_job(job);
+    }
+}
+
+/* Worker task: run job, then start jobs that waited only for it | 工作线程任务：运行任务，然后启动只等待该任务的任务 */
+static void run_batch_job(void* arg) {
+    BatchJob* job = (BatchJob*)arg;
+    Batch* batch = job->batch;
+    int result = 0;
+    if (job->failed_line) {
+        printf("Job at line %d: %s skipped, input from failed job at line %d\n", job->line, job->argv[1],
+               job->failed_line);
+    } else {
+        double start = perf_now();
+        switch (job->opts.mode) {
+            case MODE_MERGE:
+                result = merge_arxml_files(&job->opts);
+                break;
+            case MODE_FORMAT:
+                result = format_arxml_files(&job->opts);
+                break;
+            default:
+                result = compare_arxml_files(&job->opts);
+                break;
+        }
+        printf("Job at line %d: %s %s in %.1f ms\n", job->line, job->argv[1], result ? "done" : "failed",
+               (perf_now() - start) * 1000.0);
+    }
+    fflush(stdout);
+
+    pthread_mutex_lock(&batch->lock);
+    if (result) batch->done++;
+    else if (job->failed_line) batch->skipped++;
+    else batch->failed++;
+    int ready = 0;
+    for (int d = 0; d < job->dependent_count; d++) {
+        BatchJob* next = &batch->jobs[job->dependents[d]];
+        if (!result && !next->failed_line) {
+            next->failed_line = job->failed_line ? job->failed_line : job->line;
+        }
+        if (--next->waiting == 0) {
+            job->dependents[ready++] = job->dependents[d];
+        }
+    }
+    pthread_mutex_unlock(&batch->lock);
+
+    for (int r = 0; r < ready; r++) {
+        start_job(&batch->jobs[job->dependents[r]]);
+    }
+}
+
+static void free_batch(Batch* batch) {
+    for (int i = 0; i < batch->count; i++) {
+        BatchJob* job = &batch->jobs[i];
+        free_options(&job->opts);
+        path_list_free(&job->owned);
+        path_list_free(&job->outputs);
+        free(job->dependents);
+        free_command_args(job->argv);
+    }
+    free(batch->jobs);
+}
+
+int run_arxml_batch(const ProgramOptions *opts) {
+    const char* job_file = opts->input_files.items[0];
+    Batch batch;
+    memset(&batch, 0, sizeof(batch));
+
+    char* cwd = get_current_directory();
+    if (!cwd) {
+        printf("Error: Cannot get current directory\n");
+        return 0;
+    }
+    /* Outputs are passed in memory, inputs nobody writes are parsed by each job as usual | 输出通过内存传递，没有任务写出的输入由各任务照常解析 */
+    doc_cache_install_outputs(opts->serve.cache_size);
+    int ok = load_jobs(job_file, cwd, &batch) && link_jobs(&batch, job_file);
+    free(cwd);
+
+    /* Jobs waiting for nothing, taken before any job runs and changes the counts | 不等待其他任务的任务，在任何任务运行并修改计数之前取出 */
+    int* initial = ok ? (int*)malloc((size_t)batch.count * sizeof(int)) : NULL;
+    if (ok && !initial) {
+        printf("Error: Memory allocation failed\n");
+        ok = 0;
+    }
+    if (!ok) {
+        doc_cache_shutdown();
+        free_batch(&batch);
+        return 0;
+    }
+    int initial_count = 0;
+    for (int i = 0; i < batch.count; i++) {
+        batch.jobs[i].batch = &batch;
+        if (batch.jobs[i].waiting == 0) initial[initial_count++] = i;
+    }
+
+    int workers = opts->jobs > 0 ? opts->jobs : get_cpu_count();
+    perf_set_shared_process();
+    pthread_mutex_init(&batch.lock, NULL);
+    batch.pool = thread_pool_create(workers);
+    if (!batch.pool) {
+        printf("Error: Cannot create worker threads\n");
+        ok = 0;
+    } else {
+        printf("Batch: %d jobs from '%s', %d workers\n", batch.count, job_file, workers);
+        fflush(stdout);
+        double start = perf_now();
+        for (int i = 0; i < initial_count; i++) {
+            start_job(&batch.jobs[initial[i]]);
+        }
+        thread_pool_destroy(batch.pool);
+
+        DocCacheStats stats;
+        doc_cache_get_stats(&stats);
+        printf("Batch finished in %.1f ms: %d done, %d failed, %d skipped, "
+               "%llu outputs passed in memory, %llu files parsed\n",
+               (perf_now() - start) * 1000.0, batch.done, batch.failed, batch.skipped,
+               (unsigned long long)stats.stored, (unsigned long long)stats.parsed);
+        ok = batch.failed == 0 && batch.skipped == 0;
+    }
+
+    doc_cache_shutdown();
+    pthread_mutex_destroy(&batch.lock);
+    free(initial);
+    free_batch(&batch);
+    return ok;
+}
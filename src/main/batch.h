@@ -0,0 +1,12 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "common.h"
+
+/* Run merge, format and compare jobs of a job file, one job per line | 运行任务文件中的merge、format和compare任务，每行一个任务
+ * A job reading another job's output runs after it, independent jobs run in parallel.
+ * Outputs stay parsed in memory, so consuming jobs do not parse them again.
+ * 读取其他任务输出的任务在其之后运行，相互独立的任务并行运行；输出保持解析状态，后续任务无需重新解析 */
+int run_arxml_batch(const ProgramOptions *opts);
+
+#endif /* BATCH_H */
@@ -4,8 +4,11 @@
 /* 在文件开头添加版本信息常量 */
 #define ARXML_TOOL_VERSION "1.1.0"
 
+#include <stdint.h>
+#include "../utils/fs_utils.h"
+
+/* Limit of tag names, file and AUTOSAR paths have no limit | 标签名的长度上限，文件路径和AUTOSAR路径不受限制 */
 #define MAX_PATH 256
-#define MAX_FILES 1024
 
 /* Operation mode | 操作模式 */
 typedef enum {
@@ -13,7 +16,19 @@ typedef enum {
     MODE_MERGE,
     MODE_FORMAT,
     MODE_COMPARE,
-    MODE_GENERATE
+    MODE_GENERATE,
+    MODE_PATCH,
+    MODE_SYNTH,
+    MODE_INDEX,
+    MODE_EXTRACT,
+    MODE_CHECK_REFS,
+    MODE_SPLIT,
+    MODE_RENAME,
+    MODE_STATS,
+    MODE_SERVE,
+    MODE_CLIENT,
+    MODE_BATCH,
+    MODE_SNAPSHOT
 } OperationMode;
 
 /* Sort order for format/merge operations | 格式化/合并操作的排序方式 */
@@ -30,18 +45,72 @@ typedef enum {
     INDENT_SPACE = 1     /* Space indentation | 空格缩进 */
 } IndentStyle;
 
+/* Synthetic corpus parameters | 合成测试语料参数 */
+typedef struct {
+    uint64_t seed;           /* Same seed gives byte identical corpus | 相同种子生成完全相同的语料 */
+    int package_depth;       /* AR-PACKAGE nesting levels | AR-PACKAGE嵌套层数 */
+    int package_fanout;      /* Sub-packages per package | 每个包的子包数量 */
+    long elements;           /* Elements per file | 每个文件的元素数量 */
+    int name_length;         /* SHORT-NAME length | SHORT-NAME长度 */
+    double ref_density;      /* Average references per element | 每个元素的平均引用数 */
+    double duplicate_ratio;  /* Share of elements present in every file | 在所有文件中都出现的元素比例 */
+    int file_count;          /* Number of files | 文件数量 */
+    uint64_t target_size;    /* Total corpus bytes, overrides elements if set | 语料总字节数，设置后覆盖元素数量 */
+} SynthParams;
+
+/* Split mode parameters | 拆分模式参数 */
+typedef struct {
+    int depth;               /* Package depth of output files, 0 to cut between elements | 输出文件对应的包深度，0表示在元素之间切分 */
+    uint64_t chunk_size;     /* Target bytes per file, 0 for one file per package | 每个文件的目标字节数，0表示每个包一个文件 */
+} SplitParams;
+
+/* Stats mode parameters | 统计模式参数 */
+typedef struct {
+    int json;                /* Write JSON instead of text | 输出JSON而不是文本 */
+    int top;                 /* Tags and subtrees listed in text output | 文本输出中列出的标签和子树数量 */
+} StatsParams;
+
+/* Serve and client mode parameters, batch mode uses cache_size | 服务和客户端模式参数，batch模式使用cache_size */
+typedef struct {
+    const char* socket_path; /* Unix socket of the server | 服务器的Unix套接字 */
+    uint64_t cache_size;     /* Source bytes of documents kept parsed | 保持解析状态的文档的源文件字节数 */
+    int job_argc;            /* Client: mode and its options sent to the server | 客户端：发送给服务器的模式及其选项 */
+    char** job_argv;
+    const char* client_dir;  /* Server: relative -d directories are walked here, NULL for the current directory | 服务器：相对的-d目录在此目录中遍历，NULL表示当前目录 */
+} ServeParams;
+
 /* Program options | 程序选项 */
 typedef struct {
     OperationMode mode;
-    char input_files[MAX_FILES][MAX_PATH];
-    int input_file_count;
-    char output_file[MAX_PATH];
-    char output_dir[MAX_PATH];
+    PathList input_files;    /* Files given with -a or found with -d, any number | 通过-a指定或通过-d找到的文件，数量不限 */
+    PathList input_dirs;     /* Directories searched for *.arxml with -d | 通过-d搜索*.arxml的目录 */
+    PathList include_globs;  /* --include globs for -d | -d使用的--include通配符 */
+    PathList exclude_globs;  /* --exclude globs for -d | -d使用的--exclude通配符 */
+    const char* output_file; /* Option paths point into argv, never NULL | 选项中的路径指向argv，从不为NULL */
+    const char* output_dir;
     IndentStyle indent_style;
     int indent_width;        /* Number of spaces for indentation | 缩进的空格数 */
     SortOrder sort_order;
     char target_tag[256];    /* Target tag name for sorting | 要排序的目标标签名 */
     int sort_specific_tag;   /* Whether to sort specific tag only | 是否只对特定标签排序 */
+    int jobs;                /* Worker threads, 0 means one per CPU | 工作线程数，0表示每个CPU一个 */
+    const char* patch_file;  /* Patch file written by compare / read by patch | compare写出、patch读取的补丁文件 */
+    SynthParams synth;       /* Parameters of synth mode | synth模式的参数 */
+    PathList ar_paths;       /* AUTOSAR paths given with -e or old paths of -r, any number and length | 通过-e指定的AUTOSAR路径或-r的旧路径，数量和长度不限 */
+    PathList new_paths;      /* New paths of -r old=new, paired with ar_paths | -r old=new中的新路径，与ar_paths一一对应 */
+    SplitParams split;       /* Parameters of split mode | split模式的参数 */
+    StatsParams stats;       /* Parameters of stats mode | stats模式的参数 */
+    ServeParams serve;       /* Parameters of serve and client mode | serve和client模式的参数 */
+    int profile;             /* Measure phases of merge/format | 测量merge/format各阶段 */
+    const char* profile_file;  /* JSON profile output, empty prints a table | JSON性能记录输出文件，为空时打印表格 */
+    int alloc_stats;         /* Count libxml2 allocations per phase | 按阶段统计libxml2的内存分配 */
+    int arena;               /* Allocate libxml2 trees from an arena | 从arena分配libxml2文档树 */
+    int watch;               /* Run merge/format again when inputs change | 输入文件变化时重新运行merge/format */
+    const char* result_cache;  /* Directory of earlier merge outputs, empty for none | 保存之前merge输出的目录，为空表示不使用 */
+    uint64_t result_cache_size;  /* Bytes the result cache keeps | 结果缓存保留的字节数 */
+    const char* snapshot_file;  /* --load-snapshot base of merge, empty for none | merge的--load-snapshot基础快照，为空表示不使用 */
+    PathList only_paths;     /* --only-path AUTOSAR path patterns of merge/format | merge/format的--only-path AUTOSAR路径模式 */
+    PathList skip_paths;     /* --skip-path AUTOSAR path patterns of merge/format | merge/format的--skip-path AUTOSAR路径模式 */
 } ProgramOptions;
 
 #endif /* COMMON_H */
\ No newline at end of file
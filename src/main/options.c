@@ -4,7 +4,10 @@
 #include <stdlib.h>
 #include <getopt.h>
 #include "../utils/fs_utils.h"
+#include "../utils/dir_walk.h"
+#include "../utils/compressed_io.h"
 #include "../main/arxml_tool.h"
+#include "../operations/synth.h"
 
 #ifdef _WIN32
 #include <io.h>
@@ -15,76 +18,343 @@
 
 extern int optind;  /* 声明 optind */
 
-/* Parse command line options | 解析命令行选项 */
-int parse_options(int argc, char *argv[], ProgramOptions *opts) {
-    /* Initialize basic options | 初始化基本选项 */
+/* Parse worker thread count | 解析工作线程数 */
+static int parse_jobs(const char* value, ProgramOptions *opts) {
+    char* endptr;
+    long jobs = strtol(value, &endptr, 10);
+    if (*endptr != '\0' || jobs < 0 || jobs > 1024) {
+        printf("Error: Invalid number of jobs '%s'\n", value);
+        return 0;
+    }
+    opts->jobs = (int)jobs;
+    return 1;
+}
+
+/* Parse -i value, "tab" or a number of spaces | 解析-i的值，"tab"或空格数 */
+static int parse_indent(const char* value, ProgramOptions *opts) {
+    if (strcmp(value, "tab") == 0) {
+        opts->indent_style = INDENT_TAB;
+        return 1;
+    }
+    char* endptr;
+    long spaces = strtol(value, &endptr, 10);
+    if (*endptr != '\0' || spaces <= 0) {
+        printf("Error: Invalid indent style '%s'. Use 'tab' or a positive number\n", value);
+        return 0;
+    }
+    opts->indent_style = INDENT_SPACE;
+    opts->indent_width = (int)spaces;
+    return 1;
+}
+
+/* Append input file given with -a | 追加通过-a指定的输入文件 */
+static int add_input_file(const char* path, ProgramOptions *opts) {
+    if (!path_list_add(&opts->input_files, path)) {
+        printf("Error: Memory allocation failed\n");
+        return 0;
+    }
+    return 1;
+}
+
+/* Remember directory or glob given with -d, --include or --exclude | 记录通过-d、--include或--exclude指定的目录或通配符 */
+static int add_option_value(PathList* list, const char* value) {
+    if (!path_list_add(list, value)) {
+        printf("Error: Memory allocation failed\n");
+        return 0;
+    }
+    return 1;
+}
+
+/* Remember AUTOSAR path pattern given with --only-path or --skip-path | 记录通过--only-path或--skip-path指定的AUTOSAR路径模式 */
+static int add_path_pattern(PathList* list, const char* value) {
+    if (!ar_path_pattern_valid(value)) {
+        printf("Error: Invalid AUTOSAR path pattern '%s'. Use a form like /Pkg/Sub or /Pkg/*Swc*\n", value);
+        return 0;
+    }
+    return add_option_value(list, value);
+}
+
+/* Append *.arxml files found below -d directories, sorted per directory | 追加-d目录下找到的*.arxml文件，每个目录内按顺序排列 */
+static int collect_input_dirs(ProgramOptions *opts) {
+    if (opts->input_dirs.count == 0) {
+        if (opts->include_globs.count > 0 || opts->exclude_globs.count > 0) {
+            printf("Error: --include and --exclude require an input directory (-d)\n");
+            return 0;
+        }
+        return 1;
+    }
+
+    /* Modes parsing through libxml2 also read compressed files | 通过libxml2解析的模式也读取压缩文件 */
+    int compressed = opts->mode == MODE_MERGE || opts->mode == MODE_FORMAT;
+    DirWalkFilter filter = {".arxml", compressed, &opts->include_globs, &opts->exclude_globs, opts->jobs};
+    for (int d = 0; d < opts->input_dirs.count; d++) {
+        const char* dir = opts->input_dirs.items[d];
+        char* joined = NULL;
+        if (opts->serve.client_dir && dir[0] != '/') {
+            /* Jobs of the server name directories relative to their client | 服务器的任务以相对客户端的路径指定目录 */
+            size_t size = strlen(opts->serve.client_dir) + strlen(dir) + 2;
+            joined = (char*)malloc(size);
+            if (!joined) {
+                printf("Error: Memory allocation failed\n");
+                return 0;
+            }
+            snprintf(joined, size, "%s/%s", opts->serve.client_dir, dir);
+            dir = joined;
+        }
+        size_t dir_len = strlen(dir);
+        while (dir_len > 1 && (dir[dir_len - 1] == '/' || dir[dir_len - 1] == '\\')) dir_len--;
+
+        PathList found = {0};
+        if (!dir_walk(dir, &filter, &found)) {
+            path_list_free(&found);
+            free(joined);
+            return 0;
+        }
+        if (found.count == 0) {
+            printf("Warning: No *.arxml files found in '%s'\n", dir);
+        }
+        int ok = 1;
+        for (int i = 0; ok && i < found.count; i++) {
+            size_t size = dir_len + strlen(found.items[i]) + 2;
+            char* path = (char*)malloc(size);
+            ok = path != NULL;
+            if (ok) {
+                snprintf(path, size, "%.*s/%s", (int)dir_len, dir, found.items[i]);
+                ok = add_input_file(path, opts);
+                free(path);
+            } else {
+                printf("Error: Memory allocation failed\n");
+            }
+        }
+        path_list_free(&found);
+        free(joined);
+        if (!ok) return 0;
+    }
+    return 1;
+}
+
+/* Initialize options with defaults | 使用默认值初始化选项 */
+void init_options(ProgramOptions *opts) {
     memset(opts, 0, sizeof(ProgramOptions));
     opts->mode = MODE_UNKNOWN;
     opts->indent_style = INDENT_DEFAULT;
-    opts->indent_width = 4;
+    opts->indent_width = 4;  /* Default to 4 spaces | 默认使用4空格缩进 */
     opts->sort_order = SORT_NONE;
-    /* Initialize new options | 初始化新选项 */
-    opts->sort_specific_tag = 0;
-    memset(opts->target_tag, 0, sizeof(opts->target_tag));
-    
-    strncpy(opts->output_dir, ".", MAX_PATH - 1);
+    opts->output_file = "";
+    opts->output_dir = ".";
+    opts->patch_file = "";
+    opts->profile_file = "";
+    opts->serve.socket_path = "";
+    opts->serve.cache_size = (uint64_t)256 << 20;
+    opts->result_cache = "";
+    opts->result_cache_size = (uint64_t)1 << 30;
+    opts->snapshot_file = "";
+}
+
+/* Free input file lists | 释放输入文件列表 */
+void free_options(ProgramOptions *opts) {
+    path_list_free(&opts->input_files);
+    path_list_free(&opts->input_dirs);
+    path_list_free(&opts->include_globs);
+    path_list_free(&opts->exclude_globs);
+    path_list_free(&opts->only_paths);
+    path_list_free(&opts->skip_paths);
+    path_list_free(&opts->ar_paths);
+    path_list_free(&opts->new_paths);
+}
+
+/* Parse command line options | 解析命令行选项 */
+int parse_options(int argc, char *argv[], ProgramOptions *opts) {
 
     /* Parse operation mode | 解析操作模式 */
-    if (strcmp(argv[1], "merge") == 0) {
-        opts->mode = MODE_MERGE;
-        return parse_merge_options(argc - 1, argv + 1, opts);
-    } else if (strcmp(argv[1], "format") == 0) {
-        opts->mode = MODE_FORMAT;
-        return parse_format_options(argc - 1, argv + 1, opts);
-    } else if (strcmp(argv[1], "--help") == 0) {
+    if (strcmp(argv[1], "--help") == 0) {
         print_usage();
         return 0;
     } else if (strcmp(argv[1], "--version") == 0) {
         printf("arXmlTool version %s\n", ARXML_TOOL_VERSION);
         return 0;
-    } else {
+    }
+
+    opts->mode = parse_mode(argv[1]);
+    if (opts->mode == MODE_UNKNOWN) {
         printf("Error: Unknown operation mode '%s'\n", argv[1]);
         return 0;
     }
+    return parse_mode_options(opts->mode, argc - 1, argv + 1, opts);
+}
+
+/* Parse options of given mode | 解析指定模式的选项 */
+int parse_mode_options(OperationMode mode, int argc, char *argv[], ProgramOptions *opts) {
+    switch (mode) {
+        case MODE_MERGE:
+            return parse_merge_options(argc, argv, opts);
+        case MODE_FORMAT:
+            return parse_format_options(argc, argv, opts);
+        case MODE_COMPARE:
+            return parse_compare_options(argc, argv, opts);
+        case MODE_PATCH:
+            return parse_patch_options(argc, argv, opts);
+        case MODE_GENERATE:
+            return parse_generate_options(argc, argv, opts);
+        case MODE_SYNTH:
+            return parse_synth_options(argc, argv, opts);
+        case MODE_INDEX:
+            return parse_index_options(argc, argv, opts);
+        case MODE_EXTRACT:
+            return parse_extract_options(argc, argv, opts);
+        case MODE_CHECK_REFS:
+            return parse_check_refs_options(argc, argv, opts);
+        case MODE_SPLIT:
+            return parse_split_options(argc, argv, opts);
+        case MODE_RENAME:
+            return parse_rename_options(argc, argv, opts);
+        case MODE_STATS:
+            return parse_stats_options(argc, argv, opts);
+        case MODE_SERVE:
+            return parse_serve_options(argc, argv, opts);
+        case MODE_CLIENT:
+            return parse_client_options(argc, argv, opts);
+        case MODE_BATCH:
+            return parse_batch_options(argc, argv, opts);
+        case MODE_SNAPSHOT:
+            return parse_snapshot_options(argc, argv, opts);
+        default:
+            printf("Error: Invalid operation mode\n");
+            return 0;
+    }
+}
+
+/* Parse size with optional K/M/G suffix | 解析带可选K/M/G后缀的大小 */
+static int parse_size(const char* value, uint64_t* size) {
+    char* endptr;
+    double number = strtod(value, &endptr);
+    double unit = 1.0;
+    if (*endptr == 'K' || *endptr == 'k') {
+        unit = 1024.0;
+        endptr++;
+    } else if (*endptr == 'M' || *endptr == 'm') {
+        unit = 1024.0 * 1024.0;
+        endptr++;
+    } else if (*endptr == 'G' || *endptr == 'g') {
+        unit = 1024.0 * 1024.0 * 1024.0;
+        endptr++;
+    }
+    if (*endptr != '\0' || endptr == value || number <= 0) {
+        printf("Error: Invalid size '%s'. Use a number with optional K, M or G suffix\n", value);
+        return 0;
+    }
+    *size = (uint64_t)(number * unit);
+    return 1;
+}
+
+/* Long options of modes taking input directories | 接受输入目录的模式的长选项 */
+#define INPUT_LONG_OPTIONS \
+    {"include", required_argument, NULL, 'I'}, \
+    {"exclude", required_argument, NULL, 'X'}
+
+/* Long options shared by merge and format | merge和format共用的长选项 */
+#define PROFILE_LONG_OPTIONS \
+    {"profile", optional_argument, NULL, 'P'}, \
+    {"alloc-stats", no_argument, NULL, 'M'}, \
+    {"arena", no_argument, NULL, 'R'}, \
+    {"watch", no_argument, NULL, 'W'}, \
+    INPUT_LONG_OPTIONS, \
+    {"only-path", required_argument, NULL, 'O'}, \
+    {"skip-path", required_argument, NULL, 'K'}
+
+static const struct option profile_options[] = {
+    PROFILE_LONG_OPTIONS,
+    {NULL, 0, NULL, 0}
+};
+
+static const struct option input_options[] = {
+    INPUT_LONG_OPTIONS,
+    {NULL, 0, NULL, 0}
+};
+
+/* Long options of merge, the shared ones plus the result cache and snapshot | merge的长选项，即共用选项加上结果缓存和快照 */
+static const struct option merge_options[] = {
+    PROFILE_LONG_OPTIONS,
+    {"result-cache", required_argument, NULL, 'Q'},
+    {"result-cache-size", required_argument, NULL, 'Y'},
+    {"load-snapshot", required_argument, NULL, 'B'},
+    {NULL, 0, NULL, 0}
+};
+
+/* Parse --profile[=<file.json>] | 解析--profile[=<file.json>] */
+static void parse_profile(const char* value, ProgramOptions *opts) {
+    opts->profile = 1;
+    if (value) {
+        opts->profile_file = value;
+    }
+}
+
+/* Check inputs named "-", standard input can be read only once and not watched | 检查名为"-"的输入，标准输入只能读取一次且无法监视
+ * A watch rewriting its output again and again cannot write standard output either | 反复重写输出的监视也不能写出到标准输出 */
+static int check_stdio_paths(const ProgramOptions *opts, const char* output) {
+    int count = 0;
+    for (int i = 0; i < opts->input_files.count; i++) {
+        count += is_stdio_path(opts->input_files.items[i]);
+    }
+    if (count > 1) {
+        printf("Error: Standard input ('-') can be read only once\n");
+        return 0;
+    }
+    if (count == 1 && opts->watch) {
+        printf("Error: --watch cannot watch standard input\n");
+        return 0;
+    }
+    if (is_stdio_path(output) && opts->watch) {
+        printf("Error: --watch cannot write standard output\n");
+        return 0;
+    }
+    return 1;
+}
+
+int options_write_stdout(OperationMode mode, const ProgramOptions *opts) {
+    switch (mode) {
+        case MODE_MERGE:
+            return is_stdio_path(opts->output_file);
+        case MODE_FORMAT:
+            return is_stdio_path(opts->output_dir) || has_stdio_path(&opts->input_files);
+        case MODE_COMPARE:
+            return is_stdio_path(opts->patch_file);
+        case MODE_STATS:
+            return is_stdio_path(opts->output_file) || is_stdio_path(opts->output_dir);
+        default:
+            return 0;
+    }
 }
 
 /* Parse merge operation options | 解析合并操作的选项 */
 int parse_merge_options(int argc, char *argv[], ProgramOptions *opts) {
     int opt;
-    opts->input_file_count = 0;
+    path_list_free(&opts->input_files);
     
     /* Reset getopt | 重置getopt */
     optind = 1;
     
-    while ((opt = getopt(argc, argv, "a:m:o:i:s:t:")) != -1) {
+    while ((opt = getopt_long(argc, argv, "a:d:m:o:i:s:t:j:", merge_options, NULL)) != -1) {
         switch (opt) {
             case 'a':
-                if (opts->input_file_count >= MAX_FILES) {
-                    printf("Error: Number of input files exceeds limit (%d)\n", MAX_FILES);
+                if (!add_input_file(optarg, opts)) {
                     return 0;
                 }
-                strncpy(opts->input_files[opts->input_file_count], optarg, MAX_PATH - 1);
-                opts->input_file_count++;
                 break;
             case 'm':
-                strncpy(opts->output_file, optarg, MAX_PATH - 1);
+                opts->output_file = optarg;
                 break;
             case 'o':
-                strncpy(opts->output_dir, optarg, MAX_PATH - 1);
+                opts->output_dir = optarg;
+                break;
+            case 'j':
+                if (!parse_jobs(optarg, opts)) {
+                    return 0;
+                }
                 break;
             case 'i':
-                if (strcmp(optarg, "tab") == 0) {
-                    opts->indent_style = INDENT_TAB;
-                } else {
-                    /* Try to parse number of spaces | 尝试解析空格数 */
-                    char* endptr;
-                    long spaces = strtol(optarg, &endptr, 10);
-                    if (*endptr != '\0' || spaces <= 0) {
-                        printf("Error: Invalid indent style '%s'. Use 'tab' or a positive number\n", optarg);
-                        return 0;
-                    }
-                    opts->indent_style = INDENT_SPACE;
-                    opts->indent_width = (int)spaces;
+                if (!parse_indent(optarg, opts)) {
+                    return 0;
                 }
                 break;
                 case 's':
@@ -103,6 +373,54 @@ int parse_merge_options(int argc, char *argv[], ProgramOptions *opts) {
                 strncpy(opts->target_tag, optarg, sizeof(opts->target_tag) - 1);
                 opts->target_tag[sizeof(opts->target_tag) - 1] = '\0';
                 break;
+            case 'P':
+                parse_profile(optarg, opts);
+                break;
+            case 'M':
+                /* Reported per phase, so it implies --profile | 按阶段报告，因此隐含--profile */
+                opts->alloc_stats = 1;
+                opts->profile = 1;
+                break;
+            case 'R':
+                opts->arena = 1;
+                break;
+            case 'W':
+                opts->watch = 1;
+                break;
+            case 'd':
+                if (!add_option_value(&opts->input_dirs, optarg)) {
+                    return 0;
+                }
+                break;
+            case 'I':
+                if (!add_option_value(&opts->include_globs, optarg)) {
+                    return 0;
+                }
+                break;
+            case 'X':
+                if (!add_option_value(&opts->exclude_globs, optarg)) {
+                    return 0;
+                }
+                break;
+            case 'O':
+                if (!add_path_pattern(&opts->only_paths, optarg)) {
+                    return 0;
+                }
+                break;
+            case 'K':
+                if (!add_path_pattern(&opts->skip_paths, optarg)) {
+                    return 0;
+                }
+                break;
+            case 'Q':
+                opts->result_cache = optarg;
+                break;
+            case 'Y':
+                if (!parse_size(optarg, &opts->result_cache_size)) return 0;
+                break;
+            case 'B':
+                opts->snapshot_file = optarg;
+                break;
                 
             case '?':
                 printf("Error: Invalid option or missing argument\n");
@@ -110,14 +428,38 @@ int parse_merge_options(int argc, char *argv[], ProgramOptions *opts) {
         }
     }
     
+    /* CI agents may share one cache without changing command lines | CI代理可以在不修改命令行的情况下共享缓存 */
+    if (opts->result_cache[0] == '\0' && getenv("ARXML_RESULT_CACHE")) {
+        opts->result_cache = getenv("ARXML_RESULT_CACHE");
+    }
+
     /* Validate options | 验证选项 */
     if (opts->sort_specific_tag && opts->sort_order == SORT_NONE) {
         printf("Error: Tag specified but no sort order given (-s option)\n");
         return 0;
     }
     
-    if (opts->input_file_count == 0 || opts->output_file[0] == '\0') {
-        printf("Error: Merge mode requires at least one input file (-a) and one output file (-m)\n");
+    if (!collect_input_dirs(opts)) {
+        return 0;
+    }
+    if ((opts->input_files.count == 0 && opts->snapshot_file[0] == '\0') || opts->output_file[0] == '\0') {
+        printf("Error: Merge mode requires at least one input file (-a, -d or --load-snapshot) and one output file (-m)\n");
+        return 0;
+    }
+    if (opts->watch && opts->input_files.count == 0) {
+        printf("Error: --watch requires an input file (-a or -d) to watch\n");
+        return 0;
+    }
+    if (opts->watch && opts->arena) {
+        printf("Error: --watch cannot be combined with --arena\n");
+        return 0;
+    }
+    if (!check_stdio_paths(opts, opts->output_file)) {
+        return 0;
+    }
+    /* A snapshot is loaded whole, it is never parsed | 快照整体加载，不经过解析 */
+    if (opts->snapshot_file[0] != '\0' && opts->only_paths.count + opts->skip_paths.count > 0) {
+        printf("Error: --only-path and --skip-path cannot be combined with --load-snapshot\n");
         return 0;
     }
 
@@ -127,37 +469,29 @@ int parse_merge_options(int argc, char *argv[], ProgramOptions *opts) {
 /* Parse format mode options | 解析格式化模式的选项 */
 int parse_format_options(int argc, char *argv[], ProgramOptions *opts) {
     int opt;
-    opts->input_file_count = 0;
+    path_list_free(&opts->input_files);
     
     /* Reset getopt | 重置getopt */
     optind = 1;
     
-    while ((opt = getopt(argc, argv, "a:o:i:s:t:")) != -1) {
+    while ((opt = getopt_long(argc, argv, "a:d:o:i:s:t:j:", profile_options, NULL)) != -1) {
         switch (opt) {
             case 'a':
-                if (opts->input_file_count >= MAX_FILES) {
-                    printf("Error: Number of input files exceeds limit (%d)\n", MAX_FILES);
+                if (!add_input_file(optarg, opts)) {
                     return 0;
                 }
-                strncpy(opts->input_files[opts->input_file_count], optarg, MAX_PATH - 1);
-                opts->input_file_count++;
                 break;
             case 'o':
-                strncpy(opts->output_dir, optarg, MAX_PATH - 1);
+                opts->output_dir = optarg;
+                break;
+            case 'j':
+                if (!parse_jobs(optarg, opts)) {
+                    return 0;
+                }
                 break;
             case 'i':
-                if (strcmp(optarg, "tab") == 0) {
-                    opts->indent_style = INDENT_TAB;
-                } else {
-                    /* Try to parse number of spaces | 尝试解析空格数 */
-                    char* endptr;
-                    long spaces = strtol(optarg, &endptr, 10);
-                    if (*endptr != '\0' || spaces <= 0) {
-                        printf("Error: Invalid indent style '%s'. Use 'tab' or a positive number\n", optarg);
-                        return 0;
-                    }
-                    opts->indent_style = INDENT_SPACE;
-                    opts->indent_width = (int)spaces;
+                if (!parse_indent(optarg, opts)) {
+                    return 0;
                 }
                 break;
             case 's':
@@ -176,6 +510,45 @@ int parse_format_options(int argc, char *argv[], ProgramOptions *opts) {
                 strncpy(opts->target_tag, optarg, sizeof(opts->target_tag) - 1);
                 opts->target_tag[sizeof(opts->target_tag) - 1] = '\0';
                 break;
+            case 'P':
+                parse_profile(optarg, opts);
+                break;
+            case 'M':
+                /* Reported per phase, so it implies --profile | 按阶段报告，因此隐含--profile */
+                opts->alloc_stats = 1;
+                opts->profile = 1;
+                break;
+            case 'R':
+                opts->arena = 1;
+                break;
+            case 'W':
+                opts->watch = 1;
+                break;
+            case 'd':
+                if (!add_option_value(&opts->input_dirs, optarg)) {
+                    return 0;
+                }
+                break;
+            case 'I':
+                if (!add_option_value(&opts->include_globs, optarg)) {
+                    return 0;
+                }
+                break;
+            case 'X':
+                if (!add_option_value(&opts->exclude_globs, optarg)) {
+                    return 0;
+                }
+                break;
+            case 'O':
+                if (!add_path_pattern(&opts->only_paths, optarg)) {
+                    return 0;
+                }
+                break;
+            case 'K':
+                if (!add_path_pattern(&opts->skip_paths, optarg)) {
+                    return 0;
+                }
+                break;
 
             case '?':
                 printf("Error: Invalid option or missing argument\n");
@@ -189,10 +562,860 @@ int parse_format_options(int argc, char *argv[], ProgramOptions *opts) {
         return 0;
     }
 
-    if (opts->input_file_count == 0) {
-        printf("Error: Format mode requires at least one input file (-a)\n");
+    if (!collect_input_dirs(opts)) {
+        return 0;
+    }
+    if (opts->input_files.count == 0) {
+        printf("Error: Format mode requires at least one input file (-a or -d)\n");
+        return 0;
+    }
+    if (opts->watch && opts->arena) {
+        printf("Error: --watch cannot be combined with --arena\n");
+        return 0;
+    }
+    if (!check_stdio_paths(opts, opts->output_dir)) {
+        return 0;
+    }
+    /* Standard input has no file to overwrite, it is formatted to standard output | 标准输入没有可覆盖的文件，格式化结果写出到标准输出 */
+    if (has_stdio_path(&opts->input_files) && strcmp(opts->output_dir, ".") != 0 && !is_stdio_path(opts->output_dir)) {
+        printf("Error: Standard input ('-') is formatted to standard output, -o must be '-' or omitted\n");
+        return 0;
+    }
+    if (is_stdio_path(opts->output_dir) && opts->input_files.count != 1) {
+        printf("Error: -o - writes standard output and takes exactly one input file\n");
+        return 0;
+    }
+    /* Formatting in place would drop the content left out from the sources | 原地格式化会从源文件中删除未选中的内容 */
+    if (opts->only_paths.count + opts->skip_paths.count > 0 && strcmp(opts->output_dir, ".") == 0 &&
+        !has_stdio_path(&opts->input_files)) {
+        printf("Error: --only-path and --skip-path need an output directory (-o), source files are not overwritten\n");
+        return 0;
+    }
+
+    return 1;
+}
+
+/* Parse compare mode options | 解析比较模式的选项 */
+int parse_compare_options(int argc, char *argv[], ProgramOptions *opts) {
+    int opt;
+    path_list_free(&opts->input_files);
+
+    /* Reset getopt | 重置getopt */
+    optind = 1;
+
+    while ((opt = getopt(argc, argv, "a:p:j:")) != -1) {
+        switch (opt) {
+            case 'a':
+                if (opts->input_files.count >= 2) {
+                    printf("Error: Compare mode takes exactly two input files (-a)\n");
+                    return 0;
+                }
+                if (!add_input_file(optarg, opts)) {
+                    return 0;
+                }
+                break;
+            case 'p':
+                opts->patch_file = optarg;
+                break;
+            case 'j':
+                if (!parse_jobs(optarg, opts)) {
+                    return 0;
+                }
+                break;
+
+            case '?':
+                printf("Error: Invalid option or missing argument\n");
+                return 0;
+        }
+    }
+
+    /* Validate options | 验证选项 */
+    if (opts->input_files.count != 2) {
+        printf("Error: Compare mode requires two input files (-a <base> -a <new>)\n");
+        return 0;
+    }
+    if (!check_stdio_paths(opts, opts->patch_file)) {
+        return 0;
+    }
+
+    return 1;
+}
+
+/* Parse patch mode options | 解析补丁模式的选项 */
+int parse_patch_options(int argc, char *argv[], ProgramOptions *opts) {
+    int opt;
+    path_list_free(&opts->input_files);
+
+    /* Reset getopt | 重置getopt */
+    optind = 1;
+
+    while ((opt = getopt(argc, argv, "a:p:m:o:i:")) != -1) {
+        switch (opt) {
+            case 'a':
+                if (opts->input_files.count >= 1) {
+                    printf("Error: Patch mode takes exactly one base file (-a)\n");
+                    return 0;
+                }
+                if (!add_input_file(optarg, opts)) {
+                    return 0;
+                }
+                break;
+            case 'p':
+                opts->patch_file = optarg;
+                break;
+            case 'm':
+                opts->output_file = optarg;
+                break;
+            case 'o':
+                opts->output_dir = optarg;
+                break;
+            case 'i':
+                if (!parse_indent(optarg, opts)) {
+                    return 0;
+                }
+                break;
+
+            case '?':
+                printf("Error: Invalid option or missing argument\n");
+                return 0;
+        }
+    }
+
+    /* Validate options | 验证选项 */
+    if (opts->input_files.count == 0 || opts->patch_file[0] == '\0' || opts->output_file[0] == '\0') {
+        printf("Error: Patch mode requires a base file (-a), a patch file (-p) and an output file (-m)\n");
+        return 0;
+    }
+
+    return 1;
+}
+
+/* Parse generate mode options | 解析生成模式的选项 */
+int parse_generate_options(int argc, char *argv[], ProgramOptions *opts) {
+    int opt;
+    path_list_free(&opts->input_files);
+
+    /* Reset getopt | 重置getopt */
+    optind = 1;
+
+    while ((opt = getopt(argc, argv, "a:m:o:i:")) != -1) {
+        switch (opt) {
+            case 'a':
+                if (opts->input_files.count >= 1) {
+                    printf("Error: Generate mode takes exactly one spec file (-a)\n");
+                    return 0;
+                }
+                if (!add_input_file(optarg, opts)) {
+                    return 0;
+                }
+                break;
+            case 'm':
+                opts->output_file = optarg;
+                break;
+            case 'o':
+                opts->output_dir = optarg;
+                break;
+            case 'i':
+                if (!parse_indent(optarg, opts)) {
+                    return 0;
+                }
+                break;
+
+            case '?':
+                printf("Error: Invalid option or missing argument\n");
+                return 0;
+        }
+    }
+
+    /* Validate options | 验证选项 */
+    if (opts->input_files.count == 0 || opts->output_file[0] == '\0') {
+        printf("Error: Generate mode requires a spec file (-a) and an output file (-m)\n");
         return 0;
     }
 
     return 1;
-}
\ No newline at end of file
+}
+
+/* Parse integer option within range | 解析指定范围内的整数选项 */
+static int parse_long_range(const char* name, const char* value, long min, long max, long* result) {
+    char* endptr;
+    long number = strtol(value, &endptr, 10);
+    if (*endptr != '\0' || endptr == value || number < min || number > max) {
+        printf("Error: Invalid %s '%s' (expected %ld..%ld)\n", name, value, min, max);
+        return 0;
+    }
+    *result = number;
+    return 1;
+}
+
+/* Parse fraction option within range | 解析指定范围内的小数选项 */
+static int parse_double_range(const char* name, const char* value, double min, double max, double* result) {
+    char* endptr;
+    double number = strtod(value, &endptr);
+    if (*endptr != '\0' || endptr == value || number < min || number > max) {
+        printf("Error: Invalid %s '%s' (expected %g..%g)\n", name, value, min, max);
+        return 0;
+    }
+    *result = number;
+    return 1;
+}
+
+/* Parse synth mode options | 解析合成模式的选项 */
+int parse_synth_options(int argc, char *argv[], ProgramOptions *opts) {
+    static const struct option long_options[] = {
+        {"seed", required_argument, NULL, 'S'},
+        {"depth", required_argument, NULL, 'D'},
+        {"fanout", required_argument, NULL, 'F'},
+        {"elements", required_argument, NULL, 'E'},
+        {"name-length", required_argument, NULL, 'L'},
+        {"ref-density", required_argument, NULL, 'R'},
+        {"duplicates", required_argument, NULL, 'U'},
+        {"files", required_argument, NULL, 'N'},
+        {"size", required_argument, NULL, 'Z'},
+        {NULL, 0, NULL, 0}
+    };
+    SynthParams* params = &opts->synth;
+    long number;
+    int opt;
+
+    synth_default_params(params);
+
+    /* Reset getopt | 重置getopt */
+    optind = 1;
+
+    while ((opt = getopt_long(argc, argv, "m:o:i:j:", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 'm':
+                opts->output_file = optarg;
+                break;
+            case 'o':
+                opts->output_dir = optarg;
+                break;
+            case 'i':
+                if (!parse_indent(optarg, opts)) {
+                    return 0;
+                }
+                break;
+            case 'j':
+                if (!parse_jobs(optarg, opts)) {
+                    return 0;
+                }
+                break;
+            case 'S': {
+                char* endptr;
+                params->seed = strtoull(optarg, &endptr, 0);
+                if (*endptr != '\0' || endptr == optarg) {
+                    printf("Error: Invalid seed '%s'\n", optarg);
+                    return 0;
+                }
+                break;
+            }
+            case 'D':
+                if (!parse_long_range("depth", optarg, 1, 32, &number)) return 0;
+                params->package_depth = (int)number;
+                break;
+            case 'F':
+                if (!parse_long_range("fanout", optarg, 1, 1000, &number)) return 0;
+                params->package_fanout = (int)number;
+                break;
+            case 'E':
+                if (!parse_long_range("element count", optarg, 1, 1000000000L, &number)) return 0;
+                params->elements = number;
+                break;
+            case 'L':
+                if (!parse_long_range("name length", optarg, 1, 128, &number)) return 0;
+                params->name_length = (int)number;
+                break;
+            case 'R':
+                if (!parse_double_range("reference density", optarg, 0.0, 64.0, &params->ref_density)) return 0;
+                break;
+            case 'U':
+                if (!parse_double_range("duplicate ratio", optarg, 0.0, 1.0, &params->duplicate_ratio)) return 0;
+                break;
+            case 'N':
+                if (!parse_long_range("file count", optarg, 1, 100000, &number)) return 0;
+                params->file_count = (int)number;
+                break;
+            case 'Z':
+                if (!parse_size(optarg, &params->target_size)) return 0;
+                break;
+
+            case '?':
+                printf("Error: Invalid option or missing argument\n");
+                return 0;
+        }
+    }
+
+    return 1;
+}
+
+/* Parse index mode options | 解析索引模式的选项 */
+int parse_index_options(int argc, char *argv[], ProgramOptions *opts) {
+    int opt;
+    path_list_free(&opts->input_files);
+
+    /* Reset getopt | 重置getopt */
+    optind = 1;
+
+    while ((opt = getopt_long(argc, argv, "a:d:j:", input_options, NULL)) != -1) {
+        switch (opt) {
+            case 'a':
+                if (!add_input_file(optarg, opts)) {
+                    return 0;
+                }
+                break;
+            case 'j':
+                if (!parse_jobs(optarg, opts)) {
+                    return 0;
+                }
+                break;
+            case 'd':
+                if (!add_option_value(&opts->input_dirs, optarg)) {
+                    return 0;
+                }
+                break;
+            case 'I':
+                if (!add_option_value(&opts->include_globs, optarg)) {
+                    return 0;
+                }
+                break;
+            case 'X':
+                if (!add_option_value(&opts->exclude_globs, optarg)) {
+                    return 0;
+                }
+                break;
+
+            case '?':
+                printf("Error: Invalid option or missing argument\n");
+                return 0;
+        }
+    }
+
+    /* Validate options | 验证选项 */
+    if (!collect_input_dirs(opts)) {
+        return 0;
+    }
+    if (opts->input_files.count == 0) {
+        printf("Error: Index mode requires at least one input file (-a or -d)\n");
+        return 0;
+    }
+
+    return 1;
+}
+
+/* Parse extract mode options | 解析提取模式的选项 */
+int parse_extract_options(int argc, char *argv[], ProgramOptions *opts) {
+    int opt;
+    path_list_free(&opts->input_files);
+    path_list_free(&opts->ar_paths);
+    path_list_free(&opts->new_paths);
+
+    /* Reset getopt | 重置getopt */
+    optind = 1;
+
+    while ((opt = getopt(argc, argv, "a:e:m:o:i:")) != -1) {
+        switch (opt) {
+            case 'a':
+                if (opts->input_files.count >= 1) {
+                    printf("Error: Extract mode takes exactly one input file (-a)\n");
+                    return 0;
+                }
+                if (!add_input_file(optarg, opts)) {
+                    return 0;
+                }
+                break;
+            case 'e':
+                if (optarg[0] != '/' || strlen(optarg) < 2) {
+                    printf("Error: Invalid AUTOSAR path '%s'. Use an absolute path like /Pkg/MySwc\n", optarg);
+                    return 0;
+                }
+                if (!add_option_value(&opts->ar_paths, optarg)) {
+                    return 0;
+                }
+                break;
+            case 'm':
+                opts->output_file = optarg;
+                break;
+            case 'o':
+                opts->output_dir = optarg;
+                break;
+            case 'i':
+                if (!parse_indent(optarg, opts)) {
+                    return 0;
+                }
+                break;
+
+            case '?':
+                printf("Error: Invalid option or missing argument\n");
+                return 0;
+        }
+    }
+
+    /* Validate options | 验证选项 */
+    if (opts->input_files.count == 0 || opts->ar_paths.count == 0 || opts->output_file[0] == '\0') {
+        printf("Error: Extract mode requires an input file (-a), at least one path (-e) and an output file (-m)\n");
+        return 0;
+    }
+
+    return 1;
+}
+
+/* Parse check-refs mode options | 解析引用检查模式的选项 */
+int parse_check_refs_options(int argc, char *argv[], ProgramOptions *opts) {
+    int opt;
+    path_list_free(&opts->input_files);
+
+    /* Reset getopt | 重置getopt */
+    optind = 1;
+
+    while ((opt = getopt_long(argc, argv, "a:d:j:", input_options, NULL)) != -1) {
+        switch (opt) {
+            case 'a':
+                if (!add_input_file(optarg, opts)) {
+                    return 0;
+                }
+                break;
+            case 'j':
+                if (!parse_jobs(optarg, opts)) {
+                    return 0;
+                }
+                break;
+            case 'd':
+                if (!add_option_value(&opts->input_dirs, optarg)) {
+                    return 0;
+                }
+                break;
+            case 'I':
+                if (!add_option_value(&opts->include_globs, optarg)) {
+                    return 0;
+                }
+                break;
+            case 'X':
+                if (!add_option_value(&opts->exclude_globs, optarg)) {
+                    return 0;
+                }
+                break;
+
+            case '?':
+                printf("Error: Invalid option or missing argument\n");
+                return 0;
+        }
+    }
+
+    /* Validate options | 验证选项 */
+    if (!collect_input_dirs(opts)) {
+        return 0;
+    }
+    if (opts->input_files.count == 0) {
+        printf("Error: Check-refs mode requires at least one input file (-a or -d)\n");
+        return 0;
+    }
+
+    return 1;
+}
+
+/* Parse split mode options | 解析拆分模式的选项 */
+int parse_split_options(int argc, char *argv[], ProgramOptions *opts) {
+    static const struct option long_options[] = {
+        {"depth", required_argument, NULL, 'D'},
+        {"size", required_argument, NULL, 'Z'},
+        {NULL, 0, NULL, 0}
+    };
+    long number;
+    int opt;
+    path_list_free(&opts->input_files);
+    opts->split.depth = -1;
+    opts->split.chunk_size = 0;
+
+    /* Reset getopt | 重置getopt */
+    optind = 1;
+
+    while ((opt = getopt_long(argc, argv, "a:m:o:j:", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 'a':
+                if (opts->input_files.count >= 1) {
+                    printf("Error: Split mode takes exactly one input file (-a)\n");
+                    return 0;
+                }
+                if (!add_input_file(optarg, opts)) {
+                    return 0;
+                }
+                break;
+            case 'm':
+                opts->output_file = optarg;
+                break;
+            case 'o':
+                opts->output_dir = optarg;
+                break;
+            case 'j':
+                if (!parse_jobs(optarg, opts)) {
+                    return 0;
+                }
+                break;
+            case 'D':
+                if (!parse_long_range("depth", optarg, 1, 64, &number)) return 0;
+                opts->split.depth = (int)number;
+                break;
+            case 'Z':
+                if (!parse_size(optarg, &opts->split.chunk_size)) return 0;
+                break;
+
+            case '?':
+                printf("Error: Invalid option or missing argument\n");
+                return 0;
+        }
+    }
+
+    /* Validate options | 验证选项 */
+    if (opts->input_files.count == 0) {
+        printf("Error: Split mode requires an input file (-a)\n");
+        return 0;
+    }
+    if (strchr(opts->output_file, '/') || strchr(opts->output_file, '\\')) {
+        printf("Error: Prefix '%s' must be a file name, use -o for the directory\n", opts->output_file);
+        return 0;
+    }
+
+    /* Size alone cuts between elements, otherwise split per top-level package | 仅指定大小时在元素之间切分，否则按顶层包拆分 */
+    if (opts->split.depth < 0) {
+        opts->split.depth = opts->split.chunk_size > 0 ? 0 : 1;
+    }
+
+    return 1;
+}
+
+/* Check absolute AUTOSAR path with at least one segment | 检查至少包含一段的AUTOSAR绝对路径 */
+static int is_valid_ar_path(const char* path) {
+    size_t len = strlen(path);
+    return len >= 2 && path[0] == '/' && path[len - 1] != '/' && strstr(path, "//") == NULL;
+}
+
+/* Parse rename mode options | 解析重命名模式的选项 */
+int parse_rename_options(int argc, char *argv[], ProgramOptions *opts) {
+    int opt;
+    path_list_free(&opts->input_files);
+    path_list_free(&opts->ar_paths);
+    path_list_free(&opts->new_paths);
+
+    /* Reset getopt | 重置getopt */
+    optind = 1;
+
+    while ((opt = getopt_long(argc, argv, "a:d:r:o:j:", input_options, NULL)) != -1) {
+        switch (opt) {
+            case 'a':
+                if (!add_input_file(optarg, opts)) {
+                    return 0;
+                }
+                break;
+            case 'r': {
+                const char* separator = strchr(optarg, '=');
+                if (!separator) {
+                    printf("Error: Invalid rename '%s'. Use <old>=<new>, e.g. /Pkg/Old=/Pkg/New\n", optarg);
+                    return 0;
+                }
+                const char* new_path = separator + 1;
+                char* old_path = (char*)malloc((size_t)(separator - optarg) + 1);
+                if (!old_path) {
+                    printf("Error: Memory allocation failed\n");
+                    return 0;
+                }
+                memcpy(old_path, optarg, (size_t)(separator - optarg));
+                old_path[separator - optarg] = '\0';
+                if (!is_valid_ar_path(old_path) || !is_valid_ar_path(new_path) || strcmp(old_path, new_path) == 0) {
+                    printf("Error: Invalid rename '%s'. Use two different absolute paths like /Pkg/Old=/Pkg/New\n", optarg);
+                    free(old_path);
+                    return 0;
+                }
+                int ok = add_option_value(&opts->ar_paths, old_path) && add_option_value(&opts->new_paths, new_path);
+                free(old_path);
+                if (!ok) {
+                    return 0;
+                }
+                break;
+            }
+            case 'o':
+                opts->output_dir = optarg;
+                break;
+            case 'j':
+                if (!parse_jobs(optarg, opts)) {
+                    return 0;
+                }
+                break;
+            case 'd':
+                if (!add_option_value(&opts->input_dirs, optarg)) {
+                    return 0;
+                }
+                break;
+            case 'I':
+                if (!add_option_value(&opts->include_globs, optarg)) {
+                    return 0;
+                }
+                break;
+            case 'X':
+                if (!add_option_value(&opts->exclude_globs, optarg)) {
+                    return 0;
+                }
+                break;
+
+            case '?':
+                printf("Error: Invalid option or missing argument\n");
+                return 0;
+        }
+    }
+
+    /* Validate options | 验证选项 */
+    if (!collect_input_dirs(opts)) {
+        return 0;
+    }
+    if (opts->input_files.count == 0 || opts->ar_paths.count == 0) {
+        printf("Error: Rename mode requires at least one input file (-a or -d) and one rename (-r)\n");
+        return 0;
+    }
+
+    return 1;
+}
+
+/* Parse stats mode options | 解析统计模式的选项 */
+int parse_stats_options(int argc, char *argv[], ProgramOptions *opts) {
+    static const struct option long_options[] = {
+        {"json", no_argument, NULL, 'J'},
+        {"top", required_argument, NULL, 'T'},
+        INPUT_LONG_OPTIONS,
+        {NULL, 0, NULL, 0}
+    };
+    long number;
+    int opt;
+    path_list_free(&opts->input_files);
+    opts->stats.json = 0;
+    opts->stats.top = 20;
+
+    /* Reset getopt | 重置getopt */
+    optind = 1;
+
+    while ((opt = getopt_long(argc, argv, "a:d:m:o:j:", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 'a':
+                if (!add_input_file(optarg, opts)) {
+                    return 0;
+                }
+                break;
+            case 'd':
+                if (!add_option_value(&opts->input_dirs, optarg)) {
+                    return 0;
+                }
+                break;
+            case 'I':
+                if (!add_option_value(&opts->include_globs, optarg)) {
+                    return 0;
+                }
+                break;
+            case 'X':
+                if (!add_option_value(&opts->exclude_globs, optarg)) {
+                    return 0;
+                }
+                break;
+            case 'm':
+                opts->output_file = optarg;
+                break;
+            case 'o':
+                opts->output_dir = optarg;
+                break;
+            case 'j':
+                if (!parse_jobs(optarg, opts)) {
+                    return 0;
+                }
+                break;
+            case 'J':
+                opts->stats.json = 1;
+                break;
+            case 'T':
+                if (!parse_long_range("top", optarg, 0, 100000, &number)) return 0;
+                opts->stats.top = (int)number;
+                break;
+
+            case '?':
+                printf("Error: Invalid option or missing argument\n");
+                return 0;
+        }
+    }
+
+    /* Validate options | 验证选项 */
+    if (!collect_input_dirs(opts)) {
+        return 0;
+    }
+    if (opts->input_files.count == 0) {
+        printf("Error: Stats mode requires at least one input file (-a or -d)\n");
+        return 0;
+    }
+    if (strcmp(opts->output_dir, ".") != 0 && opts->output_file[0] == '\0') {
+        printf("Error: Output directory (-o) requires an output file (-m)\n");
+        return 0;
+    }
+
+    return 1;
+}
+
+/* Parse serve mode options | 解析服务模式的选项 */
+int parse_serve_options(int argc, char *argv[], ProgramOptions *opts) {
+    static const struct option long_options[] = {
+        {"socket", required_argument, NULL, 'K'},
+        {"cache-size", required_argument, NULL, 'C'},
+        {NULL, 0, NULL, 0}
+    };
+    int opt;
+
+    optind = 1;
+    while ((opt = getopt_long(argc, argv, "j:", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 'K':
+                opts->serve.socket_path = optarg;
+                break;
+            case 'C':
+                if (!parse_size(optarg, &opts->serve.cache_size)) return 0;
+                break;
+            case 'j':
+                if (!parse_jobs(optarg, opts)) {
+                    return 0;
+                }
+                break;
+
+            case '?':
+                printf("Error: Invalid option or missing argument\n");
+                return 0;
+        }
+    }
+
+    /* Validate options | 验证选项 */
+    if (opts->serve.socket_path[0] == '\0') {
+        printf("Error: Serve mode requires a socket path (--socket)\n");
+        return 0;
+    }
+
+    return 1;
+}
+
+/* Parse client mode options, everything after the job mode is sent unchanged | 解析客户端模式的选项，任务模式之后的参数原样发送 */
+int parse_client_options(int argc, char *argv[], ProgramOptions *opts) {
+    int i = 1;
+    while (i < argc && argv[i][0] == '-') {
+        if (strcmp(argv[i], "--socket") == 0 && i + 1 < argc) {
+            opts->serve.socket_path = argv[i + 1];
+            i += 2;
+        } else if (strncmp(argv[i], "--socket=", 9) == 0) {
+            opts->serve.socket_path = argv[i] + 9;
+            i++;
+        } else {
+            printf("Error: Invalid option or missing argument\n");
+            return 0;
+        }
+    }
+
+    /* Validate options | 验证选项 */
+    if (opts->serve.socket_path[0] == '\0' || i >= argc) {
+        printf("Error: Client mode requires a socket path (--socket) and a job, e.g. merge -a a.arxml -m out.arxml\n");
+        return 0;
+    }
+    OperationMode job_mode = parse_mode(argv[i]);
+    if (job_mode != MODE_MERGE && job_mode != MODE_FORMAT && job_mode != MODE_COMPARE) {
+        printf("Error: Server runs merge, format and compare jobs, not '%s'\n", argv[i]);
+        return 0;
+    }
+    opts->serve.job_argc = argc - i;
+    opts->serve.job_argv = argv + i;
+
+    return 1;
+}
+
+/* Parse batch mode options | 解析批处理模式的选项 */
+int parse_batch_options(int argc, char *argv[], ProgramOptions *opts) {
+    static const struct option long_options[] = {
+        {"cache-size", required_argument, NULL, 'C'},
+        {NULL, 0, NULL, 0}
+    };
+    int opt;
+
+    optind = 1;
+    while ((opt = getopt_long(argc, argv, "a:j:", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 'a':
+                if (!add_input_file(optarg, opts)) {
+                    return 0;
+                }
+                break;
+            case 'C':
+                if (!parse_size(optarg, &opts->serve.cache_size)) return 0;
+                break;
+            case 'j':
+                if (!parse_jobs(optarg, opts)) {
+                    return 0;
+                }
+                break;
+
+            case '?':
+                printf("Error: Invalid option or missing argument\n");
+                return 0;
+        }
+    }
+
+    /* Validate options | 验证选项 */
+    if (opts->input_files.count != 1) {
+        printf("Error: Batch mode requires one job file (-a)\n");
+        return 0;
+    }
+
+    return 1;
+}
+
+/* Parse snapshot mode options | 解析快照模式的选项 */
+int parse_snapshot_options(int argc, char *argv[], ProgramOptions *opts) {
+    int opt;
+    path_list_free(&opts->input_files);
+
+    /* Reset getopt | 重置getopt */
+    optind = 1;
+
+    while ((opt = getopt_long(argc, argv, "a:d:j:", input_options, NULL)) != -1) {
+        switch (opt) {
+            case 'a':
+                if (!add_input_file(optarg, opts)) {
+                    return 0;
+                }
+                break;
+            case 'j':
+                if (!parse_jobs(optarg, opts)) {
+                    return 0;
+                }
+                break;
+            case 'd':
+                if (!add_option_value(&opts->input_dirs, optarg)) {
+                    return 0;
+                }
+                break;
+            case 'I':
+                if (!add_option_value(&opts->include_globs, optarg)) {
+                    return 0;
+                }
+                break;
+            case 'X':
+                if (!add_option_value(&opts->exclude_globs, optarg)) {
+                    return 0;
+                }
+                break;
+
+            case '?':
+                printf("Error: Invalid option or missing argument\n");
+                return 0;
+        }
+    }
+
+    /* Validate options | 验证选项 */
+    if (!collect_input_dirs(opts)) {
+        return 0;
+    }
+    if (opts->input_files.count == 0) {
+        printf("Error: Snapshot mode requires at least one input file (-a or -d)\n");
+        return 0;
+    }
+
+    return 1;
+}
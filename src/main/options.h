@@ -6,13 +6,67 @@
 /* Parse operation mode | 解析操作模式 */
 OperationMode parse_mode(const char* mode_str);
 
+/* Initialize options with defaults | 使用默认值初始化选项 */
+void init_options(ProgramOptions *opts);
+
+/* Free memory owned by options | 释放选项持有的内存 */
+void free_options(ProgramOptions *opts);
+
+/* Check whether mode writes document data to standard output ("-") | 检查模式是否将文档数据写出到标准输出（"-"） */
+int options_write_stdout(OperationMode mode, const ProgramOptions *opts);
+
 /* Parse command line options | 解析命令行选项 */
 int parse_options(int argc, char *argv[], ProgramOptions *opts);
 
+/* Parse options of given mode | 解析指定模式的选项 */
+int parse_mode_options(OperationMode mode, int argc, char *argv[], ProgramOptions *opts);
+
 /* Parse merge mode options | 解析合并模式的选项 */
 int parse_merge_options(int argc, char *argv[], ProgramOptions *opts);
 
 /* Parse format mode options | 解析格式化模式的选项 */
 int parse_format_options(int argc, char *argv[], ProgramOptions *opts);
 
+/* Parse compare mode options | 解析比较模式的选项 */
+int parse_compare_options(int argc, char *argv[], ProgramOptions *opts);
+
+/* Parse patch mode options | 解析补丁模式的选项 */
+int parse_patch_options(int argc, char *argv[], ProgramOptions *opts);
+
+/* Parse generate mode options | 解析生成模式的选项 */
+int parse_generate_options(int argc, char *argv[], ProgramOptions *opts);
+
+/* Parse synth mode options | 解析合成模式的选项 */
+int parse_synth_options(int argc, char *argv[], ProgramOptions *opts);
+
+/* Parse index mode options | 解析索引模式的选项 */
+int parse_index_options(int argc, char *argv[], ProgramOptions *opts);
+
+/* Parse extract mode options | 解析提取模式的选项 */
+int parse_extract_options(int argc, char *argv[], ProgramOptions *opts);
+
+/* Parse check-refs mode options | 解析引用检查模式的选项 */
+int parse_check_refs_options(int argc, char *argv[], ProgramOptions *opts);
+
+/* Parse split mode options | 解析拆分模式的选项 */
+int parse_split_options(int argc, char *argv[], ProgramOptions *opts);
+
+/* Parse rename mode options | 解析重命名模式的选项 */
+int parse_rename_options(int argc, char *argv[], ProgramOptions *opts);
+
+/* Parse stats mode options | 解析统计模式的选项 */
+int parse_stats_options(int argc, char *argv[], ProgramOptions *opts);
+
+/* Parse serve mode options | 解析服务模式的选项 */
+int parse_serve_options(int argc, char *argv[], ProgramOptions *opts);
+
+/* Parse client mode options | 解析客户端模式的选项 */
+int parse_client_options(int argc, char *argv[], ProgramOptions *opts);
+
+/* Parse batch mode options | 解析批处理模式的选项 */
+int parse_batch_options(int argc, char *argv[], ProgramOptions *opts);
+
+/* Parse snapshot mode options | 解析快照模式的选项 */
+int parse_snapshot_options(int argc, char *argv[], ProgramOptions *opts);
+
 #endif /* OPTIONS_H */ 
\ No newline at end of file
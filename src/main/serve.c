@@ -0,0 +1,392 @@
+#include "serve.h"
+#include "options.h"
+#include "../command/command.h"
+#include "../operations/merge.h"
+#include "../operations/format.h"
+#include "../operations/compare.h"
+#include "../utils/doc_cache.h"
+#include "../utils/thread_pool.h"
+#include "../utils/perf_utils.h"
+#include "../utils/compressed_io.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+/* A client that sends nothing must not hold a worker forever | 不发送数据的客户端不能一直占用工作线程 */
+#define REQUEST_TIMEOUT_SECONDS 10
+
+/* getopt is not thread safe, workers parse their requests one at a time | getopt不是线程安全的，工作线程逐个解析请求 */
+static pthread_mutex_t parse_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Accepted connection whose request is not read yet | 已接受但尚未读取请求的连接 */
+typedef struct {
+    int fd;
+    int id;
+} ServeConnection;
+
+/* One job received from a client | 从客户端收到的一个任务 */
+typedef struct {
+    int fd;
+    int id;
+    char** argv;             /* Request: program name, client directory, mode, options | 请求：程序名、客户端目录、模式、选项 */
+    ProgramOptions opts;
+    PathList owned;          /* Option paths made absolute | 转换为绝对路径的选项路径 */
+} ServeJob;
+
+static volatile sig_atomic_t stop_requested;
+
+static void request_stop(int sig) {
+    (void)sig;
+    stop_requested = 1;
+}
+
+static int fill_address(const char* path, struct sockaddr_un* addr) {
+    memset(addr, 0, sizeof(struct sockaddr_un));
+    addr->sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr->sun_path)) {
+        printf("Error: Socket path '%s' is too long (max %d characters)\n", path, (int)sizeof(addr->sun_path) - 1);
+        return 0;
+    }
+    strcpy(addr->sun_path, path);
+    return 1;
+}
+
+static void send_result(int fd, int result) {
+    char reply[32];
+    int len = snprintf(reply, sizeof(reply), "result %d\n", result);
+    if (write(fd, reply, (size_t)len) != len) {
+        printf("Warning: Cannot send result to client\n");
+    }
+}
+
+/* Resolve relative option path against client directory, empty stays empty | 将相对选项路径解析为相对客户端目录的路径，空路径保持不变 */
+static const char* absolute_path(ServeJob* job, const char* cwd, const char* path) {
+    if (path[0] == '\0' || path[0] == '/') {
+        return path;
+    }
+    size_t size = strlen(cwd) + strlen(path) + 2;
+    char* joined = (char*)malloc(size);
+    if (!joined) return NULL;
+    snprintf(joined, size, "%s/%s", cwd, path);
+    int ok = path_list_add(&job->owned, joined);
+    free(joined);
+    return ok ? job->owned.items[job->owned.count - 1] : NULL;
+}
+
+/* Make every path of the job absolute, workers do not share the client directory | 将任务的所有路径转换为绝对路径，工作线程不使用客户端目录 */
+static int make_paths_absolute(ServeJob* job, const char* cwd) {
+    ProgramOptions* opts = &job->opts;
+    for (int i = 0; i < opts->input_files.count; i++) {
+        const char* path = absolute_path(job, cwd, opts->input_files.items[i]);
+        if (!path) return 0;
+        if (path != opts->input_files.items[i]) {
+            char* copy = strdup(path);
+            if (!copy) return 0;
+            free(opts->input_files.items[i]);
+            opts->input_files.items[i] = copy;
+        }
+    }
+    /* "." means no -o, so only an explicit directory is resolved | "."表示未指定-o，只解析明确指定的目录 */
+    if (strcmp(opts->output_dir, ".") != 0 && !(opts->output_dir = absolute_path(job, cwd, opts->output_dir))) return 0;
+    if (!(opts->output_file = absolute_path(job, cwd, opts->output_file))) return 0;
+    if (!(opts->patch_file = absolute_path(job, cwd, opts->patch_file))) return 0;
+    if (!(opts->profile_file = absolute_path(job, cwd, opts->profile_file))) return 0;
+    if (!(opts->result_cache = absolute_path(job, cwd, opts->result_cache))) return 0;
+    if (!(opts->snapshot_file = absolute_path(job, cwd, opts->snapshot_file))) return 0;
+    return 1;
+}
+
+static void free_job(ServeJob* job) {
+    free_options(&job->opts);
+    path_list_free(&job->owned);
+    free_command_args(job->argv);
+    free(job);
+}
+
+/* Read and parse request on a worker, a slow client only holds its own worker | 在工作线程中读取并解析请求，慢速客户端只占用自己的工作线程
+ * -d directories are walked in the client directory, the process directory is never changed | -d目录在客户端目录中遍历，从不改变进程的当前目录 */
+static ServeJob* read_job(int fd, int id) {
+    ServeJob* job = (ServeJob*)calloc(1, sizeof(ServeJob));
+    if (!job) {
+        printf("Error: Memory allocation failed\n");
+        return NULL;
+    }
+    job->fd = fd;
+    job->id = id;
+    init_options(&job->opts);
+
+    struct timeval timeout = {REQUEST_TIMEOUT_SECONDS, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    int in_fd = dup(fd);
+    FILE* in = in_fd >= 0 ? fdopen(in_fd, "r") : NULL;
+    if (!in) {
+        if (in_fd >= 0) close(in_fd);
+        printf("Error: Cannot read request\n");
+        free_job(job);
+        return NULL;
+    }
+    int argc = 0;
+    job->argv = read_command_stream(in, "request", &argc);
+    fclose(in);
+    if (!job->argv) {
+        free_job(job);
+        return NULL;
+    }
+    if (argc < 3) {
+        printf("Error: Malformed request\n");
+        free_job(job);
+        return NULL;
+    }
+
+    const char* cwd = job->argv[1];
+    job->opts.mode = parse_mode(job->argv[2]);
+    if (job->opts.mode != MODE_MERGE && job->opts.mode != MODE_FORMAT && job->opts.mode != MODE_COMPARE) {
+        printf("Error: Server runs merge, format and compare jobs, not '%s'\n", job->argv[2]);
+        free_job(job);
+        return NULL;
+    }
+    if (cwd[0] != '/') {
+        printf("Error: Client directory '%s' is not absolute\n", cwd);
+        free_job(job);
+        return NULL;
+    }
+    job->opts.serve.client_dir = cwd;
+    pthread_mutex_lock(&parse_lock);
+    int ok = parse_mode_options(job->opts.mode, argc - 2, job->argv + 2, &job->opts);
+    pthread_mutex_unlock(&parse_lock);
+    if (ok && (job->opts.arena || job->opts.alloc_stats)) {
+        printf("Error: --arena and --alloc-stats are not available in serve mode\n");
+        ok = 0;
+    }
+    /* Standard input and output of the server are not those of the client | 服务器的标准输入和输出不是客户端的 */
+    if (ok && (has_stdio_path(&job->opts.input_files) || options_write_stdout(job->opts.mode, &job->opts))) {
+        printf("Error: Standard input and output ('-') are not available in serve mode\n");
+        ok = 0;
+    }
+    if (ok && !make_paths_absolute(job, cwd)) {
+        printf("Error: Memory allocation failed\n");
+        ok = 0;
+    }
+    if (!ok) {
+        free_job(job);
+        return NULL;
+    }
+    return job;
+}
+
+/* Worker task: read one job, run it and send its result | 工作线程任务：读取一个任务，运行并发送结果 */
+static void run_job(void* arg) {
+    ServeConnection* connection = (ServeConnection*)arg;
+    ServeJob* job = read_job(connection->fd, connection->id);
+    if (!job) {
+        send_result(connection->fd, 0);
+        close(connection->fd);
+        fflush(stdout);
+        free(connection);
+        return;
+    }
+    free(connection);
+
+    double start = perf_now();
+    int result;
+    switch (job->opts.mode) {
+        case MODE_MERGE:
+            result = merge_arxml_files(&job->opts);
+            break;
+        case MODE_FORMAT:
+            result = format_arxml_files(&job->opts);
+            break;
+        default:
+            result = compare_arxml_files(&job->opts);
+            break;
+    }
+    send_result(job->fd, result);
+    close(job->fd);
+    printf("Job %d: %s %s in %.1f ms\n", job->id, job->argv[2], result ? "done" : "failed",
+           (perf_now() - start) * 1000.0);
+    fflush(stdout);
+    free_job(job);
+}
+
+int serve_arxml_jobs(const ProgramOptions *opts) {
+    const char* path = opts->serve.socket_path;
+    struct sockaddr_un addr;
+    if (!fill_address(path, &addr)) {
+        return 0;
+    }
+
+    /* Remove socket left by a previous server, never other files | 删除之前服务器遗留的套接字，不删除其他文件 */
+    struct stat st;
+    if (lstat(path, &st) == 0) {
+        if (!S_ISSOCK(st.st_mode)) {
+            printf("Error: '%s' exists and is not a socket\n", path);
+            return 0;
+        }
+        unlink(path);
+    }
+
+    int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0 || bind(listen_fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(listen_fd, 64) != 0) {
+        printf("Error: Cannot listen on socket '%s'\n", path);
+        if (listen_fd >= 0) close(listen_fd);
+        return 0;
+    }
+
+    /* Workers block the stop signals, so they interrupt accept on this thread | 工作线程屏蔽停止信号，使信号中断本线程的accept */
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = request_stop;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    signal(SIGPIPE, SIG_IGN);
+    sigset_t stop_signals, old_mask;
+    sigemptyset(&stop_signals);
+    sigaddset(&stop_signals, SIGINT);
+    sigaddset(&stop_signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stop_signals, &old_mask);
+
+    doc_cache_install(opts->serve.cache_size);
+    perf_set_shared_process();
+    int workers = opts->jobs > 0 ? opts->jobs : get_cpu_count();
+    ThreadPool* pool = thread_pool_create(workers);
+    pthread_sigmask(SIG_SETMASK, &old_mask, NULL);
+    if (!pool) {
+        printf("Error: Cannot create worker threads\n");
+        doc_cache_shutdown();
+        close(listen_fd);
+        unlink(path);
+        return 0;
+    }
+
+    printf("Serving on %s with %d workers, document cache %.0f MB\n", path, workers,
+           (double)opts->serve.cache_size / (1024.0 * 1024.0));
+    fflush(stdout);
+
+    int next_id = 1;
+    while (!stop_requested) {
+        int fd = accept(listen_fd, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            printf("Error: Cannot accept connection\n");
+            break;
+        }
+        ServeConnection* connection = (ServeConnection*)malloc(sizeof(ServeConnection));
+        if (!connection) {
+            printf("Error: Memory allocation failed\n");
+            send_result(fd, 0);
+            close(fd);
+            continue;
+        }
+        connection->fd = fd;
+        connection->id = next_id++;
+        if (!thread_pool_submit(pool, run_job, connection)) {
+            run_job(connection);
+        }
+    }
+
+    /* Finish accepted jobs before the cache goes away | 在释放缓存前完成已接收的任务 */
+    thread_pool_destroy(pool);
+    close(listen_fd);
+    unlink(path);
+
+    DocCacheStats stats;
+    doc_cache_get_stats(&stats);
+    printf("Server stopped: %d jobs, document cache %llu hits, %llu revalidated, %llu parsed, %llu evicted\n",
+           next_id - 1, (unsigned long long)stats.hits, (unsigned long long)stats.revalidated,
+           (unsigned long long)stats.parsed, (unsigned long long)stats.evicted);
+    doc_cache_shutdown();
+    return 1;
+}
+
+/* Write argument in double quotes as read by read_command_stream | 将参数写在双引号中，格式与read_command_stream一致 */
+static void write_quoted(FILE* out, const char* value) {
+    fputc('"', out);
+    for (const char* p = value; *p; p++) {
+        if (*p == '"' || *p == '\\') fputc('\\', out);
+        fputc(*p, out);
+    }
+    fputs("\"\n", out);
+}
+
+int send_arxml_job(const ProgramOptions *opts) {
+    struct sockaddr_un addr;
+    if (!fill_address(opts->serve.socket_path, &addr)) {
+        return 0;
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        printf("Error: Cannot connect to server on '%s'\n", opts->serve.socket_path);
+        if (fd >= 0) close(fd);
+        return 0;
+    }
+
+    /* Request: client directory, then mode and options | 请求：客户端目录，然后是模式和选项 */
+    char* cwd = get_current_directory();
+    int out_fd = dup(fd);
+    FILE* out = out_fd >= 0 ? fdopen(out_fd, "w") : NULL;
+    if (!cwd || !out) {
+        printf("Error: Cannot send job to server\n");
+        if (out) fclose(out);
+        else if (out_fd >= 0) close(out_fd);
+        free(cwd);
+        close(fd);
+        return 0;
+    }
+    write_quoted(out, cwd);
+    for (int i = 0; i < opts->serve.job_argc; i++) {
+        write_quoted(out, opts->serve.job_argv[i]);
+    }
+    int sent = fclose(out) == 0;
+    free(cwd);
+    if (!sent || shutdown(fd, SHUT_WR) != 0) {
+        printf("Error: Cannot send job to server\n");
+        close(fd);
+        return 0;
+    }
+
+    /* Wait for result line | 等待结果行 */
+    char reply[64];
+    size_t len = 0;
+    ssize_t n;
+    while (len < sizeof(reply) - 1 && (n = read(fd, reply + len, sizeof(reply) - 1 - len)) > 0) {
+        len += (size_t)n;
+    }
+    close(fd);
+    reply[len] = '\0';
+
+    int result;
+    if (sscanf(reply, "result %d", &result) != 1) {
+        printf("Error: Server closed connection without a result\n");
+        return 0;
+    }
+    if (!result) {
+        printf("Error: Job failed, see server output for details\n");
+    }
+    return result;
+}
+
+#else
+
+int serve_arxml_jobs(const ProgramOptions *opts) {
+    (void)opts;
+    printf("Error: Serve mode needs Unix domain sockets, not available on this platform\n");
+    return 0;
+}
+
+int send_arxml_job(const ProgramOptions *opts) {
+    (void)opts;
+    printf("Error: Client mode needs Unix domain sockets, not available on this platform\n");
+    return 0;
+}
+
+#endif
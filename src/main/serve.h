@@ -0,0 +1,13 @@
+#ifndef SERVE_H
+#define SERVE_H
+
+#include "common.h"
+
+/* Run merge, format and compare jobs sent over a Unix socket until SIGINT/SIGTERM | 运行通过Unix套接字发送的merge、format和compare任务，直到收到SIGINT/SIGTERM
+ * Parsed documents stay cached between jobs | 已解析的文档在任务之间保持缓存 */
+int serve_arxml_jobs(const ProgramOptions *opts);
+
+/* Send one job to a running server and wait for its result | 向运行中的服务器发送一个任务并等待结果 */
+int send_arxml_job(const ProgramOptions *opts);
+
+#endif /* SERVE_H */
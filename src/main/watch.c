@@ -0,0 +1,262 @@
+#include "watch.h"
+#include "../operations/merge.h"
+#include "../operations/format.h"
+#include "../utils/doc_cache.h"
+#include "../utils/hash_utils.h"
+#include "../utils/perf_utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+
+#ifdef __linux__
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+/* Without inotify inputs are checked this often | 没有inotify时按此间隔检查输入文件 */
+#define WATCH_POLL_MS 300
+/* Editors write in several steps, wait until events stop for this long | 编辑器分多步写文件，等待事件停止这么长时间 */
+#define WATCH_SETTLE_MS 50
+/* Keep every input parsed, the watched set is fixed | 保持所有输入处于解析状态，监视的文件集合是固定的 */
+#define WATCH_CACHE_BYTES ((uint64_t)1 << 62)
+
+/* Last seen state of one input | 单个输入文件最近一次的状态 */
+typedef struct {
+    uint64_t size;
+    int64_t mtime;
+    uint64_t hash;
+    int exists;
+    int changed;
+#ifdef __linux__
+    int wd;                  /* inotify watch of the parent directory | 父目录的inotify监视 */
+    const char* name;        /* File name inside the directory | 目录中的文件名 */
+#endif
+} WatchedFile;
+
+static volatile sig_atomic_t stop_requested;
+
+static void request_stop(int sig) {
+    (void)sig;
+    stop_requested = 1;
+}
+
+static void take_snapshot(const char* path, WatchedFile* file) {
+    file->exists = get_file_size(path, &file->size) && get_file_mtime(path, &file->mtime) &&
+                   hash_file(path, &file->hash);
+}
+
+/* Same size and hash means unchanged, a touched file is not run again | 大小和哈希相同表示未变化，只被touch的文件不会重新运行 */
+static int check_changed(const char* path, WatchedFile* file, int force_hash) {
+    WatchedFile now = *file;
+    now.exists = get_file_size(path, &now.size) && get_file_mtime(path, &now.mtime);
+    if (!now.exists) {
+        /* Saved by rename, the new file appears shortly | 通过重命名保存，新文件很快出现 */
+        return 0;
+    }
+    if (file->exists && !force_hash && now.size == file->size && now.mtime == file->mtime) {
+        return 0;
+    }
+    if (!hash_file(path, &now.hash)) {
+        return 0;
+    }
+    int changed = !file->exists || now.size != file->size || now.hash != file->hash;
+    file->size = now.size;
+    file->mtime = now.mtime;
+    file->hash = now.hash;
+    file->exists = 1;
+    return changed;
+}
+
+static void sleep_ms(int ms) {
+#ifdef _WIN32
+    Sleep((DWORD)ms);
+#else
+    usleep((useconds_t)ms * 1000);
+#endif
+}
+
+/* Run the operation on all inputs, or format on changed ones only | 对所有输入运行操作，或只对变化的文件运行format */
+static int run_once(const ProgramOptions *opts, const WatchedFile* files, int only_changed) {
+    if (opts->mode == MODE_MERGE || !only_changed) {
+        return opts->mode == MODE_MERGE ? merge_arxml_files(opts) : format_arxml_files(opts);
+    }
+
+    ProgramOptions changed_opts = *opts;
+    memset(&changed_opts.input_files, 0, sizeof(PathList));
+    int ok = 1;
+    for (int i = 0; ok && i < opts->input_files.count; i++) {
+        if (files[i].changed) {
+            ok = path_list_add(&changed_opts.input_files, opts->input_files.items[i]);
+        }
+    }
+    if (!ok) {
+        printf("Error: Memory allocation failed\n");
+    } else {
+        ok = format_arxml_files(&changed_opts);
+    }
+    path_list_free(&changed_opts.input_files);
+    return ok;
+}
+
+#ifdef __linux__
+/* Watch parent directories, editors often replace files instead of writing them | 监视父目录，编辑器经常替换文件而不是直接写入 */
+static int add_watches(int fd, const ProgramOptions *opts, WatchedFile* files) {
+    for (int i = 0; i < opts->input_files.count; i++) {
+        const char* path = opts->input_files.items[i];
+        char* dir = get_directory_path(path);
+        if (!dir) {
+            printf("Error: Memory allocation failed\n");
+            return 0;
+        }
+        files[i].wd = inotify_add_watch(fd, dir[0] ? dir : "/", IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_ATTRIB);
+        const char* slash = strrchr(path, '/');
+        files[i].name = slash ? slash + 1 : path;
+        if (files[i].wd < 0) {
+            printf("Error: Cannot watch directory '%s'\n", dir);
+            free(dir);
+            return 0;
+        }
+        free(dir);
+    }
+    return 1;
+}
+
+/* Read pending events, mark inputs they name | 读取待处理事件，标记其中涉及的输入文件 */
+static int read_events(int fd, const ProgramOptions *opts, WatchedFile* files) {
+    char buffer[16384] __attribute__((aligned(__alignof__(struct inotify_event))));
+    ssize_t len = read(fd, buffer, sizeof(buffer));
+    if (len <= 0) {
+        return len < 0 && errno == EINTR ? 1 : 0;
+    }
+    for (char* p = buffer; p < buffer + len; ) {
+        struct inotify_event* event = (struct inotify_event*)p;
+        for (int i = 0; event->len > 0 && i < opts->input_files.count; i++) {
+            if (files[i].wd == event->wd && strcmp(files[i].name, event->name) == 0) {
+                files[i].changed = 1;
+            }
+        }
+        p += sizeof(struct inotify_event) + event->len;
+    }
+    return 1;
+}
+
+/* Block until some input has new content | 阻塞直到某个输入文件内容变化 */
+static int wait_for_change(int fd, const ProgramOptions *opts, WatchedFile* files) {
+    for (;;) {
+        struct pollfd pfd = {fd, POLLIN, 0};
+        if (poll(&pfd, 1, -1) < 0) {
+            if (errno == EINTR && !stop_requested) continue;
+            return 0;
+        }
+        if (!read_events(fd, opts, files)) return 0;
+
+        /* Collect the rest of this save | 收集本次保存的其余事件 */
+        while (poll(&pfd, 1, WATCH_SETTLE_MS) > 0) {
+            if (!read_events(fd, opts, files)) return 0;
+        }
+        if (stop_requested) return 0;
+
+        int any = 0;
+        for (int i = 0; i < opts->input_files.count; i++) {
+            if (files[i].changed) {
+                files[i].changed = check_changed(opts->input_files.items[i], &files[i], 1);
+                any |= files[i].changed;
+            }
+        }
+        if (any) return 1;
+    }
+}
+#endif
+
+/* Check modification times until some input has new content | 检查修改时间，直到某个输入文件内容变化 */
+static int poll_for_change(const ProgramOptions *opts, WatchedFile* files) {
+    while (!stop_requested) {
+        sleep_ms(WATCH_POLL_MS);
+        int any = 0;
+        for (int i = 0; i < opts->input_files.count; i++) {
+            files[i].changed = check_changed(opts->input_files.items[i], &files[i], 0);
+            any |= files[i].changed;
+        }
+        if (any) return 1;
+    }
+    return 0;
+}
+
+int watch_arxml_files(const ProgramOptions *opts) {
+    int count = opts->input_files.count;
+    WatchedFile* files = (WatchedFile*)calloc((size_t)count, sizeof(WatchedFile));
+    if (!files) {
+        printf("Error: Memory allocation failed\n");
+        return 0;
+    }
+
+    signal(SIGINT, request_stop);
+    signal(SIGTERM, request_stop);
+    doc_cache_install(WATCH_CACHE_BYTES);
+
+#ifdef __linux__
+    int inotify_fd = inotify_init1(IN_CLOEXEC);
+    if (inotify_fd >= 0 && !add_watches(inotify_fd, opts, files)) {
+        close(inotify_fd);
+        inotify_fd = -1;
+    }
+    if (inotify_fd < 0) {
+        printf("Warning: inotify not available, checking inputs every %d ms\n", WATCH_POLL_MS);
+    }
+#endif
+
+    /* Snapshot before the first run, so changes while it runs are picked up next. | 在首次运行前记录状态，运行期间的变化在下一轮处理；
+     * Formatting in place rewrites the inputs, there the result is the state to watch | 原地格式化会重写输入文件，此时以结果作为监视的状态 */
+    int in_place = opts->mode == MODE_FORMAT && strcmp(opts->output_dir, ".") == 0;
+    for (int i = 0; !in_place && i < count; i++) {
+        take_snapshot(opts->input_files.items[i], &files[i]);
+    }
+    int result = run_once(opts, files, 0);
+    for (int i = 0; in_place && i < count; i++) {
+        take_snapshot(opts->input_files.items[i], &files[i]);
+    }
+    printf("Watching %d input file(s), press Ctrl+C to stop\n", count);
+    fflush(stdout);
+
+    for (;;) {
+        int changed;
+#ifdef __linux__
+        changed = inotify_fd >= 0 ? wait_for_change(inotify_fd, opts, files) : poll_for_change(opts, files);
+#else
+        changed = poll_for_change(opts, files);
+#endif
+        if (!changed) break;
+
+        for (int i = 0; i < count; i++) {
+            if (files[i].changed) printf("Changed: %s\n", opts->input_files.items[i]);
+        }
+        double start = perf_now();
+        result = run_once(opts, files, 1);
+        printf("%s %s in %.0f ms\n", opts->mode == MODE_MERGE ? "Merge" : "Format",
+               result ? "done" : "failed", (perf_now() - start) * 1000.0);
+
+        /* Formatting in place rewrote the inputs, take them as the new state | 原地格式化重写了输入文件，将其作为新状态 */
+        for (int i = 0; i < count; i++) {
+            if (in_place && files[i].changed) {
+                take_snapshot(opts->input_files.items[i], &files[i]);
+            }
+            files[i].changed = 0;
+        }
+        fflush(stdout);
+    }
+
+#ifdef __linux__
+    if (inotify_fd >= 0) close(inotify_fd);
+#endif
+    doc_cache_shutdown();
+    free(files);
+    printf("Watch stopped\n");
+    return result;
+}
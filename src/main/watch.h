@@ -0,0 +1,10 @@
+#ifndef WATCH_H
+#define WATCH_H
+
+#include "common.h"
+
+/* Run merge or format, then again whenever an input changes, until SIGINT/SIGTERM | 运行merge或format，之后每当输入文件变化时重新运行，直到收到SIGINT/SIGTERM
+ * Unchanged inputs stay parsed, format only rewrites changed files | 未变化的输入保持解析状态，format只重写变化的文件 */
+int watch_arxml_files(const ProgramOptions *opts);
+
+#endif /* WATCH_H */
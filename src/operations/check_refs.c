@@ -0,0 +1,567 @@
+#include "check_refs.h"
+#include "../utils/arxml_scanner.h"
+#include "../utils/fs_utils.h"
+#include "../utils/hash_utils.h"
+#include "../utils/thread_pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define REGISTRY_SHARD_BITS 6
+#define REGISTRY_SHARDS (1 << REGISTRY_SHARD_BITS)
+#define REFS_PER_TASK 65536
+
+/* Strings of one file, referenced by offset while growing | 单个文件的字符串，增长期间通过偏移引用 */
+typedef struct {
+    char* data;
+    size_t size;
+    size_t capacity;
+} StringPool;
+
+typedef struct {
+    uint64_t hash;
+    size_t path;
+    size_t tag;
+} PathRecord;
+
+typedef struct {
+    size_t value;
+    size_t dest;          /* (size_t)-1 if no DEST | 无DEST时为(size_t)-1 */
+    size_t base;          /* (size_t)-1 if no BASE | 无BASE时为(size_t)-1 */
+    size_t context;       /* Enclosing identifiable | 所在的可标识元素 */
+    long line;
+} RefRecord;
+
+/* REFERENCE-BASE of a package | 包的REFERENCE-BASE */
+typedef struct {
+    size_t package;
+    size_t label;
+    size_t target;        /* PACKAGE-REF, (size_t)-1 until read | PACKAGE-REF，读取前为(size_t)-1 */
+    int is_default;
+} BaseRecord;
+
+typedef enum {
+    ISSUE_NOT_FOUND,
+    ISSUE_WRONG_DEST,
+    ISSUE_NO_BASE
+} IssueKind;
+
+typedef struct {
+    const RefRecord* ref;
+    IssueKind kind;
+    char* target;         /* Resolved path | 解析后的路径 */
+    const char* found_tag;
+} RefIssue;
+
+/* Scan results of one input file | 单个输入文件的扫描结果 */
+typedef struct {
+    const char* file_path;
+    StringPool strings;
+    PathRecord* paths;
+    size_t path_count;
+    size_t path_capacity;
+    RefRecord* refs;
+    size_t ref_count;
+    size_t ref_capacity;
+    BaseRecord* bases;
+    size_t base_count;
+    size_t base_capacity;
+    int ok;
+} FileCheck;
+
+typedef struct {
+    uint64_t hash;
+    const char* path;     /* NULL for empty slot | 空槽位为NULL */
+    const char* tag;
+} RegistrySlot;
+
+typedef struct {
+    RegistrySlot* slots;
+    uint64_t mask;
+} RegistryShard;
+
+/* Base with strings resolved | 字符串已解析的引用基 */
+typedef struct {
+    const char* package;
+    const char* label;
+    const char* target;
+    int is_default;
+} ReferenceBase;
+
+typedef struct {
+    FileCheck* files;
+    int file_count;
+    RegistryShard shards[REGISTRY_SHARDS];
+    ReferenceBase* bases;
+    size_t base_count;
+} CheckContext;
+
+typedef struct {
+    CheckContext* ctx;
+    int shard;
+    int ok;
+} ShardTask;
+
+/* Resolution of a slice of one file's references | 单个文件部分引用的解析任务 */
+typedef struct {
+    CheckContext* ctx;
+    FileCheck* file;
+    size_t first;
+    size_t last;
+    RefIssue* issues;
+    size_t issue_count;
+    size_t issue_capacity;
+    int ok;
+} ResolveTask;
+
+#define NO_STRING ((size_t)-1)
+
+/* Run task on pool, inline if pool is missing or full | 在线程池上运行任务，线程池不可用时直接运行 */
+static void run_task(ThreadPool* pool, ThreadTask task, void* arg) {
+    if (!pool || !thread_pool_submit(pool, task, arg)) {
+        task(arg);
+    }
+}
+
+static int pool_add(StringPool* pool, const char* str, size_t len, size_t* offset) {
+    if (pool->size + len + 1 > pool->capacity) {
+        size_t capacity = pool->capacity ? pool->capacity : 65536;
+        while (capacity < pool->size + len + 1) capacity *= 2;
+        char* data = (char*)realloc(pool->data, capacity);
+        if (!data) return 0;
+        pool->data = data;
+        pool->capacity = capacity;
+    }
+    memcpy(pool->data + pool->size, str, len);
+    pool->data[pool->size + len] = '\0';
+    *offset = pool->size;
+    pool->size += len + 1;
+    return 1;
+}
+
+/* Grow array of records when full | 数组已满时扩容 */
+static int reserve(void** items, size_t count, size_t* capacity, size_t item_size) {
+    if (count < *capacity) return 1;
+    size_t new_capacity = *capacity ? *capacity * 2 : 256;
+    void* new_items = realloc(*items, new_capacity * item_size);
+    if (!new_items) return 0;
+    *items = new_items;
+    *capacity = new_capacity;
+    return 1;
+}
+
+static int ends_with(const char* str, size_t len, const char* suffix) {
+    size_t suffix_len = strlen(suffix);
+    return len >= suffix_len && memcmp(str + len - suffix_len, suffix, suffix_len) == 0;
+}
+
+static int text_equals(const char* text, size_t len, const char* value) {
+    return strlen(value) == len && memcmp(text, value, len) == 0;
+}
+
+/* Trim XML whitespace | 去除XML空白字符 */
+static void trim(const char** text, size_t* len) {
+    while (*len > 0 && (**text == ' ' || **text == '\t' || **text == '\r' || **text == '\n')) {
+        (*text)++;
+        (*len)--;
+    }
+    while (*len > 0 && ((*text)[*len - 1] == ' ' || (*text)[*len - 1] == '\t' ||
+                        (*text)[*len - 1] == '\r' || (*text)[*len - 1] == '\n')) {
+        (*len)--;
+    }
+}
+
+/* Scanner callback: register identifiable path | 扫描器回调：登记可标识元素路径 */
+static ArxmlScanResult on_identifiable(const ArxmlScanEntry* entry, void* data) {
+    FileCheck* file = (FileCheck*)data;
+    if (!reserve((void**)&file->paths, file->path_count, &file->path_capacity, sizeof(PathRecord))) {
+        return ARXML_SCAN_ERROR;
+    }
+    PathRecord* record = &file->paths[file->path_count];
+    record->hash = hash64(entry->path, entry->path_len, 0);
+    if (!pool_add(&file->strings, entry->path, entry->path_len, &record->path) ||
+        !pool_add(&file->strings, entry->tag, entry->tag_len, &record->tag)) {
+        return ARXML_SCAN_ERROR;
+    }
+    file->path_count++;
+    return ARXML_SCAN_CONTINUE;
+}
+
+/* Record part of a REFERENCE-BASE definition | 记录REFERENCE-BASE定义的一部分 */
+static int record_base_leaf(FileCheck* file, const ArxmlScanEntry* entry, const char* text, size_t len) {
+    if (text_equals(entry->tag, entry->tag_len, "SHORT-LABEL")) {
+        if (!reserve((void**)&file->bases, file->base_count, &file->base_capacity, sizeof(BaseRecord))) return 0;
+        BaseRecord* base = &file->bases[file->base_count];
+        base->target = NO_STRING;
+        base->is_default = 0;
+        if (!pool_add(&file->strings, entry->path, entry->path_len, &base->package) ||
+            !pool_add(&file->strings, text, len, &base->label)) {
+            return 0;
+        }
+        file->base_count++;
+    } else if (file->base_count > 0) {
+        BaseRecord* base = &file->bases[file->base_count - 1];
+        if (text_equals(entry->tag, entry->tag_len, "IS-DEFAULT")) {
+            base->is_default = text_equals(text, len, "true") || text_equals(text, len, "1");
+        } else if (text_equals(entry->tag, entry->tag_len, "PACKAGE-REF")) {
+            return pool_add(&file->strings, text, len, &base->target);
+        }
+    }
+    return 1;
+}
+
+/* Scanner callback: collect references and reference bases | 扫描器回调：收集引用和引用基 */
+static ArxmlScanResult on_leaf(const ArxmlScanEntry* entry, void* data) {
+    FileCheck* file = (FileCheck*)data;
+    const char* text = entry->text;
+    size_t len = entry->text_len;
+    trim(&text, &len);
+
+    if (ends_with(entry->container, entry->container_len, "REFERENCE-BASE") &&
+        !record_base_leaf(file, entry, text, len)) {
+        return ARXML_SCAN_ERROR;
+    }
+    if (!ends_with(entry->tag, entry->tag_len, "-REF") && !ends_with(entry->tag, entry->tag_len, "-TREF")) {
+        return ARXML_SCAN_CONTINUE;
+    }
+
+    if (!reserve((void**)&file->refs, file->ref_count, &file->ref_capacity, sizeof(RefRecord))) {
+        return ARXML_SCAN_ERROR;
+    }
+    RefRecord* ref = &file->refs[file->ref_count];
+    const char* attr;
+    size_t attr_len;
+    ref->line = entry->line;
+    ref->dest = NO_STRING;
+    ref->base = NO_STRING;
+    if (!pool_add(&file->strings, text, len, &ref->value) ||
+        !pool_add(&file->strings, entry->path, entry->path_len, &ref->context)) {
+        return ARXML_SCAN_ERROR;
+    }
+    if (arxml_scan_attribute(entry->attributes, entry->attributes_len, "DEST", &attr, &attr_len) &&
+        !pool_add(&file->strings, attr, attr_len, &ref->dest)) {
+        return ARXML_SCAN_ERROR;
+    }
+    if (arxml_scan_attribute(entry->attributes, entry->attributes_len, "BASE", &attr, &attr_len) &&
+        !pool_add(&file->strings, attr, attr_len, &ref->base)) {
+        return ARXML_SCAN_ERROR;
+    }
+    file->ref_count++;
+    return ARXML_SCAN_CONTINUE;
+}
+
+/* Worker task: scan one file | 工作线程任务：扫描单个文件 */
+static void scan_file_task(void* arg) {
+    FileCheck* file = (FileCheck*)arg;
+    MappedFile source;
+    ArxmlScanHandler handler = {on_identifiable, NULL, on_leaf, NULL, 1};
+
+    if (!map_file(file->file_path, &source)) {
+        file->ok = 0;
+        return;
+    }
+    file->ok = source.size > 0 && arxml_scan(source.data, (size_t)source.size, &handler, file);
+    unmap_file(&source);
+}
+
+static int shard_of(uint64_t hash) {
+    return (int)(hash >> (64 - REGISTRY_SHARD_BITS));
+}
+
+/* Worker task: build one registry shard from all files | 工作线程任务：根据所有文件构建一个注册表分片 */
+static void build_shard_task(void* arg) {
+    ShardTask* task = (ShardTask*)arg;
+    CheckContext* ctx = task->ctx;
+    RegistryShard* shard = &ctx->shards[task->shard];
+    size_t count = 0;
+
+    for (int f = 0; f < ctx->file_count; f++) {
+        for (size_t i = 0; i < ctx->files[f].path_count; i++) {
+            if (shard_of(ctx->files[f].paths[i].hash) == task->shard) count++;
+        }
+    }
+    uint64_t capacity = 16;
+    while (capacity < count * 2) capacity *= 2;
+    shard->slots = (RegistrySlot*)calloc((size_t)capacity, sizeof(RegistrySlot));
+    shard->mask = capacity - 1;
+    if (!shard->slots) {
+        task->ok = 0;
+        return;
+    }
+
+    /* Same path in several files (split packages) is kept once | 多个文件中相同的路径（拆分的包）只保留一次 */
+    for (int f = 0; f < ctx->file_count; f++) {
+        const FileCheck* file = &ctx->files[f];
+        for (size_t i = 0; i < file->path_count; i++) {
+            const PathRecord* record = &file->paths[i];
+            if (shard_of(record->hash) != task->shard) continue;
+            const char* path = file->strings.data + record->path;
+            uint64_t slot = record->hash & shard->mask;
+            while (shard->slots[slot].path &&
+                   !(shard->slots[slot].hash == record->hash && strcmp(shard->slots[slot].path, path) == 0)) {
+                slot = (slot + 1) & shard->mask;
+            }
+            if (!shard->slots[slot].path) {
+                shard->slots[slot].hash = record->hash;
+                shard->slots[slot].path = path;
+                shard->slots[slot].tag = file->strings.data + record->tag;
+            }
+        }
+    }
+    task->ok = 1;
+}
+
+/* Look up path in registry, returns tag of element or NULL | 在注册表中查找路径，返回元素标签或NULL */
+static const char* registry_lookup(const CheckContext* ctx, const char* path) {
+    uint64_t hash = hash64(path, strlen(path), 0);
+    const RegistryShard* shard = &ctx->shards[shard_of(hash)];
+    uint64_t slot = hash & shard->mask;
+    while (shard->slots[slot].path) {
+        if (shard->slots[slot].hash == hash && strcmp(shard->slots[slot].path, path) == 0) {
+            return shard->slots[slot].tag;
+        }
+        slot = (slot + 1) & shard->mask;
+    }
+    return NULL;
+}
+
+/* Find reference base for context, innermost package first | 为上下文查找引用基，从最内层的包开始 */
+static const char* find_base(const CheckContext* ctx, const char* context, const char* label) {
+    size_t len = strlen(context);
+    while (len > 0) {
+        for (size_t i = 0; i < ctx->base_count; i++) {
+            const ReferenceBase* base = &ctx->bases[i];
+            if (base->target && strlen(base->package) == len && memcmp(base->package, context, len) == 0 &&
+                (label ? strcmp(base->label, label) == 0 : base->is_default)) {
+                return base->target;
+            }
+        }
+        while (len > 0 && context[len - 1] != '/') len--;
+        if (len > 0) len--;  /* Drop the '/' too | 同时去掉'/' */
+    }
+    return NULL;
+}
+
+static int add_issue(ResolveTask* task, const RefRecord* ref, IssueKind kind, const char* target, const char* found_tag) {
+    if (!reserve((void**)&task->issues, task->issue_count, &task->issue_capacity, sizeof(RefIssue))) return 0;
+    RefIssue* issue = &task->issues[task->issue_count];
+    issue->ref = ref;
+    issue->kind = kind;
+    issue->target = strdup(target);
+    issue->found_tag = found_tag;
+    if (!issue->target) return 0;
+    task->issue_count++;
+    return 1;
+}
+
+/* Worker task: resolve a slice of references | 工作线程任务：解析一部分引用 */
+static void resolve_task(void* arg) {
+    ResolveTask* task = (ResolveTask*)arg;
+    const char* strings = task->file->strings.data;
+    char* buffer = NULL;
+    size_t buffer_size = 0;
+
+    task->ok = 1;
+    for (size_t i = task->first; task->ok && i < task->last; i++) {
+        const RefRecord* ref = &task->file->refs[i];
+        const char* value = strings + ref->value;
+        const char* target = value;
+
+        /* Relative references go through a reference base | 相对引用通过引用基解析 */
+        if (value[0] != '/') {
+            const char* base = find_base(task->ctx, strings + ref->context,
+                                         ref->base != NO_STRING ? strings + ref->base : NULL);
+            if (!base) {
+                task->ok = add_issue(task, ref, ISSUE_NO_BASE, value, NULL);
+                continue;
+            }
+            size_t needed = strlen(base) + strlen(value) + 2;
+            if (needed > buffer_size) {
+                char* grown = (char*)realloc(buffer, needed);
+                if (!grown) {
+                    task->ok = 0;
+                    break;
+                }
+                buffer = grown;
+                buffer_size = needed;
+            }
+            snprintf(buffer, buffer_size, "%s/%s", base, value);
+            target = buffer;
+        }
+
+        const char* tag = registry_lookup(task->ctx, target);
+        if (!tag) {
+            task->ok = add_issue(task, ref, ISSUE_NOT_FOUND, target, NULL);
+        } else if (ref->dest != NO_STRING && strcmp(tag, strings + ref->dest) != 0) {
+            task->ok = add_issue(task, ref, ISSUE_WRONG_DEST, target, tag);
+        }
+    }
+    free(buffer);
+}
+
+/* Collect reference bases of all files | 收集所有文件的引用基 */
+static int collect_bases(CheckContext* ctx) {
+    size_t count = 0;
+    for (int f = 0; f < ctx->file_count; f++) count += ctx->files[f].base_count;
+    if (count == 0) return 1;
+    ctx->bases = (ReferenceBase*)malloc(count * sizeof(ReferenceBase));
+    if (!ctx->bases) return 0;
+    for (int f = 0; f < ctx->file_count; f++) {
+        const FileCheck* file = &ctx->files[f];
+        for (size_t i = 0; i < file->base_count; i++) {
+            ReferenceBase* base = &ctx->bases[ctx->base_count++];
+            base->package = file->strings.data + file->bases[i].package;
+            base->label = file->strings.data + file->bases[i].label;
+            base->target = file->bases[i].target != NO_STRING ? file->strings.data + file->bases[i].target : NULL;
+            base->is_default = file->bases[i].is_default;
+        }
+    }
+    return 1;
+}
+
+static void print_issue(const char* file_path, const char* strings, const RefIssue* issue) {
+    const RefRecord* ref = issue->ref;
+    const char* dest = ref->dest != NO_STRING ? strings + ref->dest : "?";
+    switch (issue->kind) {
+        case ISSUE_NOT_FOUND:
+            printf("%s:%ld: Unresolved reference '%s' (DEST=%s) in %s\n",
+                   file_path, ref->line, issue->target, dest, strings + ref->context);
+            break;
+        case ISSUE_WRONG_DEST:
+            printf("%s:%ld: Reference '%s' points to %s, expected DEST=%s, in %s\n",
+                   file_path, ref->line, issue->target, issue->found_tag, dest, strings + ref->context);
+            break;
+        case ISSUE_NO_BASE:
+            printf("%s:%ld: No reference base for relative reference '%s'%s%s in %s\n",
+                   file_path, ref->line, issue->target, ref->base != NO_STRING ? " BASE=" : "",
+                   ref->base != NO_STRING ? strings + ref->base : "", strings + ref->context);
+            break;
+    }
+}
+
+/* Check references of all input files | 检查所有输入文件的引用 */
+int check_arxml_references(const ProgramOptions *opts) {
+    CheckContext ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.file_count = opts->input_files.count;
+    ctx.files = (FileCheck*)calloc((size_t)ctx.file_count, sizeof(FileCheck));
+    ShardTask shard_tasks[REGISTRY_SHARDS];
+    if (!ctx.files) {
+        printf("Error: Memory allocation failed\n");
+        return 0;
+    }
+    ThreadPool* pool = thread_pool_create(opts->jobs);
+
+    /* Phase 1: scan files concurrently | 阶段1：并发扫描文件 */
+    for (int f = 0; f < ctx.file_count; f++) {
+        ctx.files[f].file_path = opts->input_files.items[f];
+        run_task(pool, scan_file_task, &ctx.files[f]);
+    }
+    if (pool) {
+        thread_pool_wait(pool);
+    }
+
+    int ok = 1;
+    for (int f = 0; f < ctx.file_count; f++) {
+        if (!ctx.files[f].ok) {
+            printf("Error: Cannot scan file '%s' (missing, unreadable or malformed XML)\n", ctx.files[f].file_path);
+            ok = 0;
+        }
+    }
+
+    /* Phase 2: build registry shards concurrently | 阶段2：并发构建注册表分片 */
+    if (ok) {
+        for (int s = 0; s < REGISTRY_SHARDS; s++) {
+            shard_tasks[s].ctx = &ctx;
+            shard_tasks[s].shard = s;
+            shard_tasks[s].ok = 0;
+            run_task(pool, build_shard_task, &shard_tasks[s]);
+        }
+        if (pool) {
+            thread_pool_wait(pool);
+        }
+        for (int s = 0; s < REGISTRY_SHARDS; s++) {
+            if (!shard_tasks[s].ok) ok = 0;
+        }
+        if (!ok || !collect_bases(&ctx)) {
+            printf("Error: Memory allocation failed\n");
+            ok = 0;
+        }
+    }
+
+    /* Phase 3: resolve references in slices concurrently | 阶段3：分片并发解析引用 */
+    ResolveTask* tasks = NULL;
+    size_t task_count = 0;
+    if (ok) {
+        for (int f = 0; f < ctx.file_count; f++) {
+            task_count += (ctx.files[f].ref_count + REFS_PER_TASK - 1) / REFS_PER_TASK;
+        }
+        tasks = (ResolveTask*)calloc(task_count ? task_count : 1, sizeof(ResolveTask));
+        if (!tasks) {
+            printf("Error: Memory allocation failed\n");
+            ok = 0;
+        }
+    }
+    if (ok) {
+        size_t t = 0;
+        for (int f = 0; f < ctx.file_count; f++) {
+            for (size_t first = 0; first < ctx.files[f].ref_count; first += REFS_PER_TASK) {
+                tasks[t].ctx = &ctx;
+                tasks[t].file = &ctx.files[f];
+                tasks[t].first = first;
+                tasks[t].last = first + REFS_PER_TASK < ctx.files[f].ref_count ? first + REFS_PER_TASK
+                                                                               : ctx.files[f].ref_count;
+                run_task(pool, resolve_task, &tasks[t]);
+                t++;
+            }
+        }
+        if (pool) {
+            thread_pool_wait(pool);
+        }
+    }
+    if (pool) {
+        thread_pool_destroy(pool);
+    }
+
+    /* Report in input and document order | 按输入和文档顺序报告 */
+    size_t path_total = 0;
+    size_t ref_total = 0;
+    size_t broken = 0;
+    for (size_t t = 0; ok && t < task_count; t++) {
+        if (!tasks[t].ok) {
+            printf("Error: Memory allocation failed\n");
+            ok = 0;
+        }
+    }
+    for (size_t t = 0; t < task_count; t++) {
+        for (size_t i = 0; i < tasks[t].issue_count; i++) {
+            if (ok) print_issue(tasks[t].file->file_path, tasks[t].file->strings.data, &tasks[t].issues[i]);
+            free(tasks[t].issues[i].target);
+        }
+        broken += tasks[t].issue_count;
+        free(tasks[t].issues);
+    }
+    free(tasks);
+
+    for (int f = 0; f < ctx.file_count; f++) {
+        path_total += ctx.files[f].path_count;
+        ref_total += ctx.files[f].ref_count;
+        free(ctx.files[f].strings.data);
+        free(ctx.files[f].paths);
+        free(ctx.files[f].refs);
+        free(ctx.files[f].bases);
+    }
+    for (int s = 0; s < REGISTRY_SHARDS; s++) {
+        free(ctx.shards[s].slots);
+    }
+    free(ctx.bases);
+    free(ctx.files);
+
+    if (!ok) {
+        return 0;
+    }
+    printf("Reference check completed: %d files, %llu paths, %llu references, %llu broken\n",
+           opts->input_files.count, (unsigned long long)path_total, (unsigned long long)ref_total,
+           (unsigned long long)broken);
+    return broken == 0;
+}
@@ -0,0 +1,12 @@
+#ifndef CHECK_REFS_H
+#define CHECK_REFS_H
+
+#include "../main/common.h"
+
+/* Check that every *-REF / *-TREF of the input files resolves | 检查输入文件中的每个*-REF / *-TREF引用都能解析
+ * Paths of all files form one registry; relative references are resolved through REFERENCE-BASES.
+ * 所有文件的路径组成一个注册表；相对引用通过REFERENCE-BASES解析
+ * Returns 1 if all references resolve, 0 otherwise | 所有引用都能解析时返回1，否则返回0 */
+int check_arxml_references(const ProgramOptions *opts);
+
+#endif /* CHECK_REFS_H */
@@ -0,0 +1,462 @@
+#include "compare.h"
+#include "../utils/xml_utils.h"
+#include "../utils/ar_path.h"
+#include "../utils/json_utils.h"
+#include "../utils/fs_utils.h"
+#include "../utils/dir_walk.h"
+#include "../utils/hash_utils.h"
+#include "../utils/thread_pool.h"
+#include "../utils/doc_cache.h"
+#include "../utils/compressed_io.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <libxml/parser.h>
+#include <libxml/hash.h>
+
+/* Skip nodes that carry no content after XML_PARSE_NOBLANKS | 跳过XML_PARSE_NOBLANKS解析后不携带内容的节点 */
+static xmlNodePtr next_content_node(xmlNodePtr node, int skip_identifiable) {
+    while (node != NULL) {
+        if (node->type == XML_TEXT_NODE || node->type == XML_CDATA_SECTION_NODE) {
+            return node;
+        }
+        if (node->type == XML_ELEMENT_NODE && !(skip_identifiable && peek_short_name(node) != NULL)) {
+            return node;
+        }
+        node = node->next;
+    }
+    return NULL;
+}
+
+/* Compare attributes of two elements | 比较两个元素的属性 */
+static int attributes_equal(xmlNodePtr a, xmlNodePtr b) {
+    xmlAttrPtr attr_a = a->properties;
+    xmlAttrPtr attr_b = b->properties;
+
+    while (attr_a != NULL && attr_b != NULL) {
+        const xmlChar* value_a = attr_a->children ? attr_a->children->content : NULL;
+        const xmlChar* value_b = attr_b->children ? attr_b->children->content : NULL;
+        if (!xmlStrEqual(attr_a->name, attr_b->name) || !xmlStrEqual(value_a, value_b)) {
+            return 0;
+        }
+        attr_a = attr_a->next;
+        attr_b = attr_b->next;
+    }
+    return attr_a == NULL && attr_b == NULL;
+}
+
+/* Compare two subtrees | 比较两个子树
+ * With skip_identifiable set, identifiable descendants are ignored so only the "shell" is compared
+ * 设置skip_identifiable时忽略可标识的后代节点，只比较外壳部分 */
+static int nodes_equal(xmlNodePtr a, xmlNodePtr b, int skip_identifiable) {
+    if (a->type != b->type) {
+        return 0;
+    }
+    if (a->type != XML_ELEMENT_NODE) {
+        return xmlStrEqual(a->content, b->content);
+    }
+    if (compare_node_names(a->name, b->name) != 0 || !attributes_equal(a, b)) {
+        return 0;
+    }
+
+    xmlNodePtr child_a = next_content_node(a->children, skip_identifiable);
+    xmlNodePtr child_b = next_content_node(b->children, skip_identifiable);
+    while (child_a != NULL && child_b != NULL) {
+        if (!nodes_equal(child_a, child_b, skip_identifiable)) {
+            return 0;
+        }
+        child_a = next_content_node(child_a->next, skip_identifiable);
+        child_b = next_content_node(child_b->next, skip_identifiable);
+    }
+    return child_a == NULL && child_b == NULL;
+}
+
+/* Collect identifiable children into SHORT-NAME keyed table | 将可标识子节点收集到以SHORT-NAME为键的表中 */
+static void collect_child(xmlNodePtr child, void* data) {
+    xmlHashTablePtr table = (xmlHashTablePtr)data;
+    xmlHashAddEntry(table, peek_short_name(child), child);
+}
+
+/* Write one patch record | 写出一条补丁记录 */
+static void write_patch_record(FILE* out, const char* op, const xmlChar* path, xmlNodePtr node) {
+    if (out == NULL) {
+        return;
+    }
+
+    fputs("{\"op\":", out);
+    json_write_string(out, op);
+    fputs(",\"path\":", out);
+    json_write_string(out, (const char*)path);
+
+    if (node != NULL) {
+        if (strcmp(op, "add") == 0) {
+            /* Added nodes need their parent and container tags | 新增节点需要父路径和容器标签 */
+            xmlChar* parent_path = get_ar_path(node->parent);
+            xmlChar* container = get_ar_container_path(node);
+            fputs(",\"parent\":", out);
+            json_write_string(out, (const char*)parent_path);
+            fputs(",\"container\":", out);
+            json_write_string(out, (const char*)container);
+            xmlFree(parent_path);
+            xmlFree(container);
+        }
+
+        /* Serialize subtree without formatting | 不带格式地序列化子树 */
+        xmlBufferPtr buf = xmlBufferCreate();
+        xmlNodeDump(buf, node->doc, node, 0, 0);
+        fputs(",\"subtree\":", out);
+        json_write_string_len(out, (const char*)xmlBufferContent(buf), (size_t)xmlBufferLength(buf));
+        xmlBufferFree(buf);
+    }
+
+    fputs("}\n", out);
+}
+
+/* Context for walking identifiable children of the new node | 遍历新节点可标识子节点时的上下文 */
+typedef struct {
+    xmlHashTablePtr base_children;
+    const xmlChar* path;
+    FILE* patch_out;
+    CompareStats* stats;
+} DiffContext;
+
+static void diff_node(xmlNodePtr base_node, xmlNodePtr new_node, const xmlChar* path,
+                      FILE* patch_out, CompareStats* stats);
+
+/* Build child path "<path>/<SHORT-NAME>" | 构建子路径"<path>/<SHORT-NAME>" */
+static xmlChar* child_path(const xmlChar* path, xmlNodePtr child) {
+    xmlChar* result = xmlStrdup(path);
+    result = xmlStrcat(result, (const xmlChar*)"/");
+    return xmlStrcat(result, peek_short_name(child));
+}
+
+/* Match new child against base children | 将新文档的子节点与基础文档的子节点匹配 */
+static void diff_new_child(xmlNodePtr child, void* data) {
+    DiffContext* ctx = (DiffContext*)data;
+    xmlChar* path = child_path(ctx->path, child);
+    xmlNodePtr base_child = (xmlNodePtr)xmlHashLookup(ctx->base_children, peek_short_name(child));
+
+    if (base_child != NULL) {
+        /* Remove matched entry, whatever is left was removed | 移除已匹配条目，剩余的即为被删除的节点 */
+        xmlHashRemoveEntry(ctx->base_children, peek_short_name(child), NULL);
+        diff_node(base_child, child, path, ctx->patch_out, ctx->stats);
+    } else {
+        write_patch_record(ctx->patch_out, "add", path, child);
+        ctx->stats->added++;
+    }
+    xmlFree(path);
+}
+
+/* Report base child if it was left unmatched | 若基础文档子节点未被匹配则报告删除
+ * Called in document order, so patch files are the same for the same inputs | 按文档顺序调用，因此相同输入得到相同的补丁文件 */
+static void report_removed_child(xmlNodePtr child, void* data) {
+    DiffContext* ctx = (DiffContext*)data;
+    if (xmlHashLookup(ctx->base_children, peek_short_name(child)) != child) {
+        return;
+    }
+    xmlChar* path = child_path(ctx->path, child);
+
+    write_patch_record(ctx->patch_out, "remove", path, NULL);
+    ctx->stats->removed++;
+    xmlFree(path);
+}
+
+/* Check whether node has identifiable descendants | 检查节点是否有可标识的后代节点 */
+static void mark_found(xmlNodePtr child, void* data) {
+    (void)child;
+    *(int*)data = 1;
+}
+
+static int has_identifiable_children(xmlNodePtr node) {
+    int found = 0;
+    for_each_identifiable_child(node, mark_found, &found);
+    return found;
+}
+
+/* Recursively compare two identifiables with the same path | 递归比较路径相同的两个可标识节点 */
+static void diff_node(xmlNodePtr base_node, xmlNodePtr new_node, const xmlChar* path,
+                      FILE* patch_out, CompareStats* stats) {
+    if (nodes_equal(base_node, new_node, 0)) {
+        return;
+    }
+
+    /* Leaf or changed shell: replace the whole identifiable | 叶子节点或外壳有变化：替换整个可标识节点 */
+    if (!nodes_equal(base_node, new_node, 1) ||
+        (!has_identifiable_children(base_node) && !has_identifiable_children(new_node))) {
+        write_patch_record(patch_out, "replace", path, new_node);
+        stats->replaced++;
+        return;
+    }
+
+    /* Only identifiable children differ, descend | 只有可标识子节点不同，继续向下比较 */
+    DiffContext ctx = {xmlHashCreate(64), path, patch_out, stats};
+    for_each_identifiable_child(base_node, collect_child, ctx.base_children);
+    for_each_identifiable_child(new_node, diff_new_child, &ctx);
+    for_each_identifiable_child(base_node, report_removed_child, &ctx);
+    xmlHashFree(ctx.base_children, NULL);
+}
+
+/* Compare two parsed documents | 比较两个已解析的文档 */
+void diff_arxml_documents(xmlDocPtr base_doc, xmlDocPtr new_doc, FILE* patch_out, CompareStats* stats) {
+    memset(stats, 0, sizeof(CompareStats));
+
+    xmlNodePtr base_root = xmlDocGetRootElement(base_doc);
+    xmlNodePtr new_root = xmlDocGetRootElement(new_doc);
+    if (base_root == NULL || new_root == NULL) {
+        if (base_root != new_root) {
+            write_patch_record(patch_out, "replace", (const xmlChar*)"", new_root);
+            stats->replaced++;
+        }
+        return;
+    }
+
+    /* The root element is addressed by the empty path | 根元素使用空路径表示 */
+    diff_node(base_root, new_root, (const xmlChar*)"", patch_out, stats);
+}
+
+/* Compare two files, optionally writing a patch file | 比较两个文件，可选写出补丁文件 */
+static int compare_file_pair(const char* base_path, const char* new_path, const char* patch_path, CompareStats* stats) {
+    FILE* patch_out = NULL;
+
+    /* Both documents are only read | 两个文档都只被读取 */
+    xmlDocPtr base_doc = doc_cache_read(base_path, XML_PARSE_NOBLANKS, 1);
+    if (base_doc == NULL) {
+        printf("Error: Cannot parse file '%s'\n", base_path);
+        return 0;
+    }
+    xmlDocPtr new_doc = doc_cache_read(new_path, XML_PARSE_NOBLANKS, 1);
+    if (new_doc == NULL) {
+        printf("Error: Cannot parse file '%s'\n", new_path);
+        doc_cache_release(base_doc);
+        return 0;
+    }
+
+    /* Open patch file if requested, "-" writes standard output | 如果需要则打开补丁文件，"-"写出到标准输出 */
+    if (patch_path != NULL && is_stdio_path(patch_path)) {
+        patch_out = stdout_data();
+    } else if (patch_path != NULL && patch_path[0] != '\0') {
+        if (!create_parent_directories(patch_path) || !(patch_out = fopen(patch_path, "wb"))) {
+            printf("Error: Cannot create patch file '%s'\n", patch_path);
+            doc_cache_release(new_doc);
+            doc_cache_release(base_doc);
+            return 0;
+        }
+    }
+
+    /* Header record identifies the format | 头记录标识补丁格式 */
+    if (patch_out != NULL) {
+        fputs("{\"op\":\"header\",\"format\":\"arxml-patch\",\"version\":1,\"base\":", patch_out);
+        json_write_string(patch_out, base_path);
+        fputs(",\"target\":", patch_out);
+        json_write_string(patch_out, new_path);
+        fputs("}\n", patch_out);
+    }
+
+    diff_arxml_documents(base_doc, new_doc, patch_out, stats);
+
+    if (patch_out == stdout_data()) {
+        fflush(patch_out);
+    } else if (patch_out != NULL) {
+        fclose(patch_out);
+    }
+    doc_cache_release(new_doc);
+    doc_cache_release(base_doc);
+    return 1;
+}
+
+/* Status of one file pair in a directory compare | 目录比较中单个文件对的状态 */
+typedef enum {
+    PAIR_SAME_BYTES,    /* Identical bytes, not parsed | 字节完全相同，未解析 */
+    PAIR_IDENTICAL,     /* Parsed, no differences | 已解析，无差异 */
+    PAIR_DIFFERENT,
+    PAIR_ONLY_BASE,
+    PAIR_ONLY_NEW,
+    PAIR_ERROR
+} PairStatus;
+
+/* One file pair of a directory compare | 目录比较中的一个文件对 */
+typedef struct {
+    const char* relative;
+    char* base_path;
+    char* new_path;
+    char* patch_path;
+    PairStatus status;
+    CompareStats stats;
+} FilePair;
+
+/* Join directory and relative path | 连接目录与相对路径 */
+static char* join_path(const char* dir, const char* relative, const char* suffix) {
+    size_t len = strlen(dir) + strlen(relative) + strlen(suffix) + 2;
+    char* path = (char*)malloc(len);
+    if (path) {
+        snprintf(path, len, "%s/%s%s", dir, relative, suffix);
+    }
+    return path;
+}
+
+/* Check whether both files have identical bytes | 检查两个文件的字节是否完全相同 */
+static int same_bytes(const char* path1, const char* path2) {
+    uint64_t size1, size2, hash1, hash2;
+    if (!get_file_size(path1, &size1) || !get_file_size(path2, &size2) || size1 != size2) {
+        return 0;
+    }
+    return hash_file(path1, &hash1) && hash_file(path2, &hash2) && hash1 == hash2;
+}
+
+/* Worker task: compare one file pair | 工作线程任务：比较一个文件对 */
+static void compare_pair_task(void* arg) {
+    FilePair* pair = (FilePair*)arg;
+
+    /* Skip parsing when bytes are identical | 字节相同时跳过解析 */
+    if (same_bytes(pair->base_path, pair->new_path)) {
+        pair->status = PAIR_SAME_BYTES;
+        return;
+    }
+
+    if (!compare_file_pair(pair->base_path, pair->new_path, pair->patch_path, &pair->stats)) {
+        pair->status = PAIR_ERROR;
+    } else if (pair->stats.added == 0 && pair->stats.removed == 0 && pair->stats.replaced == 0) {
+        pair->status = PAIR_IDENTICAL;
+        if (pair->patch_path != NULL) {
+            remove(pair->patch_path);  /* Empty patch is not kept | 不保留空补丁 */
+        }
+    } else {
+        pair->status = PAIR_DIFFERENT;
+    }
+}
+
+/* Compare two directory trees pairing files by relative path | 按相对路径配对比较两个目录树 */
+static int compare_directories(const ProgramOptions *opts) {
+    const char* base_dir = opts->input_files.items[0];
+    const char* new_dir = opts->input_files.items[1];
+    PathList base_files = {0};
+    PathList new_files = {0};
+    int ok = 1;
+
+    DirWalkFilter filter = {".arxml", 1, NULL, NULL, opts->jobs};
+    if (!dir_walk(base_dir, &filter, &base_files) || !dir_walk(new_dir, &filter, &new_files)) {
+        path_list_free(&base_files);
+        path_list_free(&new_files);
+        return 0;
+    }
+
+    /* Pair files by walking both sorted lists | 同时遍历两个有序列表进行配对 */
+    FilePair* pairs = (FilePair*)calloc((size_t)(base_files.count + new_files.count) + 1, sizeof(FilePair));
+    if (!pairs) {
+        printf("Error: Memory allocation failed\n");
+        path_list_free(&base_files);
+        path_list_free(&new_files);
+        return 0;
+    }
+    int pair_count = 0;
+    int bi = 0, ni = 0;
+    while (bi < base_files.count || ni < new_files.count) {
+        FilePair* pair = &pairs[pair_count++];
+        int order = bi >= base_files.count ? 1 :
+                    ni >= new_files.count ? -1 : strcmp(base_files.items[bi], new_files.items[ni]);
+        if (order < 0) {
+            pair->relative = base_files.items[bi++];
+            pair->status = PAIR_ONLY_BASE;
+        } else if (order > 0) {
+            pair->relative = new_files.items[ni++];
+            pair->status = PAIR_ONLY_NEW;
+        } else {
+            pair->relative = base_files.items[bi++];
+            ni++;
+            pair->status = PAIR_ERROR;  /* Until the pair is compared | 在比较该文件对之前 */
+            pair->base_path = join_path(base_dir, pair->relative, "");
+            pair->new_path = join_path(new_dir, pair->relative, "");
+            if (opts->patch_file[0] != '\0') {
+                pair->patch_path = join_path(opts->patch_file, pair->relative, ".jsonl");
+            }
+        }
+    }
+
+    /* Compare pairs present on both sides concurrently | 并发比较两侧都存在的文件对 */
+    xmlInitParser();
+    ThreadPool* pool = thread_pool_create(opts->jobs);
+    for (int i = 0; i < pair_count; i++) {
+        if (pairs[i].base_path && pairs[i].new_path) {
+            /* Inline if pool is missing or full | 线程池不可用时直接运行 */
+            if (!pool || !thread_pool_submit(pool, compare_pair_task, &pairs[i])) {
+                compare_pair_task(&pairs[i]);
+            }
+        }
+    }
+    thread_pool_destroy(pool);
+
+    /* Report per file and aggregate | 逐文件报告并汇总 */
+    int counts[PAIR_ERROR + 1] = {0};
+    CompareStats total = {0, 0, 0};
+    for (int i = 0; ok && i < pair_count; i++) {
+        FilePair* pair = &pairs[i];
+        counts[pair->status]++;
+        total.added += pair->stats.added;
+        total.removed += pair->stats.removed;
+        total.replaced += pair->stats.replaced;
+
+        if (pair->status == PAIR_DIFFERENT) {
+            printf("Differ: %s (%d added, %d removed, %d replaced)\n", pair->relative,
+                   pair->stats.added, pair->stats.removed, pair->stats.replaced);
+        } else if (pair->status == PAIR_ONLY_BASE) {
+            printf("Only in %s: %s\n", base_dir, pair->relative);
+        } else if (pair->status == PAIR_ONLY_NEW) {
+            printf("Only in %s: %s\n", new_dir, pair->relative);
+        } else if (pair->status == PAIR_ERROR) {
+            printf("Failed: %s\n", pair->relative);
+        }
+    }
+    if (ok) {
+        printf("Directory compare completed: %d files, %d identical (%d by hash), %d differ, "
+               "%d only in base, %d only in new, %d failed\n",
+               pair_count, counts[PAIR_SAME_BYTES] + counts[PAIR_IDENTICAL], counts[PAIR_SAME_BYTES],
+               counts[PAIR_DIFFERENT], counts[PAIR_ONLY_BASE], counts[PAIR_ONLY_NEW], counts[PAIR_ERROR]);
+        printf("Total differences: %d added, %d removed, %d replaced\n", total.added, total.removed, total.replaced);
+        ok = counts[PAIR_ERROR] == 0;
+    }
+
+    for (int i = 0; i < pair_count; i++) {
+        free(pairs[i].base_path);
+        free(pairs[i].new_path);
+        free(pairs[i].patch_path);
+    }
+    free(pairs);
+    path_list_free(&base_files);
+    path_list_free(&new_files);
+    return ok;
+}
+
+/* Compare ARXML files implementation | ARXML文件比较实现 */
+int compare_arxml_files(const ProgramOptions *opts) {
+    CompareStats stats;
+    int base_is_dir = is_directory(opts->input_files.items[0]);
+    int new_is_dir = is_directory(opts->input_files.items[1]);
+
+    /* Two directories: compare trees file by file | 两个目录：逐文件比较目录树 */
+    if (base_is_dir && new_is_dir) {
+        if (is_stdio_path(opts->patch_file)) {
+            printf("Error: A directory compare writes one patch per file, -p cannot be '-'\n");
+            return 0;
+        }
+        return compare_directories(opts);
+    }
+    if (base_is_dir || new_is_dir) {
+        printf("Error: Compare needs two files or two directories\n");
+        return 0;
+    }
+
+    if (!compare_file_pair(opts->input_files.items[0], opts->input_files.items[1], opts->patch_file, &stats)) {
+        return 0;
+    }
+
+    /* Print summary | 打印比较结果 */
+    if (stats.added == 0 && stats.removed == 0 && stats.replaced == 0) {
+        printf("Files are identical: %s %s\n", opts->input_files.items[0], opts->input_files.items[1]);
+    } else {
+        printf("Files differ: %d added, %d removed, %d replaced\n", stats.added, stats.removed, stats.replaced);
+    }
+    if (opts->patch_file[0] != '\0') {
+        printf("Patch written: %s\n", opts->patch_file);
+    }
+    return 1;
+}
@@ -0,0 +1,22 @@
+#ifndef COMPARE_H
+#define COMPARE_H
+
+#include <stdio.h>
+#include <libxml/parser.h>
+#include "../main/common.h"
+
+/* Difference counters of one comparison | 一次比较的差异计数 */
+typedef struct {
+    int added;      /* Identifiables only in new document | 仅存在于新文档中的可标识元素 */
+    int removed;    /* Identifiables only in base document | 仅存在于基础文档中的可标识元素 */
+    int replaced;   /* Identifiables with changed content | 内容发生变化的可标识元素 */
+} CompareStats;
+
+/* Compare two parsed documents | 比较两个已解析的文档
+ * Patch records are written to patch_out if it is not NULL | patch_out非空时写出补丁记录 */
+void diff_arxml_documents(xmlDocPtr base_doc, xmlDocPtr new_doc, FILE* patch_out, CompareStats* stats);
+
+/* Compare ARXML files implementation | ARXML文件比较实现 */
+int compare_arxml_files(const ProgramOptions *opts);
+
+#endif /* COMPARE_H */
@@ -0,0 +1,455 @@
+#include "extract.h"
+#include "../utils/arxml_scanner.h"
+#include "../utils/arxml_index.h"
+#include "../utils/xml_utils.h"
+#include "../utils/fs_utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <libxml/parser.h>
+
+/* Located target or ancestor of a target | 已定位的目标或目标的祖先 */
+typedef struct {
+    char* path;
+    char* container;
+    uint64_t start;
+    uint64_t end;       /* 0 until element end is seen | 读到元素结尾之前为0 */
+    int is_target;
+} ExtractNode;
+
+typedef struct {
+    ExtractNode* nodes;
+    int count;
+    int capacity;
+    const char** targets;
+    int target_count;
+    int targets_done;
+} ExtractState;
+
+/* Growable output text | 可增长的输出文本 */
+typedef struct {
+    char* data;
+    size_t len;
+    size_t capacity;
+    int failed;
+} TextBuffer;
+
+/* Element opened around extracted subtrees | 在提取的子树外层打开的元素 */
+typedef struct {
+    char* key;
+    char* tag;
+} OpenItem;
+
+/* Growable stack of open elements, any nesting depth | 可增长的已打开元素栈，不限嵌套深度 */
+typedef struct {
+    OpenItem* items;
+    int depth;
+    int capacity;
+} OpenStack;
+
+static void text_append(TextBuffer* buf, const char* str, size_t len) {
+    if (buf->failed) return;
+    if (buf->len + len + 1 > buf->capacity) {
+        size_t capacity = buf->capacity ? buf->capacity : 65536;
+        while (capacity < buf->len + len + 1) capacity *= 2;
+        char* data = (char*)realloc(buf->data, capacity);
+        if (!data) {
+            buf->failed = 1;
+            return;
+        }
+        buf->data = data;
+        buf->capacity = capacity;
+    }
+    memcpy(buf->data + buf->len, str, len);
+    buf->len += len;
+    buf->data[buf->len] = '\0';
+}
+
+static void text_append_str(TextBuffer* buf, const char* str) {
+    text_append(buf, str, strlen(str));
+}
+
+static ExtractNode* find_node(ExtractState* state, const char* path, size_t len) {
+    for (int i = 0; i < state->count; i++) {
+        if (strlen(state->nodes[i].path) == len && memcmp(state->nodes[i].path, path, len) == 0) {
+            return &state->nodes[i];
+        }
+    }
+    return NULL;
+}
+
+static ExtractNode* add_node(ExtractState* state, const char* path, size_t path_len,
+                             const char* container, uint64_t start) {
+    if (state->count == state->capacity) {
+        int capacity = state->capacity ? state->capacity * 2 : 32;
+        ExtractNode* nodes = (ExtractNode*)realloc(state->nodes, (size_t)capacity * sizeof(ExtractNode));
+        if (!nodes) return NULL;
+        state->nodes = nodes;
+        state->capacity = capacity;
+    }
+    ExtractNode* node = &state->nodes[state->count];
+    memset(node, 0, sizeof(ExtractNode));
+    node->path = (char*)malloc(path_len + 1);
+    node->container = strdup(container);
+    if (!node->path || !node->container) {
+        free(node->path);
+        free(node->container);
+        return NULL;
+    }
+    memcpy(node->path, path, path_len);
+    node->path[path_len] = '\0';
+    node->start = start;
+    state->count++;
+    return node;
+}
+
+/* Check whether path is a proper ancestor of target | 检查路径是否为目标的真祖先 */
+static int is_ancestor(const char* path, size_t len, const char* target) {
+    return strncmp(target, path, len) == 0 && target[len] == '/';
+}
+
+/* Scanner callback: record targets and their ancestors, skip everything else | 扫描器回调：记录目标及其祖先，跳过其他内容 */
+static ArxmlScanResult on_open(const ArxmlScanEntry* entry, void* data) {
+    ExtractState* state = (ExtractState*)data;
+    int relevant = 0;
+    int target = 0;
+
+    for (int i = 0; i < state->target_count; i++) {
+        if (strcmp(entry->path, state->targets[i]) == 0) {
+            target = 1;
+        } else if (is_ancestor(entry->path, entry->path_len, state->targets[i])) {
+            relevant = 1;
+        }
+    }
+    if ((target || relevant) && !find_node(state, entry->path, entry->path_len)) {
+        if (!add_node(state, entry->path, entry->path_len, entry->container, entry->start)) {
+            return ARXML_SCAN_ERROR;
+        }
+    }
+    /* Target content is copied as bytes, no need to look inside | 目标内容按字节复制，无需查看内部 */
+    return relevant ? ARXML_SCAN_CONTINUE : ARXML_SCAN_SKIP;
+}
+
+static ArxmlScanResult on_close(const ArxmlScanEntry* entry, void* data) {
+    ExtractState* state = (ExtractState*)data;
+    ExtractNode* node = find_node(state, entry->path, entry->path_len);
+    for (int i = 0; node && node->end == 0 && i < state->target_count; i++) {
+        if (strcmp(entry->path, state->targets[i]) == 0) {
+            node->end = entry->end;
+            node->is_target = 1;
+            state->targets_done++;
+        }
+    }
+    return state->targets_done == state->target_count ? ARXML_SCAN_STOP : ARXML_SCAN_CONTINUE;
+}
+
+/* Locate targets and ancestors through sidecar index | 通过旁路索引定位目标及其祖先 */
+static int locate_with_index(ExtractState* state, const ArxmlIndex* index) {
+    for (int i = 0; i < state->target_count; i++) {
+        const char* target = state->targets[i];
+        size_t target_len = strlen(target);
+        for (size_t len = 1; len <= target_len; len++) {
+            if (len < target_len && target[len] != '/') continue;
+            ExtractNode* node = find_node(state, target, len);
+            if (node && (len < target_len || node->is_target)) continue;
+            const ArxmlIndexEntry* entry = arxml_index_lookup(index, target, len);
+            if (!entry) break;
+            if (!node) {
+                node = add_node(state, target, len, arxml_index_entry_container(index, entry), entry->start);
+                if (!node) return 0;
+            }
+            if (len == target_len) {
+                node->end = entry->end;
+                node->is_target = 1;
+            }
+        }
+    }
+    return 1;
+}
+
+/* Order targets by position in source | 按在源文件中的位置排序目标 */
+static int compare_nodes_by_start(const void* a, const void* b) {
+    const ExtractNode* node_a = *(const ExtractNode* const*)a;
+    const ExtractNode* node_b = *(const ExtractNode* const*)b;
+    return node_a->start < node_b->start ? -1 : (node_a->start > node_b->start ? 1 : 0);
+}
+
+/* Get tag name of start tag at pos | 获取pos处开始标签的标签名 */
+static char* tag_name_at(const char* data, uint64_t size, uint64_t pos) {
+    uint64_t end = pos + 1;
+    while (end < size && data[end] != '>' && data[end] != '/' && data[end] != ' ' &&
+           data[end] != '\t' && data[end] != '\r' && data[end] != '\n') {
+        end++;
+    }
+    char* tag = (char*)malloc((size_t)(end - pos));
+    if (tag) {
+        memcpy(tag, data + pos + 1, (size_t)(end - pos - 1));
+        tag[end - pos - 1] = '\0';
+    }
+    return tag;
+}
+
+/* Close open items deeper than level | 关闭深于level的已打开元素 */
+static void close_items(TextBuffer* out, OpenStack* stack, int level) {
+    while (stack->depth > level) {
+        OpenItem* item = &stack->items[--stack->depth];
+        text_append_str(out, "</");
+        text_append_str(out, item->tag);
+        text_append_str(out, ">");
+        free(item->key);
+        free(item->tag);
+    }
+}
+
+/* Open or reuse wrapper item, closing items that no longer apply | 打开或复用外层元素，关闭不再适用的元素 */
+static int open_item(TextBuffer* out, OpenStack* stack, int level,
+                     const char* key, const char* tag, const char* open_text, size_t open_len) {
+    if (level < stack->depth && strcmp(stack->items[level].key, key) == 0) {
+        return 1;  /* Shared with previous target | 与上一个目标共用 */
+    }
+    close_items(out, stack, level);
+    if (stack->depth == stack->capacity) {
+        int capacity = stack->capacity ? stack->capacity * 2 : 32;
+        OpenItem* items = (OpenItem*)realloc(stack->items, (size_t)capacity * sizeof(OpenItem));
+        if (!items) return 0;
+        stack->items = items;
+        stack->capacity = capacity;
+    }
+    OpenItem* item = &stack->items[level];
+    item->key = strdup(key);
+    item->tag = strdup(tag);
+    if (!item->key || !item->tag) {
+        free(item->key);
+        free(item->tag);
+        return 0;
+    }
+    stack->depth++;
+    text_append(out, open_text, open_len);
+    return 1;
+}
+
+/* Write wrappers of one target and its bytes | 写出一个目标的外层元素及其内容 */
+static int write_target(TextBuffer* out, ExtractState* state, const ExtractNode* target,
+                        const char* data, uint64_t size, OpenStack* stack) {
+    const char* path = target->path;
+    size_t path_len = strlen(path);
+    int level = 0;
+
+    for (size_t len = 1; len <= path_len; len++) {
+        if (len < path_len && path[len] != '/') continue;
+        ExtractNode* node = find_node(state, path, len);
+        size_t parent_len = (size_t)(strrchr(node->path, '/') - node->path);
+
+        /* Containers between parent and node, key is parent path and container path | 父元素与该节点之间的容器，键为父路径加容器路径 */
+        const char* seg = node->container;
+        while (*seg) {
+            const char* seg_end = strchr(seg, '/');
+            size_t seg_len = seg_end ? (size_t)(seg_end - seg) : strlen(seg);
+            TextBuffer key = {NULL, 0, 0, 0};
+            TextBuffer open_text = {NULL, 0, 0, 0};
+            text_append(&key, node->path, parent_len);
+            text_append_str(&key, "#");
+            text_append(&key, node->container, (size_t)(seg + seg_len - node->container));
+            text_append_str(&open_text, "<");
+            text_append(&open_text, seg, seg_len);
+            text_append_str(&open_text, ">");
+            char* tag = (char*)malloc(seg_len + 1);
+            int ok = !key.failed && !open_text.failed && tag;
+            if (ok) {
+                memcpy(tag, seg, seg_len);
+                tag[seg_len] = '\0';
+                ok = open_item(out, stack, level++, key.data, tag, open_text.data, open_text.len);
+            }
+            free(tag);
+            free(key.data);
+            free(open_text.data);
+            if (!ok) return 0;
+            seg = seg_end ? seg_end + 1 : seg + seg_len;
+        }
+        if (len == path_len) {
+            break;
+        }
+
+        /* Ancestor shell: original start tag and SHORT-NAME | 祖先外壳：原始开始标签和SHORT-NAME */
+        char* tag = tag_name_at(data, size, node->start);
+        if (!tag) {
+            return 0;
+        }
+        const char* tag_end = (const char*)memchr(data + node->start, '>', (size_t)(size - node->start));
+        TextBuffer shell = {NULL, 0, 0, 0};
+        text_append(&shell, data + node->start, (size_t)(tag_end + 1 - (data + node->start)));
+        text_append_str(&shell, "<SHORT-NAME>");
+        text_append_str(&shell, node->path + parent_len + 1);
+        text_append_str(&shell, "</SHORT-NAME>");
+        int ok = !shell.failed && open_item(out, stack, level++, node->path, tag, shell.data, shell.len);
+        free(shell.data);
+        free(tag);
+        if (!ok) return 0;
+    }
+
+    /* Close deeper items of previous target, then copy subtree bytes | 关闭上一个目标更深的元素，再复制子树内容 */
+    close_items(out, stack, level);
+    text_append(out, data + target->start, (size_t)(target->end - target->start));
+    return !out->failed;
+}
+
+/* Build extracted document text | 构建提取出的文档文本 */
+static int build_document(TextBuffer* out, ExtractState* state, const char* data, uint64_t size) {
+    const char* root_end = NULL;
+    const char* root = arxml_find_root_tag(data, (size_t)size, &root_end);
+    if (!root) return 0;
+    char* root_tag = tag_name_at(data, size, (uint64_t)(root - data));
+    if (!root_tag) return 0;
+
+    ExtractNode** targets = (ExtractNode**)malloc((size_t)state->count * sizeof(ExtractNode*));
+    int target_count = 0;
+    if (!targets) {
+        free(root_tag);
+        return 0;
+    }
+
+    /* Nested targets are already part of their ancestor target | 嵌套的目标已包含在其祖先目标中 */
+    for (int i = 0; i < state->count; i++) {
+        ExtractNode* node = &state->nodes[i];
+        int nested = 0;
+        if (!node->is_target) continue;
+        for (int j = 0; j < state->count; j++) {
+            if (j != i && state->nodes[j].is_target &&
+                is_ancestor(state->nodes[j].path, strlen(state->nodes[j].path), node->path)) {
+                nested = 1;
+            }
+        }
+        if (!nested) targets[target_count++] = node;
+    }
+    qsort(targets, (size_t)target_count, sizeof(ExtractNode*), compare_nodes_by_start);
+
+    text_append_str(out, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+    text_append(out, root, (size_t)(root_end - root));
+
+    OpenStack stack = {NULL, 0, 0};
+    int ok = 1;
+    for (int i = 0; ok && i < target_count; i++) {
+        ok = write_target(out, state, targets[i], data, size, &stack);
+    }
+    close_items(out, &stack, 0);
+    free(stack.items);
+    text_append_str(out, "</");
+    text_append_str(out, root_tag);
+    text_append_str(out, ">\n");
+
+    free(targets);
+    free(root_tag);
+    return ok && !out->failed;
+}
+
+/* Extract subtrees by AUTOSAR path into a new ARXML file | 按AUTOSAR路径提取子树到新的ARXML文件 */
+int extract_arxml_subtrees(const ProgramOptions *opts) {
+    const char* source_path = opts->input_files.items[0];
+    ExtractState state;
+    MappedFile source;
+    int used_index = 0;
+
+    memset(&state, 0, sizeof(state));
+    state.targets = (const char**)opts->ar_paths.items;
+    state.target_count = opts->ar_paths.count;
+
+    /* Initialize detected indentation style | 初始化检测到的缩进风格 */
+    DetectedIndentStyle detected = {.style = 's', .width = 4};  /* Default to 4 spaces | 默认4空格 */
+    if (opts->indent_style == INDENT_DEFAULT) {
+        detected = detect_indent_style(source_path);
+    }
+
+    if (!map_file(source_path, &source)) {
+        printf("Error: Cannot open file '%s'\n", source_path);
+        return 0;
+    }
+
+    /* Prefer an up to date sidecar index, otherwise scan | 优先使用最新的旁路索引，否则扫描文件 */
+    char* index_path = arxml_index_sidecar_path(source_path);
+    ArxmlIndex index;
+    ArxmlIndexStatus status = index_path ? arxml_index_open(index_path, source_path, &index) : ARXML_INDEX_MISSING;
+    int ok = 1;
+    if (status == ARXML_INDEX_OK) {
+        ok = locate_with_index(&state, &index);
+        arxml_index_close(&index);
+        used_index = 1;
+    } else {
+        if (status == ARXML_INDEX_STALE) {
+            printf("Warning: Index '%s' is out of date, scanning source file\n", index_path);
+        } else if (status == ARXML_INDEX_INVALID) {
+            printf("Warning: Index '%s' is not usable, scanning source file\n", index_path);
+        }
+        ArxmlScanHandler handler = {on_open, on_close, NULL, NULL, 0};
+        if (!arxml_scan(source.data, (size_t)source.size, &handler, &state)) {
+            printf("Error: Cannot scan file '%s' (malformed XML)\n", source_path);
+            ok = 0;
+        }
+    }
+    free(index_path);
+
+    for (int i = 0; ok && i < state.target_count; i++) {
+        ExtractNode* node = find_node(&state, state.targets[i], strlen(state.targets[i]));
+        if (!node || !node->is_target) {
+            printf("Error: Path '%s' not found in '%s'\n", state.targets[i], source_path);
+            ok = 0;
+        }
+    }
+
+    TextBuffer text = {NULL, 0, 0, 0};
+    if (ok && !build_document(&text, &state, source.data, source.size)) {
+        printf("Error: Cannot build extracted document\n");
+        ok = 0;
+    }
+    unmap_file(&source);
+    for (int i = 0; i < state.count; i++) {
+        free(state.nodes[i].path);
+        free(state.nodes[i].container);
+    }
+    free(state.nodes);
+
+    /* Only the extracted part is parsed, then saved formatted | 只解析提取出的部分，再格式化保存 */
+    xmlDocPtr doc = NULL;
+    if (ok) {
+        doc = xmlReadMemory(text.data, (int)text.len, NULL, "UTF-8", XML_PARSE_NOBLANKS | XML_PARSE_HUGE);
+        if (!doc) {
+            printf("Error: Extracted content is not well-formed\n");
+            ok = 0;
+        }
+    }
+    free(text.data);
+    if (!ok) {
+        return 0;
+    }
+
+    /* Set indentation for output | 设置输出的缩进 */
+    set_output_indent(opts, detected);
+
+    /* Get final output path | 获取最终输出路径 */
+    char* final_output_path = build_output_path(opts->output_file, opts->output_dir);
+    if (!final_output_path) {
+        printf("Error: Memory allocation failed\n");
+        xmlFreeDoc(doc);
+        return 0;
+    }
+
+    /* Create output directory if needed | 如果需要则创建输出目录 */
+    if (!create_parent_directories(final_output_path)) {
+        printf("Error: Cannot create output directory for file '%s'\n", final_output_path);
+        free(final_output_path);
+        xmlFreeDoc(doc);
+        return 0;
+    }
+
+    if (xmlSaveFormatFileEnc(final_output_path, doc, "UTF-8", 1) < 0) {
+        printf("Error: Cannot save file '%s'\n", final_output_path);
+        free(final_output_path);
+        xmlFreeDoc(doc);
+        return 0;
+    }
+    xmlFreeDoc(doc);
+
+    printf("Extract completed (%d paths, %s), output file: %s\n", opts->ar_paths.count,
+           used_index ? "index" : "scan", final_output_path);
+    free(final_output_path);
+    return 1;
+}
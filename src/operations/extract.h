@@ -0,0 +1,11 @@
+#ifndef EXTRACT_H
+#define EXTRACT_H
+
+#include "../main/common.h"
+
+/* Extract subtrees by AUTOSAR path into a new ARXML file | 按AUTOSAR路径提取子树到新的ARXML文件
+ * Uses the "<file>.idx" sidecar written by index mode when it is up to date, otherwise scans the file.
+ * 若index模式写出的"<file>.idx"旁路索引是最新的则使用它，否则扫描文件 */
+int extract_arxml_subtrees(const ProgramOptions *opts);
+
+#endif /* EXTRACT_H */
@@ -1,69 +1,66 @@
 #include "format.h"
 #include "../utils/xml_utils.h"
 #include "../utils/fs_utils.h"
+#include "../utils/perf_utils.h"
+#include "../utils/xml_arena.h"
+#include "../utils/doc_cache.h"
+#include "../utils/compressed_io.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 #include <libxml/parser.h>
 
-/* Create a string with n spaces for indentation | 创建包含n个空格的缩进字符串 */
-static const char* create_space_indent(int n) {
-    static char indent_buf[32] = {0};  /* 足够容纳大量空格 */
-    if (n <= 0) n = 4;  /* 如果指定无效数值，使用4空格 */
-    if (n > 31) n = 31; /* 限制最大空格数 */
-    
-    memset(indent_buf, ' ', n);
-    indent_buf[n] = '\0';
-    return indent_buf;
-}
+/* Format inputs, parsed through filter if set | 格式化输入，设置filter时解析经过过滤 */
+static int format_filtered(const ProgramOptions *opts, const ArPathFilter* filter) {
+    PerfProfile* profile = opts->profile ? perf_profile_create("format") : NULL;
+    double phase_start;
 
-int format_arxml_files(const ProgramOptions *opts) {
-    for (int i = 0; i < opts->input_file_count; i++) {
-        /* Get output file path | 获取输出文件路径 */
-        char output_path[MAX_PATH];
-        if (strcmp(opts->output_dir, ".") == 0) {
-            strncpy(output_path, opts->input_files[i], MAX_PATH - 1);
-            output_path[MAX_PATH - 1] = '\0';
-        } else {
-            const char *input_filename = strrchr(opts->input_files[i], '/');
-            if (!input_filename) input_filename = opts->input_files[i];
-            else input_filename++; // Skip '/'
-            
-            size_t dir_len = strlen(opts->output_dir);
-            size_t file_len = strlen(input_filename);
-            
-            if (dir_len + file_len + 2 > MAX_PATH) {  // +2 for '/' and '\0'
-                printf("Error: Output path too long\n");
-                return 0;
-            }
-            
-            strcpy(output_path, opts->output_dir);
-            output_path[dir_len] = '/';
-            strcpy(output_path + dir_len + 1, input_filename);
+    for (int i = 0; i < opts->input_files.count; i++) {
+        /* Get output file path, same file name in -o directory | 获取输出文件路径，在-o目录中使用相同文件名 */
+        char* output_path = build_output_path(opts->input_files.items[i], opts->output_dir);
+        if (!output_path) {
+            printf("Error: Memory allocation failed\n");
+            perf_profile_free(profile);
+            return 0;
         }
 
         /* First read: detect indentation if needed | 第一次读取：如果需要则检测缩进 */
         DetectedIndentStyle detected = {.style = 's', .width = 4};  /* Default to 4 spaces | 默认4空格 */
-        if (opts->indent_style == INDENT_DEFAULT) {
-            detected = detect_indent_style(opts->input_files[i]);
+        int single_pass = is_stdio_path(opts->input_files.items[i]) || filter;
+        if (opts->indent_style == INDENT_DEFAULT && !single_pass) {
+            phase_start = perf_phase_begin(profile);
+            detected = detect_indent_style(opts->input_files.items[i]);
+            perf_phase_end(profile, "detect_indent", opts->input_files.items[i], phase_start, 0, 0);
         }
 
-        /* Second read: process content | 第二次读取：处理内容 */
-        xmlDocPtr doc = xmlReadFile(opts->input_files[i], NULL, XML_PARSE_NOBLANKS);
+        /* Second read: process content, a cached tree is shared unless sorting modifies it | 第二次读取：处理内容，除非排序会修改文档树，否则共享缓存的文档树
+         * Standard input and filtered files are read once, detecting the indentation while parsing | 标准输入和经过过滤的文件只读取一次，在解析的同时检测缩进 */
+        phase_start = perf_phase_begin(profile);
+        xmlDocPtr doc = single_pass
+            ? read_xml_file_filtered(opts->input_files.items[i], XML_PARSE_NOBLANKS, filter,
+                                     opts->indent_style == INDENT_DEFAULT ? &detected : NULL)
+            : doc_cache_read(opts->input_files.items[i], XML_PARSE_NOBLANKS, opts->sort_order == SORT_NONE);
         if (!doc) {
-            printf("Error: Cannot parse file '%s'\n", opts->input_files[i]);
+            printf("Error: Cannot parse file '%s'\n", opts->input_files.items[i]);
+            free(output_path);
+            perf_profile_free(profile);
             return 0;
         }
+        perf_phase_end(profile, "parse", opts->input_files.items[i], phase_start,
+                       perf_profile_file_size(profile, opts->input_files.items[i]), 0);
 
         /* Sort nodes if requested | 如果需要则进行排序 */
         if (opts->sort_order != SORT_NONE) {
             xmlNodePtr root = xmlDocGetRootElement(doc);
             if (!root) {
                 printf("Error: Empty document\n");
-                xmlFreeDoc(doc);
+                free(output_path);
+                doc_cache_release(doc);
+                perf_profile_free(profile);
                 return 0;
             }
             
+            phase_start = perf_phase_begin(profile);
             if (opts->sort_specific_tag) {
                 /* Sort children of specific tag | 对特定标签的子节点进行排序 */
                 int sorted_count = sort_specific_tag_children(root, opts->target_tag, opts->sort_order);
@@ -74,43 +71,63 @@ int format_arxml_files(const ProgramOptions *opts) {
                 /* Sort all nodes recursively | 递归排序所有节点 */
                 sort_nodes_by_short_name(root, opts->sort_order);
             }
+            perf_phase_end(profile, "sort", opts->input_files.items[i], phase_start, 0, 0);
         }
 
         /* Set indentation for output | 设置输出的缩进 */
-        xmlKeepBlanksDefault(0);
-        xmlIndentTreeOutput = 1;
-
-        if (opts->indent_style == INDENT_DEFAULT) {
-            /* Use detected indentation | 使用检测到的缩进 */
-            xmlTreeIndentString = (detected.style == 't') ? "\t" : 
-                                create_space_indent(detected.width);
-        } else if (opts->indent_style == INDENT_TAB) {
-            /* Use tab indentation | 使用制表符缩进 */
-            xmlTreeIndentString = "\t";
-        } else {
-            /* Use specified number of spaces | 使用指定数量的空格 */
-            xmlTreeIndentString = create_space_indent(opts->indent_width);
-        }
+        set_output_indent(opts, detected);
 
         /* Create output directory if needed | 如果需要则创建输出目录 */
-        char output_dir[MAX_PATH];
-        get_directory_path(output_path, output_dir, sizeof(output_dir));
-        if (!create_directories(output_dir)) {
+        phase_start = perf_phase_begin(profile);
+        if (!create_parent_directories(output_path)) {
             printf("Error: Cannot create output directory for file '%s'\n", output_path);
-            xmlFreeDoc(doc);
+            free(output_path);
+            doc_cache_release(doc);
+            perf_profile_free(profile);
             return 0;
         }
+        perf_phase_end(profile, "mkdir", output_path, phase_start, 0, 0);
 
         /* Save the document | 保存文档 */
-        if (xmlSaveFormatFileEnc(output_path, doc, "UTF-8", 1) < 0) {
+        phase_start = perf_phase_begin(profile);
+        if (!save_xml_file(output_path, doc, opts->jobs)) {
             printf("Error: Cannot save file '%s'\n", output_path);
-            xmlFreeDoc(doc);
+            free(output_path);
+            doc_cache_release(doc);
+            perf_profile_free(profile);
             return 0;
         }
+        perf_phase_end(profile, "save", output_path, phase_start, 0, perf_profile_file_size(profile, output_path));
 
-        xmlFreeDoc(doc);
+        /* With the arena the whole tree goes at once, chunks are reused by the next file | 使用arena时一次丢弃整棵树，内存块由下一个文件复用 */
+        phase_start = perf_phase_begin(profile);
+        if (xml_arena_enabled()) {
+            xml_arena_reset();
+        } else if (!doc_cache_store(output_path, doc)) {
+            /* Stored outputs are read by later batch jobs without parsing | 保留的输出供后续批处理任务读取，无需解析 */
+            doc_cache_release(doc);
+        }
+        perf_phase_end(profile, "free", output_path, phase_start, 0, 0);
         printf("File formatted: %s\n", output_path);
+        free(output_path);
     }
 
-    return 1;
-}
\ No newline at end of file
+    int ok = perf_profile_report(profile, opts->profile_file);
+    perf_profile_free(profile);
+    return ok;
+}
+
+int format_arxml_files(const ProgramOptions *opts) {
+    /* Path patterns are compiled once for all inputs | 路径模式对所有输入只编译一次 */
+    ArPathFilter* filter = NULL;
+    if (opts->only_paths.count + opts->skip_paths.count > 0) {
+        filter = ar_path_filter_new(&opts->only_paths, &opts->skip_paths);
+        if (!filter) {
+            printf("Error: Memory allocation failed\n");
+            return 0;
+        }
+    }
+    int ok = format_filtered(opts, filter);
+    ar_path_filter_free(filter);
+    return ok;
+}
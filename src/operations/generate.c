@@ -0,0 +1,501 @@
+#include "generate.h"
+#include "../utils/xml_utils.h"
+#include "../utils/json_utils.h"
+#include "../utils/fs_utils.h"
+#include "../utils/hash_utils.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <libxml/parser.h>
+#include <libxml/xmlwriter.h>
+
+#define AUTOSAR_NAMESPACE "http://autosar.org/schema/r4.0"
+#define AUTOSAR_SCHEMA_LOCATION "http://autosar.org/schema/r4.0 AUTOSAR_00046.xsd"
+#define XSI_NAMESPACE "http://www.w3.org/2001/XMLSchema-instance"
+#define MAX_SPEC_FIELDS 5
+
+/* One row of the spec | 描述文件中的一行 */
+typedef struct {
+    const char* kind;    /* package | element | ref | value */
+    const char* path;    /* Package / element path, or owner element for ref and value | 包/元素路径，ref和value为所属元素路径 */
+    const char* tag;     /* Element or child tag | 元素或子元素标签 */
+    const char* dest;    /* DEST attribute of references | 引用的DEST属性 */
+    const char* value;   /* Reference target or text value | 引用目标或文本值 */
+} SpecRow;
+
+/* Package currently open in the writer | 写入器中当前打开的包 */
+typedef struct {
+    char* name;
+    int elements_open;   /* <ELEMENTS> is open | <ELEMENTS>已打开 */
+    int packages_open;   /* <AR-PACKAGES> is open | <AR-PACKAGES>已打开 */
+} OpenPackage;
+
+/* Streaming writer state, only the open path and closed package paths are kept in memory | 流式写入状态，内存中只保存当前打开的路径和已关闭包的路径 */
+typedef struct {
+    xmlTextWriterPtr writer;
+    OpenPackage* packages;
+    int depth;
+    int capacity;
+    char** closed;       /* Hash set of closed package paths | 已关闭包路径的哈希集合 */
+    size_t closed_count;
+    size_t closed_capacity;
+    char* element_path;  /* Path of the open element | 当前打开元素的路径 */
+    long element_count;
+    long line_num;
+    int write_failed;    /* A writer call failed | 写入器调用失败 */
+} GenerateState;
+
+/* Record result of a writer call, returns 0 on failure | 记录写入器调用的结果，失败时返回0 */
+static int checked(GenerateState* state, int rc) {
+    if (rc < 0) {
+        state->write_failed = 1;
+        return 0;
+    }
+    return 1;
+}
+
+/* Split CSV line in place, supports "quoted" fields with "" escapes | 原地拆分CSV行，支持带""转义的引号字段 */
+static int split_csv_line(char* line, char** fields, int max_fields) {
+    int count = 0;
+    char* p = line;
+
+    while (count < max_fields) {
+        char* out = p;
+        fields[count++] = p;
+
+        if (*p == '"') {
+            /* Quoted field | 带引号的字段 */
+            char* in = p + 1;
+            while (*in) {
+                if (*in == '"' && in[1] == '"') {
+                    *out++ = '"';
+                    in += 2;
+                } else if (*in == '"') {
+                    in++;
+                    break;
+                } else {
+                    *out++ = *in++;
+                }
+            }
+            while (*in && *in != ',') in++;
+            p = in;
+        } else {
+            while (*p && *p != ',') p++;
+            out = p;
+        }
+
+        if (*p == ',') {
+            *out = '\0';
+            p++;
+        } else {
+            *out = '\0';
+            break;
+        }
+    }
+    return count;
+}
+
+/* Split copy of path into segments, returns count or -1 on error, caller frees buffer and segments | 将路径副本拆分为段，出错时返回-1，调用者释放buffer和segments */
+static int split_path(const char* path, char** buffer, char*** segments) {
+    int count = 0;
+
+    *buffer = NULL;
+    *segments = NULL;
+    if (path == NULL || path[0] != '/') {
+        return -1;
+    }
+    *buffer = strdup(path + 1);
+    *segments = (char**)malloc((strlen(path) / 2 + 1) * sizeof(char*));
+    if (!*buffer || !*segments) {
+        return -1;
+    }
+
+    char* seg = *buffer;
+    while (*seg) {
+        char* end = strchr(seg, '/');
+        if (end) *end = '\0';
+        if (*seg == '\0') {
+            return -1;
+        }
+        (*segments)[count++] = seg;
+        if (!end) break;
+        seg = end + 1;
+    }
+    return count;
+}
+
+/* Path of the open packages, first depth levels | 前depth层打开的包的路径 */
+static char* open_package_path_string(const GenerateState* state, int depth) {
+    size_t len = 1;
+    for (int i = 0; i < depth; i++) {
+        len += strlen(state->packages[i].name) + 1;
+    }
+    char* path = (char*)malloc(len);
+    if (!path) return NULL;
+    char* p = path;
+    for (int i = 0; i < depth; i++) {
+        size_t name_len = strlen(state->packages[i].name);
+        *p++ = '/';
+        memcpy(p, state->packages[i].name, name_len);
+        p += name_len;
+    }
+    *p = '\0';
+    return path;
+}
+
+/* Find slot of path in closed set | 在已关闭集合中查找路径的槽位 */
+static size_t closed_slot(const GenerateState* state, const char* path) {
+    size_t mask = state->closed_capacity - 1;
+    size_t slot = (size_t)hash64(path, strlen(path), 0) & mask;
+    while (state->closed[slot] && strcmp(state->closed[slot], path) != 0) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+/* Check whether package path was closed before | 检查包路径是否已经关闭过 */
+static int is_closed(const GenerateState* state, const char* path) {
+    return state->closed_capacity > 0 && state->closed[closed_slot(state, path)] != NULL;
+}
+
+/* Remember closed package path, path is taken over | 记录已关闭的包路径，接管path的所有权 */
+static int add_closed(GenerateState* state, char* path) {
+    if ((state->closed_count + 1) * 2 > state->closed_capacity) {
+        size_t capacity = state->closed_capacity ? state->closed_capacity * 2 : 64;
+        char** old = state->closed;
+        size_t old_capacity = state->closed_capacity;
+        state->closed = (char**)calloc(capacity, sizeof(char*));
+        if (!state->closed) {
+            state->closed = old;
+            free(path);
+            return 0;
+        }
+        state->closed_capacity = capacity;
+        for (size_t i = 0; i < old_capacity; i++) {
+            if (old[i]) state->closed[closed_slot(state, old[i])] = old[i];
+        }
+        free(old);
+    }
+    size_t slot = closed_slot(state, path);
+    if (state->closed[slot]) {
+        free(path);  /* Closed again after an error | 出错后再次关闭 */
+        return 1;
+    }
+    state->closed[slot] = path;
+    state->closed_count++;
+    return 1;
+}
+
+/* Close element if one is open | 如果有打开的元素则关闭 */
+static int close_element(GenerateState* state) {
+    if (state->element_path != NULL) {
+        free(state->element_path);
+        state->element_path = NULL;
+        return checked(state, xmlTextWriterEndElement(state->writer));
+    }
+    return 1;
+}
+
+/* Close innermost package | 关闭最内层的包 */
+static int close_package(GenerateState* state) {
+    char* path = open_package_path_string(state, state->depth);
+    OpenPackage* pkg = &state->packages[--state->depth];
+    int ok = 1;
+    if (pkg->elements_open || pkg->packages_open) {
+        ok = checked(state, xmlTextWriterEndElement(state->writer));  /* ELEMENTS or AR-PACKAGES | ELEMENTS或AR-PACKAGES */
+    }
+    ok = ok && checked(state, xmlTextWriterEndElement(state->writer));  /* AR-PACKAGE */
+    free(pkg->name);
+    if (!path || !add_closed(state, path)) {
+        printf("Error: Memory allocation failed\n");
+        return 0;
+    }
+    return ok;
+}
+
+/* Make the given package path the innermost open package | 使给定的包路径成为最内层打开的包 */
+static int open_package_path(GenerateState* state, char** segments, int count) {
+    int common = 0;
+
+    /* Keep the shared prefix open, close the rest | 保留共同前缀，关闭其余的包 */
+    while (common < state->depth && common < count && strcmp(state->packages[common].name, segments[common]) == 0) {
+        common++;
+    }
+    if (!close_element(state)) {
+        return 0;
+    }
+    while (state->depth > common) {
+        if (!close_package(state)) {
+            return 0;
+        }
+    }
+
+    /* Open missing packages | 打开缺少的包 */
+    while (state->depth < count) {
+        if (state->depth == state->capacity) {
+            int capacity = state->capacity ? state->capacity * 2 : 16;
+            OpenPackage* packages = (OpenPackage*)realloc(state->packages, (size_t)capacity * sizeof(OpenPackage));
+            if (!packages) {
+                printf("Error: Memory allocation failed\n");
+                return 0;
+            }
+            state->packages = packages;
+            state->capacity = capacity;
+        }
+        if (state->depth > 0) {
+            OpenPackage* parent = &state->packages[state->depth - 1];
+            if (parent->elements_open) {
+                /* Sub-packages follow ELEMENTS | 子包位于ELEMENTS之后 */
+                if (!checked(state, xmlTextWriterEndElement(state->writer))) return 0;
+                parent->elements_open = 0;
+            }
+            if (!parent->packages_open) {
+                if (!checked(state, xmlTextWriterStartElement(state->writer, BAD_CAST "AR-PACKAGES"))) return 0;
+                parent->packages_open = 1;
+            }
+        }
+
+        OpenPackage* pkg = &state->packages[state->depth];
+        pkg->name = strdup(segments[state->depth]);
+        pkg->elements_open = 0;
+        pkg->packages_open = 0;
+        if (!pkg->name) {
+            printf("Error: Memory allocation failed\n");
+            return 0;
+        }
+        state->depth++;
+
+        /* A package written and closed before cannot be opened again | 已写出并关闭的包不能再次打开 */
+        char* path = open_package_path_string(state, state->depth);
+        int reopened = path && is_closed(state, path);
+        free(path);
+        if (reopened) {
+            printf("Error: Spec line %ld: rows of package '%s' must be contiguous\n", state->line_num, pkg->name);
+            return 0;
+        }
+        if (!checked(state, xmlTextWriterStartElement(state->writer, BAD_CAST "AR-PACKAGE")) ||
+            !checked(state, xmlTextWriterWriteElement(state->writer, BAD_CAST "SHORT-NAME", BAD_CAST pkg->name))) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* Write element row, its package is opened first | 写出元素行，先打开其所在的包 */
+static int write_element(GenerateState* state, const SpecRow* row, char** segments, int count) {
+    if (count < 2 || row->tag == NULL || row->tag[0] == '\0') {
+        printf("Error: Spec line %ld: element needs a path inside a package and a tag\n", state->line_num);
+        return 0;
+    }
+    if (!open_package_path(state, segments, count - 1)) {
+        return 0;
+    }
+
+    OpenPackage* pkg = &state->packages[state->depth - 1];
+    if (pkg->packages_open) {
+        printf("Error: Spec line %ld: elements of package '%s' must come before its sub-packages\n",
+               state->line_num, pkg->name);
+        return 0;
+    }
+    if (!pkg->elements_open) {
+        if (!checked(state, xmlTextWriterStartElement(state->writer, BAD_CAST "ELEMENTS"))) return 0;
+        pkg->elements_open = 1;
+    }
+
+    if (!checked(state, xmlTextWriterStartElement(state->writer, BAD_CAST row->tag)) ||
+        !checked(state, xmlTextWriterWriteElement(state->writer, BAD_CAST "SHORT-NAME", BAD_CAST segments[count - 1]))) {
+        return 0;
+    }
+    state->element_path = strdup(row->path);
+    if (!state->element_path) {
+        printf("Error: Memory allocation failed\n");
+        return 0;
+    }
+    state->element_count++;
+    return 1;
+}
+
+/* Write one spec row | 写出描述文件中的一行 */
+static int write_row(GenerateState* state, const SpecRow* row) {
+    if (row->kind == NULL || row->path == NULL) {
+        printf("Error: Spec line %ld: 'kind' and 'path' are required\n", state->line_num);
+        return 0;
+    }
+
+    if (strcmp(row->kind, "package") == 0 || strcmp(row->kind, "element") == 0) {
+        char* buffer;
+        char** segments;
+        int ok;
+        int count = split_path(row->path, &buffer, &segments);
+        if (count <= 0) {
+            printf("Error: Spec line %ld: invalid path '%s'\n", state->line_num, row->path);
+            ok = 0;
+        } else if (row->kind[0] == 'p') {
+            ok = open_package_path(state, segments, count);
+        } else {
+            ok = write_element(state, row, segments, count);
+        }
+        free(segments);
+        free(buffer);
+        return ok;
+    }
+
+    if (strcmp(row->kind, "ref") == 0 || strcmp(row->kind, "value") == 0) {
+        /* Children are written into the element opened by the previous rows | 子元素写入前面打开的元素中 */
+        if (state->element_path == NULL || strcmp(state->element_path, row->path) != 0) {
+            printf("Error: Spec line %ld: %s must directly follow its element '%s'\n",
+                   state->line_num, row->kind, row->path);
+            return 0;
+        }
+        if (row->tag == NULL || row->tag[0] == '\0') {
+            printf("Error: Spec line %ld: %s needs a tag\n", state->line_num, row->kind);
+            return 0;
+        }
+        if (!checked(state, xmlTextWriterStartElement(state->writer, BAD_CAST row->tag))) return 0;
+        if (row->dest != NULL && row->dest[0] != '\0' &&
+            !checked(state, xmlTextWriterWriteAttribute(state->writer, BAD_CAST "DEST", BAD_CAST row->dest))) {
+            return 0;
+        }
+        return checked(state, xmlTextWriterWriteString(state->writer, BAD_CAST (row->value ? row->value : ""))) &&
+               checked(state, xmlTextWriterEndElement(state->writer));
+    }
+
+    printf("Error: Spec line %ld: unknown kind '%s'\n", state->line_num, row->kind);
+    return 0;
+}
+
+/* Parse one spec line (CSV or JSON object) and write it | 解析描述文件的一行（CSV或JSON对象）并写出 */
+static int process_line(GenerateState* state, char* line) {
+    SpecRow row = {NULL, NULL, NULL, NULL, NULL};
+    int ok;
+
+    if (line[0] == '{') {
+        JsonField fields[JSON_MAX_FIELDS];
+        int count = json_parse_flat_object(line, fields, JSON_MAX_FIELDS);
+        if (count < 0) {
+            printf("Error: Spec line %ld: invalid JSON\n", state->line_num);
+            return 0;
+        }
+        row.kind = json_get_field(fields, count, "kind");
+        row.path = json_get_field(fields, count, "path");
+        row.tag = json_get_field(fields, count, "tag");
+        row.dest = json_get_field(fields, count, "dest");
+        row.value = json_get_field(fields, count, "value");
+        ok = write_row(state, &row);
+        json_free_fields(fields, count);
+        return ok;
+    }
+
+    /* CSV columns: kind,path,tag,dest,value | CSV列：kind,path,tag,dest,value */
+    char* fields[MAX_SPEC_FIELDS] = {NULL, NULL, NULL, NULL, NULL};
+    split_csv_line(line, fields, MAX_SPEC_FIELDS);
+    if (state->line_num == 1 && strcmp(fields[0], "kind") == 0) {
+        return 1;  /* Header line | 表头行 */
+    }
+    row.kind = fields[0];
+    row.path = fields[1];
+    row.tag = fields[2];
+    row.dest = fields[3];
+    row.value = fields[4];
+    return write_row(state, &row);
+}
+
+/* Generate ARXML file from CSV / JSON lines spec | 根据CSV或JSON Lines描述文件生成ARXML文件 */
+int generate_arxml_file(const ProgramOptions *opts) {
+    GenerateState state;
+    memset(&state, 0, sizeof(state));
+
+    FILE* spec = fopen(opts->input_files.items[0], "rb");
+    if (!spec) {
+        printf("Error: Cannot open spec file '%s'\n", opts->input_files.items[0]);
+        return 0;
+    }
+
+    /* Get final output path | 获取最终输出路径 */
+    char* final_output_path = build_output_path(opts->output_file, opts->output_dir);
+    if (!final_output_path) {
+        printf("Error: Memory allocation failed\n");
+        fclose(spec);
+        return 0;
+    }
+
+    /* Create output directory if needed | 如果需要则创建输出目录 */
+    if (!create_parent_directories(final_output_path)) {
+        printf("Error: Cannot create output directory for file '%s'\n", final_output_path);
+        free(final_output_path);
+        fclose(spec);
+        return 0;
+    }
+
+    /* Writer goes through our FILE, so write errors show up when it is closed | 写入器通过自己打开的FILE写出，关闭时可发现写入错误 */
+    FILE* output = fopen(final_output_path, "wb");
+    xmlOutputBufferPtr buffer = output ? xmlOutputBufferCreateFile(output, NULL) : NULL;
+    state.writer = buffer ? xmlNewTextWriter(buffer) : NULL;
+    if (!state.writer) {
+        printf("Error: Cannot create file '%s'\n", final_output_path);
+        if (buffer) xmlOutputBufferClose(buffer);
+        if (output) fclose(output);
+        free(final_output_path);
+        fclose(spec);
+        return 0;
+    }
+
+    /* Indentation follows -i, default 4 spaces | 缩进遵循-i参数，默认4空格 */
+    DetectedIndentStyle detected = {.style = 's', .width = 4};
+    set_output_indent(opts, detected);
+    int ok = checked(&state, xmlTextWriterSetIndent(state.writer, 1)) &&
+             checked(&state, xmlTextWriterSetIndentString(state.writer, BAD_CAST xmlTreeIndentString)) &&
+             checked(&state, xmlTextWriterStartDocument(state.writer, "1.0", "UTF-8", NULL)) &&
+             checked(&state, xmlTextWriterStartElement(state.writer, BAD_CAST "AUTOSAR")) &&
+             checked(&state, xmlTextWriterWriteAttribute(state.writer, BAD_CAST "xmlns", BAD_CAST AUTOSAR_NAMESPACE)) &&
+             checked(&state, xmlTextWriterWriteAttribute(state.writer, BAD_CAST "xmlns:xsi", BAD_CAST XSI_NAMESPACE)) &&
+             checked(&state, xmlTextWriterWriteAttribute(state.writer, BAD_CAST "xsi:schemaLocation",
+                                                         BAD_CAST AUTOSAR_SCHEMA_LOCATION)) &&
+             checked(&state, xmlTextWriterStartElement(state.writer, BAD_CAST "AR-PACKAGES"));
+
+    /* Stream rows straight to the writer, lines of any length | 逐行直接写入，行长度不限 */
+    char* line = NULL;
+    size_t capacity = 0;
+    long len;
+    while (ok && (len = read_line(spec, &line, &capacity)) >= 0) {
+        state.line_num++;
+        if (len == 0 || line[0] == '#') {
+            continue;
+        }
+        ok = process_line(&state, line);
+    }
+    free(line);
+    fclose(spec);
+
+    /* Close everything still open | 关闭所有仍然打开的元素 */
+    ok = close_element(&state) && ok;
+    while (state.depth > 0) {
+        ok = close_package(&state) && ok;
+    }
+    ok = checked(&state, xmlTextWriterEndDocument(state.writer)) && ok;
+    ok = checked(&state, xmlTextWriterFlush(state.writer)) && ok;
+    xmlFreeTextWriter(state.writer);
+    int write_error = ferror(output);
+    if (fclose(output) != 0 || write_error) {
+        state.write_failed = 1;
+        ok = 0;
+    }
+    free(state.packages);
+    for (size_t i = 0; i < state.closed_capacity; i++) {
+        free(state.closed[i]);
+    }
+    free(state.closed);
+
+    if (state.write_failed) {
+        printf("Error: Cannot write file '%s'\n", final_output_path);
+    }
+    if (!ok) {
+        remove(final_output_path);
+        free(final_output_path);
+        return 0;
+    }
+
+    printf("Generate completed (%ld elements), output file: %s\n", state.element_count, final_output_path);
+    free(final_output_path);
+    return 1;
+}
@@ -0,0 +1,9 @@
+#ifndef GENERATE_H
+#define GENERATE_H
+
+#include "../main/common.h"
+
+/* Generate ARXML file from CSV / JSON lines spec | 根据CSV或JSON Lines描述文件生成ARXML文件 */
+int generate_arxml_file(const ProgramOptions *opts);
+
+#endif /* GENERATE_H */
@@ -0,0 +1,58 @@
+#include "index.h"
+#include "../utils/arxml_index.h"
+#include "../utils/thread_pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Index job of one file | 单个文件的索引任务 */
+typedef struct {
+    const char* source_path;
+    char* index_path;
+    uint64_t entry_count;
+    int ok;
+} IndexTask;
+
+/* Worker task: build index of one file | 工作线程任务：建立单个文件的索引 */
+static void index_file_task(void* arg) {
+    IndexTask* task = (IndexTask*)arg;
+    task->ok = arxml_index_build(task->source_path, task->index_path, &task->entry_count);
+}
+
+/* Write path index beside every input file | 为每个输入文件写出路径索引 */
+int index_arxml_files(const ProgramOptions *opts) {
+    IndexTask* tasks = (IndexTask*)calloc((size_t)opts->input_files.count, sizeof(IndexTask));
+    if (!tasks) {
+        printf("Error: Memory allocation failed\n");
+        return 0;
+    }
+
+    /* Files are independent, index them concurrently | 文件之间相互独立，并发建立索引 */
+    ThreadPool* pool = opts->input_files.count > 1 ? thread_pool_create(opts->jobs) : NULL;
+    for (int i = 0; i < opts->input_files.count; i++) {
+        tasks[i].source_path = opts->input_files.items[i];
+        tasks[i].index_path = arxml_index_sidecar_path(opts->input_files.items[i]);
+        if (!tasks[i].index_path) {
+            continue;  /* Reported as failed below | 在下面报告为失败 */
+        }
+        if (!pool || !thread_pool_submit(pool, index_file_task, &tasks[i])) {
+            index_file_task(&tasks[i]);
+        }
+    }
+    if (pool) {
+        thread_pool_destroy(pool);
+    }
+
+    int ok = 1;
+    for (int i = 0; i < opts->input_files.count; i++) {
+        if (tasks[i].ok) {
+            printf("Index written: %s (%llu paths)\n", tasks[i].index_path, (unsigned long long)tasks[i].entry_count);
+        } else {
+            printf("Error: Cannot index file '%s' (missing, unreadable or malformed XML)\n", tasks[i].source_path);
+            ok = 0;
+        }
+        free(tasks[i].index_path);
+    }
+    free(tasks);
+    return ok;
+}
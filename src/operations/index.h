@@ -0,0 +1,9 @@
+#ifndef INDEX_H
+#define INDEX_H
+
+#include "../main/common.h"
+
+/* Write "<file>.idx" path index beside every input file | 为每个输入文件在同目录写出"<file>.idx"路径索引 */
+int index_arxml_files(const ProgramOptions *opts);
+
+#endif /* INDEX_H */
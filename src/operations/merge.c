@@ -1,20 +1,40 @@
 #include "merge.h"
 #include "../utils/xml_utils.h"
 #include "../utils/fs_utils.h"  /* 添加头文件引用 */
+#include "../utils/perf_utils.h"
+#include "../utils/xml_arena.h"
+#include "../utils/doc_cache.h"
+#include "../utils/result_cache.h"
+#include "../utils/arxml_snapshot.h"
+#include "../utils/compressed_io.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 #include <libxml/parser.h>
 
-/* Create a string with n spaces for indentation | 创建包含n个空格的缩进字符串 */
-static const char* create_space_indent(int n) {
-    static char indent_buf[32] = {0};  /* 足够容纳大量空格 */
-    if (n <= 0) n = 4;  /* 如果指定无效数值，使用4空格 */
-    if (n > 31) n = 31; /* 限制最大空格数 */
-    
-    memset(indent_buf, ' ', n);
-    indent_buf[n] = '\0';
-    return indent_buf;
+/* Copy element with attributes, text and child elements | 复制元素及其属性、文本和子元素
+ * Siblings with the same tag are all kept, e.g. several *-REF of one element | 同名的兄弟元素全部保留，例如一个元素的多个*-REF */
+static xmlNodePtr copy_subtree(xmlNodePtr input_node) {
+    xmlNodePtr copy = xmlNewNode(NULL, input_node->name);
+    if (input_node->properties != NULL) {
+        copy->properties = xmlCopyPropList(copy, input_node->properties);
+    }
+
+    xmlNodePtr child = input_node->children;
+    while (child != NULL) {
+        if (child->type == XML_ELEMENT_NODE) {
+            /* Recursively copy element nodes | 递归复制元素节点 */
+            xmlAddChild(copy, copy_subtree(child));
+        } else if (child->type == XML_TEXT_NODE) {
+            /* Copy text content | 复制文本内容 */
+            xmlChar* content = xmlNodeGetContent(child);
+            xmlNodePtr text = xmlNewText(content);
+            xmlAddChild(copy, text);
+            xmlFree(content);
+        }
+        child = child->next;
+    }
+    return copy;
 }
 
 /* Recursively merge nodes | 递归合并节点 */
@@ -76,49 +96,7 @@ static void merge_node(xmlNodePtr base_parent, xmlNodePtr input_node, xmlDocPtr
     }
     
     /* No matching node found, copy entire subtree | 未找到匹配节点，复制整个子树 */
-    xmlNodePtr copy = xmlNewNode(NULL, input_node->name);
-    
-    xmlNodePtr child = input_node->children;
-    while (child != NULL) {
-        if (child->type == XML_ELEMENT_NODE) {
-            /* Recursively copy element nodes | 递归复制元素节点 */
-            merge_node(copy, child, doc);
-        } else if (child->type == XML_TEXT_NODE) {
-            /* Copy text content | 复制文本内容 */
-            xmlChar* content = xmlNodeGetContent(child);
-            xmlNodePtr text = xmlNewText(content);
-            xmlAddChild(copy, text);
-            xmlFree(content);
-        }
-        child = child->next;
-    }
-    xmlAddChild(base_parent, copy);
-}
-
-/* Get final output path based on options | 根据选项获取最终输出路径 */
-static void get_final_output_path(const ProgramOptions *opts, char *final_path, size_t size) {
-    if (strcmp(opts->output_dir, ".") == 0) {
-        /* No -o parameter, use path from -m directly | 没有-o参数，直接使用-m的路径 */
-        strncpy(final_path, opts->output_file, size);
-        final_path[size - 1] = '\0';
-    } else {
-        /* -o parameter exists, combine output_dir with filename from -m | 存在-o参数，将output_dir与-m的文件名组合 */
-        char filename[MAX_PATH];
-        const char *last_slash = strrchr(opts->output_file, '/');
-        const char *last_backslash = strrchr(opts->output_file, '\\');
-        const char *last_separator = last_slash > last_backslash ? last_slash : last_backslash;
-        
-        /* Get filename from output_file | 从output_file中获取文件名 */
-        if (last_separator) {
-            strncpy(filename, last_separator + 1, sizeof(filename));
-        } else {
-            strncpy(filename, opts->output_file, sizeof(filename));
-        }
-        filename[sizeof(filename) - 1] = '\0';
-        
-        /* Combine output_dir with filename | 组合output_dir和文件名 */
-        snprintf(final_path, size, "%s/%s", opts->output_dir, filename);
-    }
+    xmlAddChild(base_parent, copy_subtree(input_node));
 }
 
 /* Remove the first comment node of the document | 移除文档的第一个注释节点 */
@@ -140,22 +118,126 @@ static void remove_first_comment(xmlDocPtr doc) {
     }
 }
 
-/* Merge ARXML files implementation | ARXML文件合并实现 */
-int merge_arxml_files(const ProgramOptions *opts) {
+/* Merge elements of doc into base_doc | 将doc中的元素合并到base_doc */
+int merge_arxml_documents(xmlDocPtr base_doc, xmlDocPtr doc) {
+    xmlNodePtr root_node = xmlDocGetRootElement(base_doc);
+    xmlNodePtr cur_root = xmlDocGetRootElement(doc);
+    if (root_node == NULL || cur_root == NULL) {
+        return 0;
+    }
+
+    /* Recursively merge nodes | 递归合并节点 */
+    xmlNodePtr cur = cur_root->children;
+    while (cur != NULL) {
+        merge_node(root_node, cur, base_doc);
+        cur = cur->next;
+    }
+    return 1;
+}
+
+/* Inputs including the snapshot base | 包括快照基础文件在内的输入数量 */
+static int merge_input_count(const ProgramOptions *opts) {
+    return opts->input_files.count + (opts->snapshot_file[0] != '\0');
+}
+
+/* Build base document from snapshot, with the indentation detected in its source | 从快照构建基础文档，并取得在其源文件中检测到的缩进 */
+static xmlDocPtr load_snapshot_base(const char* path, DetectedIndentStyle* detected) {
+    ArxmlSnapshot snapshot;
+    if (!arxml_snapshot_open(path, &snapshot)) {
+        printf("Error: Cannot open snapshot '%s' (missing, corrupt or written by another version)\n", path);
+        return NULL;
+    }
+    detected->style = (char)snapshot.header->indent_style;
+    detected->width = (int)snapshot.header->indent_width;
+    xmlDocPtr doc = arxml_snapshot_load(&snapshot);
+    if (doc == NULL) {
+        printf("Error: Memory allocation failed\n");
+    }
+    arxml_snapshot_close(&snapshot);
+    return doc;
+}
+
+/* Copy output of an identical earlier merge from the result cache | 从结果缓存中复制之前相同merge的输出 */
+static int fetch_cached_result(const ProgramOptions *opts, const char* key, PerfProfile* profile) {
+    char* output_path = build_output_path(opts->output_file, opts->output_dir);
+    if (!output_path) {
+        return 0;
+    }
+    double phase_start = perf_phase_begin(profile);
+    int hit = create_parent_directories(output_path) && result_cache_fetch(opts->result_cache, key, output_path);
+    perf_phase_end(profile, "cache", output_path, phase_start, 0,
+                   hit ? perf_profile_file_size(profile, output_path) : 0);
+    if (hit && merge_input_count(opts) > 1) {
+        printf("Merge completed, output file: %s (from result cache)\n", output_path);
+    }
+    free(output_path);
+    return hit;
+}
+
+/* Merge inputs, parsed through filter if set | 合并输入，设置filter时解析经过过滤 */
+static int merge_filtered(const ProgramOptions *opts, const ArPathFilter* filter) {
     xmlDocPtr base_doc = NULL;
     xmlNodePtr root_node = NULL;
+    PerfProfile* profile = opts->profile ? perf_profile_create("merge") : NULL;
+    double phase_start;
     
+    /* Key of this merge, unreadable inputs are reported by the merge below | 本次merge的键，无法读取的输入由下面的merge报告 */
+    char result_key[RESULT_KEY_LENGTH + 1];
+    int use_result_cache = 0;
+    /* Standard input has no content to hash beforehand, standard output no file to copy | 标准输入无法预先计算哈希，标准输出没有可复制的文件 */
+    if (opts->result_cache[0] != '\0' && !has_stdio_path(&opts->input_files) && !is_stdio_path(opts->output_file)) {
+        phase_start = perf_phase_begin(profile);
+        use_result_cache = result_cache_key(opts, result_key);
+        perf_phase_end(profile, "hash", NULL, phase_start, 0, 0);
+        if (use_result_cache && fetch_cached_result(opts, result_key, profile)) {
+            int ok = perf_profile_report(profile, opts->profile_file);
+            perf_profile_free(profile);
+            return ok;
+        }
+    }
+
     /* Initialize detected indentation style | 初始化检测到的缩进风格 */
     DetectedIndentStyle detected = {.style = 's', .width = 4};  /* Default to 4 spaces | 默认4空格 */
-    if (opts->indent_style == INDENT_DEFAULT) {
-        detected = detect_indent_style(opts->input_files[0]);
-    }
 
-    /* Parse base file | 解析基础文件 */
-    base_doc = xmlReadFile(opts->input_files[0], NULL, XML_PARSE_NOBLANKS | XML_PARSE_NOBLANKS | XML_PARSE_COMPACT);
-    if (base_doc == NULL) {
-        printf("Error: Cannot parse base file '%s'\n", opts->input_files[0]);
-        return 0;
+    /* A snapshot base takes the place of the first file | 快照基础文件代替第一个文件 */
+    const char* base_name = opts->snapshot_file[0] != '\0' ? opts->snapshot_file : opts->input_files.items[0];
+    int first_input = opts->snapshot_file[0] != '\0' ? 0 : 1;
+    if (first_input == 0) {
+        phase_start = perf_phase_begin(profile);
+        base_doc = load_snapshot_base(base_name, &detected);
+        if (base_doc == NULL) {
+            perf_profile_free(profile);
+            return 0;
+        }
+        perf_phase_end(profile, "load", base_name, phase_start, perf_profile_file_size(profile, base_name), 0);
+    } else if (is_stdio_path(base_name) || filter) {
+        /* Standard input is read once, detecting the indentation while parsing; so is a filtered file, which the cache does not hold
+         * 标准输入只读取一次，在解析的同时检测缩进；经过过滤的文件同样如此，缓存中没有过滤后的文档树 */
+        phase_start = perf_phase_begin(profile);
+        base_doc = read_xml_file_filtered(base_name, XML_PARSE_NOBLANKS | XML_PARSE_COMPACT, filter,
+                                          opts->indent_style == INDENT_DEFAULT ? &detected : NULL);
+        if (base_doc == NULL) {
+            printf("Error: Cannot parse base file '%s'\n", base_name);
+            perf_profile_free(profile);
+            return 0;
+        }
+        perf_phase_end(profile, "parse", base_name, phase_start, perf_profile_file_size(profile, base_name), 0);
+    } else {
+        if (opts->indent_style == INDENT_DEFAULT) {
+            phase_start = perf_phase_begin(profile);
+            detected = detect_indent_style(base_name);
+            perf_phase_end(profile, "detect_indent", base_name, phase_start, 0, 0);
+        }
+
+        /* Parse base file, a private copy as it is modified | 解析基础文件，由于会被修改，使用私有副本 */
+        phase_start = perf_phase_begin(profile);
+        base_doc = doc_cache_read(base_name, XML_PARSE_NOBLANKS | XML_PARSE_COMPACT, 0);
+        if (base_doc == NULL) {
+            printf("Error: Cannot parse base file '%s'\n", base_name);
+            perf_profile_free(profile);
+            return 0;
+        }
+        perf_phase_end(profile, "parse", base_name, phase_start, perf_profile_file_size(profile, base_name), 0);
     }
 
     /* Remove the first comment node of the document | 移除文档的第一个注释节点 */
@@ -164,76 +246,77 @@ int merge_arxml_files(const ProgramOptions *opts) {
     /* Get root node | 获取根节点 */
     root_node = xmlDocGetRootElement(base_doc);
     if (root_node == NULL) {
-        printf("Error: File '%s' is empty\n", opts->input_files[0]);
+        printf("Error: File '%s' is empty\n", base_name);
         xmlFreeDoc(base_doc);
+        perf_profile_free(profile);
         return 0;
     }
     
     /* Process other files | 处理其他文件 */
-    for (int i = 1; i < opts->input_file_count; i++) {
-        xmlDocPtr doc = xmlReadFile(opts->input_files[i], NULL, XML_PARSE_NOBLANKS);
+    for (int i = first_input; i < opts->input_files.count; i++) {
+        uint64_t file_bytes = perf_profile_file_size(profile, opts->input_files.items[i]);
+        phase_start = perf_phase_begin(profile);
+        /* Other inputs are only read, a cached tree is used as is | 其他输入只被读取，直接使用缓存的文档树 */
+        xmlDocPtr doc = filter ? read_xml_file_filtered(opts->input_files.items[i], XML_PARSE_NOBLANKS, filter, NULL)
+                               : doc_cache_read(opts->input_files.items[i], XML_PARSE_NOBLANKS, 1);
         if (doc == NULL) {
-            printf("Error: Cannot parse file '%s'\n", opts->input_files[i]);
+            printf("Error: Cannot parse file '%s'\n", opts->input_files.items[i]);
             xmlFreeDoc(base_doc);
+            perf_profile_free(profile);
             return 0;
         }
+        perf_phase_end(profile, "parse", opts->input_files.items[i], phase_start, file_bytes, 0);
         
-        xmlNodePtr cur_root = xmlDocGetRootElement(doc);
-        if (cur_root == NULL) {
-            printf("Error: File '%s' is empty\n", opts->input_files[i]);
-            xmlFreeDoc(doc);
+        phase_start = perf_phase_begin(profile);
+        if (!merge_arxml_documents(base_doc, doc)) {
+            printf("Error: File '%s' is empty\n", opts->input_files.items[i]);
+            doc_cache_release(doc);
             xmlFreeDoc(base_doc);
+            perf_profile_free(profile);
             return 0;
         }
+        perf_phase_end(profile, "merge", opts->input_files.items[i], phase_start, file_bytes, 0);
         
-        /* Recursively merge nodes | 递归合并节点 */
-        xmlNodePtr cur = cur_root->children;
-        while (cur != NULL) {
-            merge_node(root_node, cur, base_doc);
-            cur = cur->next;
-        }
-        
-        xmlFreeDoc(doc);
+        phase_start = perf_phase_begin(profile);
+        doc_cache_release(doc);
+        perf_phase_end(profile, "free", opts->input_files.items[i], phase_start, 0, 0);
     }
     
     /* Set indentation for output | 设置输出的缩进 */
-    xmlKeepBlanksDefault(0);
-    xmlIndentTreeOutput = 1;
-
-    if (opts->indent_style == INDENT_DEFAULT) {
-        /* Use detected indentation | 使用检测到的缩进 */
-        xmlTreeIndentString = (detected.style == 't') ? "\t" : 
-                            create_space_indent(detected.width);
-    } else if (opts->indent_style == INDENT_TAB) {
-        /* Use tab indentation | 使用制表符缩进 */
-        xmlTreeIndentString = "\t";
-    } else if (opts->indent_style == INDENT_SPACE) {
-        /* Use specified number of spaces | 使用指定数量的空格 */
-        xmlTreeIndentString = create_space_indent(opts->indent_width);
-    }
+    set_output_indent(opts, detected);
 
     /* Get final output path | 获取最终输出路径 */
-    char final_output_path[MAX_PATH];
-    get_final_output_path(opts, final_output_path, sizeof(final_output_path));
+    char* final_output_path = build_output_path(opts->output_file, opts->output_dir);
+    if (!final_output_path) {
+        printf("Error: Memory allocation failed\n");
+        xmlFreeDoc(base_doc);
+        perf_profile_free(profile);
+        return 0;
+    }
 
     /* Create output directory if needed | 如果需要则创建输出目录 */
-    char output_dir[MAX_PATH];
-    get_directory_path(final_output_path, output_dir, sizeof(output_dir));
-    if (!create_directories(output_dir)) {
+    phase_start = perf_phase_begin(profile);
+    if (!create_parent_directories(final_output_path)) {
         printf("Error: Cannot create output directory for file '%s'\n", final_output_path);
+        free(final_output_path);
         xmlFreeDoc(base_doc);
+        perf_profile_free(profile);
         return 0;
     }
+    perf_phase_end(profile, "mkdir", final_output_path, phase_start, 0, 0);
 
     /* Sort nodes if requested | 如果需要则进行排序 */
     if (opts->sort_order != SORT_NONE) {
         xmlNodePtr root = xmlDocGetRootElement(base_doc);
         if (!root) {
             printf("Error: Empty document\n");
+            free(final_output_path);
             xmlFreeDoc(base_doc);
+            perf_profile_free(profile);
             return 0;
         }
 
+        phase_start = perf_phase_begin(profile);
         if (opts->sort_specific_tag) {
             /* Sort children of specific tag | 对特定标签的子节点进行排序 */
             int sorted_count = sort_specific_tag_children(root, opts->target_tag, opts->sort_order);
@@ -244,19 +327,58 @@ int merge_arxml_files(const ProgramOptions *opts) {
             /* Sort all nodes recursively | 递归排序所有节点 */
             sort_nodes_by_short_name(root, opts->sort_order);
         }
+        perf_phase_end(profile, "sort", NULL, phase_start, 0, 0);
     }
 
     /* Save the merged document | 保存合并后的文档 */
-    if (xmlSaveFormatFileEnc(final_output_path, base_doc, "UTF-8", 1) < 0) {
+    phase_start = perf_phase_begin(profile);
+    if (!save_xml_file(final_output_path, base_doc, opts->jobs)) {
         printf("Error: Cannot save file '%s'\n", final_output_path);
+        free(final_output_path);
         xmlFreeDoc(base_doc);
+        perf_profile_free(profile);
         return 0;
     }
+    perf_phase_end(profile, "save", final_output_path, phase_start, 0,
+                   perf_profile_file_size(profile, final_output_path));
+
+    if (use_result_cache) {
+        phase_start = perf_phase_begin(profile);
+        result_cache_store(opts->result_cache, result_key, final_output_path, opts->result_cache_size);
+        perf_phase_end(profile, "cache", final_output_path, phase_start, 0, 0);
+    }
     
-    xmlFreeDoc(base_doc);
+    /* Fast exit: the process ends right after, the arena keeps the tree reachable | 快速退出：进程随即结束，arena使文档树保持可达 */
+    if (!xml_arena_enabled()) {
+        phase_start = perf_phase_begin(profile);
+        /* In batch mode later jobs read the merged tree without parsing it | 批处理模式下后续任务直接读取合并后的文档树，无需解析 */
+        if (!doc_cache_store(final_output_path, base_doc)) {
+            xmlFreeDoc(base_doc);
+        }
+        perf_phase_end(profile, "free", final_output_path, phase_start, 0, 0);
+    }
     /* Print completion message | 打印完成消息 */
-    if (opts->input_file_count > 1) {
+    if (merge_input_count(opts) > 1) {
         printf("Merge completed, output file: %s\n", final_output_path);
     }
-    return 1;
-}
\ No newline at end of file
+    free(final_output_path);
+    int ok = perf_profile_report(profile, opts->profile_file);
+    perf_profile_free(profile);
+    return ok;
+}
+
+/* Merge ARXML files implementation | ARXML文件合并实现 */
+int merge_arxml_files(const ProgramOptions *opts) {
+    /* Path patterns are compiled once for all inputs | 路径模式对所有输入只编译一次 */
+    ArPathFilter* filter = NULL;
+    if (opts->only_paths.count + opts->skip_paths.count > 0) {
+        filter = ar_path_filter_new(&opts->only_paths, &opts->skip_paths);
+        if (!filter) {
+            printf("Error: Memory allocation failed\n");
+            return 0;
+        }
+    }
+    int ok = merge_filtered(opts, filter);
+    ar_path_filter_free(filter);
+    return ok;
+}
@@ -4,6 +4,10 @@
 #include <libxml/parser.h>
 #include "../main/common.h"
 
+/* Merge elements of doc into base_doc, doc is only read | 将doc中的元素合并到base_doc，doc只被读取
+ * Returns 0 if either document has no root element | 任一文档没有根元素时返回0 */
+int merge_arxml_documents(xmlDocPtr base_doc, xmlDocPtr doc);
+
 /* Merge ARXML files implementation | ARXML文件合并实现 */
 int merge_arxml_files(const ProgramOptions *opts);
 
@@ -0,0 +1,243 @@
+#include "patch.h"
+#include "../utils/xml_utils.h"
+#include "../utils/ar_path.h"
+#include "../utils/json_utils.h"
+#include "../utils/fs_utils.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <libxml/parser.h>
+
+/* Parse serialized subtree in the namespace context of a node | 在节点的命名空间上下文中解析序列化的子树 */
+static xmlNodePtr parse_subtree(xmlNodePtr context, const JsonField* fields, int count) {
+    const char* subtree = json_get_field(fields, count, "subtree");
+    xmlNodePtr list = NULL;
+    xmlNodePtr result = NULL;
+
+    if (subtree == NULL || context == NULL || context->type != XML_ELEMENT_NODE) {
+        return NULL;
+    }
+    if (xmlParseInNodeContext(context, subtree, (int)strlen(subtree), XML_PARSE_NOBLANKS, &list) != XML_ERR_OK) {
+        xmlFreeNodeList(list);
+        return NULL;
+    }
+
+    /* Keep the first element, drop anything else | 保留第一个元素，丢弃其他节点 */
+    for (xmlNodePtr cur = list; cur != NULL; cur = cur->next) {
+        if (cur->type == XML_ELEMENT_NODE) {
+            result = cur;
+            break;
+        }
+    }
+    if (result != NULL) {
+        if (result == list) list = result->next;
+        xmlUnlinkNode(result);
+    }
+    xmlFreeNodeList(list);
+    return result;
+}
+
+/* Find or create container element chain below parent | 在父节点下查找或创建容器元素链 */
+static xmlNodePtr ensure_container(xmlNodePtr parent, const char* container) {
+    xmlNodePtr cur = parent;
+    const char* seg = container;
+
+    while (cur != NULL && seg != NULL && *seg) {
+        const char* seg_end = strchr(seg, '/');
+        size_t seg_len = seg_end ? (size_t)(seg_end - seg) : strlen(seg);
+        xmlChar* name = xmlStrndup((const xmlChar*)seg, (int)seg_len);
+        xmlNodePtr child = cur->children;
+
+        while (child != NULL &&
+               !(child->type == XML_ELEMENT_NODE && compare_node_names(child->name, name) == 0)) {
+            child = child->next;
+        }
+        if (child == NULL) {
+            /* Create missing container in parent's namespace | 在父节点命名空间中创建缺失的容器 */
+            child = xmlNewChild(cur, cur->ns, name, NULL);
+        }
+        xmlFree(name);
+
+        cur = child;
+        seg = seg_end ? seg_end + 1 : NULL;
+    }
+    return cur;
+}
+
+/* Replace node (or the root element) by new node | 用新节点替换节点（或根元素） */
+static void replace_node(xmlDocPtr doc, xmlNodePtr old_node, xmlNodePtr new_node) {
+    if (old_node == xmlDocGetRootElement(doc)) {
+        xmlDocSetRootElement(doc, new_node);
+    } else {
+        xmlReplaceNode(old_node, new_node);
+    }
+    xmlFreeNode(old_node);
+}
+
+/* Apply one patch record | 应用一条补丁记录 */
+static int apply_record(xmlDocPtr doc, ArPathIndex* index, const JsonField* fields, int count, long line_num) {
+    const char* op = json_get_field(fields, count, "op");
+    const char* path = json_get_field(fields, count, "path");
+
+    if (op == NULL) {
+        printf("Error: Patch line %ld: missing 'op'\n", line_num);
+        return 0;
+    }
+    if (strcmp(op, "header") == 0) {
+        return 1;
+    }
+    if (path == NULL) {
+        printf("Error: Patch line %ld: missing 'path'\n", line_num);
+        return 0;
+    }
+
+    xmlNodePtr target = ar_path_index_lookup(index, path);
+
+    if (strcmp(op, "remove") == 0) {
+        if (target == NULL) {
+            printf("Error: Patch line %ld: path '%s' not found\n", line_num, path);
+            return 0;
+        }
+        ar_path_index_remove(index, path);
+        xmlUnlinkNode(target);
+        xmlFreeNode(target);
+        return 1;
+    }
+
+    if (strcmp(op, "replace") == 0 || (strcmp(op, "add") == 0 && target != NULL)) {
+        /* Adding an existing path replaces it | 新增已存在的路径时执行替换 */
+        if (target == NULL) {
+            printf("Error: Patch line %ld: path '%s' not found\n", line_num, path);
+            return 0;
+        }
+        xmlNodePtr context = target->parent->type == XML_ELEMENT_NODE ? target->parent : target;
+        xmlNodePtr node = parse_subtree(context, fields, count);
+        if (node == NULL) {
+            printf("Error: Patch line %ld: invalid subtree for '%s'\n", line_num, path);
+            return 0;
+        }
+        ar_path_index_remove(index, path);
+        replace_node(doc, target, node);
+        ar_path_index_add(index, path, node);
+        return 1;
+    }
+
+    if (strcmp(op, "add") == 0) {
+        const char* parent_path = json_get_field(fields, count, "parent");
+        const char* container = json_get_field(fields, count, "container");
+        xmlNodePtr parent = ar_path_index_lookup(index, parent_path ? parent_path : "");
+        if (parent == NULL) {
+            printf("Error: Patch line %ld: parent path '%s' not found\n", line_num, parent_path ? parent_path : "");
+            return 0;
+        }
+        xmlNodePtr container_node = ensure_container(parent, container ? container : "");
+        xmlNodePtr node = parse_subtree(container_node, fields, count);
+        if (node == NULL) {
+            printf("Error: Patch line %ld: invalid subtree for '%s'\n", line_num, path);
+            return 0;
+        }
+        xmlAddChild(container_node, node);
+        ar_path_index_add(index, path, node);
+        return 1;
+    }
+
+    printf("Error: Patch line %ld: unknown operation '%s'\n", line_num, op);
+    return 0;
+}
+
+/* Apply patch file to base ARXML file | 将补丁文件应用到基础ARXML文件 */
+int patch_arxml_file(const ProgramOptions *opts) {
+    /* Initialize detected indentation style | 初始化检测到的缩进风格 */
+    DetectedIndentStyle detected = {.style = 's', .width = 4};  /* Default to 4 spaces | 默认4空格 */
+    if (opts->indent_style == INDENT_DEFAULT) {
+        detected = detect_indent_style(opts->input_files.items[0]);
+    }
+
+    FILE* patch = fopen(opts->patch_file, "rb");
+    if (!patch) {
+        printf("Error: Cannot open patch file '%s'\n", opts->patch_file);
+        return 0;
+    }
+
+    xmlDocPtr doc = xmlReadFile(opts->input_files.items[0], NULL, XML_PARSE_NOBLANKS);
+    if (doc == NULL) {
+        printf("Error: Cannot parse base file '%s'\n", opts->input_files.items[0]);
+        fclose(patch);
+        return 0;
+    }
+
+    /* Paths are resolved lazily, only touched packages get indexed | 路径按需解析，只索引涉及到的包 */
+    ArPathIndex* index = ar_path_index_new(doc);
+    if (!index) {
+        printf("Error: Memory allocation failed\n");
+        xmlFreeDoc(doc);
+        fclose(patch);
+        return 0;
+    }
+
+    char* line = NULL;
+    size_t capacity = 0;
+    long line_num = 0;
+    long len;
+    int applied = 0;
+    int ok = 1;
+    while (ok && (len = read_line(patch, &line, &capacity)) >= 0) {
+        JsonField fields[JSON_MAX_FIELDS];
+        line_num++;
+        if (len == 0) {
+            continue;
+        }
+
+        int count = json_parse_flat_object(line, fields, JSON_MAX_FIELDS);
+        if (count < 0) {
+            printf("Error: Patch line %ld: invalid JSON\n", line_num);
+            ok = 0;
+            break;
+        }
+        ok = apply_record(doc, index, fields, count, line_num);
+        if (ok && strcmp(json_get_field(fields, count, "op"), "header") != 0) {
+            applied++;
+        }
+        json_free_fields(fields, count);
+    }
+    free(line);
+    fclose(patch);
+    ar_path_index_free(index);
+
+    if (!ok) {
+        xmlFreeDoc(doc);
+        return 0;
+    }
+
+    /* Set indentation for output | 设置输出的缩进 */
+    set_output_indent(opts, detected);
+
+    /* Get final output path | 获取最终输出路径 */
+    char* final_output_path = build_output_path(opts->output_file, opts->output_dir);
+    if (!final_output_path) {
+        printf("Error: Memory allocation failed\n");
+        xmlFreeDoc(doc);
+        return 0;
+    }
+
+    /* Create output directory if needed | 如果需要则创建输出目录 */
+    if (!create_parent_directories(final_output_path)) {
+        printf("Error: Cannot create output directory for file '%s'\n", final_output_path);
+        free(final_output_path);
+        xmlFreeDoc(doc);
+        return 0;
+    }
+
+    /* Save the patched document | 保存打补丁后的文档 */
+    if (xmlSaveFormatFileEnc(final_output_path, doc, "UTF-8", 1) < 0) {
+        printf("Error: Cannot save file '%s'\n", final_output_path);
+        free(final_output_path);
+        xmlFreeDoc(doc);
+        return 0;
+    }
+
+    xmlFreeDoc(doc);
+    printf("Patch applied (%d operations), output file: %s\n", applied, final_output_path);
+    free(final_output_path);
+    return 1;
+}
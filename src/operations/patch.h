@@ -0,0 +1,9 @@
+#ifndef PATCH_H
+#define PATCH_H
+
+#include "../main/common.h"
+
+/* Apply patch file to base ARXML file | 将补丁文件应用到基础ARXML文件 */
+int patch_arxml_file(const ProgramOptions *opts);
+
+#endif /* PATCH_H */
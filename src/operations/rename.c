@@ -0,0 +1,841 @@
+#include "rename.h"
+#include "../utils/arxml_scanner.h"
+#include "../utils/fs_utils.h"
+#include "../utils/hash_utils.h"
+#include "../utils/thread_pool.h"
+#include "../utils/xml_utils.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Role of a path the scan looks for | 扫描时关注的路径的作用 */
+typedef enum {
+    ROLE_OLD,       /* Element to rename | 要重命名的元素 */
+    ROLE_NEW,       /* Must not exist yet | 必须尚不存在 */
+    ROLE_PARENT     /* Receives moved element | 接收移动过来的元素 */
+} PathRole;
+
+typedef struct {
+    uint64_t hash;
+    const char* path;     /* NULL for empty slot | 空槽位为NULL */
+    size_t path_len;
+    PathRole role;
+    int rule;
+} WatchedPath;
+
+/* One old -> new pair | 一个旧路径 -> 新路径对 */
+typedef struct {
+    const char* old_path;
+    size_t old_len;
+    const char* new_path;
+    size_t new_len;
+    const char* new_name;   /* Last segment of new path | 新路径的最后一段 */
+    int moved;              /* Parent changes | 父元素改变 */
+    int name_changed;
+    long ref_count;
+} RenameRule;
+
+/* Identifiable matching a watched path | 与关注路径匹配的可标识元素 */
+typedef struct {
+    int watch;
+    uint64_t start;
+    uint64_t end;            /* 0 while open | 打开期间为0 */
+    uint64_t name_offset;    /* SHORT-NAME text | SHORT-NAME文本 */
+    size_t name_len;
+    char* container;
+    const char* created;     /* Container created in this parent for moved elements | 为移动的元素在此父元素中创建的容器 */
+} PathHit;
+
+/* Reference starting with an old path | 以旧路径开头的引用 */
+typedef struct {
+    uint64_t offset;
+    int rule;
+} RefHit;
+
+/* Replace len bytes at offset by text | 将offset处的len字节替换为text */
+typedef struct {
+    uint64_t offset;
+    uint64_t len;
+    char* text;
+    size_t text_len;
+    int order;              /* Keeps insertions at same offset in order | 保持同一偏移处插入的顺序 */
+    int dropped;            /* Applied to moved text instead | 已应用到移动的文本中 */
+} TextEdit;
+
+typedef struct RenameContext RenameContext;
+
+/* Scan results and edits of one input file | 单个输入文件的扫描结果和修改 */
+typedef struct {
+    const RenameContext* ctx;
+    const char* file_path;
+    MappedFile source;
+    int mapped;
+    PathHit* hits;
+    size_t hit_count;
+    size_t hit_capacity;
+    RefHit* refs;
+    size_t ref_count;
+    size_t ref_capacity;
+    TextEdit* edits;
+    size_t edit_count;
+    size_t edit_capacity;
+    char* output_path;
+    int ok;
+} RenameFile;
+
+struct RenameContext {
+    RenameRule* rules;
+    int rule_count;
+    WatchedPath* watched;
+    uint64_t watch_mask;
+    RenameFile* files;
+    int file_count;
+    int edit_order;
+};
+
+/* Run task on pool, inline if pool is missing or full | 在线程池上运行任务，线程池不可用时直接运行 */
+static void run_task(ThreadPool* pool, ThreadTask task, void* arg) {
+    if (!pool || !thread_pool_submit(pool, task, arg)) {
+        task(arg);
+    }
+}
+
+/* Grow array of records when full | 数组已满时扩容 */
+static int reserve(void** items, size_t count, size_t* capacity, size_t item_size) {
+    if (count < *capacity) return 1;
+    size_t new_capacity = *capacity ? *capacity * 2 : 64;
+    void* new_items = realloc(*items, new_capacity * item_size);
+    if (!new_items) return 0;
+    *items = new_items;
+    *capacity = new_capacity;
+    return 1;
+}
+
+static int ends_with(const char* str, size_t len, const char* suffix) {
+    size_t suffix_len = strlen(suffix);
+    return len >= suffix_len && memcmp(str + len - suffix_len, suffix, suffix_len) == 0;
+}
+
+static int is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static void add_watch(RenameContext* ctx, const char* path, size_t path_len, PathRole role, int rule) {
+    uint64_t hash = hash64(path, path_len, 0);
+    uint64_t slot = hash & ctx->watch_mask;
+    while (ctx->watched[slot].path) slot = (slot + 1) & ctx->watch_mask;
+    ctx->watched[slot].hash = hash;
+    ctx->watched[slot].path = path;
+    ctx->watched[slot].path_len = path_len;
+    ctx->watched[slot].role = role;
+    ctx->watched[slot].rule = rule;
+}
+
+/* Find next watched entry for path from slot on, returns slot or -1 | 从slot开始查找路径的下一个关注项，返回槽位或-1 */
+static long find_watch(const RenameContext* ctx, const char* path, size_t path_len, uint64_t hash, uint64_t slot) {
+    while (ctx->watched[slot].path) {
+        const WatchedPath* watch = &ctx->watched[slot];
+        if (watch->hash == hash && watch->path_len == path_len && memcmp(watch->path, path, path_len) == 0) {
+            return (long)slot;
+        }
+        slot = (slot + 1) & ctx->watch_mask;
+    }
+    return -1;
+}
+
+/* Scanner callback: record elements with watched paths | 扫描器回调：记录路径受关注的元素 */
+static ArxmlScanResult on_open(const ArxmlScanEntry* entry, void* data) {
+    RenameFile* file = (RenameFile*)data;
+    const RenameContext* ctx = file->ctx;
+    uint64_t hash = hash64(entry->path, entry->path_len, 0);
+    long slot = find_watch(ctx, entry->path, entry->path_len, hash, hash & ctx->watch_mask);
+    while (slot >= 0) {
+        if (!reserve((void**)&file->hits, file->hit_count, &file->hit_capacity, sizeof(PathHit))) {
+            return ARXML_SCAN_ERROR;
+        }
+        PathHit* hit = &file->hits[file->hit_count];
+        memset(hit, 0, sizeof(PathHit));
+        hit->watch = (int)slot;
+        hit->start = entry->start;
+        hit->container = strdup(entry->container);
+        if (!hit->container) return ARXML_SCAN_ERROR;
+        file->hit_count++;
+        slot = find_watch(ctx, entry->path, entry->path_len, hash, ((uint64_t)slot + 1) & ctx->watch_mask);
+    }
+    return ARXML_SCAN_CONTINUE;
+}
+
+/* Scanner callback: complete open hits of the element | 扫描器回调：补全该元素的已打开记录 */
+static ArxmlScanResult on_close(const ArxmlScanEntry* entry, void* data) {
+    RenameFile* file = (RenameFile*)data;
+    for (size_t i = file->hit_count; i > 0; i--) {
+        PathHit* hit = &file->hits[i - 1];
+        const WatchedPath* watch = &file->ctx->watched[hit->watch];
+        if (hit->end == 0 && watch->path_len == entry->path_len && memcmp(watch->path, entry->path, entry->path_len) == 0) {
+            hit->end = entry->end;
+        }
+    }
+    return ARXML_SCAN_CONTINUE;
+}
+
+/* Scanner callback: SHORT-NAMEs of hits and references into renamed elements | 扫描器回调：记录的SHORT-NAME以及指向被重命名元素的引用 */
+static ArxmlScanResult on_leaf(const ArxmlScanEntry* entry, void* data) {
+    RenameFile* file = (RenameFile*)data;
+    const RenameContext* ctx = file->ctx;
+    const char* text = entry->text;
+    size_t len = entry->text_len;
+    while (len > 0 && is_space(*text)) {
+        text++;
+        len--;
+    }
+    while (len > 0 && is_space(text[len - 1])) len--;
+
+    if (entry->tag_len == 10 && memcmp(entry->tag, "SHORT-NAME", 10) == 0) {
+        for (size_t i = 0; i < file->hit_count; i++) {
+            PathHit* hit = &file->hits[i];
+            const WatchedPath* watch = &ctx->watched[hit->watch];
+            if (hit->end == 0 && hit->name_offset == 0 && watch->path_len == entry->path_len &&
+                memcmp(watch->path, entry->path, entry->path_len) == 0) {
+                hit->name_offset = (uint64_t)(text - file->source.data);
+                hit->name_len = len;
+            }
+        }
+        return ARXML_SCAN_CONTINUE;
+    }
+    if (len == 0 || text[0] != '/' ||
+        (!ends_with(entry->tag, entry->tag_len, "-REF") && !ends_with(entry->tag, entry->tag_len, "-TREF"))) {
+        return ARXML_SCAN_CONTINUE;
+    }
+
+    /* Old paths never overlap, so at most one prefix matches | 旧路径互不重叠，最多只有一个前缀匹配 */
+    for (size_t prefix = 2; prefix <= len; prefix++) {
+        if (prefix < len && text[prefix] != '/') continue;
+        uint64_t hash = hash64(text, prefix, 0);
+        long slot = find_watch(ctx, text, prefix, hash, hash & ctx->watch_mask);
+        while (slot >= 0 && ctx->watched[slot].role != ROLE_OLD) {
+            slot = find_watch(ctx, text, prefix, hash, ((uint64_t)slot + 1) & ctx->watch_mask);
+        }
+        if (slot >= 0) {
+            if (!reserve((void**)&file->refs, file->ref_count, &file->ref_capacity, sizeof(RefHit))) {
+                return ARXML_SCAN_ERROR;
+            }
+            file->refs[file->ref_count].offset = (uint64_t)(text - file->source.data);
+            file->refs[file->ref_count].rule = ctx->watched[slot].rule;
+            file->ref_count++;
+            break;
+        }
+    }
+    return ARXML_SCAN_CONTINUE;
+}
+
+/* Worker task: scan one file | 工作线程任务：扫描单个文件 */
+static void scan_file_task(void* arg) {
+    RenameFile* file = (RenameFile*)arg;
+    ArxmlScanHandler handler = {on_open, on_close, on_leaf, NULL, 0};
+
+    if (!map_file(file->file_path, &file->source)) {
+        file->ok = 0;
+        return;
+    }
+    file->mapped = 1;
+    file->ok = file->source.size > 0 && arxml_scan(file->source.data, (size_t)file->source.size, &handler, file);
+
+    /* Files without matches are not needed any more | 没有匹配项的文件不再需要 */
+    if (file->ok && file->hit_count == 0 && file->ref_count == 0) {
+        unmap_file(&file->source);
+        file->mapped = 0;
+    }
+}
+
+static int add_edit(RenameFile* file, RenameContext* ctx, uint64_t offset, uint64_t len, const char* text, size_t text_len) {
+    if (!reserve((void**)&file->edits, file->edit_count, &file->edit_capacity, sizeof(TextEdit))) return 0;
+    TextEdit* edit = &file->edits[file->edit_count];
+    edit->offset = offset;
+    edit->len = len;
+    edit->text = (char*)malloc(text_len + 1);
+    edit->text_len = text_len;
+    edit->order = ctx->edit_order++;
+    edit->dropped = 0;
+    if (!edit->text) return 0;
+    memcpy(edit->text, text, text_len);
+    edit->text[text_len] = '\0';
+    file->edit_count++;
+    return 1;
+}
+
+static int compare_edits(const void* a, const void* b) {
+    const TextEdit* edit_a = (const TextEdit*)a;
+    const TextEdit* edit_b = (const TextEdit*)b;
+    if (edit_a->offset != edit_b->offset) return edit_a->offset < edit_b->offset ? -1 : 1;
+    return edit_a->order < edit_b->order ? -1 : edit_a->order > edit_b->order;
+}
+
+/* Apply sorted edits inside [start, end) to a copy of the bytes | 将[start, end)内已排序的修改应用到字节副本 */
+static char* apply_edits(const char* data, uint64_t start, uint64_t end, TextEdit* edits, size_t count, size_t* out_len) {
+    size_t len = (size_t)(end - start);
+    for (size_t i = 0; i < count; i++) {
+        if (edits[i].dropped || edits[i].offset < start || edits[i].offset >= end) continue;
+        len += edits[i].text_len;
+    }
+    char* text = (char*)malloc(len + 1);
+    if (!text) return NULL;
+
+    uint64_t pos = start;
+    size_t out = 0;
+    for (size_t i = 0; i < count; i++) {
+        TextEdit* edit = &edits[i];
+        if (edit->dropped || edit->offset < start || edit->offset >= end) continue;
+        memcpy(text + out, data + pos, (size_t)(edit->offset - pos));
+        out += (size_t)(edit->offset - pos);
+        memcpy(text + out, edit->text, edit->text_len);
+        out += edit->text_len;
+        pos = edit->offset + edit->len;
+        edit->dropped = 1;
+    }
+    memcpy(text + out, data + pos, (size_t)(end - pos));
+    out += (size_t)(end - pos);
+    text[out] = '\0';
+    *out_len = out;
+    return text;
+}
+
+/* Indentation of line holding pos, 0 if other content precedes it | pos所在行的缩进，前面有其他内容时为0 */
+static size_t line_indent(const char* data, uint64_t pos, uint64_t* line_start) {
+    uint64_t p = pos;
+    while (p > 0 && (data[p - 1] == ' ' || data[p - 1] == '\t')) p--;
+    if (p == 0 || data[p - 1] != '\n') return 0;
+    *line_start = p - 1;
+    return (size_t)(pos - p);
+}
+
+/* Re-indent lines after the first from old to new indentation | 将第一行之后各行的缩进从旧缩进改为新缩进 */
+static char* reindent(const char* text, size_t len, const char* old_indent, size_t old_len,
+                      const char* new_indent, size_t new_len, size_t* out_len) {
+    size_t lines = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (text[i] == '\n') lines++;
+    }
+    char* result = (char*)malloc(len + lines * new_len + 1);
+    if (!result) return NULL;
+    size_t out = 0;
+    for (size_t i = 0; i < len; i++) {
+        result[out++] = text[i];
+        if (text[i] == '\n') {
+            if (len - i - 1 >= old_len && memcmp(text + i + 1, old_indent, old_len) == 0) {
+                i += old_len;
+            }
+            memcpy(result + out, new_indent, new_len);
+            out += new_len;
+        }
+    }
+    result[out] = '\0';
+    *out_len = out;
+    return result;
+}
+
+/* Find start or end tag of direct child container of element | 查找元素的直接子容器的开始或结束标签
+ * Returns offset of '<' of "<container>" or "</container>", 0 if there is none | 返回"<container>"或"</container>"中'<'的偏移，不存在时返回0 */
+static uint64_t find_container(const char* data, uint64_t start, uint64_t end, const char* container, int end_tag) {
+    size_t container_len = strlen(container);
+    const char* p = (const char*)memchr(data + start, '>', (size_t)(end - start));
+    const char* limit = data + end;
+    int depth = 0;
+    int found = 0;
+
+    while (p && p < limit) {
+        const char* lt = (const char*)memchr(p, '<', (size_t)(limit - p));
+        if (!lt || lt + 1 >= limit) return 0;
+        if (lt[1] == '!' || lt[1] == '?') {
+            const char* terminator = lt[1] == '?' ? "?>" : (limit - lt >= 4 && memcmp(lt, "<!--", 4) == 0 ? "-->" : "]]>");
+            size_t term_len = strlen(terminator);
+            p = lt + 2;
+            while (p + term_len <= limit && memcmp(p, terminator, term_len) != 0) p++;
+            p += term_len;
+            continue;
+        }
+        const char* gt = (const char*)memchr(lt, '>', (size_t)(limit - lt));
+        if (!gt) return 0;
+        if (lt[1] == '/') {
+            depth--;
+            if (depth == 0 && found) return (uint64_t)(lt - data);
+            if (depth < 0) return 0;
+        } else if (gt[-1] != '/') {
+            const char* name_end = lt + 1;
+            while (name_end < gt && !is_space(*name_end) && *name_end != '>') name_end++;
+            if (depth == 0 && (size_t)(name_end - lt - 1) == container_len &&
+                memcmp(lt + 1, container, container_len) == 0) {
+                if (!end_tag) return (uint64_t)(lt - data);
+                found = 1;
+            }
+            depth++;
+        }
+        p = gt + 1;
+    }
+    return 0;
+}
+
+/* Moved bytes with their own renamed SHORT-NAME and references, removed from source | 带有自身已改名的SHORT-NAME和引用的移动内容，并从源文件中删除
+ * old_indent receives the indentation of the element's line | old_indent接收元素所在行的缩进 */
+static char* cut_moved(RenameContext* ctx, RenameFile* source, const PathHit* hit, size_t* moved_len,
+                       const char** old_indent, size_t* old_indent_len) {
+    const char* data = source->source.data;
+    if (source->edit_count > 0) qsort(source->edits, source->edit_count, sizeof(TextEdit), compare_edits);
+    char* moved = apply_edits(data, hit->start, hit->end, source->edits, source->edit_count, moved_len);
+    if (!moved) return NULL;
+
+    uint64_t remove_start = hit->start;
+    *old_indent_len = line_indent(data, hit->start, &remove_start);
+    *old_indent = data + hit->start - *old_indent_len;
+    if (!add_edit(source, ctx, remove_start, hit->end - remove_start, "", 0)) {
+        free(moved);
+        return NULL;
+    }
+    return moved;
+}
+
+/* Indentation of line holding pos plus levels steps of the target file's style | pos所在行的缩进加上目标文件风格的levels级缩进 */
+static size_t deeper_indent(const RenameFile* target, uint64_t pos, int levels, char* indent, size_t size) {
+    const char* data = target->source.data;
+    uint64_t line_start = 0;
+    size_t len = line_indent(data, pos, &line_start);
+    if (len > size - 1) len = size - 1;
+    memcpy(indent, data + pos - len, len);
+    DetectedIndentStyle detected = detect_indent_style(target->file_path);
+    int step = detected.style == 't' ? 1 : detected.width;
+    for (int i = 0; i < step * levels && len < size - 1; i++) {
+        indent[len++] = detected.style == 't' ? '\t' : ' ';
+    }
+    return len;
+}
+
+/* Plan removal and insertion of a moved element | 规划被移动元素的删除和插入 */
+static int plan_move(RenameContext* ctx, int rule_index, RenameFile* source, PathHit* hit,
+                     RenameFile* target, uint64_t insert_before) {
+    const RenameRule* rule = &ctx->rules[rule_index];
+    const char* old_indent;
+    size_t old_indent_len;
+    size_t moved_len;
+    char* moved = cut_moved(ctx, source, hit, &moved_len, &old_indent, &old_indent_len);
+    if (!moved) return 0;
+
+    /* New line below the last child of the target container | 在目标容器最后一个子元素之后另起一行 */
+    const char* target_data = target->source.data;
+    uint64_t insert_at = insert_before;
+    while (insert_at > 0 && is_space(target_data[insert_at - 1])) insert_at--;
+    uint64_t close_line = 0;
+    size_t close_indent_len = line_indent(target_data, insert_before, &close_line);
+    char* text = moved;
+    size_t text_len = moved_len;
+    int ok = 1;
+
+    if (close_indent_len > 0 || (insert_before > 0 && target_data[insert_before - 1] == '\n')) {
+        char indent[MAX_PATH];
+        size_t indent_len = deeper_indent(target, insert_before, 1, indent, sizeof(indent));
+        size_t reindented_len;
+        char* reindented = reindent(moved, moved_len, old_indent, old_indent_len, indent, indent_len, &reindented_len);
+        text = (char*)malloc(reindented_len + indent_len + 2);
+        if (reindented && text) {
+            text[0] = '\n';
+            memcpy(text + 1, indent, indent_len);
+            memcpy(text + 1 + indent_len, reindented, reindented_len);
+            text_len = reindented_len + indent_len + 1;
+        } else {
+            ok = 0;
+        }
+        free(reindented);
+        free(moved);
+    }
+
+    ok = ok && add_edit(target, ctx, insert_at, 0, text, text_len);
+    free(text);
+    if (ok) {
+        printf("Moved '%s' to '%s' in '%s'\n", rule->old_path, rule->new_path, target->file_path);
+    }
+    return ok;
+}
+
+/* Plan move into a parent lacking the container, which is created | 规划移动到缺少容器的父元素中，并创建该容器
+ * The container goes before AR-PACKAGES, as the schema orders it, or at the end of the parent.
+ * Elements moved into the same new container share its insertion point, its end tag is ordered last.
+ * 容器按模式规定的顺序放在AR-PACKAGES之前，否则放在父元素末尾；移动到同一新容器的元素共用其插入位置，其结束标签排在最后 */
+static int plan_move_new_container(RenameContext* ctx, int rule_index, RenameFile* source, PathHit* hit,
+                                   RenameFile* target, PathHit* parent) {
+    const RenameRule* rule = &ctx->rules[rule_index];
+    const char* data = target->source.data;
+    uint64_t anchor = 0;
+    if (strcmp(hit->container, "AR-PACKAGES") != 0) {
+        anchor = find_container(data, parent->start, parent->end, "AR-PACKAGES", 0);
+    }
+    if (anchor == 0) {
+        /* End tag of the parent | 父元素的结束标签 */
+        anchor = parent->end;
+        while (anchor > parent->start && data[anchor - 1] != '<') anchor--;
+        if (anchor == parent->start) return 0;
+        anchor--;
+    }
+
+    uint64_t line_start = 0;
+    size_t anchor_indent = line_indent(data, anchor, &line_start);
+    int own_line = anchor_indent > 0 || (anchor > 0 && data[anchor - 1] == '\n');
+    uint64_t insert_at = own_line ? anchor - anchor_indent : anchor;
+
+    const char* old_indent;
+    size_t old_indent_len;
+    size_t moved_len;
+    char* moved = cut_moved(ctx, source, hit, &moved_len, &old_indent, &old_indent_len);
+    if (!moved) return 0;
+
+    char container_indent[MAX_PATH];
+    char element_indent[MAX_PATH];
+    size_t container_indent_len = 0;
+    size_t element_indent_len = 0;
+    if (own_line) {
+        container_indent_len = deeper_indent(target, parent->start, 1, container_indent, sizeof(container_indent));
+        element_indent_len = deeper_indent(target, parent->start, 2, element_indent, sizeof(element_indent));
+    }
+    size_t container_len = strlen(hit->container);
+    size_t reindented_len = moved_len;
+    char* reindented = own_line ? reindent(moved, moved_len, old_indent, old_indent_len, element_indent,
+                                           element_indent_len, &reindented_len) : moved;
+    size_t tag_len = container_indent_len + container_len + 4;
+    char* text = (char*)malloc(element_indent_len + reindented_len + tag_len + 2);
+    int ok = reindented && text;
+    if (ok) {
+        size_t len = 0;
+        memcpy(text, element_indent, element_indent_len);
+        len += element_indent_len;
+        memcpy(text + len, reindented, reindented_len);
+        len += reindented_len;
+        if (own_line) text[len++] = '\n';
+        ok = add_edit(target, ctx, insert_at, 0, text, len);
+
+        /* Start and end tag of the container once | 容器的开始和结束标签只添加一次 */
+        if (ok && (!parent->created || strcmp(parent->created, hit->container) != 0)) {
+            len = (size_t)snprintf(text, tag_len + 1, "%.*s<%s>%s", (int)container_indent_len, container_indent,
+                                   hit->container, own_line ? "\n" : "");
+            ok = add_edit(target, ctx, insert_at, 0, text, len);
+            if (ok) target->edits[target->edit_count - 1].order = -1;
+            len = (size_t)snprintf(text, tag_len + 2, "%.*s</%s>%s", (int)container_indent_len, container_indent,
+                                   hit->container, own_line ? "\n" : "");
+            ok = ok && add_edit(target, ctx, insert_at, 0, text, len);
+            if (ok) target->edits[target->edit_count - 1].order = INT_MAX;
+
+            /* Every rule has its own hit of the parent | 每条规则都有各自的父元素记录 */
+            for (size_t h = 0; h < target->hit_count; h++) {
+                if (target->hits[h].start == parent->start) target->hits[h].created = hit->container;
+            }
+        }
+    }
+    if (reindented != moved) free(reindented);
+    free(moved);
+    free(text);
+    if (ok) {
+        printf("Moved '%s' to '%s' in '%s', created %s\n", rule->old_path, rule->new_path, target->file_path, hit->container);
+    }
+    return ok;
+}
+
+/* Check rules against each other | 检查各规则之间的关系 */
+static int validate_rules(const RenameContext* ctx) {
+    for (int i = 0; i < ctx->rule_count; i++) {
+        const RenameRule* rule = &ctx->rules[i];
+        for (int j = 0; j < ctx->rule_count; j++) {
+            const RenameRule* other = &ctx->rules[j];
+            if (i != j && strncmp(rule->old_path, other->old_path, rule->old_len) == 0 &&
+                (other->old_path[rule->old_len] == '/' || other->old_path[rule->old_len] == '\0')) {
+                printf("Error: Renames of '%s' and '%s' overlap\n", rule->old_path, other->old_path);
+                return 0;
+            }
+            if (i < j && strcmp(rule->new_path, other->new_path) == 0) {
+                printf("Error: Two paths are renamed to '%s'\n", rule->new_path);
+                return 0;
+            }
+            /* Target package must stay where it is | 目标包必须保持不动 */
+            size_t parent_len = (size_t)(rule->new_name - 1 - rule->new_path);
+            if (rule->moved && parent_len >= other->old_len &&
+                strncmp(rule->new_path, other->old_path, other->old_len) == 0 &&
+                (rule->new_path[other->old_len] == '/')) {
+                printf("Error: Target '%s' lies inside '%s', which is renamed as well\n", rule->new_path, other->old_path);
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+/* Turn scan results into per file edits | 将扫描结果转换为每个文件的修改 */
+static int plan_edits(RenameContext* ctx) {
+    int ok = 1;
+
+    /* Existence checks | 存在性检查 */
+    for (int r = 0; r < ctx->rule_count; r++) {
+        int old_count = 0;
+        int new_count = 0;
+        for (int f = 0; f < ctx->file_count; f++) {
+            for (size_t h = 0; h < ctx->files[f].hit_count; h++) {
+                const WatchedPath* watch = &ctx->watched[ctx->files[f].hits[h].watch];
+                if (watch->rule != r) continue;
+                if (watch->role == ROLE_OLD) old_count++;
+                if (watch->role == ROLE_NEW) new_count++;
+            }
+        }
+        if (old_count == 0) {
+            printf("Error: Path '%s' not found in input files\n", ctx->rules[r].old_path);
+            ok = 0;
+        } else if (new_count > 0) {
+            printf("Error: Path '%s' already exists\n", ctx->rules[r].new_path);
+            ok = 0;
+        } else if (ctx->rules[r].moved && old_count > 1) {
+            printf("Error: '%s' is defined in %d places, cannot move it\n", ctx->rules[r].old_path, old_count);
+            ok = 0;
+        }
+    }
+    if (!ok) return 0;
+
+    /* SHORT-NAMEs and references | SHORT-NAME和引用 */
+    for (int f = 0; ok && f < ctx->file_count; f++) {
+        RenameFile* file = &ctx->files[f];
+        for (size_t h = 0; ok && h < file->hit_count; h++) {
+            const WatchedPath* watch = &ctx->watched[file->hits[h].watch];
+            const RenameRule* rule = &ctx->rules[watch->rule];
+            if (watch->role != ROLE_OLD || !rule->name_changed) continue;
+            if (file->hits[h].name_offset == 0) {
+                printf("Error: Cannot locate SHORT-NAME of '%s' in '%s'\n", rule->old_path, file->file_path);
+                return 0;
+            }
+            ok = add_edit(file, ctx, file->hits[h].name_offset, file->hits[h].name_len, rule->new_name, strlen(rule->new_name));
+        }
+        for (size_t i = 0; ok && i < file->ref_count; i++) {
+            RenameRule* rule = &ctx->rules[file->refs[i].rule];
+            rule->ref_count++;
+            ok = add_edit(file, ctx, file->refs[i].offset, rule->old_len, rule->new_path, rule->new_len);
+        }
+    }
+
+    /* Moves: element leaves its file and enters the target package | 移动：元素离开原文件并进入目标包 */
+    for (int r = 0; ok && r < ctx->rule_count; r++) {
+        if (!ctx->rules[r].moved) continue;
+        RenameFile* source = NULL;
+        PathHit* hit = NULL;
+        RenameFile* target = NULL;
+        uint64_t insert_before = 0;
+        for (int f = 0; f < ctx->file_count; f++) {
+            for (size_t h = 0; h < ctx->files[f].hit_count; h++) {
+                const WatchedPath* watch = &ctx->watched[ctx->files[f].hits[h].watch];
+                if (watch->rule == r && watch->role == ROLE_OLD) {
+                    source = &ctx->files[f];
+                    hit = &ctx->files[f].hits[h];
+                }
+            }
+        }
+        if (strchr(hit->container, '/')) {
+            printf("Error: Cannot move '%s', only elements held directly in a container can be moved\n",
+                   ctx->rules[r].old_path);
+            return 0;
+        }
+        PathHit* target_parent = NULL;
+        for (int f = 0; !target && f < ctx->file_count; f++) {
+            for (size_t h = 0; !target && h < ctx->files[f].hit_count; h++) {
+                PathHit* parent = &ctx->files[f].hits[h];
+                const WatchedPath* watch = &ctx->watched[parent->watch];
+                if (watch->rule != r || watch->role != ROLE_PARENT) continue;
+                if (!target_parent) target_parent = parent;
+                insert_before = find_container(ctx->files[f].source.data, parent->start, parent->end, hit->container, 1);
+                if (insert_before) target = &ctx->files[f];
+            }
+        }
+        if (target) {
+            ok = plan_move(ctx, r, source, hit, target, insert_before);
+            continue;
+        }
+        if (!target_parent) {
+            printf("Error: No '%.*s' found to move '%s' into\n",
+                   (int)(ctx->rules[r].new_name - 1 - ctx->rules[r].new_path), ctx->rules[r].new_path,
+                   ctx->rules[r].old_path);
+            return 0;
+        }
+
+        /* Parent without the container, e.g. a package holding only sub-packages | 没有该容器的父元素，例如只包含子包的包 */
+        for (int f = 0; !target && f < ctx->file_count; f++) {
+            if (target_parent >= ctx->files[f].hits && target_parent < ctx->files[f].hits + ctx->files[f].hit_count) {
+                target = &ctx->files[f];
+            }
+        }
+        ok = plan_move_new_container(ctx, r, source, hit, target, target_parent);
+    }
+    if (!ok) {
+        printf("Error: Memory allocation failed\n");
+    }
+    return ok;
+}
+
+/* Worker task: write file with edits applied | 工作线程任务：写出应用修改后的文件 */
+static void write_file_task(void* arg) {
+    RenameFile* file = (RenameFile*)arg;
+    const char* data = file->source.data;
+    size_t tmp_size = strlen(file->output_path) + 5;
+    char* tmp_path = (char*)malloc(tmp_size);
+    int ok = 1;
+
+    qsort(file->edits, file->edit_count, sizeof(TextEdit), compare_edits);
+    if (!tmp_path) {
+        file->ok = 0;
+        return;
+    }
+    snprintf(tmp_path, tmp_size, "%s.tmp", file->output_path);
+    FILE* out = fopen(tmp_path, "wb");
+    if (!out) {
+        free(tmp_path);
+        file->ok = 0;
+        return;
+    }
+
+    uint64_t pos = 0;
+    for (size_t i = 0; ok && i < file->edit_count; i++) {
+        const TextEdit* edit = &file->edits[i];
+        if (edit->dropped) continue;
+        if (edit->offset < pos) {
+            ok = 0;  /* Overlapping edits | 修改重叠 */
+            break;
+        }
+        fwrite(data + pos, 1, (size_t)(edit->offset - pos), out);
+        fwrite(edit->text, 1, edit->text_len, out);
+        pos = edit->offset + edit->len;
+    }
+    fwrite(data + pos, 1, (size_t)(file->source.size - pos), out);
+    if (ferror(out)) ok = 0;
+    if (fclose(out) != 0) ok = 0;
+
+    /* Replace file only after new content is complete | 新内容完整写出后才替换文件 */
+#ifdef _WIN32
+    unmap_file(&file->source);
+    file->mapped = 0;
+    if (ok) remove(file->output_path);
+#endif
+    if (ok && rename(tmp_path, file->output_path) != 0) ok = 0;
+    if (!ok) remove(tmp_path);
+    free(tmp_path);
+    file->ok = ok;
+}
+
+/* Output path: in place, or same file name in output directory | 输出路径：原位置，或输出目录中的同名文件 */
+static int build_file_output_path(const ProgramOptions* opts, RenameFile* file) {
+    file->output_path = build_output_path(file->file_path, opts->output_dir);
+    return file->output_path != NULL;
+}
+
+/* Rename or move elements and rewrite every reference to them | 重命名或移动元素，并改写所有指向它们的引用 */
+int rename_arxml_elements(const ProgramOptions *opts) {
+    RenameContext ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.rule_count = opts->ar_paths.count;
+    ctx.file_count = opts->input_files.count;
+    ctx.rules = (RenameRule*)calloc((size_t)ctx.rule_count, sizeof(RenameRule));
+    ctx.files = (RenameFile*)calloc((size_t)ctx.file_count, sizeof(RenameFile));
+    uint64_t watch_capacity = 16;
+    while (watch_capacity < (uint64_t)ctx.rule_count * 6) watch_capacity *= 2;
+    ctx.watched = (WatchedPath*)calloc((size_t)watch_capacity, sizeof(WatchedPath));
+    ctx.watch_mask = watch_capacity - 1;
+    if (!ctx.rules || !ctx.files || !ctx.watched) {
+        printf("Error: Memory allocation failed\n");
+        free(ctx.rules);
+        free(ctx.files);
+        free(ctx.watched);
+        return 0;
+    }
+
+    for (int i = 0; i < ctx.rule_count; i++) {
+        RenameRule* rule = &ctx.rules[i];
+        rule->old_path = opts->ar_paths.items[i];
+        rule->old_len = strlen(rule->old_path);
+        rule->new_path = opts->new_paths.items[i];
+        rule->new_len = strlen(rule->new_path);
+        rule->new_name = strrchr(rule->new_path, '/') + 1;
+        const char* old_name = strrchr(rule->old_path, '/') + 1;
+        size_t old_parent_len = (size_t)(old_name - rule->old_path);
+        size_t new_parent_len = (size_t)(rule->new_name - rule->new_path);
+        rule->moved = old_parent_len != new_parent_len || memcmp(rule->old_path, rule->new_path, old_parent_len) != 0;
+        rule->name_changed = strcmp(old_name, rule->new_name) != 0;
+        add_watch(&ctx, rule->old_path, rule->old_len, ROLE_OLD, i);
+        add_watch(&ctx, rule->new_path, rule->new_len, ROLE_NEW, i);
+        if (rule->moved) {
+            add_watch(&ctx, rule->new_path, new_parent_len - 1, ROLE_PARENT, i);
+        }
+    }
+    int ok = validate_rules(&ctx);
+
+    /* Phase 1: scan all files concurrently | 阶段1：并发扫描所有文件 */
+    ThreadPool* pool = ok ? thread_pool_create(opts->jobs) : NULL;
+    for (int f = 0; ok && f < ctx.file_count; f++) {
+        ctx.files[f].ctx = &ctx;
+        ctx.files[f].file_path = opts->input_files.items[f];
+        run_task(pool, scan_file_task, &ctx.files[f]);
+    }
+    if (pool) {
+        thread_pool_wait(pool);
+    }
+    for (int f = 0; ok && f < ctx.file_count; f++) {
+        if (!ctx.files[f].ok) {
+            printf("Error: Cannot scan file '%s' (missing, unreadable or malformed XML)\n", ctx.files[f].file_path);
+            ok = 0;
+        }
+    }
+
+    /* Phase 2: plan edits, then write affected files concurrently | 阶段2：规划修改，再并发写出受影响的文件 */
+    ok = ok && plan_edits(&ctx);
+    if (ok && strcmp(opts->output_dir, ".") != 0 && !create_directories(opts->output_dir)) {
+        printf("Error: Cannot create output directory '%s'\n", opts->output_dir);
+        ok = 0;
+    }
+    int written = 0;
+    for (int f = 0; ok && f < ctx.file_count; f++) {
+        RenameFile* file = &ctx.files[f];
+        if (file->edit_count == 0) continue;
+        if (!build_file_output_path(opts, file)) {
+            printf("Error: Memory allocation failed\n");
+            ok = 0;
+            break;
+        }
+        run_task(pool, write_file_task, file);
+        written++;
+    }
+    if (pool) {
+        thread_pool_wait(pool);
+        thread_pool_destroy(pool);
+    }
+    for (int f = 0; ok && f < ctx.file_count; f++) {
+        if (ctx.files[f].edit_count > 0 && !ctx.files[f].ok) {
+            printf("Error: Cannot write file '%s'\n", ctx.files[f].output_path);
+            ok = 0;
+        }
+    }
+
+    if (ok) {
+        for (int f = 0; f < ctx.file_count; f++) {
+            if (ctx.files[f].edit_count > 0) {
+                printf("Updated file: %s\n", ctx.files[f].output_path);
+            }
+        }
+        for (int i = 0; i < ctx.rule_count; i++) {
+            printf("Renamed '%s' to '%s' (%ld references updated)\n",
+                   ctx.rules[i].old_path, ctx.rules[i].new_path, ctx.rules[i].ref_count);
+        }
+        printf("Rename completed: %d of %d files rewritten\n", written, ctx.file_count);
+    }
+
+    for (int f = 0; f < ctx.file_count; f++) {
+        RenameFile* file = &ctx.files[f];
+        if (file->mapped) unmap_file(&file->source);
+        for (size_t h = 0; h < file->hit_count; h++) free(file->hits[h].container);
+        for (size_t e = 0; e < file->edit_count; e++) free(file->edits[e].text);
+        free(file->hits);
+        free(file->refs);
+        free(file->edits);
+        free(file->output_path);
+    }
+    free(ctx.files);
+    free(ctx.rules);
+    free(ctx.watched);
+    return ok;
+}
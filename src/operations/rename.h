@@ -0,0 +1,12 @@
+#ifndef RENAME_H
+#define RENAME_H
+
+#include "../main/common.h"
+
+/* Rename or move elements and rewrite every reference to them | 重命名或移动元素，并改写所有指向它们的引用
+ * Pairs are opts->ar_paths.items[i] -> opts->new_paths.items[i]. All files are scanned in parallel, then only the
+ * affected SHORT-NAME and *-REF text is edited; files without changes are not rewritten.
+ * 路径对为opts->ar_paths.items[i] -> opts->new_paths.items[i]；并行扫描所有文件后只修改受影响的SHORT-NAME和*-REF文本，未改变的文件不会被重写 */
+int rename_arxml_elements(const ProgramOptions *opts);
+
+#endif /* RENAME_H */
@@ -0,0 +1,61 @@
+#include "snapshot.h"
+#include "../utils/arxml_snapshot.h"
+#include "../utils/thread_pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <libxml/parser.h>
+
+/* Snapshot job of one file | 单个文件的快照任务 */
+typedef struct {
+    const char* source_path;
+    char* snapshot_path;
+    uint64_t node_count;
+    int ok;
+} SnapshotTask;
+
+/* Worker task: parse one file and write its snapshot | 工作线程任务：解析单个文件并写出其快照 */
+static void snapshot_file_task(void* arg) {
+    SnapshotTask* task = (SnapshotTask*)arg;
+    task->ok = arxml_snapshot_build(task->source_path, task->snapshot_path, &task->node_count);
+}
+
+/* Write snapshot beside every input file | 为每个输入文件写出快照 */
+int snapshot_arxml_files(const ProgramOptions *opts) {
+    SnapshotTask* tasks = (SnapshotTask*)calloc((size_t)opts->input_files.count, sizeof(SnapshotTask));
+    if (!tasks) {
+        printf("Error: Memory allocation failed\n");
+        return 0;
+    }
+
+    /* Parser globals are set up before workers use them | 在工作线程使用之前初始化解析器全局状态 */
+    xmlInitParser();
+    ThreadPool* pool = opts->input_files.count > 1 ? thread_pool_create(opts->jobs) : NULL;
+    for (int i = 0; i < opts->input_files.count; i++) {
+        tasks[i].source_path = opts->input_files.items[i];
+        tasks[i].snapshot_path = arxml_snapshot_sidecar_path(opts->input_files.items[i]);
+        if (!tasks[i].snapshot_path) {
+            continue;  /* Reported as failed below | 在下面报告为失败 */
+        }
+        if (!pool || !thread_pool_submit(pool, snapshot_file_task, &tasks[i])) {
+            snapshot_file_task(&tasks[i]);
+        }
+    }
+    if (pool) {
+        thread_pool_destroy(pool);
+    }
+
+    int ok = 1;
+    for (int i = 0; i < opts->input_files.count; i++) {
+        if (tasks[i].ok) {
+            printf("Snapshot written: %s (%llu nodes)\n", tasks[i].snapshot_path, (unsigned long long)tasks[i].node_count);
+        } else {
+            printf("Error: Cannot snapshot file '%s' (missing, unreadable, malformed XML or DTD and entity references)\n",
+                   tasks[i].source_path);
+            ok = 0;
+        }
+        free(tasks[i].snapshot_path);
+    }
+    free(tasks);
+    return ok;
+}
@@ -0,0 +1,9 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "../main/common.h"
+
+/* Write "<file>.snap" binary snapshot beside every input file | 为每个输入文件在同目录写出"<file>.snap"二进制快照 */
+int snapshot_arxml_files(const ProgramOptions *opts);
+
+#endif /* SNAPSHOT_H */
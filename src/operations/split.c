@@ -0,0 +1,576 @@
+#include "split.h"
+#include "../utils/arxml_scanner.h"
+#include "../utils/fs_utils.h"
+#include "../utils/hash_utils.h"
+#include "../utils/thread_pool.h"
+#include "../utils/xml_utils.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SPLIT_MAX_DEPTH 256
+#define SPLIT_MAX_WRAPPERS 512
+#define SPLIT_PENDING_LIMIT 64
+#define SPLIT_WRITE_BUFFER (1024 * 1024)
+
+/* Consecutive units sharing parent and container | 父元素和容器都相同的连续单元 */
+typedef struct {
+    char* parent_path;     /* "" for top level | 顶层为"" */
+    int levels;            /* Number of ancestor identifiables | 祖先可标识元素的数量 */
+    uint64_t* starts;      /* Start tag offsets of ancestors | 祖先开始标签的偏移 */
+    char** containers;     /* levels + 1 container paths, the last one holds the units | levels+1个容器路径，最后一个包含这些单元 */
+    uint64_t start;
+    uint64_t end;
+} SplitRange;
+
+typedef struct SplitContext SplitContext;
+
+/* One output file | 一个输出文件 */
+typedef struct {
+    const SplitContext* ctx;
+    char* key;             /* Package path of content | 内容所属的包路径 */
+    char* file_path;
+    SplitRange* ranges;
+    int range_count;
+    int range_capacity;
+    uint64_t bytes;
+    int ok;
+} SplitChunk;
+
+/* Identifiable element open during scan | 扫描过程中已打开的可标识元素 */
+typedef struct {
+    uint64_t start;
+    char* container;
+    int is_package;
+    int in_packages;       /* All ancestors are AR-PACKAGEs | 所有祖先都是AR-PACKAGE */
+    int has_child;
+    int is_unit;           /* Copied whole into an output file | 整体复制到输出文件 */
+} SplitFrame;
+
+/* Wrapper element open in output file | 输出文件中已打开的外层元素 */
+typedef struct {
+    char* key;
+    const char* tag;
+    size_t tag_len;
+} SplitWrapper;
+
+struct SplitContext {
+    const char* data;
+    uint64_t size;
+    const char* root;           /* Root start tag in source | 源数据中的根元素开始标签 */
+    size_t root_len;
+    size_t root_tag_len;
+    int pretty;                 /* Source has one element per line | 源文件每行一个元素 */
+    char indent[16];
+    int unit_depth;
+    uint64_t chunk_size;
+    const char* output_dir;
+    char* prefix;               /* Output file name prefix, any length | 输出文件名前缀，长度不限 */
+
+    SplitFrame frames[SPLIT_MAX_DEPTH];
+    int frame_count;
+    SplitChunk* current;
+    SplitChunk* pending[SPLIT_PENDING_LIMIT];  /* Submitted, not yet collected | 已提交、尚未收集 */
+    int pending_count;
+    ThreadPool* pool;
+    uint64_t* names;            /* Hashes of used file names | 已使用文件名的哈希 */
+    size_t name_count;
+    size_t name_capacity;
+    int file_count;
+    long unit_count;
+    int ok;
+};
+
+/* Run task on pool, inline if pool is missing or full | 在线程池上运行任务，线程池不可用时直接运行 */
+static void run_task(ThreadPool* pool, ThreadTask task, void* arg) {
+    if (!pool || !thread_pool_submit(pool, task, arg)) {
+        task(arg);
+    }
+}
+
+static size_t tag_length(const char* tag) {
+    size_t len = 1;
+    while (tag[len] != '>' && tag[len] != '/' && tag[len] != ' ' && tag[len] != '\t' &&
+           tag[len] != '\r' && tag[len] != '\n') {
+        len++;
+    }
+    return len - 1;
+}
+
+static void write_indent(FILE* file, const SplitContext* ctx, int level) {
+    if (!ctx->pretty) return;
+    fputc('\n', file);
+    for (int i = 0; i < level; i++) {
+        fputs(ctx->indent, file);
+    }
+}
+
+/* Close wrappers deeper than level | 关闭深于level的外层元素 */
+static void close_wrappers(FILE* file, const SplitContext* ctx, SplitWrapper* stack, int* depth, int level) {
+    while (*depth > level) {
+        (*depth)--;
+        write_indent(file, ctx, *depth + 1);
+        fputs("</", file);
+        fwrite(stack[*depth].tag, 1, stack[*depth].tag_len, file);
+        fputc('>', file);
+        free(stack[*depth].key);
+    }
+}
+
+/* Open or reuse wrapper, key is taken over | 打开或复用外层元素，key的所有权被接管 */
+static int open_wrapper(FILE* file, const SplitContext* ctx, SplitWrapper* stack, int* depth, int level,
+                        char* key, const char* tag, size_t tag_len, const char* short_name, size_t name_len) {
+    if (!key || level >= SPLIT_MAX_WRAPPERS) {
+        free(key);
+        return 0;
+    }
+    if (level < *depth && strcmp(stack[level].key, key) == 0) {
+        free(key);
+        return 1;  /* Shared with previous range | 与上一个范围共用 */
+    }
+    close_wrappers(file, ctx, stack, depth, level);
+    stack[level].key = key;
+    stack[level].tag = tag;
+    stack[level].tag_len = tag_len;
+    (*depth)++;
+
+    /* Ancestors keep their original start tag and SHORT-NAME | 祖先保留原始开始标签和SHORT-NAME */
+    write_indent(file, ctx, level + 1);
+    if (short_name) {
+        const char* tag_end = (const char*)memchr(tag, '>', (size_t)(ctx->data + ctx->size - tag));
+        fwrite(tag - 1, 1, (size_t)(tag_end + 1 - (tag - 1)), file);
+        write_indent(file, ctx, level + 2);
+        fputs("<SHORT-NAME>", file);
+        fwrite(short_name, 1, name_len, file);
+        fputs("</SHORT-NAME>", file);
+    } else {
+        fputc('<', file);
+        fwrite(tag, 1, tag_len, file);
+        fputc('>', file);
+    }
+    return 1;
+}
+
+static char* make_key(const char* path, size_t path_len, const char* container, size_t container_len) {
+    char* key = (char*)malloc(path_len + container_len + 2);
+    if (key) {
+        memcpy(key, path, path_len);
+        key[path_len] = '#';
+        memcpy(key + path_len + 1, container, container_len);
+        key[path_len + container_len + 1] = '\0';
+    }
+    return key;
+}
+
+/* Open containers of one level | 打开一层中的容器 */
+static int open_containers(FILE* file, const SplitContext* ctx, SplitWrapper* stack, int* depth, int* level,
+                           const char* owner, size_t owner_len, const char* container) {
+    const char* seg = container;
+    while (*seg) {
+        const char* seg_end = strchr(seg, '/');
+        size_t seg_len = seg_end ? (size_t)(seg_end - seg) : strlen(seg);
+        char* key = make_key(owner, owner_len, container, (size_t)(seg + seg_len - container));
+        if (!open_wrapper(file, ctx, stack, depth, (*level)++, key, seg, seg_len, NULL, 0)) return 0;
+        seg = seg_end ? seg_end + 1 : seg + seg_len;
+    }
+    return 1;
+}
+
+/* Write wrappers of a range and its bytes | 写出一个范围的外层元素及其内容 */
+static int write_range(FILE* file, const SplitContext* ctx, SplitWrapper* stack, int* depth, const SplitRange* range) {
+    const char* path = range->parent_path;
+    size_t owner_len = 0;
+    int level = 0;
+
+    for (int i = 0; i <= range->levels; i++) {
+        if (!open_containers(file, ctx, stack, depth, &level, path, owner_len, range->containers[i])) return 0;
+        if (i == range->levels) break;
+
+        const char* name_end = strchr(path + owner_len + 1, '/');
+        size_t path_len = name_end ? (size_t)(name_end - path) : strlen(path);
+        const char* tag = ctx->data + range->starts[i] + 1;
+        char* key = (char*)malloc(path_len + 1);
+        if (key) {
+            memcpy(key, path, path_len);
+            key[path_len] = '\0';
+        }
+        if (!open_wrapper(file, ctx, stack, depth, level++, key, tag, tag_length(tag - 1),
+                          path + owner_len + 1, path_len - owner_len - 1)) {
+            return 0;
+        }
+        owner_len = path_len;
+    }
+
+    close_wrappers(file, ctx, stack, depth, level);
+    write_indent(file, ctx, level + 1);
+    fwrite(ctx->data + range->start, 1, (size_t)(range->end - range->start), file);
+    return 1;
+}
+
+/* Worker task: write one output file | 工作线程任务：写出一个输出文件 */
+static void write_chunk_task(void* arg) {
+    SplitChunk* chunk = (SplitChunk*)arg;
+    const SplitContext* ctx = chunk->ctx;
+    FILE* file = fopen(chunk->file_path, "wb");
+    if (!file) {
+        chunk->ok = 0;
+        return;
+    }
+    setvbuf(file, NULL, _IOFBF, SPLIT_WRITE_BUFFER);
+
+    SplitWrapper stack[SPLIT_MAX_WRAPPERS];
+    int depth = 0;
+    int ok = 1;
+    fputs("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n", file);
+    fwrite(ctx->root, 1, ctx->root_len, file);
+    for (int i = 0; ok && i < chunk->range_count; i++) {
+        ok = write_range(file, ctx, stack, &depth, &chunk->ranges[i]);
+    }
+    close_wrappers(file, ctx, stack, &depth, 0);
+    write_indent(file, ctx, 0);
+    fputs("</", file);
+    fwrite(ctx->root + 1, 1, ctx->root_tag_len, file);
+    fputs(">\n", file);
+
+    if (ferror(file)) ok = 0;
+    if (fclose(file) != 0) ok = 0;
+    chunk->ok = ok;
+}
+
+static void free_chunk(SplitChunk* chunk) {
+    for (int i = 0; i < chunk->range_count; i++) {
+        SplitRange* range = &chunk->ranges[i];
+        for (int j = 0; j <= range->levels; j++) {
+            free(range->containers[j]);
+        }
+        free(range->containers);
+        free(range->starts);
+        free(range->parent_path);
+    }
+    free(chunk->ranges);
+    free(chunk->file_path);
+    free(chunk->key);
+    free(chunk);
+}
+
+/* Wait for submitted files and check results | 等待已提交的文件并检查结果 */
+static void collect_pending(SplitContext* ctx) {
+    if (ctx->pool) {
+        thread_pool_wait(ctx->pool);
+    }
+    for (int i = 0; i < ctx->pending_count; i++) {
+        if (!ctx->pending[i]->ok) {
+            printf("Error: Cannot write file '%s'\n", ctx->pending[i]->file_path);
+            ctx->ok = 0;
+        }
+        free_chunk(ctx->pending[i]);
+    }
+    ctx->pending_count = 0;
+}
+
+/* Hand current file to a worker | 将当前文件交给工作线程 */
+static void finish_chunk(SplitContext* ctx) {
+    if (!ctx->current) return;
+    ctx->pending[ctx->pending_count++] = ctx->current;
+    run_task(ctx->pool, write_chunk_task, ctx->current);
+    ctx->current = NULL;
+
+    /* Bound the number of files in flight | 限制同时处理的文件数量 */
+    if (ctx->pending_count == SPLIT_PENDING_LIMIT) {
+        collect_pending(ctx);
+    }
+}
+
+/* Remember file name, returns 0 if it was used before | 记录文件名，已使用过时返回0 */
+static int claim_name(SplitContext* ctx, const char* name) {
+    if (ctx->name_count * 2 >= ctx->name_capacity) {
+        size_t capacity = ctx->name_capacity ? ctx->name_capacity * 2 : 1024;
+        uint64_t* names = (uint64_t*)calloc(capacity, sizeof(uint64_t));
+        if (!names) return 0;
+        for (size_t i = 0; i < ctx->name_capacity; i++) {
+            if (!ctx->names[i]) continue;
+            size_t slot = (size_t)(ctx->names[i] & (capacity - 1));
+            while (names[slot]) slot = (slot + 1) & (capacity - 1);
+            names[slot] = ctx->names[i];
+        }
+        free(ctx->names);
+        ctx->names = names;
+        ctx->name_capacity = capacity;
+    }
+    uint64_t hash = hash64(name, strlen(name), 0);
+    if (hash == 0) hash = 1;
+    size_t slot = (size_t)(hash & (ctx->name_capacity - 1));
+    while (ctx->names[slot]) {
+        if (ctx->names[slot] == hash) return 0;
+        slot = (slot + 1) & (ctx->name_capacity - 1);
+    }
+    ctx->names[slot] = hash;
+    ctx->name_count++;
+    return 1;
+}
+
+/* Build output file path of a new chunk | 构建新输出文件的路径 */
+static char* make_file_path(SplitContext* ctx, const char* key) {
+    size_t prefix_len = strlen(ctx->prefix);
+    size_t capacity = prefix_len + strlen(key) + 32;
+    char* name = (char*)malloc(capacity);
+    if (!name) return NULL;
+    size_t len;
+
+    if (ctx->chunk_size > 0) {
+        len = (size_t)snprintf(name, capacity, "%s_%04d", ctx->prefix, ctx->file_count);
+    } else {
+        /* Package path segments joined by '_' | 用'_'连接包路径的各段 */
+        len = (size_t)snprintf(name, capacity, "%s%s%s", ctx->prefix, prefix_len ? "_" : "", key + 1);
+        for (size_t i = prefix_len; i < len; i++) {
+            if (name[i] == '/') name[i] = '_';
+        }
+    }
+
+    /* Same package seen again or name clash: add counter | 再次遇到相同的包或文件名冲突时添加序号 */
+    if (!claim_name(ctx, name)) {
+        for (int n = 2; ; n++) {
+            snprintf(name + len, capacity - len, "_%d", n);
+            if (claim_name(ctx, name)) break;
+        }
+    }
+
+    size_t size = strlen(ctx->output_dir) + strlen(name) + 8;
+    char* path = (char*)malloc(size);
+    if (path) {
+        snprintf(path, size, "%s/%s.arxml", ctx->output_dir, name);
+    }
+    free(name);
+    return path;
+}
+
+/* Add unit to current output file, starting a new file when needed | 将单元加入当前输出文件，需要时开始新文件 */
+static int add_unit(SplitContext* ctx, const ArxmlScanEntry* entry, int frame_index, int is_package) {
+    uint64_t unit_size = entry->end - entry->start;
+    size_t parent_len = (size_t)(strrchr(entry->path, '/') - entry->path);
+    size_t key_len = is_package ? entry->path_len : parent_len;
+    SplitChunk* chunk = ctx->current;
+
+    if (chunk) {
+        if (ctx->chunk_size == 0) {
+            if (strlen(chunk->key) != key_len || memcmp(chunk->key, entry->path, key_len) != 0) {
+                finish_chunk(ctx);
+            }
+        } else if (chunk->bytes > 0 && chunk->bytes + unit_size > ctx->chunk_size) {
+            finish_chunk(ctx);
+        }
+    }
+    if (!ctx->current) {
+        chunk = (SplitChunk*)calloc(1, sizeof(SplitChunk));
+        if (!chunk) return 0;
+        chunk->ctx = ctx;
+        chunk->key = (char*)malloc(key_len + 1);
+        if (chunk->key) {
+            memcpy(chunk->key, entry->path, key_len);
+            chunk->key[key_len] = '\0';
+            chunk->file_path = make_file_path(ctx, chunk->key);
+        }
+        if (!chunk->file_path) {
+            free_chunk(chunk);
+            return 0;
+        }
+        ctx->current = chunk;
+        ctx->file_count++;
+    }
+    chunk = ctx->current;
+    chunk->bytes += unit_size;
+    ctx->unit_count++;
+
+    /* Sibling of previous unit: extend its range | 上一个单元的兄弟：扩展其范围 */
+    const char* container = ctx->frames[frame_index].container;
+    if (chunk->range_count > 0) {
+        SplitRange* last = &chunk->ranges[chunk->range_count - 1];
+        if (strlen(last->parent_path) == parent_len && memcmp(last->parent_path, entry->path, parent_len) == 0 &&
+            strcmp(last->containers[last->levels], container) == 0) {
+            last->end = entry->end;
+            return 1;
+        }
+    }
+
+    if (chunk->range_count == chunk->range_capacity) {
+        int capacity = chunk->range_capacity ? chunk->range_capacity * 2 : 16;
+        SplitRange* ranges = (SplitRange*)realloc(chunk->ranges, (size_t)capacity * sizeof(SplitRange));
+        if (!ranges) return 0;
+        chunk->ranges = ranges;
+        chunk->range_capacity = capacity;
+    }
+    SplitRange* range = &chunk->ranges[chunk->range_count];
+    memset(range, 0, sizeof(SplitRange));
+    range->levels = frame_index;
+    range->start = entry->start;
+    range->end = entry->end;
+    range->parent_path = (char*)malloc(parent_len + 1);
+    range->starts = (uint64_t*)malloc((size_t)(frame_index + 1) * sizeof(uint64_t));
+    range->containers = (char**)calloc((size_t)frame_index + 1, sizeof(char*));
+    chunk->range_count++;
+    if (!range->parent_path || !range->starts || !range->containers) {
+        range->levels = -1;  /* Nothing to free per level | 无需逐层释放 */
+        return 0;
+    }
+    memcpy(range->parent_path, entry->path, parent_len);
+    range->parent_path[parent_len] = '\0';
+    for (int i = 0; i <= frame_index; i++) {
+        range->starts[i] = ctx->frames[i].start;
+        range->containers[i] = strdup(ctx->frames[i].container);
+        if (!range->containers[i]) return 0;
+    }
+    return 1;
+}
+
+/* Scanner callback: decide whether element is copied whole | 扫描器回调：判断元素是否整体复制 */
+static ArxmlScanResult on_open(const ArxmlScanEntry* entry, void* data) {
+    SplitContext* ctx = (SplitContext*)data;
+    if (ctx->frame_count >= SPLIT_MAX_DEPTH) {
+        printf("Error: Elements nest deeper than %d levels, cannot split\n", SPLIT_MAX_DEPTH);
+        ctx->ok = 0;
+        return ARXML_SCAN_ERROR;
+    }
+    SplitFrame* parent = ctx->frame_count > 0 ? &ctx->frames[ctx->frame_count - 1] : NULL;
+    SplitFrame* frame = &ctx->frames[ctx->frame_count];
+    if (parent) {
+        parent->has_child = 1;
+    }
+    frame->start = entry->start;
+    frame->container = strdup(entry->container);
+    if (!frame->container) {
+        return ARXML_SCAN_ERROR;
+    }
+    ctx->frame_count++;
+    frame->is_package = entry->tag_len == 10 && memcmp(entry->tag, "AR-PACKAGE", 10) == 0;
+    frame->in_packages = parent ? parent->in_packages && parent->is_package : 1;
+    frame->has_child = 0;
+
+    /* Elements and packages at split depth are units | 元素以及拆分深度处的包是单元 */
+    frame->is_unit = frame->in_packages && (!frame->is_package || entry->depth >= ctx->unit_depth);
+    return frame->is_unit ? ARXML_SCAN_SKIP : ARXML_SCAN_CONTINUE;
+}
+
+static ArxmlScanResult on_close(const ArxmlScanEntry* entry, void* data) {
+    SplitContext* ctx = (SplitContext*)data;
+    SplitFrame* frame = &ctx->frames[ctx->frame_count - 1];
+
+    /* Packages without identifiable content are kept as a whole | 不含可标识内容的包整体保留 */
+    if (frame->is_unit || (frame->in_packages && frame->is_package && !frame->has_child)) {
+        if (!add_unit(ctx, entry, ctx->frame_count - 1, frame->is_package)) {
+            printf("Error: Memory allocation failed\n");
+            ctx->ok = 0;
+        }
+    }
+    free(frame->container);
+    ctx->frame_count--;
+    return ctx->ok ? ARXML_SCAN_CONTINUE : ARXML_SCAN_ERROR;
+}
+
+/* Split one ARXML file into several, inverse of merge | 将一个ARXML文件拆分为多个，merge的逆操作 */
+int split_arxml_file(const ProgramOptions *opts) {
+    const char* source_path = opts->input_files.items[0];
+    MappedFile source;
+    SplitContext* ctx = (SplitContext*)calloc(1, sizeof(SplitContext));
+    if (!ctx) {
+        printf("Error: Memory allocation failed\n");
+        return 0;
+    }
+    if (!map_file(source_path, &source)) {
+        printf("Error: Cannot open file '%s'\n", source_path);
+        free(ctx);
+        return 0;
+    }
+
+    const char* root_end = NULL;
+    ctx->data = source.data;
+    ctx->size = source.size;
+    ctx->root = source.data ? arxml_find_root_tag(source.data, (size_t)source.size, &root_end) : NULL;
+    if (!ctx->root) {
+        printf("Error: Cannot find root element in '%s'\n", source_path);
+        unmap_file(&source);
+        free(ctx);
+        return 0;
+    }
+    ctx->root_len = (size_t)(root_end - ctx->root);
+    ctx->root_tag_len = tag_length(ctx->root);
+    ctx->unit_depth = opts->split.depth > 0 ? opts->split.depth : INT_MAX;
+    ctx->chunk_size = opts->split.chunk_size;
+    ctx->output_dir = opts->output_dir;
+    ctx->ok = 1;
+
+    /* Wrappers follow source indentation, copied units keep theirs | 外层元素沿用源文件缩进，复制的单元保留原有缩进 */
+    const char* next = root_end;
+    while (next < source.data + source.size && (*next == ' ' || *next == '\t' || *next == '\r')) next++;
+    ctx->pretty = next < source.data + source.size && *next == '\n';
+    DetectedIndentStyle detected = detect_indent_style(source_path);
+    if (detected.style == 't') {
+        strcpy(ctx->indent, "\t");
+    } else {
+        int width = detected.width > 0 && detected.width < (int)sizeof(ctx->indent) ? detected.width : 4;
+        memset(ctx->indent, ' ', (size_t)width);
+        ctx->indent[width] = '\0';
+    }
+
+    /* Output name prefix, default is input file name without extension | 输出文件名前缀，默认为不含扩展名的输入文件名 */
+    if (opts->output_file[0]) {
+        ctx->prefix = strdup(opts->output_file);
+    } else if (ctx->chunk_size > 0) {
+        const char* name = strrchr(source_path, '/');
+        name = name ? name + 1 : source_path;
+        ctx->prefix = strdup(name);
+        char* dot = ctx->prefix ? strrchr(ctx->prefix, '.') : NULL;
+        if (dot && dot != ctx->prefix) *dot = '\0';
+    } else {
+        ctx->prefix = strdup("");
+    }
+    if (!ctx->prefix) {
+        printf("Error: Memory allocation failed\n");
+        unmap_file(&source);
+        free(ctx);
+        return 0;
+    }
+
+    if (!create_directories(opts->output_dir)) {
+        printf("Error: Cannot create output directory '%s'\n", opts->output_dir);
+        unmap_file(&source);
+        free(ctx->prefix);
+        free(ctx);
+        return 0;
+    }
+
+    /* Scan streams through the mapping, files are written by workers | 扫描顺序读取映射，文件由工作线程写出 */
+    ctx->pool = thread_pool_create(opts->jobs);
+    ArxmlScanHandler handler = {on_open, on_close, NULL, NULL, 0};
+    if (!arxml_scan(source.data, (size_t)source.size, &handler, ctx) && ctx->ok) {
+        printf("Error: Cannot scan file '%s' (malformed XML)\n", source_path);
+        ctx->ok = 0;
+    }
+    if (ctx->ok) {
+        finish_chunk(ctx);
+    } else if (ctx->current) {
+        free_chunk(ctx->current);
+    }
+    collect_pending(ctx);
+    if (ctx->pool) {
+        thread_pool_destroy(ctx->pool);
+    }
+    while (ctx->frame_count > 0) {
+        free(ctx->frames[--ctx->frame_count].container);
+    }
+    unmap_file(&source);
+
+    int ok = ctx->ok;
+    if (ok && ctx->file_count == 0) {
+        printf("Error: No AR-PACKAGE content found in '%s'\n", source_path);
+        ok = 0;
+    }
+    if (ok) {
+        printf("Split completed: %d files, %ld subtrees, output directory: %s\n",
+               ctx->file_count, ctx->unit_count, opts->output_dir);
+    }
+    free(ctx->names);
+    free(ctx->prefix);
+    free(ctx);
+    return ok;
+}
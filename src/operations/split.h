@@ -0,0 +1,12 @@
+#ifndef SPLIT_H
+#define SPLIT_H
+
+#include "../main/common.h"
+
+/* Split one ARXML file into several, inverse of merge | 将一个ARXML文件拆分为多个，merge的逆操作
+ * Streams the input and copies subtrees as bytes, so memory does not grow with file size.
+ * Every output file gets the AUTOSAR root and the AR-PACKAGE wrappers of its content.
+ * 流式读取输入并按字节复制子树，内存占用不随文件大小增长；每个输出文件都带有AUTOSAR根元素和内容的上级AR-PACKAGE */
+int split_arxml_file(const ProgramOptions *opts);
+
+#endif /* SPLIT_H */
@@ -0,0 +1,530 @@
+#include "stats.h"
+#include "../utils/arxml_scanner.h"
+#include "../utils/compressed_io.h"
+#include "../utils/fs_utils.h"
+#include "../utils/hash_utils.h"
+#include "../utils/json_utils.h"
+#include "../utils/thread_pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Count and bytes of one name | 单个名称的数量和字节数 */
+typedef struct {
+    uint64_t hash;
+    char* name;           /* NULL for empty slot | 空槽位为NULL */
+    size_t name_len;
+    uint64_t count;
+    uint64_t bytes;
+} CountEntry;
+
+/* Open addressing table, size is a power of two | 开放寻址哈希表，大小为2的幂 */
+typedef struct {
+    CountEntry* entries;
+    size_t capacity;
+    size_t count;
+} CountTable;
+
+/* Top-level AR-PACKAGE | 顶层AR-PACKAGE */
+typedef struct {
+    char* path;
+    uint64_t bytes;
+    uint64_t elements;
+    uint64_t identifiables;
+} PackageStats;
+
+/* Identifiable kept in the largest subtrees heap | 保存在最大子树堆中的可标识元素 */
+typedef struct {
+    uint64_t bytes;
+    char* path;
+    char* tag;
+} SubtreeItem;
+
+/* Statistics of one input file | 单个输入文件的统计信息 */
+typedef struct {
+    const char* file_path;
+    int top;
+    int ok;
+    uint64_t size;
+    uint64_t elements;
+    uint64_t identifiables;
+    uint64_t references;
+    uint64_t absolute_references;
+    CountTable tags;
+    CountTable dests;
+    PackageStats* packages;
+    size_t package_count;
+    size_t package_capacity;
+    long current_package;     /* -1 outside top-level packages | 在顶层包之外时为-1 */
+    uint64_t* levels;         /* Elements per nesting level, index 0 is the root | 各嵌套层级的元素数量，下标0为根元素 */
+    size_t level_count;
+    SubtreeItem* largest;     /* Min-heap by bytes | 按字节数排列的最小堆 */
+    size_t largest_count;
+} FileStats;
+
+/* Run task on pool, inline if pool is missing or full | 在线程池上运行任务，线程池不可用时直接运行 */
+static void run_task(ThreadPool* pool, ThreadTask task, void* arg) {
+    if (!pool || !thread_pool_submit(pool, task, arg)) {
+        task(arg);
+    }
+}
+
+static int ends_with(const char* str, size_t len, const char* suffix) {
+    size_t suffix_len = strlen(suffix);
+    return len >= suffix_len && memcmp(str + len - suffix_len, suffix, suffix_len) == 0;
+}
+
+static int is_package(const ArxmlScanEntry* entry) {
+    return entry->tag_len == 10 && memcmp(entry->tag, "AR-PACKAGE", 10) == 0;
+}
+
+static char* copy_text(const char* text, size_t len) {
+    char* copy = (char*)malloc(len + 1);
+    if (!copy) return NULL;
+    memcpy(copy, text, len);
+    copy[len] = '\0';
+    return copy;
+}
+
+/* Add count and bytes to name, table grows at half load | 为名称累加数量和字节数，负载达到一半时扩容 */
+static int count_add(CountTable* table, const char* name, size_t len, uint64_t bytes) {
+    if (table->count * 2 >= table->capacity) {
+        size_t capacity = table->capacity ? table->capacity * 2 : 256;
+        CountEntry* entries = (CountEntry*)calloc(capacity, sizeof(CountEntry));
+        if (!entries) return 0;
+        for (size_t i = 0; i < table->capacity; i++) {
+            if (!table->entries[i].name) continue;
+            size_t slot = table->entries[i].hash & (capacity - 1);
+            while (entries[slot].name) slot = (slot + 1) & (capacity - 1);
+            entries[slot] = table->entries[i];
+        }
+        free(table->entries);
+        table->entries = entries;
+        table->capacity = capacity;
+    }
+
+    uint64_t hash = hash64(name, len, 0);
+    size_t slot = hash & (table->capacity - 1);
+    while (table->entries[slot].name) {
+        CountEntry* entry = &table->entries[slot];
+        if (entry->hash == hash && entry->name_len == len && memcmp(entry->name, name, len) == 0) {
+            entry->count++;
+            entry->bytes += bytes;
+            return 1;
+        }
+        slot = (slot + 1) & (table->capacity - 1);
+    }
+    CountEntry* entry = &table->entries[slot];
+    entry->name = copy_text(name, len);
+    if (!entry->name) return 0;
+    entry->hash = hash;
+    entry->name_len = len;
+    entry->count = 1;
+    entry->bytes = bytes;
+    table->count++;
+    return 1;
+}
+
+static void count_free(CountTable* table) {
+    for (size_t i = 0; i < table->capacity; i++) {
+        free(table->entries[i].name);
+    }
+    free(table->entries);
+}
+
+static int compare_count_entries(const void* a, const void* b) {
+    const CountEntry* x = *(const CountEntry* const*)a;
+    const CountEntry* y = *(const CountEntry* const*)b;
+    if (x->count != y->count) return x->count < y->count ? 1 : -1;
+    return strcmp(x->name, y->name);
+}
+
+/* Used entries sorted by count, descending | 按数量降序排列的已用条目 */
+static const CountEntry** count_sorted(const CountTable* table) {
+    const CountEntry** sorted = (const CountEntry**)malloc((table->count ? table->count : 1) * sizeof(CountEntry*));
+    if (!sorted) return NULL;
+    size_t n = 0;
+    for (size_t i = 0; i < table->capacity; i++) {
+        if (table->entries[i].name) sorted[n++] = &table->entries[i];
+    }
+    qsort(sorted, n, sizeof(CountEntry*), compare_count_entries);
+    return sorted;
+}
+
+static void heap_sift_down(SubtreeItem* heap, size_t count, size_t i) {
+    for (;;) {
+        size_t smallest = i;
+        size_t left = 2 * i + 1;
+        size_t right = left + 1;
+        if (left < count && heap[left].bytes < heap[smallest].bytes) smallest = left;
+        if (right < count && heap[right].bytes < heap[smallest].bytes) smallest = right;
+        if (smallest == i) return;
+        SubtreeItem tmp = heap[i];
+        heap[i] = heap[smallest];
+        heap[smallest] = tmp;
+        i = smallest;
+    }
+}
+
+/* Keep element if it is among the top largest seen | 如果元素属于目前最大的top个则保留 */
+static int offer_subtree(FileStats* file, const ArxmlScanEntry* entry, uint64_t bytes) {
+    size_t top = (size_t)file->top;
+    if (file->largest_count == top && bytes <= file->largest[0].bytes) return 1;
+
+    char* path = copy_text(entry->path, entry->path_len);
+    char* tag = copy_text(entry->tag, entry->tag_len);
+    if (!path || !tag) {
+        free(path);
+        free(tag);
+        return 0;
+    }
+    if (file->largest_count < top) {
+        /* Sift up new item | 新元素上浮 */
+        size_t i = file->largest_count++;
+        while (i > 0 && file->largest[(i - 1) / 2].bytes > bytes) {
+            file->largest[i] = file->largest[(i - 1) / 2];
+            i = (i - 1) / 2;
+        }
+        file->largest[i].bytes = bytes;
+        file->largest[i].path = path;
+        file->largest[i].tag = tag;
+    } else {
+        free(file->largest[0].path);
+        free(file->largest[0].tag);
+        file->largest[0].bytes = bytes;
+        file->largest[0].path = path;
+        file->largest[0].tag = tag;
+        heap_sift_down(file->largest, file->largest_count, 0);
+    }
+    return 1;
+}
+
+/* Scanner callback: SHORT-NAMEs and top-level packages | 扫描器回调：SHORT-NAME和顶层包 */
+static ArxmlScanResult on_open(const ArxmlScanEntry* entry, void* data) {
+    FileStats* file = (FileStats*)data;
+    file->identifiables++;
+    if (entry->depth == 1 && is_package(entry)) {
+        if (file->package_count == file->package_capacity) {
+            size_t capacity = file->package_capacity ? file->package_capacity * 2 : 16;
+            PackageStats* packages = (PackageStats*)realloc(file->packages, capacity * sizeof(PackageStats));
+            if (!packages) return ARXML_SCAN_ERROR;
+            file->packages = packages;
+            file->package_capacity = capacity;
+        }
+        PackageStats* package = &file->packages[file->package_count];
+        memset(package, 0, sizeof(PackageStats));
+        package->path = copy_text(entry->path, entry->path_len);
+        if (!package->path) return ARXML_SCAN_ERROR;
+        file->current_package = (long)file->package_count++;
+    }
+    if (file->current_package >= 0) {
+        file->packages[file->current_package].identifiables++;
+    }
+    return ARXML_SCAN_CONTINUE;
+}
+
+/* Scanner callback: sizes of packages and largest elements | 扫描器回调：包的大小和最大的元素 */
+static ArxmlScanResult on_close(const ArxmlScanEntry* entry, void* data) {
+    FileStats* file = (FileStats*)data;
+    uint64_t bytes = entry->end - entry->start;
+    if (is_package(entry)) {
+        if (entry->depth == 1 && file->current_package >= 0) {
+            file->packages[file->current_package].bytes = bytes;
+            file->packages[file->current_package].elements++;  /* Package itself ends after this | 包元素本身在此之后结束 */
+            file->current_package = -1;
+        }
+        return ARXML_SCAN_CONTINUE;
+    }
+    if (file->top > 0 && !offer_subtree(file, entry, bytes)) return ARXML_SCAN_ERROR;
+    return ARXML_SCAN_CONTINUE;
+}
+
+/* Scanner callback: count references by DEST | 扫描器回调：按DEST统计引用 */
+static ArxmlScanResult on_leaf(const ArxmlScanEntry* entry, void* data) {
+    FileStats* file = (FileStats*)data;
+    if (!ends_with(entry->tag, entry->tag_len, "-REF") && !ends_with(entry->tag, entry->tag_len, "-TREF")) {
+        return ARXML_SCAN_CONTINUE;
+    }
+    const char* text = entry->text;
+    size_t len = entry->text_len;
+    while (len > 0 && (*text == ' ' || *text == '\t' || *text == '\r' || *text == '\n')) {
+        text++;
+        len--;
+    }
+    file->references++;
+    if (len > 0 && text[0] == '/') file->absolute_references++;
+
+    const char* dest;
+    size_t dest_len;
+    if (!arxml_scan_attribute(entry->attributes, entry->attributes_len, "DEST", &dest, &dest_len)) {
+        dest = "";
+        dest_len = 0;
+    }
+    return count_add(&file->dests, dest, dest_len, 0) ? ARXML_SCAN_CONTINUE : ARXML_SCAN_ERROR;
+}
+
+/* Scanner callback: every element | 扫描器回调：每个元素 */
+static ArxmlScanResult on_element(const ArxmlScanEntry* entry, void* data) {
+    FileStats* file = (FileStats*)data;
+    size_t level = (size_t)entry->level;
+    file->elements++;
+    if (level > file->level_count) {
+        uint64_t* levels = (uint64_t*)realloc(file->levels, level * sizeof(uint64_t));
+        if (!levels) return ARXML_SCAN_ERROR;
+        memset(levels + file->level_count, 0, (level - file->level_count) * sizeof(uint64_t));
+        file->levels = levels;
+        file->level_count = level;
+    }
+    file->levels[level - 1]++;
+    if (file->current_package >= 0) {
+        file->packages[file->current_package].elements++;
+    }
+    return count_add(&file->tags, entry->tag, entry->tag_len, entry->end - entry->start) ? ARXML_SCAN_CONTINUE
+                                                                                        : ARXML_SCAN_ERROR;
+}
+
+/* Worker task: scan one file | 工作线程任务：扫描单个文件 */
+static void stats_file_task(void* arg) {
+    FileStats* file = (FileStats*)arg;
+    MappedFile source;
+    ArxmlScanHandler handler = {on_open, on_close, on_leaf, on_element, 0};
+
+    file->current_package = -1;
+    file->largest = (SubtreeItem*)calloc((size_t)file->top + 1, sizeof(SubtreeItem));
+    if (!file->largest || !map_file(file->file_path, &source)) {
+        file->ok = 0;
+        return;
+    }
+    file->size = (uint64_t)source.size;
+    file->ok = source.size > 0 && arxml_scan(source.data, (size_t)source.size, &handler, file);
+    unmap_file(&source);
+}
+
+static void free_file_stats(FileStats* file) {
+    count_free(&file->tags);
+    count_free(&file->dests);
+    for (size_t i = 0; i < file->package_count; i++) {
+        free(file->packages[i].path);
+    }
+    free(file->packages);
+    free(file->levels);
+    for (size_t i = 0; i < file->largest_count; i++) {
+        free(file->largest[i].path);
+        free(file->largest[i].tag);
+    }
+    free(file->largest);
+}
+
+static int compare_subtrees(const void* a, const void* b) {
+    const SubtreeItem* x = (const SubtreeItem*)a;
+    const SubtreeItem* y = (const SubtreeItem*)b;
+    if (x->bytes != y->bytes) return x->bytes < y->bytes ? 1 : -1;
+    return strcmp(x->path, y->path);
+}
+
+static double percent(uint64_t part, uint64_t total) {
+    return total ? 100.0 * (double)part / (double)total : 0.0;
+}
+
+/* Write report of one file as text | 以文本形式写出单个文件的报告 */
+static int write_text(FILE* out, const FileStats* file) {
+    const CountEntry** tags = count_sorted(&file->tags);
+    const CountEntry** dests = count_sorted(&file->dests);
+    if (!tags || !dests) {
+        free(tags);
+        free(dests);
+        return 0;
+    }
+    size_t shown = file->tags.count < (size_t)file->top ? file->tags.count : (size_t)file->top;
+
+    fprintf(out, "File: %s\n", file->file_path);
+    fprintf(out, "  Size:           %llu bytes\n", (unsigned long long)file->size);
+    fprintf(out, "  Elements:       %llu (%zu distinct tags, max depth %zu)\n",
+            (unsigned long long)file->elements, file->tags.count, file->level_count);
+    fprintf(out, "  SHORT-NAMEs:    %llu\n", (unsigned long long)file->identifiables);
+    fprintf(out, "  References:     %llu (%llu absolute, %llu relative)\n", (unsigned long long)file->references,
+            (unsigned long long)file->absolute_references,
+            (unsigned long long)(file->references - file->absolute_references));
+
+    fprintf(out, "  Elements per tag (top %zu of %zu):\n", shown, file->tags.count);
+    for (size_t i = 0; i < shown; i++) {
+        fprintf(out, "    %12llu  %14llu bytes  %s\n", (unsigned long long)tags[i]->count,
+                (unsigned long long)tags[i]->bytes, tags[i]->name);
+    }
+    if (file->dests.count > 0) {
+        fprintf(out, "  References per DEST:\n");
+        for (size_t i = 0; i < file->dests.count; i++) {
+            fprintf(out, "    %12llu  %s\n", (unsigned long long)dests[i]->count,
+                    dests[i]->name_len ? dests[i]->name : "(no DEST)");
+        }
+    }
+    if (file->package_count > 0) {
+        fprintf(out, "  Top-level packages:\n");
+        for (size_t i = 0; i < file->package_count; i++) {
+            const PackageStats* package = &file->packages[i];
+            fprintf(out, "    %14llu bytes %6.2f%%  %10llu elements  %s\n", (unsigned long long)package->bytes,
+                    percent(package->bytes, file->size), (unsigned long long)package->elements, package->path);
+        }
+    }
+    fprintf(out, "  Depth histogram:\n");
+    for (size_t i = 0; i < file->level_count; i++) {
+        fprintf(out, "    %4zu  %12llu\n", i + 1, (unsigned long long)file->levels[i]);
+    }
+    if (file->largest_count > 0) {
+        fprintf(out, "  Largest subtrees:\n");
+        for (size_t i = 0; i < file->largest_count; i++) {
+            fprintf(out, "    %14llu bytes  %s (%s)\n", (unsigned long long)file->largest[i].bytes,
+                    file->largest[i].path, file->largest[i].tag);
+        }
+    }
+    free(tags);
+    free(dests);
+    return 1;
+}
+
+/* Write report of one file as JSON object, all tags included | 以JSON对象写出单个文件的报告，包含所有标签 */
+static int write_json(FILE* out, const FileStats* file) {
+    const CountEntry** tags = count_sorted(&file->tags);
+    const CountEntry** dests = count_sorted(&file->dests);
+    if (!tags || !dests) {
+        free(tags);
+        free(dests);
+        return 0;
+    }
+
+    fprintf(out, "{\"file\":");
+    json_write_string(out, file->file_path);
+    fprintf(out, ",\"bytes\":%llu,\"elements\":%llu,\"max_depth\":%zu,\"short_names\":%llu",
+            (unsigned long long)file->size, (unsigned long long)file->elements, file->level_count,
+            (unsigned long long)file->identifiables);
+    fprintf(out, ",\"references\":{\"total\":%llu,\"absolute\":%llu,\"relative\":%llu,\"by_dest\":{",
+            (unsigned long long)file->references, (unsigned long long)file->absolute_references,
+            (unsigned long long)(file->references - file->absolute_references));
+    for (size_t i = 0; i < file->dests.count; i++) {
+        fprintf(out, "%s", i ? "," : "");
+        json_write_string_len(out, dests[i]->name, dests[i]->name_len);
+        fprintf(out, ":%llu", (unsigned long long)dests[i]->count);
+    }
+    fprintf(out, "}},\"tags\":[");
+    for (size_t i = 0; i < file->tags.count; i++) {
+        fprintf(out, "%s{\"tag\":", i ? "," : "");
+        json_write_string_len(out, tags[i]->name, tags[i]->name_len);
+        fprintf(out, ",\"count\":%llu,\"bytes\":%llu}", (unsigned long long)tags[i]->count,
+                (unsigned long long)tags[i]->bytes);
+    }
+    fprintf(out, "],\"packages\":[");
+    for (size_t i = 0; i < file->package_count; i++) {
+        fprintf(out, "%s{\"path\":", i ? "," : "");
+        json_write_string(out, file->packages[i].path);
+        fprintf(out, ",\"bytes\":%llu,\"elements\":%llu,\"short_names\":%llu}",
+                (unsigned long long)file->packages[i].bytes, (unsigned long long)file->packages[i].elements,
+                (unsigned long long)file->packages[i].identifiables);
+    }
+    fprintf(out, "],\"depth_histogram\":[");
+    for (size_t i = 0; i < file->level_count; i++) {
+        fprintf(out, "%s%llu", i ? "," : "", (unsigned long long)file->levels[i]);
+    }
+    fprintf(out, "],\"largest_subtrees\":[");
+    for (size_t i = 0; i < file->largest_count; i++) {
+        fprintf(out, "%s{\"path\":", i ? "," : "");
+        json_write_string(out, file->largest[i].path);
+        fprintf(out, ",\"tag\":");
+        json_write_string(out, file->largest[i].tag);
+        fprintf(out, ",\"bytes\":%llu}", (unsigned long long)file->largest[i].bytes);
+    }
+    fprintf(out, "]}");
+    free(tags);
+    free(dests);
+    return 1;
+}
+
+/* Report statistics of all input files | 报告所有输入文件的统计信息 */
+int stats_arxml_files(const ProgramOptions *opts) {
+    int file_count = opts->input_files.count;
+    FileStats* files = (FileStats*)calloc((size_t)file_count, sizeof(FileStats));
+    if (!files) {
+        printf("Error: Memory allocation failed\n");
+        return 0;
+    }
+
+    /* Scan files concurrently | 并发扫描文件 */
+    ThreadPool* pool = thread_pool_create(opts->jobs);
+    for (int f = 0; f < file_count; f++) {
+        files[f].file_path = opts->input_files.items[f];
+        files[f].top = opts->stats.top;
+        run_task(pool, stats_file_task, &files[f]);
+    }
+    if (pool) {
+        thread_pool_wait(pool);
+        thread_pool_destroy(pool);
+    }
+
+    int ok = 1;
+    for (int f = 0; f < file_count; f++) {
+        if (!files[f].ok) {
+            printf("Error: Cannot scan file '%s' (missing, unreadable or malformed XML)\n", files[f].file_path);
+            ok = 0;
+        }
+    }
+
+    /* Write report in input order, "-" writes standard output | 按输入顺序写出报告，"-"写出到标准输出 */
+    FILE* out = stdout;
+    char* final_output_path = NULL;
+    int to_file = 0;
+    if (ok && opts->output_file[0] != '\0') {
+        final_output_path = build_output_path(opts->output_file, opts->output_dir);
+        if (!final_output_path) {
+            printf("Error: Memory allocation failed\n");
+            ok = 0;
+        } else if (is_stdio_path(final_output_path)) {
+            out = stdout_data();
+        } else if (!create_parent_directories(final_output_path) || !(out = fopen(final_output_path, "w"))) {
+            printf("Error: Cannot create output file '%s'\n", final_output_path);
+            ok = 0;
+        } else {
+            to_file = 1;
+        }
+    }
+    uint64_t total_bytes = 0;
+    uint64_t total_elements = 0;
+    if (ok) {
+        if (opts->stats.json) fprintf(out, "{\"files\":[");
+        for (int f = 0; ok && f < file_count; f++) {
+            qsort(files[f].largest, files[f].largest_count, sizeof(SubtreeItem), compare_subtrees);
+            if (opts->stats.json) {
+                fprintf(out, "%s", f ? ",\n" : "\n");
+                ok = write_json(out, &files[f]);
+            } else {
+                fprintf(out, "%s", f ? "\n" : "");
+                ok = write_text(out, &files[f]);
+            }
+            total_bytes += files[f].size;
+            total_elements += files[f].elements;
+        }
+        if (opts->stats.json) fprintf(out, "\n]}\n");
+        if (!ok) printf("Error: Memory allocation failed\n");
+    }
+    if (to_file) {
+        if (fclose(out) != 0) {
+            printf("Error: Cannot write output file '%s'\n", final_output_path);
+            ok = 0;
+        }
+    } else if (out != stdout && fflush(out) != 0) {
+        printf("Error: Cannot write standard output\n");
+        ok = 0;
+    }
+
+    /* Report on the console is followed by a blank line, JSON there stays valid | 控制台上的报告后空一行，控制台上的JSON保持有效 */
+    if (ok && (out != stdout || !opts->stats.json)) {
+        printf("%sStats completed: %d files, %llu bytes, %llu elements%s%s\n", out == stdout ? "\n" : "", file_count,
+               (unsigned long long)total_bytes, (unsigned long long)total_elements,
+               to_file ? ", output file: " : "", to_file ? final_output_path : "");
+    }
+
+    free(final_output_path);
+    for (int f = 0; f < file_count; f++) {
+        free_file_stats(&files[f]);
+    }
+    free(files);
+    return ok;
+}
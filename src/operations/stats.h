@@ -0,0 +1,12 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include "../main/common.h"
+
+/* Report statistics of ARXML files | 报告ARXML文件的统计信息
+ * Each file is streamed once: element counts and bytes per tag, bytes per top-level package,
+ * depth histogram, SHORT-NAME and reference counts and the largest subtrees, as text or JSON.
+ * 每个文件只流式读取一次：各标签的元素数量和字节数、各顶层包的字节数、深度分布、SHORT-NAME和引用数量以及最大的子树，输出为文本或JSON */
+int stats_arxml_files(const ProgramOptions *opts);
+
+#endif /* STATS_H */
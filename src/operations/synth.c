@@ -0,0 +1,446 @@
+#include "synth.h"
+#include "../utils/fs_utils.h"
+#include "../utils/thread_pool.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#define SYNTH_BUFFER_SIZE (1 << 20)
+#define SYNTH_MAX_LEAVES 1000000
+#define SYNTH_SAMPLE_ELEMENTS 256
+#define SYNTH_MAX_NAME 256
+#define SYNTH_MAX_PATH 4096
+
+/* Element kinds mimicking an ECU extract | 模拟ECU提取文件的元素类型 */
+typedef struct {
+    const char* tag;
+    const char* name_prefix;
+    const char* value_tag;      /* Fixed text child | 固定的文本子元素 */
+    const char* value_text;
+    const char* ref_container;  /* Wrapper of referencing children, NULL for none | 引用子元素的容器，NULL表示无 */
+    const char* ref_owner;      /* Identifiable owning each reference, NULL for none | 每个引用所属的可标识元素，NULL表示无 */
+    const char* ref_owner_prefix;
+    const char* ref_tag;        /* NULL if kind has no references | 该类型无引用时为NULL */
+    int target_kind;
+} ElementKind;
+
+static const ElementKind element_kinds[] = {
+    {"APPLICATION-SW-COMPONENT-TYPE", "Swc", NULL, NULL,
+     "PORTS", "R-PORT-PROTOTYPE", "Port", "REQUIRED-INTERFACE-TREF", 1},
+    {"SENDER-RECEIVER-INTERFACE", "If", "IS-SERVICE", "false",
+     "DATA-ELEMENTS", "VARIABLE-DATA-PROTOTYPE", "De", "TYPE-TREF", 2},
+    {"IMPLEMENTATION-DATA-TYPE", "Dt", "CATEGORY", "STRUCTURE",
+     "SUB-ELEMENTS", "IMPLEMENTATION-DATA-TYPE-ELEMENT", "Field", "IMPLEMENTATION-DATA-TYPE-REF", 2},
+    {"I-SIGNAL", "Sig", "LENGTH", "8",
+     NULL, NULL, NULL, "SYSTEM-SIGNAL-REF", 4},
+    {"SYSTEM-SIGNAL", "SysSig", "DYNAMIC-LENGTH", "false",
+     NULL, NULL, NULL, NULL, -1}
+};
+#define KIND_COUNT ((int)(sizeof(element_kinds) / sizeof(element_kinds[0])))
+#define REF_KIND_COUNT 4
+
+/* Buffered output, counts bytes only if file is NULL | 带缓冲的输出，file为NULL时只计数 */
+typedef struct {
+    FILE* file;
+    char* buf;
+    size_t len;
+    uint64_t written;
+    int failed;
+} OutBuffer;
+
+/* Shared, read-only generation context | 共享的只读生成上下文 */
+typedef struct {
+    const SynthParams* params;
+    char indent[32];
+    size_t indent_len;
+    long leaves;
+    long per_file;            /* Elements per file | 每个文件的元素数 */
+    long shared;              /* Elements shared by all files | 所有文件共享的元素数 */
+    long unique;              /* Elements unique to each file | 每个文件独有的元素数 */
+    long total;               /* Distinct elements in corpus | 语料中不同元素的总数 */
+    double refs_per_element;  /* Per reference carrying element | 每个可带引用的元素的引用数 */
+} SynthContext;
+
+/* Task of writing one file | 写出单个文件的任务 */
+typedef struct {
+    const SynthContext* ctx;
+    int file_index;
+    char* path;
+    uint64_t bytes;
+    int ok;
+} SynthFileTask;
+
+/* splitmix64 mixer, also used as stateless per element generator | splitmix64混合函数，也用作无状态的逐元素随机数 */
+static uint64_t mix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+static uint64_t next_random(uint64_t* state) {
+    *state += 0x9E3779B97F4A7C15ULL;
+    return mix64(*state);
+}
+
+static void out_write(OutBuffer* out, const char* data, size_t len) {
+    out->written += len;
+    if (out->file == NULL) {
+        return;
+    }
+    if (out->len + len > SYNTH_BUFFER_SIZE) {
+        if (fwrite(out->buf, 1, out->len, out->file) != out->len) out->failed = 1;
+        out->len = 0;
+    }
+    if (len > SYNTH_BUFFER_SIZE) {
+        if (fwrite(data, 1, len, out->file) != len) out->failed = 1;
+        return;
+    }
+    memcpy(out->buf + out->len, data, len);
+    out->len += len;
+}
+
+static void out_str(OutBuffer* out, const char* str) {
+    out_write(out, str, strlen(str));
+}
+
+static void out_indent(OutBuffer* out, const SynthContext* ctx, int level) {
+    for (int i = 0; i < level; i++) {
+        out_write(out, ctx->indent, ctx->indent_len);
+    }
+}
+
+/* Write "<tag>" or "</tag>" on its own line | 在单独一行写出"<tag>"或"</tag>" */
+static void out_tag(OutBuffer* out, const SynthContext* ctx, int level, const char* tag, int closing) {
+    out_indent(out, ctx, level);
+    out_str(out, closing ? "</" : "<");
+    out_str(out, tag);
+    out_str(out, ">\n");
+}
+
+/* Write "<tag DEST="dest">text</tag>" line | 写出"<tag DEST="dest">text</tag>"行 */
+static void out_text_element(OutBuffer* out, const SynthContext* ctx, int level,
+                             const char* tag, const char* dest, const char* text) {
+    out_indent(out, ctx, level);
+    out_str(out, "<");
+    out_str(out, tag);
+    if (dest) {
+        out_str(out, " DEST=\"");
+        out_str(out, dest);
+        out_str(out, "\"");
+    }
+    out_str(out, ">");
+    out_str(out, text);
+    out_str(out, "</");
+    out_str(out, tag);
+    out_str(out, ">\n");
+}
+
+/* Build SHORT-NAME: prefix, base36 id, random filler up to length | 构建SHORT-NAME：前缀、36进制编号、随机填充到指定长度 */
+static void make_name(char* buf, const char* prefix, uint64_t id, uint64_t salt, int length) {
+    static const char digits[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+    char id_buf[16];
+    int id_len = 0;
+    size_t len = strlen(prefix);
+
+    memcpy(buf, prefix, len);
+    do {
+        id_buf[id_len++] = digits[id % 36];
+        id /= 36;
+    } while (id > 0);
+    while (id_len > 0) {
+        buf[len++] = id_buf[--id_len];
+    }
+
+    /* Filler keeps names unique, it only pads | 填充字符只用于补齐长度，不影响唯一性 */
+    if ((int)len < length) {
+        buf[len++] = '_';
+    }
+    uint64_t state = salt;
+    while ((int)len < length && len < SYNTH_MAX_NAME - 1) {
+        buf[len++] = (char)('A' + next_random(&state) % 26);
+    }
+    buf[len] = '\0';
+}
+
+static int kind_of(const SynthContext* ctx, long index) {
+    return (int)(mix64(ctx->params->seed ^ ((uint64_t)index * 0x2545F4914F6CDD1DULL)) % KIND_COUNT);
+}
+
+static void package_name(const SynthContext* ctx, char* buf, int level, long digit) {
+    make_name(buf, "Pkg", (uint64_t)digit, ctx->params->seed ^ ((uint64_t)level << 40) ^ (uint64_t)digit,
+              ctx->params->name_length);
+}
+
+static void element_name(const SynthContext* ctx, char* buf, long index) {
+    make_name(buf, element_kinds[kind_of(ctx, index)].name_prefix, (uint64_t)index,
+              mix64(ctx->params->seed + (uint64_t)index), ctx->params->name_length);
+}
+
+/* Build AUTOSAR path of element, computed from its index alone | 仅根据编号计算元素的AUTOSAR路径 */
+static void element_path(const SynthContext* ctx, char* buf, long index) {
+    char name[SYNTH_MAX_NAME];
+    long leaf = index % ctx->leaves;
+    long divisor = ctx->leaves;
+    size_t len = 0;
+
+    for (int level = 0; level < ctx->params->package_depth; level++) {
+        divisor /= ctx->params->package_fanout;
+        package_name(ctx, name, level, (leaf / divisor) % ctx->params->package_fanout);
+        len += (size_t)snprintf(buf + len, SYNTH_MAX_PATH - len, "/%s", name);
+    }
+    element_name(ctx, name, index);
+    snprintf(buf + len, SYNTH_MAX_PATH - len, "/%s", name);
+}
+
+/* Write one element, content depends only on its index | 写出一个元素，内容只取决于其编号 */
+static void write_element(OutBuffer* out, const SynthContext* ctx, long index, int level) {
+    const ElementKind* kind = &element_kinds[kind_of(ctx, index)];
+    uint64_t state = mix64(ctx->params->seed ^ (uint64_t)index);
+    char name[SYNTH_MAX_NAME];
+    char path[SYNTH_MAX_PATH];
+
+    out_tag(out, ctx, level, kind->tag, 0);
+    element_name(ctx, name, index);
+    out_text_element(out, ctx, level + 1, "SHORT-NAME", NULL, name);
+    if (kind->value_tag) {
+        out_text_element(out, ctx, level + 1, kind->value_tag, NULL, kind->value_text);
+    }
+
+    /* Number of references: integer part plus chance for one more | 引用数：整数部分加上一个概率引用 */
+    int refs = 0;
+    if (kind->ref_tag) {
+        double density = ctx->refs_per_element;
+        refs = (int)density;
+        if ((double)(next_random(&state) % 1000000) / 1000000.0 < density - refs) {
+            refs++;
+        }
+    }
+
+    if (refs > 0 && kind->ref_container) {
+        out_tag(out, ctx, level + 1, kind->ref_container, 0);
+    }
+    int ref_level = level + (kind->ref_container ? 2 : 1);
+    for (int r = 0; r < refs; r++) {
+        /* Pick a target of the expected kind anywhere in the corpus | 在整个语料中选择期望类型的目标 */
+        long target = (long)(next_random(&state) % (uint64_t)ctx->total);
+        /* Step to next index of that kind so references always resolve | 步进到该类型的下一个编号，保证引用总能解析 */
+        for (long step = 0; step < ctx->total && kind_of(ctx, target) != kind->target_kind; step++) {
+            target = (target + 1) % ctx->total;
+        }
+        element_path(ctx, path, target);
+
+        if (kind->ref_owner) {
+            out_tag(out, ctx, ref_level, kind->ref_owner, 0);
+            make_name(name, kind->ref_owner_prefix, (uint64_t)r, 0, 0);
+            out_text_element(out, ctx, ref_level + 1, "SHORT-NAME", NULL, name);
+            out_text_element(out, ctx, ref_level + 1, kind->ref_tag, element_kinds[kind->target_kind].tag, path);
+            out_tag(out, ctx, ref_level, kind->ref_owner, 1);
+        } else {
+            out_text_element(out, ctx, ref_level, kind->ref_tag, element_kinds[kind->target_kind].tag, path);
+        }
+    }
+    if (refs > 0 && kind->ref_container) {
+        out_tag(out, ctx, level + 1, kind->ref_container, 1);
+    }
+
+    out_tag(out, ctx, level, kind->tag, 1);
+}
+
+/* Count i in [lo, hi) with i % leaves in [a, b) | 统计[lo, hi)中满足i % leaves属于[a, b)的i的数量 */
+static long count_below(long n, long leaves, long a, long b) {
+    long rest = n % leaves - a;
+    if (rest < 0) rest = 0;
+    if (rest > b - a) rest = b - a;
+    return (n / leaves) * (b - a) + rest;
+}
+
+static long count_in_leaves(const SynthContext* ctx, int file_index, long a, long b) {
+    long unique_lo = ctx->shared + (long)file_index * ctx->unique;
+    return count_below(ctx->shared, ctx->leaves, a, b) +
+           count_below(unique_lo + ctx->unique, ctx->leaves, a, b) - count_below(unique_lo, ctx->leaves, a, b);
+}
+
+/* Write elements of range [lo, hi) that belong to leaf | 写出[lo, hi)中属于该叶子包的元素 */
+static void write_leaf_range(OutBuffer* out, const SynthContext* ctx, long leaf, long lo, long hi, int level) {
+    long first = lo + ((leaf - lo % ctx->leaves) + ctx->leaves) % ctx->leaves;
+    for (long i = first; i < hi; i += ctx->leaves) {
+        write_element(out, ctx, i, level);
+    }
+}
+
+/* Recursively write packages covering leaves [first_leaf, first_leaf + span) | 递归写出覆盖叶子包[first_leaf, first_leaf + span)的包 */
+static void write_packages(OutBuffer* out, const SynthContext* ctx, int file_index,
+                           int level, long first_leaf, long span, int indent_level) {
+    long child_span = span / ctx->params->package_fanout;
+    char name[SYNTH_MAX_NAME];
+
+    for (long digit = 0; digit < ctx->params->package_fanout; digit++) {
+        long a = first_leaf + digit * child_span;
+        if (count_in_leaves(ctx, file_index, a, a + child_span) == 0) {
+            continue;  /* No element of this file below | 此文件在该包下没有元素 */
+        }
+
+        out_tag(out, ctx, indent_level, "AR-PACKAGE", 0);
+        package_name(ctx, name, level, digit);
+        out_text_element(out, ctx, indent_level + 1, "SHORT-NAME", NULL, name);
+        if (level == ctx->params->package_depth - 1) {
+            long unique_lo = ctx->shared + (long)file_index * ctx->unique;
+            out_tag(out, ctx, indent_level + 1, "ELEMENTS", 0);
+            write_leaf_range(out, ctx, a, 0, ctx->shared, indent_level + 2);
+            write_leaf_range(out, ctx, a, unique_lo, unique_lo + ctx->unique, indent_level + 2);
+            out_tag(out, ctx, indent_level + 1, "ELEMENTS", 1);
+        } else {
+            out_tag(out, ctx, indent_level + 1, "AR-PACKAGES", 0);
+            write_packages(out, ctx, file_index, level + 1, a, child_span, indent_level + 2);
+            out_tag(out, ctx, indent_level + 1, "AR-PACKAGES", 1);
+        }
+        out_tag(out, ctx, indent_level, "AR-PACKAGE", 1);
+    }
+}
+
+/* Worker task: write one corpus file | 工作线程任务：写出一个语料文件 */
+static void write_file_task(void* arg) {
+    SynthFileTask* task = (SynthFileTask*)arg;
+    const SynthContext* ctx = task->ctx;
+    OutBuffer out = {NULL, NULL, 0, 0, 0};
+
+    out.file = fopen(task->path, "wb");
+    out.buf = (char*)malloc(SYNTH_BUFFER_SIZE);
+    if (!out.file || !out.buf) {
+        if (out.file) fclose(out.file);
+        free(out.buf);
+        task->ok = 0;
+        return;
+    }
+
+    out_str(&out, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+    out_str(&out, "<AUTOSAR xmlns=\"http://autosar.org/schema/r4.0\" "
+                  "xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\" "
+                  "xsi:schemaLocation=\"http://autosar.org/schema/r4.0 AUTOSAR_00046.xsd\">\n");
+    out_tag(&out, ctx, 1, "AR-PACKAGES", 0);
+    write_packages(&out, ctx, task->file_index, 0, 0, ctx->leaves, 2);
+    out_tag(&out, ctx, 1, "AR-PACKAGES", 1);
+    out_str(&out, "</AUTOSAR>\n");
+
+    if (out.len > 0 && fwrite(out.buf, 1, out.len, out.file) != out.len) {
+        out.failed = 1;
+    }
+    if (fclose(out.file) != 0) {
+        out.failed = 1;
+    }
+    free(out.buf);
+    task->bytes = out.written;
+    task->ok = !out.failed;
+}
+
+/* Derive per file element counts from parameters | 根据参数推导每个文件的元素数量 */
+static void plan_corpus(SynthContext* ctx, long per_file) {
+    const SynthParams* params = ctx->params;
+    ctx->per_file = per_file > 0 ? per_file : 1;
+    ctx->shared = (long)(ctx->per_file * params->duplicate_ratio + 0.5);
+    ctx->unique = ctx->per_file - ctx->shared;
+    ctx->total = ctx->shared + (long)params->file_count * ctx->unique;
+}
+
+/* Fill synth parameters with defaults | 用默认值填充合成参数 */
+void synth_default_params(SynthParams *params) {
+    params->seed = 1;
+    params->package_depth = 3;
+    params->package_fanout = 4;
+    params->elements = 10000;
+    params->name_length = 16;
+    params->ref_density = 1.0;
+    params->duplicate_ratio = 0.0;
+    params->file_count = 1;
+    params->target_size = 0;
+}
+
+/* Generate deterministic synthetic ARXML corpus | 生成确定性的合成ARXML测试语料 */
+int synth_arxml_corpus(const ProgramOptions *opts) {
+    const SynthParams* params = &opts->synth;
+    SynthContext ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.params = params;
+
+    /* Indentation follows -i, default 4 spaces | 缩进遵循-i参数，默认4空格 */
+    if (opts->indent_style == INDENT_TAB) {
+        strcpy(ctx.indent, "\t");
+    } else {
+        int width = opts->indent_style == INDENT_SPACE ? opts->indent_width : 4;
+        if (width > 31) width = 31;
+        memset(ctx.indent, ' ', (size_t)width);
+        ctx.indent[width] = '\0';
+    }
+    ctx.indent_len = strlen(ctx.indent);
+
+    ctx.leaves = 1;
+    for (int i = 0; i < params->package_depth; i++) {
+        ctx.leaves *= params->package_fanout;
+        if (ctx.leaves > SYNTH_MAX_LEAVES) {
+            printf("Error: Too many packages (fanout^depth exceeds %d)\n", SYNTH_MAX_LEAVES);
+            return 0;
+        }
+    }
+    ctx.refs_per_element = params->ref_density * KIND_COUNT / REF_KIND_COUNT;
+
+    /* Derive element count from size target using a measured sample | 根据样本测得的大小推算元素数量 */
+    long per_file = params->elements;
+    if (params->target_size > 0) {
+        OutBuffer counter = {NULL, NULL, 0, 0, 0};
+        plan_corpus(&ctx, 1000000);
+        for (long i = 0; i < SYNTH_SAMPLE_ELEMENTS; i++) {
+            write_element(&counter, &ctx, i, 2 * params->package_depth + 2);
+        }
+        uint64_t average = counter.written / SYNTH_SAMPLE_ELEMENTS + 1;
+        per_file = (long)(params->target_size / (uint64_t)params->file_count / average);
+    }
+    plan_corpus(&ctx, per_file);
+
+    if (!create_directories(opts->output_dir)) {
+        printf("Error: Cannot create output directory '%s'\n", opts->output_dir);
+        return 0;
+    }
+
+    SynthFileTask* tasks = (SynthFileTask*)calloc((size_t)params->file_count, sizeof(SynthFileTask));
+    ThreadPool* pool = tasks ? thread_pool_create(opts->jobs) : NULL;
+    if (!pool) {
+        printf("Error: Cannot start worker threads\n");
+        free(tasks);
+        return 0;
+    }
+
+    /* Files are independent, write them concurrently | 文件之间相互独立，并发写出 */
+    const char* prefix = opts->output_file[0] ? opts->output_file : "corpus";
+    for (int i = 0; i < params->file_count; i++) {
+        size_t len = strlen(opts->output_dir) + strlen(prefix) + 32;
+        tasks[i].ctx = &ctx;
+        tasks[i].file_index = i;
+        tasks[i].path = (char*)malloc(len);
+        if (!tasks[i].path) continue;
+        snprintf(tasks[i].path, len, "%s/%s_%04d.arxml", opts->output_dir, prefix, i);
+        if (!thread_pool_submit(pool, write_file_task, &tasks[i])) {
+            write_file_task(&tasks[i]);  /* Inline if pool is full | 线程池已满时直接运行 */
+        }
+    }
+    thread_pool_destroy(pool);
+
+    int ok = 1;
+    uint64_t total_bytes = 0;
+    for (int i = 0; i < params->file_count; i++) {
+        if (!tasks[i].ok) {
+            printf("Error: Cannot write file '%s'\n", tasks[i].path ? tasks[i].path : prefix);
+            ok = 0;
+        }
+        total_bytes += tasks[i].bytes;
+        free(tasks[i].path);
+    }
+    free(tasks);
+
+    if (ok) {
+        printf("Synth completed: %d files, %ld elements per file (%ld shared), %llu bytes, seed %llu\n",
+               params->file_count, ctx.per_file, ctx.shared,
+               (unsigned long long)total_bytes, (unsigned long long)params->seed);
+    }
+    return ok;
+}
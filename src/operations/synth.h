@@ -0,0 +1,14 @@
+#ifndef SYNTH_H
+#define SYNTH_H
+
+#include "../main/common.h"
+
+/* Fill synth parameters with defaults | 用默认值填充合成参数 */
+void synth_default_params(SynthParams *params);
+
+/* Generate deterministic synthetic ARXML corpus | 生成确定性的合成ARXML测试语料
+ * Files are written to opts->output_dir as <prefix>_<n>.arxml, prefix taken from opts->output_file
+ * 文件写入opts->output_dir，命名为<prefix>_<n>.arxml，前缀取自opts->output_file */
+int synth_arxml_corpus(const ProgramOptions *opts);
+
+#endif /* SYNTH_H */
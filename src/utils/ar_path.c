@@ -0,0 +1,207 @@
+#include "ar_path.h"
+#include "xml_utils.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+/* Get SHORT-NAME text of node without copying | 获取节点的SHORT-NAME文本（不复制） */
+const xmlChar* peek_short_name(xmlNodePtr node) {
+    if (node == NULL || node->type != XML_ELEMENT_NODE) {
+        return NULL;
+    }
+    for (xmlNodePtr cur = node->children; cur != NULL; cur = cur->next) {
+        if (cur->type == XML_ELEMENT_NODE && compare_node_names(cur->name, (const xmlChar*)"SHORT-NAME") == 0) {
+            /* SHORT-NAME holds a single text node | SHORT-NAME只包含一个文本节点 */
+            if (cur->children && cur->children->type == XML_TEXT_NODE && cur->children->content) {
+                return cur->children->content;
+            }
+            return (const xmlChar*)"";
+        }
+    }
+    return NULL;
+}
+
+/* Build AUTOSAR path of node | 构建节点的AUTOSAR路径 */
+xmlChar* get_ar_path(xmlNodePtr node) {
+    size_t len = 0;
+
+    /* First pass sums SHORT-NAMEs from node up to the root, any depth | 第一遍从节点向上累计SHORT-NAME长度，不限深度 */
+    for (xmlNodePtr cur = node; cur != NULL && cur->type == XML_ELEMENT_NODE; cur = cur->parent) {
+        const xmlChar* name = peek_short_name(cur);
+        if (name != NULL) {
+            len += (size_t)xmlStrlen(name) + 1;
+        }
+    }
+
+    xmlChar* path = (xmlChar*)xmlMalloc(len + 1);
+    if (!path) return NULL;
+
+    /* Second pass fills the path from its end | 第二遍从路径末尾向前填充 */
+    xmlChar* p = path + len;
+    *p = '\0';
+    for (xmlNodePtr cur = node; cur != NULL && cur->type == XML_ELEMENT_NODE; cur = cur->parent) {
+        const xmlChar* name = peek_short_name(cur);
+        if (name != NULL) {
+            size_t name_len = (size_t)xmlStrlen(name);
+            p -= name_len;
+            memcpy(p, name, name_len);
+            *--p = '/';
+        }
+    }
+    return path;
+}
+
+/* Get tag names between nearest identifiable ancestor and node | 获取最近可标识祖先与节点之间的标签名 */
+xmlChar* get_ar_container_path(xmlNodePtr node) {
+    xmlChar* container = NULL;
+
+    for (xmlNodePtr cur = node->parent; cur != NULL && cur->type == XML_ELEMENT_NODE; cur = cur->parent) {
+        /* Stop at identifiable ancestor or the root element | 遇到可标识祖先或根元素时停止 */
+        if (peek_short_name(cur) != NULL || cur->parent == NULL || cur->parent->type != XML_ELEMENT_NODE) {
+            break;
+        }
+
+        /* Prepend tag name | 在前面添加标签名 */
+        xmlChar* joined = xmlStrdup(cur->name);
+        if (container != NULL) {
+            joined = xmlStrcat(joined, (const xmlChar*)"/");
+            joined = xmlStrcat(joined, container);
+            xmlFree(container);
+        }
+        container = joined;
+    }
+
+    return container ? container : xmlStrdup((const xmlChar*)"");
+}
+
+/* Call callback for every identifiable below node | 对节点下的每个可标识节点调用回调 */
+void for_each_identifiable_child(xmlNodePtr node, void (*callback)(xmlNodePtr child, void* data), void* data) {
+    for (xmlNodePtr cur = node->children; cur != NULL; cur = cur->next) {
+        if (cur->type != XML_ELEMENT_NODE) {
+            continue;
+        }
+        if (peek_short_name(cur) != NULL) {
+            callback(cur, data);
+        } else {
+            /* Look through non-identifiable containers such as ELEMENTS | 穿过ELEMENTS等不可标识的容器 */
+            for_each_identifiable_child(cur, callback, data);
+        }
+    }
+}
+
+/* Context for indexing children of one node | 索引某节点子节点时的上下文 */
+typedef struct {
+    ArPathIndex* index;
+    const char* parent_path;
+} ExpandContext;
+
+/* Add one child to the index | 将一个子节点加入索引 */
+static void index_child(xmlNodePtr child, void* data) {
+    ExpandContext* ctx = (ExpandContext*)data;
+    xmlChar* path = xmlStrdup((const xmlChar*)ctx->parent_path);
+    path = xmlStrcat(path, (const xmlChar*)"/");
+    path = xmlStrcat(path, peek_short_name(child));
+
+    /* Keep the first node when SHORT-NAMEs are duplicated | SHORT-NAME重复时保留第一个节点 */
+    if (xmlHashLookup(ctx->index->nodes, path) == NULL) {
+        xmlHashAddEntry(ctx->index->nodes, path, child);
+    }
+    xmlFree(path);
+}
+
+/* Index direct identifiable children of path if not done yet | 若尚未索引则索引路径下的直接可标识子节点 */
+static void expand_path(ArPathIndex* index, const char* path, xmlNodePtr node) {
+    if (xmlHashLookup(index->expanded, (const xmlChar*)path) != NULL) {
+        return;
+    }
+    ExpandContext ctx = {index, path};
+    for_each_identifiable_child(node, index_child, &ctx);
+    xmlHashAddEntry(index->expanded, (const xmlChar*)path, (void*)node);
+}
+
+/* Create path index for document | 为文档创建路径索引 */
+ArPathIndex* ar_path_index_new(xmlDocPtr doc) {
+    ArPathIndex* index = (ArPathIndex*)calloc(1, sizeof(ArPathIndex));
+    if (!index) return NULL;
+
+    index->doc = doc;
+    index->nodes = xmlHashCreate(1024);
+    index->expanded = xmlHashCreate(256);
+    if (!index->nodes || !index->expanded) {
+        ar_path_index_free(index);
+        return NULL;
+    }
+    return index;
+}
+
+/* Look up node by AUTOSAR path | 按AUTOSAR路径查找节点 */
+xmlNodePtr ar_path_index_lookup(ArPathIndex* index, const char* path) {
+    xmlNodePtr node = xmlDocGetRootElement(index->doc);
+    if (node == NULL || path == NULL || path[0] == '\0' || strcmp(path, "/") == 0) {
+        return node;
+    }
+
+    size_t len = strlen(path);
+    char* prefix = (char*)malloc(len + 1);
+    if (!prefix) return NULL;
+
+    /* Walk down one segment at a time, expanding parents on demand | 逐段向下查找，按需展开父节点 */
+    prefix[0] = '\0';
+    const char* seg = (path[0] == '/') ? path + 1 : path;
+    size_t prefix_len = 0;
+    while (node != NULL && *seg) {
+        const char* seg_end = strchr(seg, '/');
+        size_t seg_len = seg_end ? (size_t)(seg_end - seg) : strlen(seg);
+
+        expand_path(index, prefix, node);
+
+        prefix[prefix_len++] = '/';
+        memcpy(prefix + prefix_len, seg, seg_len);
+        prefix_len += seg_len;
+        prefix[prefix_len] = '\0';
+
+        node = (xmlNodePtr)xmlHashLookup(index->nodes, (const xmlChar*)prefix);
+        seg = seg_end ? seg_end + 1 : seg + seg_len;
+    }
+
+    free(prefix);
+    return node;
+}
+
+/* Register node under path | 在索引中登记节点 */
+void ar_path_index_add(ArPathIndex* index, const char* path, xmlNodePtr node) {
+    xmlHashUpdateEntry(index->nodes, (const xmlChar*)path, node, NULL);
+}
+
+/* Drop one child of a removed node | 移除被删除节点的一个子节点 */
+static void remove_child(xmlNodePtr child, void* data) {
+    ExpandContext* ctx = (ExpandContext*)data;
+    xmlChar* path = xmlStrdup((const xmlChar*)ctx->parent_path);
+    path = xmlStrcat(path, (const xmlChar*)"/");
+    path = xmlStrcat(path, peek_short_name(child));
+    ar_path_index_remove(ctx->index, (const char*)path);
+    xmlFree(path);
+}
+
+/* Drop path and everything below it from the index | 从索引中移除路径及其下所有路径
+ * Walks the expanded part of the removed subtree, not the whole tables | 只遍历被移除子树中已展开的部分，而不是整个哈希表 */
+void ar_path_index_remove(ArPathIndex* index, const char* path) {
+    xmlHashRemoveEntry(index->nodes, (const xmlChar*)path, NULL);
+
+    /* Only children of expanded paths were indexed | 只有已展开路径的子节点被索引过 */
+    xmlNodePtr node = (xmlNodePtr)xmlHashLookup(index->expanded, (const xmlChar*)path);
+    if (node == NULL) {
+        return;
+    }
+    xmlHashRemoveEntry(index->expanded, (const xmlChar*)path, NULL);
+    ExpandContext ctx = {index, path};
+    for_each_identifiable_child(node, remove_child, &ctx);
+}
+
+/* Free path index | 释放路径索引 */
+void ar_path_index_free(ArPathIndex* index) {
+    if (!index) return;
+    if (index->nodes) xmlHashFree(index->nodes, NULL);
+    if (index->expanded) xmlHashFree(index->expanded, NULL);
+    free(index);
+}
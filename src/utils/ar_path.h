@@ -0,0 +1,47 @@
+#ifndef AR_PATH_H
+#define AR_PATH_H
+
+#include <libxml/parser.h>
+#include <libxml/hash.h>
+
+/* Lazily built AUTOSAR path index of a document | 文档的延迟构建AUTOSAR路径索引
+ * Children of a node are only indexed when a path below it is looked up,
+ * so lookup cost scales with the touched packages, not the document.
+ * 仅当查找某节点下的路径时才索引其子节点，因此查找开销只与涉及的包有关，而与文档大小无关 */
+typedef struct {
+    xmlDocPtr doc;
+    xmlHashTablePtr nodes;      /* Path -> node | 路径 -> 节点 */
+    xmlHashTablePtr expanded;   /* Paths whose children are indexed | 子节点已被索引的路径 */
+} ArPathIndex;
+
+/* Get SHORT-NAME text of node without copying | 获取节点的SHORT-NAME文本（不复制）
+ * Returns NULL if node is not identifiable | 节点没有SHORT-NAME时返回NULL */
+const xmlChar* peek_short_name(xmlNodePtr node);
+
+/* Build AUTOSAR path of node, e.g. "/Pkg/Sub/MySwc" | 构建节点的AUTOSAR路径，例如"/Pkg/Sub/MySwc"
+ * The root element has the empty path; result must be freed with xmlFree | 根元素路径为空字符串；结果需用xmlFree释放 */
+xmlChar* get_ar_path(xmlNodePtr node);
+
+/* Get tag names between nearest identifiable ancestor and node, joined by '/' | 获取最近可标识祖先与节点之间的标签名，以'/'连接
+ * e.g. "ELEMENTS" for an element in a package; result must be freed with xmlFree | 例如包中元素为"ELEMENTS"；结果需用xmlFree释放 */
+xmlChar* get_ar_container_path(xmlNodePtr node);
+
+/* Call callback for every identifiable below node, without descending into them | 对节点下的每个可标识节点调用回调，不进入其内部 */
+void for_each_identifiable_child(xmlNodePtr node, void (*callback)(xmlNodePtr child, void* data), void* data);
+
+/* Create path index for document | 为文档创建路径索引 */
+ArPathIndex* ar_path_index_new(xmlDocPtr doc);
+
+/* Look up node by AUTOSAR path, NULL if not found | 按AUTOSAR路径查找节点，未找到时返回NULL */
+xmlNodePtr ar_path_index_lookup(ArPathIndex* index, const char* path);
+
+/* Register node under path after it was added to the tree | 节点加入文档树后在索引中登记 */
+void ar_path_index_add(ArPathIndex* index, const char* path, xmlNodePtr node);
+
+/* Drop path and everything below it from the index | 从索引中移除路径及其下所有路径 */
+void ar_path_index_remove(ArPathIndex* index, const char* path);
+
+/* Free path index (the document is not freed) | 释放路径索引（不释放文档） */
+void ar_path_index_free(ArPathIndex* index);
+
+#endif /* AR_PATH_H */
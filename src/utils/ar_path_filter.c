@@ -0,0 +1,461 @@
+#include "ar_path_filter.h"
+#include "dir_walk.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <libxml/tree.h>
+
+/* Kind of pattern segment, decided when compiling | 模式段的类型，在编译时确定 */
+typedef enum {
+    SEGMENT_LITERAL,    /* Compared as is | 直接比较 */
+    SEGMENT_GLOB,       /* Contains '*', '?' or '[' | 包含'*'、'?'或'[' */
+    SEGMENT_ANY         /* "**", any number of package segments | "**"，任意数量的包路径段 */
+} SegmentKind;
+
+typedef struct {
+    char* text;
+    SegmentKind kind;
+} PatternSegment;
+
+/* One compiled pattern, its positions in a match state are first .. first + count | 一个编译后的模式，其在匹配状态中的位置为first .. first + count */
+typedef struct {
+    PatternSegment* segments;
+    int count;
+    int first;
+    int skip;           /* From skip, else from only | 来自skip，否则来自only */
+} PathPattern;
+
+struct ArPathFilter {
+    PathPattern* patterns;
+    int count;
+    int positions;      /* Bytes of one match state, a byte per segment position of every pattern | 一个匹配状态的字节数，每个模式的每个段位置占一个字节 */
+    int has_only;
+};
+
+/* Selection below one kept identifiable | 一个保留的可标识元素之下的选择状态 */
+typedef struct {
+    int included;       /* Selected by only, or no only patterns | 已被only选中，或没有only模式 */
+    int settled;        /* Everything below is kept, no more matching needed | 其下所有内容都保留，无需继续匹配 */
+} FilterScope;
+
+/* Open element while parsing | 解析时打开的元素 */
+typedef struct {
+    int named;          /* SHORT-NAME child seen | 已遇到SHORT-NAME子元素 */
+    int package;        /* AR-PACKAGE element | AR-PACKAGE元素 */
+    int dropped;        /* A child was dropped | 有子元素被丢弃 */
+    int scope_pushed;   /* Identifiable that pushed a scope | 压入了选择状态的可标识元素 */
+} FilterFrame;
+
+/* State of one filtered parse, reached through ctxt->_private | 一次过滤解析的状态，通过ctxt->_private访问 */
+typedef struct {
+    const ArPathFilter* filter;
+    startElementNsSAX2Func start_element;
+    endElementNsSAX2Func end_element;
+    charactersSAXFunc characters;
+    ignorableWhitespaceSAXFunc ignorable_whitespace;
+    cdataBlockSAXFunc cdata_block;
+    commentSAXFunc comment;
+    processingInstructionSAXFunc processing_instruction;
+    referenceSAXFunc reference;
+    FilterFrame* frames;
+    int depth;
+    int frames_size;
+    FilterScope* scopes;
+    unsigned char* states;  /* Match state of each scope | 每个选择状态的匹配状态 */
+    int scope_count;
+    int scopes_size;
+    char* name;             /* SHORT-NAME being read | 正在读取的SHORT-NAME */
+    size_t name_len;
+    size_t name_size;
+    int capturing;
+    xmlNodePtr skipped;     /* Identifiable being dropped, its content is not built | 正在丢弃的可标识元素，不构建其内容 */
+    int skip_depth;         /* Elements open inside it | 其中打开的元素数 */
+    int failed;
+} FilterReader;
+
+int ar_path_pattern_valid(const char* pattern) {
+    size_t len = strlen(pattern);
+    return len >= 2 && pattern[0] == '/' && pattern[len - 1] != '/' && strstr(pattern, "//") == NULL;
+}
+
+/* Split pattern into segments | 将模式拆分为段 */
+static int compile_pattern(const char* text, int skip, PathPattern* pattern) {
+    int count = 0;
+    for (const char* p = text; *p; p++) {
+        count += *p == '/';
+    }
+    pattern->segments = (PatternSegment*)calloc((size_t)count, sizeof(PatternSegment));
+    pattern->skip = skip;
+    if (!pattern->segments) {
+        return 0;
+    }
+    const char* start = text + 1;
+    while (pattern->count < count) {
+        const char* end = strchr(start, '/');
+        size_t len = end ? (size_t)(end - start) : strlen(start);
+        PatternSegment* segment = &pattern->segments[pattern->count];
+        segment->text = (char*)malloc(len + 1);
+        if (!segment->text) {
+            return 0;
+        }
+        memcpy(segment->text, start, len);
+        segment->text[len] = '\0';
+        pattern->count++;
+        if (strcmp(segment->text, "**") == 0) {
+            segment->kind = SEGMENT_ANY;
+        } else if (strpbrk(segment->text, "*?[") != NULL) {
+            segment->kind = SEGMENT_GLOB;
+        } else {
+            segment->kind = SEGMENT_LITERAL;
+        }
+        start += len + 1;
+    }
+    return 1;
+}
+
+ArPathFilter* ar_path_filter_new(const PathList* only, const PathList* skip) {
+    ArPathFilter* filter = (ArPathFilter*)calloc(1, sizeof(ArPathFilter));
+    if (!filter) {
+        return NULL;
+    }
+    int total = only->count + skip->count;
+    filter->patterns = (PathPattern*)calloc(total > 0 ? (size_t)total : 1, sizeof(PathPattern));
+    if (!filter->patterns) {
+        free(filter);
+        return NULL;
+    }
+    filter->has_only = only->count > 0;
+    for (int i = 0; i < total; i++) {
+        int from_skip = i >= only->count;
+        const char* text = from_skip ? skip->items[i - only->count] : only->items[i];
+        PathPattern* pattern = &filter->patterns[filter->count++];
+        if (!compile_pattern(text, from_skip, pattern)) {
+            ar_path_filter_free(filter);
+            return NULL;
+        }
+        pattern->first = filter->positions;
+        filter->positions += pattern->count + 1;
+    }
+    return filter;
+}
+
+void ar_path_filter_free(ArPathFilter* filter) {
+    if (!filter) return;
+    for (int i = 0; i < filter->count; i++) {
+        for (int j = 0; j < filter->patterns[i].count; j++) {
+            free(filter->patterns[i].segments[j].text);
+        }
+        free(filter->patterns[i].segments);
+    }
+    free(filter->patterns);
+    free(filter);
+}
+
+/* "**" may also match no segment, so the position after it is reached as well | "**"也可以不匹配任何段，因此同时到达其后的位置 */
+static void close_state(const ArPathFilter* filter, unsigned char* state) {
+    for (int i = 0; i < filter->count; i++) {
+        const PathPattern* pattern = &filter->patterns[i];
+        for (int p = 0; p < pattern->count; p++) {
+            if (state[pattern->first + p] && pattern->segments[p].kind == SEGMENT_ANY) {
+                state[pattern->first + p + 1] = 1;
+            }
+        }
+    }
+}
+
+/* Match state of a child named name | 名为name的子元素的匹配状态 */
+static void advance_state(const ArPathFilter* filter, const unsigned char* from, const char* name, int package, unsigned char* to) {
+    memset(to, 0, (size_t)filter->positions);
+    for (int i = 0; i < filter->count; i++) {
+        const PathPattern* pattern = &filter->patterns[i];
+        for (int p = 0; p < pattern->count; p++) {
+            if (!from[pattern->first + p]) continue;
+            const PatternSegment* segment = &pattern->segments[p];
+            if (segment->kind == SEGMENT_ANY) {
+                /* "**" takes packages only, so elements not leading to a match are dropped at once | "**"只匹配包，因此不通向匹配的元素会被立即丢弃 */
+                if (package) to[pattern->first + p] = 1;
+            } else if (segment->kind == SEGMENT_LITERAL ? strcmp(segment->text, name) == 0
+                                                        : glob_match(segment->text, name)) {
+                to[pattern->first + p + 1] = 1;
+            }
+        }
+    }
+    close_state(filter, to);
+}
+
+/* Decide for an identifiable with match state, returns 0 to drop it | 根据匹配状态决定可标识元素的去留，返回0表示丢弃 */
+static int select_scope(const ArPathFilter* filter, const unsigned char* state, int parent_included, FilterScope* scope) {
+    int included = parent_included || !filter->has_only;
+    int possible = 0;       /* An only pattern may still match below | 某个only模式仍可能匹配其下的元素 */
+    int skip_open = 0;      /* A skip pattern may still match below | 某个skip模式仍可能匹配其下的元素 */
+    for (int i = 0; i < filter->count; i++) {
+        const PathPattern* pattern = &filter->patterns[i];
+        if (state[pattern->first + pattern->count]) {
+            if (pattern->skip) return 0;
+            included = 1;
+        }
+        for (int p = 0; p < pattern->count; p++) {
+            if (state[pattern->first + p]) {
+                if (pattern->skip) skip_open = 1;
+                else possible = 1;
+                break;
+            }
+        }
+    }
+    if (!included && !possible) {
+        return 0;
+    }
+    scope->included = included;
+    scope->settled = included && !skip_open;
+    return 1;
+}
+
+static FilterReader* reader_of(void* ctx) {
+    return (FilterReader*)((xmlParserCtxtPtr)ctx)->_private;
+}
+
+/* Stop parsing after an allocation failed | 内存分配失败后停止解析 */
+static void fail(void* ctx) {
+    FilterReader* reader = reader_of(ctx);
+    if (!reader->failed) {
+        printf("Error: Memory allocation failed\n");
+    }
+    reader->failed = 1;
+    xmlStopParser((xmlParserCtxtPtr)ctx);
+}
+
+/* Make room for one more scope, returns its index or -1 | 为新的选择状态预留空间，返回其索引或-1 */
+static int reserve_scope(FilterReader* reader) {
+    if (reader->scope_count == reader->scopes_size) {
+        int size = reader->scopes_size ? reader->scopes_size * 2 : 16;
+        FilterScope* scopes = (FilterScope*)realloc(reader->scopes, (size_t)size * sizeof(FilterScope));
+        if (!scopes) return -1;
+        reader->scopes = scopes;
+        unsigned char* states = (unsigned char*)realloc(reader->states, (size_t)size * (size_t)reader->filter->positions + 1);
+        if (!states) return -1;
+        reader->states = states;
+        reader->scopes_size = size;
+    }
+    return reader->scope_count;
+}
+
+static unsigned char* scope_state(FilterReader* reader, int index) {
+    return reader->states + (size_t)index * (size_t)reader->filter->positions;
+}
+
+/* SHORT-NAME of the innermost open element was read | 已读取最内层打开元素的SHORT-NAME */
+static void select_identifiable(void* ctx) {
+    FilterReader* reader = reader_of(ctx);
+    int index = reserve_scope(reader);
+    if (index < 0) {
+        fail(ctx);
+        return;
+    }
+    reader->name[reader->name_len] = '\0';
+    advance_state(reader->filter, scope_state(reader, index - 1), reader->name, reader->frames[reader->depth - 1].package,
+                  scope_state(reader, index));
+    if (!select_scope(reader->filter, scope_state(reader, index), reader->scopes[index - 1].included, &reader->scopes[index])) {
+        /* The SHORT-NAME just ended, so the identifiable is the current node | SHORT-NAME刚刚结束，因此可标识元素就是当前节点 */
+        reader->skipped = ((xmlParserCtxtPtr)ctx)->node;
+        reader->skip_depth = 0;
+        return;
+    }
+    reader->scope_count++;
+    reader->frames[reader->depth - 1].scope_pushed = 1;
+}
+
+static void filter_start_element(void* ctx, const xmlChar* localname, const xmlChar* prefix, const xmlChar* URI,
+                                 int nb_namespaces, const xmlChar** namespaces, int nb_attributes,
+                                 int nb_defaulted, const xmlChar** attributes) {
+    FilterReader* reader = reader_of(ctx);
+    if (reader->skipped) {
+        reader->skip_depth++;
+        return;
+    }
+    reader->start_element(ctx, localname, prefix, URI, nb_namespaces, namespaces, nb_attributes, nb_defaulted, attributes);
+
+    if (reader->depth == reader->frames_size) {
+        int size = reader->frames_size ? reader->frames_size * 2 : 32;
+        FilterFrame* frames = (FilterFrame*)realloc(reader->frames, (size_t)size * sizeof(FilterFrame));
+        if (!frames) {
+            fail(ctx);
+            return;
+        }
+        reader->frames = frames;
+        reader->frames_size = size;
+    }
+    FilterFrame* frame = &reader->frames[reader->depth++];
+    frame->named = 0;
+    frame->scope_pushed = 0;
+    frame->package = xmlStrEqual(localname, (const xmlChar*)"AR-PACKAGE");
+    frame->dropped = 0;
+
+    /* Names are only needed while a pattern may still decide, the root element is always kept | 只有模式仍可能做出决定时才需要名称，根元素始终保留 */
+    if (reader->depth >= 3 && !frame[-1].named && !reader->scopes[reader->scope_count - 1].settled &&
+        xmlStrEqual(localname, (const xmlChar*)"SHORT-NAME")) {
+        frame[-1].named = 1;
+        reader->capturing = 1;
+        reader->name_len = 0;
+    }
+}
+
+static void filter_end_element(void* ctx, const xmlChar* localname, const xmlChar* prefix, const xmlChar* URI) {
+    FilterReader* reader = reader_of(ctx);
+    if (reader->skipped) {
+        if (reader->skip_depth > 0) {
+            reader->skip_depth--;
+            return;
+        }
+        reader->end_element(ctx, localname, prefix, URI);
+        xmlUnlinkNode(reader->skipped);
+        xmlFreeNode(reader->skipped);
+        reader->skipped = NULL;
+        reader->depth--;
+        reader->frames[reader->depth - 1].dropped = 1;
+        /* The last child may now be text, it must not be extended through lengths of the dropped element | 最后一个子节点现在可能是文本，不能按被丢弃元素的长度追加 */
+        ((xmlParserCtxtPtr)ctx)->nodelen = 0;
+        ((xmlParserCtxtPtr)ctx)->nodemem = 0;
+        return;
+    }
+    if (reader->depth == 0) {
+        reader->end_element(ctx, localname, prefix, URI);
+        return;
+    }
+    /* Without blanks an element emptied by the filter keeps no whitespace either, like one that was empty
+     * 不保留空白时，被过滤清空的元素也不保留空白，与原本为空的元素相同 */
+    xmlNodePtr node = ((xmlParserCtxtPtr)ctx)->node;
+    if (reader->frames[reader->depth - 1].dropped && !((xmlParserCtxtPtr)ctx)->keepBlanks && node &&
+        node->children && node->children == node->last && xmlIsBlankNode(node->children)) {
+        xmlNodePtr blank = node->children;
+        xmlUnlinkNode(blank);
+        xmlFreeNode(blank);
+    }
+    reader->end_element(ctx, localname, prefix, URI);
+    if (reader->frames[--reader->depth].scope_pushed) {
+        reader->scope_count--;
+    }
+    if (reader->capturing) {
+        reader->capturing = 0;
+        select_identifiable(ctx);
+    }
+}
+
+static void filter_characters(void* ctx, const xmlChar* ch, int len) {
+    FilterReader* reader = reader_of(ctx);
+    if (reader->skipped) return;
+    if (reader->capturing) {
+        if (reader->name_len + (size_t)len + 1 > reader->name_size) {
+            size_t size = (reader->name_len + (size_t)len + 1) * 2;
+            char* name = (char*)realloc(reader->name, size);
+            if (!name) {
+                fail(ctx);
+                return;
+            }
+            reader->name = name;
+            reader->name_size = size;
+        }
+        memcpy(reader->name + reader->name_len, ch, (size_t)len);
+        reader->name_len += (size_t)len;
+    }
+    if (reader->characters) reader->characters(ctx, ch, len);
+}
+
+static void filter_ignorable_whitespace(void* ctx, const xmlChar* ch, int len) {
+    FilterReader* reader = reader_of(ctx);
+    if (reader->skipped) return;
+    if (reader->ignorable_whitespace) reader->ignorable_whitespace(ctx, ch, len);
+}
+
+static void filter_cdata_block(void* ctx, const xmlChar* value, int len) {
+    FilterReader* reader = reader_of(ctx);
+    if (reader->skipped) return;
+    if (reader->cdata_block) reader->cdata_block(ctx, value, len);
+}
+
+static void filter_comment(void* ctx, const xmlChar* value) {
+    FilterReader* reader = reader_of(ctx);
+    if (reader->skipped) return;
+    if (reader->comment) reader->comment(ctx, value);
+}
+
+static void filter_processing_instruction(void* ctx, const xmlChar* target, const xmlChar* data) {
+    FilterReader* reader = reader_of(ctx);
+    if (reader->skipped) return;
+    if (reader->processing_instruction) reader->processing_instruction(ctx, target, data);
+}
+
+static void filter_reference(void* ctx, const xmlChar* name) {
+    FilterReader* reader = reader_of(ctx);
+    if (reader->skipped) return;
+    if (reader->reference) reader->reference(ctx, name);
+}
+
+xmlDocPtr ar_path_filter_parse(const ArPathFilter* filter, xmlParserCtxtPtr ctxt) {
+    FilterReader reader;
+    memset(&reader, 0, sizeof(reader));
+    reader.filter = filter;
+
+    /* Root scope: every pattern at its first segment | 根选择状态：每个模式都位于其第一段 */
+    if (reserve_scope(&reader) < 0) {
+        printf("Error: Memory allocation failed\n");
+        free(reader.scopes);
+        free(reader.states);
+        return NULL;
+    }
+    unsigned char* root = scope_state(&reader, 0);
+    memset(root, 0, (size_t)filter->positions);
+    for (int i = 0; i < filter->count; i++) {
+        root[filter->patterns[i].first] = 1;
+    }
+    close_state(filter, root);
+    reader.scopes[0].included = !filter->has_only;
+    reader.scopes[0].settled = 0;
+    reader.scope_count = 1;
+
+    /* Content handlers are wrapped, the tree is still built by the SAX2 defaults | 包装内容处理函数，文档树仍由SAX2默认处理函数构建 */
+    xmlSAXHandlerPtr sax = ctxt->sax;
+    reader.start_element = sax->startElementNs;
+    reader.end_element = sax->endElementNs;
+    reader.characters = sax->characters;
+    reader.ignorable_whitespace = sax->ignorableWhitespace;
+    reader.cdata_block = sax->cdataBlock;
+    reader.comment = sax->comment;
+    reader.processing_instruction = sax->processingInstruction;
+    reader.reference = sax->reference;
+    sax->startElementNs = filter_start_element;
+    sax->endElementNs = filter_end_element;
+    sax->characters = filter_characters;
+    sax->ignorableWhitespace = filter_ignorable_whitespace;
+    sax->cdataBlock = filter_cdata_block;
+    sax->comment = filter_comment;
+    sax->processingInstruction = filter_processing_instruction;
+    sax->reference = filter_reference;
+    void* previous = ctxt->_private;
+    ctxt->_private = &reader;
+
+    xmlParseDocument(ctxt);
+
+    sax->startElementNs = reader.start_element;
+    sax->endElementNs = reader.end_element;
+    sax->characters = reader.characters;
+    sax->ignorableWhitespace = reader.ignorable_whitespace;
+    sax->cdataBlock = reader.cdata_block;
+    sax->comment = reader.comment;
+    sax->processingInstruction = reader.processing_instruction;
+    sax->reference = reader.reference;
+    ctxt->_private = previous;
+
+    /* Take the document out of ctxt, it holds its own reference to the dictionary | 从ctxt中取出文档，文档持有自己对字典的引用 */
+    xmlDocPtr doc = ctxt->myDoc;
+    ctxt->myDoc = NULL;
+    if (!ctxt->wellFormed || reader.failed) {
+        xmlFreeDoc(doc);
+        doc = NULL;
+    }
+
+    free(reader.frames);
+    free(reader.scopes);
+    free(reader.states);
+    free(reader.name);
+    return doc;
+}
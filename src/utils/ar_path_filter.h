@@ -0,0 +1,33 @@
+#ifndef AR_PATH_FILTER_H
+#define AR_PATH_FILTER_H
+
+#include <libxml/parser.h>
+#include "fs_utils.h"
+
+/* AUTOSAR path patterns selecting what a parse keeps | 决定解析保留哪些内容的AUTOSAR路径模式
+ * A pattern like "/Com/Pdu*" is matched segment by segment: '*', '?' and [a-z] stay inside one segment,
+ * a "**" segment matches any number of AR-PACKAGE segments. A matching element is selected with everything below it.
+ * 如"/Com/Pdu*"的模式按路径段匹配：'*'、'?'和[a-z]只匹配单个段内的字符，"**"段匹配任意数量的AR-PACKAGE路径段；匹配的元素连同其下所有内容一起被选中 */
+typedef struct ArPathFilter ArPathFilter;
+
+/* Compile patterns once, only keeps the identifiables matching one of them (all if empty),
+ * skip drops the ones matching one of them even if only selected them.
+ * Returns NULL if memory allocation fails.
+ * 编译一次模式；only只保留匹配其中之一的可标识元素（为空时全部保留），skip丢弃匹配其中之一的可标识元素，即使only选中了它们；内存分配失败时返回NULL */
+ArPathFilter* ar_path_filter_new(const PathList* only, const PathList* skip);
+
+/* Free compiled patterns | 释放编译后的模式 */
+void ar_path_filter_free(ArPathFilter* filter);
+
+/* Check whether a pattern is a valid AUTOSAR path pattern, e.g. "/Pkg/Swc*" | 检查模式是否为有效的AUTOSAR路径模式，例如"/Pkg/Swc*" */
+int ar_path_pattern_valid(const char* pattern);
+
+/* Parse document with ctxt, whose options are already set, keeping what filter selects.
+ * Identifiables left out are dropped as soon as their SHORT-NAME is read, nothing inside them becomes a node.
+ * Packages on the way to selected elements are kept with their non-identifiable content.
+ * Returns NULL if the document is not well-formed; ctxt is not freed.
+ * 使用已设置选项的ctxt解析文档，只保留filter选中的内容；未选中的可标识元素在读取到其SHORT-NAME时即被丢弃，其内部内容不会创建任何节点；
+ * 通往选中元素的包及其非可标识内容被保留。文档格式不正确时返回NULL；不释放ctxt */
+xmlDocPtr ar_path_filter_parse(const ArPathFilter* filter, xmlParserCtxtPtr ctxt);
+
+#endif /* AR_PATH_FILTER_H */
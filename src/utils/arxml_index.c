@@ -0,0 +1,302 @@
+#include "arxml_index.h"
+#include "arxml_scanner.h"
+#include "hash_utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define ARXML_INDEX_BYTE_ORDER 0x01020304u
+
+/* Sources modified this shortly before indexing may change again within the same mtime second, their hash is checked
+ * 建立索引前刚修改过的源文件可能在同一秒内再次变化，需要校验哈希 */
+#define RECENT_SECONDS 2
+
+/* Entries and paths collected while scanning | 扫描时收集的条目和路径 */
+typedef struct {
+    ArxmlIndexEntry* entries;
+    size_t count;
+    size_t capacity;
+    char* strings;
+    size_t strings_size;
+    size_t strings_capacity;
+    char* containers;         /* Distinct container paths | 不重复的容器路径 */
+    size_t containers_size;
+    size_t containers_capacity;
+} IndexBuilder;
+
+typedef struct {
+    const char* path;
+    size_t entry;
+} SortItem;
+
+/* Append string to growable buffer including NUL | 向可增长缓冲区追加字符串（包括NUL） */
+static int append_string(char** buffer, size_t* size, size_t* capacity, const char* str, size_t len) {
+    if (*size + len + 1 > *capacity) {
+        size_t new_capacity = *capacity ? *capacity : 65536;
+        while (new_capacity < *size + len + 1) new_capacity *= 2;
+        char* new_buffer = (char*)realloc(*buffer, new_capacity);
+        if (!new_buffer) return 0;
+        *buffer = new_buffer;
+        *capacity = new_capacity;
+    }
+    memcpy(*buffer + *size, str, len);
+    (*buffer)[*size + len] = '\0';
+    *size += len + 1;
+    return 1;
+}
+
+/* Get offset of container in distinct list, adding it if new | 获取容器在不重复列表中的偏移，新容器会被加入
+ * Documents use only a handful of containers, so a linear search is enough | 文档中的容器种类很少，线性查找即可 */
+static int intern_container(IndexBuilder* builder, const char* container, size_t len, uint64_t* offset) {
+    size_t pos = 0;
+    while (pos < builder->containers_size) {
+        size_t cur_len = strlen(builder->containers + pos);
+        if (cur_len == len && memcmp(builder->containers + pos, container, len) == 0) {
+            *offset = pos;
+            return 1;
+        }
+        pos += cur_len + 1;
+    }
+    *offset = builder->containers_size;
+    return append_string(&builder->containers, &builder->containers_size, &builder->containers_capacity,
+                         container, len);
+}
+
+/* Scanner callback: record identifiable | 扫描器回调：记录可标识元素 */
+static ArxmlScanResult collect_entry(const ArxmlScanEntry* scan, void* data) {
+    IndexBuilder* builder = (IndexBuilder*)data;
+
+    if (builder->count == builder->capacity) {
+        size_t capacity = builder->capacity ? builder->capacity * 2 : 1024;
+        ArxmlIndexEntry* entries = (ArxmlIndexEntry*)realloc(builder->entries, capacity * sizeof(ArxmlIndexEntry));
+        if (!entries) return ARXML_SCAN_ERROR;
+        builder->entries = entries;
+        builder->capacity = capacity;
+    }
+
+    ArxmlIndexEntry* entry = &builder->entries[builder->count];
+    memset(entry, 0, sizeof(ArxmlIndexEntry));
+    entry->start = scan->start;
+    entry->end = scan->end;
+    entry->path_hash = hash64(scan->path, scan->path_len, 0);
+    entry->path_offset = builder->strings_size;
+    entry->path_len = (uint32_t)scan->path_len;
+    entry->depth = (uint32_t)scan->depth;
+    entry->container_len = (uint32_t)scan->container_len;
+    if (!intern_container(builder, scan->container, scan->container_len, &entry->container_offset) ||
+        !append_string(&builder->strings, &builder->strings_size, &builder->strings_capacity,
+                       scan->path, scan->path_len)) {
+        return ARXML_SCAN_ERROR;
+    }
+    builder->count++;
+    return ARXML_SCAN_CONTINUE;
+}
+
+/* Order by path, then by position in source | 先按路径排序，再按在源文件中的位置排序 */
+static int compare_sort_items(const void* a, const void* b) {
+    const SortItem* item_a = (const SortItem*)a;
+    const SortItem* item_b = (const SortItem*)b;
+    int result = strcmp(item_a->path, item_b->path);
+    if (result != 0) return result;
+    return item_a->entry < item_b->entry ? -1 : (item_a->entry > item_b->entry ? 1 : 0);
+}
+
+/* Write sorted entries, buckets and strings | 写出排序后的条目、哈希桶和字符串 */
+static int write_index(FILE* file, ArxmlIndexHeader* header, const IndexBuilder* builder, const SortItem* items) {
+    uint64_t bucket_count = 16;
+    while (bucket_count < builder->count * 2) bucket_count *= 2;
+    uint32_t* buckets = (uint32_t*)calloc((size_t)bucket_count, sizeof(uint32_t));
+    if (!buckets) return 0;
+
+    header->entry_count = builder->count;
+    header->bucket_count = bucket_count;
+    header->strings_size = builder->strings_size + builder->containers_size;
+    int ok = fwrite(header, sizeof(ArxmlIndexHeader), 1, file) == 1;
+
+    /* Strings are rewritten in sorted order | 字符串按排序后的顺序重新写出 */
+    uint64_t offset = 0;
+    for (size_t i = 0; ok && i < builder->count; i++) {
+        ArxmlIndexEntry entry = builder->entries[items[i].entry];
+        entry.path_offset = offset;
+        entry.container_offset += builder->strings_size;  /* Containers follow paths | 容器字符串位于路径之后 */
+        offset += entry.path_len + 1;
+        ok = fwrite(&entry, sizeof(entry), 1, file) == 1;
+
+        /* Only the first of equal paths goes into the hash | 相同路径只有第一个进入哈希表 */
+        if (i > 0 && strcmp(items[i - 1].path, items[i].path) == 0) continue;
+        uint64_t slot = entry.path_hash & (bucket_count - 1);
+        while (buckets[slot] != 0) slot = (slot + 1) & (bucket_count - 1);
+        buckets[slot] = (uint32_t)(i + 1);
+    }
+    if (ok) {
+        ok = fwrite(buckets, sizeof(uint32_t), (size_t)bucket_count, file) == bucket_count;
+    }
+    for (size_t i = 0; ok && i < builder->count; i++) {
+        const ArxmlIndexEntry* entry = &builder->entries[items[i].entry];
+        ok = fwrite(items[i].path, 1, entry->path_len + 1, file) == entry->path_len + 1;
+    }
+    if (ok && builder->containers_size > 0) {
+        ok = fwrite(builder->containers, 1, builder->containers_size, file) == builder->containers_size;
+    }
+    free(buckets);
+    return ok;
+}
+
+/* Get sidecar index path of source | 获取源文件的旁路索引路径 */
+char* arxml_index_sidecar_path(const char* source_path) {
+    size_t size = strlen(source_path) + sizeof(ARXML_INDEX_SUFFIX);
+    char* index_path = (char*)malloc(size);
+    if (index_path) {
+        snprintf(index_path, size, "%s%s", source_path, ARXML_INDEX_SUFFIX);
+    }
+    return index_path;
+}
+
+/* Scan source and write index file | 扫描源文件并写出索引文件 */
+int arxml_index_build(const char* source_path, const char* index_path, uint64_t* entry_count) {
+    MappedFile source;
+    IndexBuilder builder;
+    ArxmlIndexHeader header;
+    int64_t mtime = 0;
+
+    if (!get_file_mtime(source_path, &mtime) || !map_file(source_path, &source)) {
+        return 0;
+    }
+    memset(&builder, 0, sizeof(builder));
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, ARXML_INDEX_MAGIC, sizeof(ARXML_INDEX_MAGIC));
+    header.version = ARXML_INDEX_VERSION;
+    header.byte_order = ARXML_INDEX_BYTE_ORDER;
+    header.source_size = source.size;
+    header.source_mtime = mtime;
+    header.indexed_time = (int64_t)time(NULL);
+    header.source_hash = hash64(source.data, (size_t)source.size, 0);
+
+    ArxmlScanHandler handler = {NULL, collect_entry, NULL, NULL, 0};
+    int ok = source.size > 0 && arxml_scan(source.data, (size_t)source.size, &handler, &builder);
+    unmap_file(&source);
+
+    SortItem* items = NULL;
+    if (ok && builder.count > 0) {
+        items = (SortItem*)malloc(builder.count * sizeof(SortItem));
+        ok = items != NULL;
+    }
+    if (ok) {
+        for (size_t i = 0; i < builder.count; i++) {
+            items[i].path = builder.strings + builder.entries[i].path_offset;
+            items[i].entry = i;
+        }
+        qsort(items, builder.count, sizeof(SortItem), compare_sort_items);
+    }
+
+    /* Write to temporary file, then replace index atomically | 先写临时文件，再原子替换索引 */
+    if (ok) {
+        size_t tmp_len = strlen(index_path) + 5;
+        char* tmp_path = (char*)malloc(tmp_len);
+        FILE* file = NULL;
+        if (tmp_path) {
+            snprintf(tmp_path, tmp_len, "%s.tmp", index_path);
+            file = fopen(tmp_path, "wb");
+        }
+        ok = file != NULL;
+        if (ok) {
+            ok = write_index(file, &header, &builder, items);
+            if (fclose(file) != 0) ok = 0;
+#ifdef _WIN32
+            if (ok) remove(index_path);
+#endif
+            if (ok && rename(tmp_path, index_path) != 0) ok = 0;
+            if (!ok) remove(tmp_path);
+        }
+        free(tmp_path);
+    }
+
+    if (ok && entry_count) {
+        *entry_count = builder.count;
+    }
+    free(items);
+    free(builder.entries);
+    free(builder.strings);
+    free(builder.containers);
+    return ok;
+}
+
+/* Open index and validate it against source | 打开索引并根据源文件校验 */
+ArxmlIndexStatus arxml_index_open(const char* index_path, const char* source_path, ArxmlIndex* index) {
+    memset(index, 0, sizeof(ArxmlIndex));
+    if (!map_file(index_path, &index->file)) {
+        return ARXML_INDEX_MISSING;
+    }
+
+    /* Check structure before trusting any offset | 在使用任何偏移之前先检查结构 */
+    const ArxmlIndexHeader* header = (const ArxmlIndexHeader*)index->file.data;
+    uint64_t size = index->file.size;
+    if (size < sizeof(ArxmlIndexHeader) ||
+        memcmp(header->magic, ARXML_INDEX_MAGIC, sizeof(ARXML_INDEX_MAGIC)) != 0 ||
+        header->version != ARXML_INDEX_VERSION || header->byte_order != ARXML_INDEX_BYTE_ORDER ||
+        header->entry_count > size / sizeof(ArxmlIndexEntry) || header->bucket_count > size / sizeof(uint32_t) ||
+        header->bucket_count <= header->entry_count || (header->bucket_count & (header->bucket_count - 1)) != 0 ||
+        sizeof(ArxmlIndexHeader) + header->entry_count * sizeof(ArxmlIndexEntry) +
+            header->bucket_count * sizeof(uint32_t) + header->strings_size != size) {
+        arxml_index_close(index);
+        return ARXML_INDEX_INVALID;
+    }
+    index->header = header;
+    index->entries = (const ArxmlIndexEntry*)(index->file.data + sizeof(ArxmlIndexHeader));
+    index->buckets = (const uint32_t*)(index->entries + header->entry_count);
+    index->strings = (const char*)(index->buckets + header->bucket_count);
+
+    if (source_path) {
+        uint64_t source_size = 0;
+        int64_t mtime = 0;
+        uint64_t hash = 0;
+        int recent = header->indexed_time - header->source_mtime < RECENT_SECONDS;
+        if (!get_file_size(source_path, &source_size) || source_size != header->source_size ||
+            !get_file_mtime(source_path, &mtime) ||
+            ((mtime != header->source_mtime || recent) && (!hash_file(source_path, &hash) || hash != header->source_hash))) {
+            arxml_index_close(index);
+            return ARXML_INDEX_STALE;
+        }
+    }
+    return ARXML_INDEX_OK;
+}
+
+/* Close index | 关闭索引 */
+void arxml_index_close(ArxmlIndex* index) {
+    unmap_file(&index->file);
+    memset(index, 0, sizeof(ArxmlIndex));
+}
+
+/* Look up first entry with path | 查找指定路径的第一个条目 */
+const ArxmlIndexEntry* arxml_index_lookup(const ArxmlIndex* index, const char* path, size_t path_len) {
+    uint64_t mask = index->header->bucket_count - 1;
+    uint64_t hash = hash64(path, path_len, 0);
+
+    for (uint64_t slot = hash & mask, probes = 0; probes <= mask; slot = (slot + 1) & mask, probes++) {
+        uint32_t number = index->buckets[slot];
+        if (number == 0 || number > index->header->entry_count) {
+            return NULL;
+        }
+        const ArxmlIndexEntry* entry = &index->entries[number - 1];
+        if (entry->path_hash == hash && entry->path_len == path_len &&
+            entry->path_offset + path_len < index->header->strings_size &&
+            memcmp(index->strings + entry->path_offset, path, path_len) == 0) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+/* Get NUL terminated path of entry | 获取条目的以NUL结尾的路径 */
+const char* arxml_index_entry_path(const ArxmlIndex* index, const ArxmlIndexEntry* entry) {
+    return index->strings + entry->path_offset;
+}
+
+/* Get NUL terminated container path of entry | 获取条目的以NUL结尾的容器路径 */
+const char* arxml_index_entry_container(const ArxmlIndex* index, const ArxmlIndexEntry* entry) {
+    if (entry->container_offset + entry->container_len >= index->header->strings_size) {
+        return "";
+    }
+    return index->strings + entry->container_offset;
+}
@@ -0,0 +1,86 @@
+#ifndef ARXML_INDEX_H
+#define ARXML_INDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "fs_utils.h"
+
+/* Sidecar index mapping AUTOSAR paths to byte ranges of a source file | 将AUTOSAR路径映射到源文件字节范围的旁路索引
+ * Layout (host byte order, every part 8 byte aligned) | 布局（主机字节序，各部分8字节对齐）:
+ *   header | entries sorted by path | hash buckets | path and container strings
+ *   文件头 | 按路径排序的条目 | 哈希桶 | 路径和容器字符串
+ * The file is used in place through mmap, nothing is loaded or rebuilt.
+ * 文件通过mmap直接使用，不需要加载或重建 */
+#define ARXML_INDEX_MAGIC "ARXIDX1"
+#define ARXML_INDEX_VERSION 3
+#define ARXML_INDEX_SUFFIX ".idx"
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;      /* 0x01020304 as written | 写入时的0x01020304 */
+    uint64_t source_size;
+    int64_t source_mtime;
+    int64_t indexed_time;     /* When the index was built, seconds | 建立索引的时间（秒） */
+    uint64_t source_hash;     /* XXH64 of source file | 源文件的XXH64 */
+    uint64_t entry_count;
+    uint64_t bucket_count;    /* Power of two | 2的幂 */
+    uint64_t strings_size;
+} ArxmlIndexHeader;
+
+typedef struct {
+    uint64_t start;           /* Offset of start tag | 开始标签的偏移 */
+    uint64_t end;             /* Offset after end tag | 结束标签之后的偏移 */
+    uint64_t path_hash;
+    uint64_t path_offset;     /* Offset in strings | 在字符串区中的偏移 */
+    uint64_t container_offset;
+    uint32_t path_len;
+    uint32_t depth;           /* Number of path segments | 路径段数 */
+    uint32_t container_len;   /* Tags between parent identifiable and element, e.g. "ELEMENTS" | 父可标识元素与该元素之间的标签，例如"ELEMENTS" */
+    uint32_t reserved;
+} ArxmlIndexEntry;
+
+/* Opened index, all pointers refer to the mapping | 已打开的索引，所有指针都指向映射内存 */
+typedef struct {
+    MappedFile file;
+    const ArxmlIndexHeader* header;
+    const ArxmlIndexEntry* entries;
+    const uint32_t* buckets;  /* Entry number + 1, 0 for empty | 条目编号+1，0表示空 */
+    const char* strings;
+} ArxmlIndex;
+
+typedef enum {
+    ARXML_INDEX_OK = 0,
+    ARXML_INDEX_MISSING,      /* No index file | 没有索引文件 */
+    ARXML_INDEX_INVALID,      /* Not an index or corrupt | 不是索引文件或已损坏 */
+    ARXML_INDEX_STALE         /* Source changed since indexing | 建立索引后源文件已改变 */
+} ArxmlIndexStatus;
+
+/* Get sidecar index path of source, "<source>.idx" | 获取源文件的旁路索引路径"<source>.idx"
+ * Caller frees it, NULL if out of memory | 由调用者释放，内存不足时返回NULL */
+char* arxml_index_sidecar_path(const char* source_path);
+
+/* Scan source and write index file | 扫描源文件并写出索引文件
+ * Returns 1 on success, 0 on error; entry_count may be NULL | 成功返回1，出错返回0；entry_count可为NULL */
+int arxml_index_build(const char* source_path, const char* index_path, uint64_t* entry_count);
+
+/* Open index and validate it against source size, mtime and hash | 打开索引并根据源文件大小、修改时间和哈希校验
+ * Hash is only computed when mtime differs or the source was modified just before indexing,
+ * then a rewrite within the same mtime second is possible; source_path NULL skips validation.
+ * 仅当修改时间不同或源文件在建立索引前刚被修改时才计算哈希，后者可能在同一秒内被再次改写；source_path为NULL时跳过校验 */
+ArxmlIndexStatus arxml_index_open(const char* index_path, const char* source_path, ArxmlIndex* index);
+
+/* Close index opened by arxml_index_open | 关闭arxml_index_open打开的索引 */
+void arxml_index_close(ArxmlIndex* index);
+
+/* Look up first entry with path, NULL if not found | 查找指定路径的第一个条目，未找到时返回NULL
+ * Further entries with the same path follow it in the sorted array | 同一路径的其他条目在排序数组中紧随其后 */
+const ArxmlIndexEntry* arxml_index_lookup(const ArxmlIndex* index, const char* path, size_t path_len);
+
+/* Get NUL terminated path of entry | 获取条目的以NUL结尾的路径 */
+const char* arxml_index_entry_path(const ArxmlIndex* index, const ArxmlIndexEntry* entry);
+
+/* Get NUL terminated container path of entry | 获取条目的以NUL结尾的容器路径 */
+const char* arxml_index_entry_container(const ArxmlIndex* index, const ArxmlIndexEntry* entry);
+
+#endif /* ARXML_INDEX_H */
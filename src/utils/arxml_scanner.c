@@ -0,0 +1,396 @@
+#include "arxml_scanner.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* Open element on scanner stack | 扫描器栈上的打开元素 */
+typedef struct {
+    const char* tag;
+    size_t tag_len;
+    uint64_t start;
+    size_t path_len;      /* Path length to restore when element closes | 元素结束时恢复的路径长度 */
+    int depth;            /* Path depth to restore when element closes | 元素结束时恢复的路径深度 */
+    int identifiable;
+    const char* attributes;
+    size_t attributes_len;
+    const char* content;  /* First byte after start tag | 开始标签之后的第一个字节 */
+} ScanFrame;
+
+typedef struct {
+    ScanFrame* frames;
+    int count;
+    int capacity;
+    char* path;
+    size_t path_len;
+    size_t path_capacity;
+    int depth;
+    int skip_below;       /* Frame count at which callbacks resume, 0 if none skipped | 恢复回调的栈深度，0表示未跳过 */
+    char* container;
+    size_t container_capacity;
+    const ArxmlScanHandler* handler;
+    void* user_data;
+    const char* data;
+    uint64_t line_offset; /* Lines are counted up to here | 行号已统计到此处 */
+    long line;
+} ScanState;
+
+static int is_name_end(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '/' || c == '>';
+}
+
+/* Find end of construct, returns pointer after terminator or NULL | 查找结构的结尾，返回终止符之后的位置，未找到返回NULL */
+static const char* find_terminator(const char* p, const char* end, const char* terminator) {
+    size_t len = strlen(terminator);
+    while (p + len <= end) {
+        const char* hit = (const char*)memchr(p, terminator[0], (size_t)(end - p));
+        if (!hit || hit + len > end) {
+            return NULL;
+        }
+        if (memcmp(hit, terminator, len) == 0) {
+            return hit + len;
+        }
+        p = hit + 1;
+    }
+    return NULL;
+}
+
+/* Find '>' closing a tag, skipping quoted attribute values | 查找标签结尾的'>'，跳过引号中的属性值 */
+static const char* find_tag_end(const char* p, const char* end) {
+    while (p < end) {
+        if (*p == '"' || *p == '\'') {
+            const char* quote = (const char*)memchr(p + 1, *p, (size_t)(end - p - 1));
+            if (!quote) return NULL;
+            p = quote + 1;
+        } else if (*p == '>') {
+            return p;
+        } else {
+            p++;
+        }
+    }
+    return NULL;
+}
+
+/* Skip DOCTYPE including internal subset | 跳过DOCTYPE及其内部子集 */
+static const char* skip_doctype(const char* p, const char* end) {
+    int bracket = 0;
+    while (p < end) {
+        if (*p == '[') bracket++;
+        else if (*p == ']') bracket--;
+        else if (*p == '>' && bracket <= 0) return p + 1;
+        p++;
+    }
+    return NULL;
+}
+
+/* Count newlines in range | 统计范围内的换行符数量 */
+static long count_newlines(const char* p, const char* end) {
+    long count = 0;
+    while (p < end && (p = (const char*)memchr(p, '\n', (size_t)(end - p))) != NULL) {
+        count++;
+        p++;
+    }
+    return count;
+}
+
+/* Get line of offset, counting only from the previous offset | 获取偏移所在行，只从上一次的偏移开始统计
+ * Offsets almost always increase, so the whole scan counts each byte about once | 偏移几乎总是递增，因此整个扫描中每个字节大约只统计一次 */
+static long line_at(ScanState* state, uint64_t offset) {
+    if (offset >= state->line_offset) {
+        state->line += count_newlines(state->data + state->line_offset, state->data + offset);
+    } else {
+        state->line -= count_newlines(state->data + offset, state->data + state->line_offset);
+    }
+    state->line_offset = offset;
+    return state->line;
+}
+
+static int push_frame(ScanState* state, const char* tag, size_t tag_len, uint64_t start) {
+    if (state->count == state->capacity) {
+        int capacity = state->capacity ? state->capacity * 2 : 64;
+        ScanFrame* frames = (ScanFrame*)realloc(state->frames, (size_t)capacity * sizeof(ScanFrame));
+        if (!frames) return 0;
+        state->frames = frames;
+        state->capacity = capacity;
+    }
+    ScanFrame* frame = &state->frames[state->count++];
+    frame->tag = tag;
+    frame->tag_len = tag_len;
+    frame->start = start;
+    frame->path_len = state->path_len;
+    frame->depth = state->depth;
+    frame->identifiable = 0;
+    frame->attributes = NULL;
+    frame->attributes_len = 0;
+    frame->content = NULL;
+    return 1;
+}
+
+/* Append "/name" to current path | 向当前路径追加"/name" */
+static int append_segment(ScanState* state, const char* name, size_t len) {
+    size_t needed = state->path_len + len + 2;
+    if (needed > state->path_capacity) {
+        size_t capacity = state->path_capacity;
+        while (capacity < needed) capacity *= 2;
+        char* path = (char*)realloc(state->path, capacity);
+        if (!path) return 0;
+        state->path = path;
+        state->path_capacity = capacity;
+    }
+    state->path[state->path_len++] = '/';
+    memcpy(state->path + state->path_len, name, len);
+    state->path_len += len;
+    state->path[state->path_len] = '\0';
+    state->depth++;
+    return 1;
+}
+
+/* Build container path of element at frame index | 构建栈中指定位置元素的容器路径 */
+static int build_container(ScanState* state, int frame_index, size_t* length) {
+    size_t needed = 1;
+    int first = frame_index;
+    while (first > 1 && !state->frames[first - 1].identifiable) {
+        first--;
+        needed += state->frames[first].tag_len + 1;
+    }
+    if (needed > state->container_capacity) {
+        size_t capacity = state->container_capacity ? state->container_capacity : 256;
+        while (capacity < needed) capacity *= 2;
+        char* container = (char*)realloc(state->container, capacity);
+        if (!container) return 0;
+        state->container = container;
+        state->container_capacity = capacity;
+    }
+
+    size_t len = 0;
+    for (int i = first; i < frame_index; i++) {
+        if (len > 0) state->container[len++] = '/';
+        memcpy(state->container + len, state->frames[i].tag, state->frames[i].tag_len);
+        len += state->frames[i].tag_len;
+    }
+    state->container[len] = '\0';
+    *length = len;
+    return 1;
+}
+
+/* Report element at frame index to callback | 将栈中指定位置的元素报告给回调 */
+static ArxmlScanResult report(ScanState* state, ArxmlScanCallback callback, int frame_index, uint64_t end,
+                              const char* text, size_t text_len, int with_line) {
+    ArxmlScanEntry entry;
+    const ScanFrame* frame = &state->frames[frame_index];
+    if (!build_container(state, frame_index, &entry.container_len)) return ARXML_SCAN_ERROR;
+    entry.attributes = frame->attributes;
+    entry.attributes_len = frame->attributes_len;
+    entry.text = text;
+    entry.text_len = text_len;
+    entry.line = with_line && state->handler->track_lines ? line_at(state, frame->start) : 0;
+    entry.path = state->path;
+    entry.path_len = state->path_len;
+    entry.container = state->container;
+    entry.tag = frame->tag;
+    entry.tag_len = frame->tag_len;
+    entry.start = frame->start;
+    entry.end = end;
+    entry.depth = state->depth;
+    entry.level = frame_index + 1;
+    return callback(&entry, state->user_data);
+}
+
+/* Report any element to on_element, cheap enough for every element | 将任意元素报告给on_element，开销足够小，可用于每个元素 */
+static ArxmlScanResult report_element(ScanState* state, const char* tag, size_t tag_len, uint64_t start, uint64_t end,
+                                      const char* attributes, size_t attributes_len, int level) {
+    ArxmlScanEntry entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.path = state->path;
+    entry.path_len = state->path_len;
+    entry.container = "";
+    entry.tag = tag;
+    entry.tag_len = tag_len;
+    entry.start = start;
+    entry.end = end;
+    entry.depth = state->depth;
+    entry.attributes = attributes;
+    entry.attributes_len = attributes_len;
+    entry.level = level;
+    return state->handler->on_element(&entry, state->user_data);
+}
+
+/* Handle SHORT-NAME text, making its parent identifiable | 处理SHORT-NAME文本，使其父元素成为可标识元素 */
+static ArxmlScanResult handle_short_name(ScanState* state, const char* text, const char* end) {
+    if (state->count < 2 || state->frames[state->count - 2].identifiable) {
+        return ARXML_SCAN_CONTINUE;  /* Not the naming child of an element | 不是元素的命名子元素 */
+    }
+    const char* text_end = (const char*)memchr(text, '<', (size_t)(end - text));
+    if (!text_end) return ARXML_SCAN_ERROR;
+    while (text < text_end && (*text == ' ' || *text == '\t' || *text == '\r' || *text == '\n')) text++;
+    while (text_end > text && (text_end[-1] == ' ' || text_end[-1] == '\t' ||
+                               text_end[-1] == '\r' || text_end[-1] == '\n')) text_end--;
+
+    if (!append_segment(state, text, (size_t)(text_end - text))) return ARXML_SCAN_ERROR;
+    state->frames[state->count - 2].identifiable = 1;
+    /* SHORT-NAME itself must not undo the new segment | SHORT-NAME自身结束时不能撤销新的路径段 */
+    state->frames[state->count - 1].path_len = state->path_len;
+    state->frames[state->count - 1].depth = state->depth;
+
+    if (state->handler->on_open) {
+        ArxmlScanResult result = report(state, state->handler->on_open, state->count - 2, 0, NULL, 0, 1);
+        if (result == ARXML_SCAN_SKIP) {
+            state->skip_below = state->count - 1;
+            return ARXML_SCAN_CONTINUE;
+        }
+        return result;
+    }
+    return ARXML_SCAN_CONTINUE;
+}
+
+/* Scan ARXML bytes without building a tree | 不构建文档树直接扫描ARXML数据 */
+int arxml_scan(const char* data, size_t size, const ArxmlScanHandler* handler, void* user_data) {
+    const char* p = data;
+    const char* end = data + size;
+    ScanState state;
+    ArxmlScanResult result = ARXML_SCAN_CONTINUE;
+    int ok = 1;
+
+    memset(&state, 0, sizeof(state));
+    state.handler = handler;
+    state.user_data = user_data;
+    state.data = data;
+    state.line = 1;
+    state.path_capacity = 256;
+    state.path = (char*)malloc(state.path_capacity);
+    if (!state.path) return 0;
+    state.path[0] = '\0';
+
+    while (ok && result != ARXML_SCAN_STOP && p < end) {
+        const char* lt = (const char*)memchr(p, '<', (size_t)(end - p));
+        if (!lt) break;
+        if (lt + 1 >= end) { ok = 0; break; }
+
+        if (lt[1] == '?') {
+            p = find_terminator(lt + 2, end, "?>");
+        } else if (lt[1] == '!') {
+            if (end - lt >= 4 && memcmp(lt, "<!--", 4) == 0) {
+                p = find_terminator(lt + 4, end, "-->");
+            } else if (end - lt >= 9 && memcmp(lt, "<![CDATA[", 9) == 0) {
+                p = find_terminator(lt + 9, end, "]]>");
+            } else {
+                p = skip_doctype(lt + 2, end);
+            }
+        } else if (lt[1] == '/') {
+            /* End tag | 结束标签 */
+            const char* name = lt + 2;
+            const char* gt = (const char*)memchr(name, '>', (size_t)(end - name));
+            if (!gt || state.count == 0) { ok = 0; break; }
+            const char* name_end = name;
+            while (name_end < gt && !is_name_end(*name_end)) name_end++;
+
+            ScanFrame* frame = &state.frames[state.count - 1];
+            if ((size_t)(name_end - name) != frame->tag_len || memcmp(name, frame->tag, frame->tag_len) != 0) {
+                ok = 0;
+                break;
+            }
+            if (state.skip_below > 0 && state.count <= state.skip_below) {
+                state.skip_below = 0;  /* Left skipped element | 已离开被跳过的元素 */
+            }
+            if (state.skip_below == 0) {
+                if (frame->identifiable && handler->on_close) {
+                    result = report(&state, handler->on_close, state.count - 1, (uint64_t)(gt + 1 - data), NULL, 0, 0);
+                } else if (!frame->identifiable && handler->on_leaf &&
+                           !memchr(frame->content, '<', (size_t)(lt - frame->content))) {
+                    result = report(&state, handler->on_leaf, state.count - 1, (uint64_t)(gt + 1 - data),
+                                    frame->content, (size_t)(lt - frame->content), 1);
+                }
+                if (handler->on_element && result != ARXML_SCAN_ERROR && result != ARXML_SCAN_STOP) {
+                    result = report_element(&state, frame->tag, frame->tag_len, frame->start, (uint64_t)(gt + 1 - data),
+                                            frame->attributes, frame->attributes_len, state.count);
+                }
+                if (result == ARXML_SCAN_ERROR) { ok = 0; break; }
+            }
+            state.count--;
+            state.path_len = frame->path_len;
+            state.path[state.path_len] = '\0';
+            state.depth = frame->depth;
+            p = gt + 1;
+        } else {
+            /* Start tag | 开始标签 */
+            const char* name = lt + 1;
+            const char* name_end = name;
+            while (name_end < end && !is_name_end(*name_end)) name_end++;
+            const char* gt = find_tag_end(name_end, end);
+            if (!gt) { ok = 0; break; }
+            p = gt + 1;
+            if (gt[-1] == '/') {
+                /* Empty element | 空元素 */
+                if (handler->on_element && state.skip_below == 0) {
+                    result = report_element(&state, name, (size_t)(name_end - name), (uint64_t)(lt - data),
+                                            (uint64_t)(gt + 1 - data), name_end, (size_t)(gt - 1 - name_end),
+                                            state.count + 1);
+                    if (result == ARXML_SCAN_ERROR) ok = 0;
+                }
+                continue;
+            }
+            if (!push_frame(&state, name, (size_t)(name_end - name), (uint64_t)(lt - data))) { ok = 0; break; }
+            state.frames[state.count - 1].attributes = name_end;
+            state.frames[state.count - 1].attributes_len = (size_t)(gt - name_end);
+            state.frames[state.count - 1].content = p;
+            if (state.skip_below == 0 && name_end - name == 10 && memcmp(name, "SHORT-NAME", 10) == 0) {
+                result = handle_short_name(&state, p, end);
+                if (result == ARXML_SCAN_ERROR) ok = 0;
+            }
+        }
+        if (!p) ok = 0;
+    }
+
+    if (state.count != 0 && result != ARXML_SCAN_STOP) {
+        ok = 0;  /* Unclosed elements | 存在未关闭的元素 */
+    }
+    free(state.frames);
+    free(state.path);
+    free(state.container);
+    return ok;
+}
+
+/* Find attribute value in attribute text | 在属性文本中查找属性值 */
+int arxml_scan_attribute(const char* attributes, size_t len, const char* name, const char** value, size_t* value_len) {
+    const char* p = attributes;
+    const char* end = attributes + len;
+    size_t name_len = strlen(name);
+
+    while (p < end) {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) p++;
+        const char* attr = p;
+        while (p < end && *p != '=' && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n') p++;
+        size_t attr_len = (size_t)(p - attr);
+        while (p < end && *p != '"' && *p != '\'') p++;
+        if (p >= end) return 0;
+        const char* quote = (const char*)memchr(p + 1, *p, (size_t)(end - p - 1));
+        if (!quote) return 0;
+        if (attr_len == name_len && memcmp(attr, name, name_len) == 0) {
+            *value = p + 1;
+            *value_len = (size_t)(quote - p - 1);
+            return 1;
+        }
+        p = quote + 1;
+    }
+    return 0;
+}
+
+/* Find first element start tag | 查找第一个元素的开始标签 */
+const char* arxml_find_root_tag(const char* data, size_t size, const char** tag_end) {
+    const char* p = data;
+    const char* end = data + size;
+    while (p && p < end) {
+        const char* lt = (const char*)memchr(p, '<', (size_t)(end - p));
+        if (!lt || lt + 1 >= end) return NULL;
+        if (lt[1] == '?') {
+            p = find_terminator(lt + 2, end, "?>");
+        } else if (lt[1] == '!') {
+            p = (end - lt >= 4 && memcmp(lt, "<!--", 4) == 0) ? find_terminator(lt + 4, end, "-->")
+                                                              : skip_doctype(lt + 2, end);
+        } else {
+            const char* gt = find_tag_end(lt + 1, end);
+            if (!gt) return NULL;
+            *tag_end = gt + 1;
+            return lt;
+        }
+    }
+    return NULL;
+}
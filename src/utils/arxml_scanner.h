@@ -0,0 +1,64 @@
+#ifndef ARXML_SCANNER_H
+#define ARXML_SCANNER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Identifiable element found by scanner | 扫描器找到的可标识元素
+ * Strings are valid during the callback only | 字符串仅在回调期间有效 */
+typedef struct {
+    const char* path;       /* NUL terminated AUTOSAR path | 以NUL结尾的AUTOSAR路径 */
+    size_t path_len;
+    const char* container;  /* Tags between parent identifiable and element, e.g. "ELEMENTS" | 父可标识元素与该元素之间的标签，例如"ELEMENTS" */
+    size_t container_len;
+    const char* tag;        /* Tag name in source, not NUL terminated | 源数据中的标签名，不以NUL结尾 */
+    size_t tag_len;
+    uint64_t start;         /* Offset of '<' of start tag | 开始标签'<'的偏移 */
+    uint64_t end;           /* Offset after '>' of end tag, 0 when opening | 结束标签'>'之后的偏移，打开时为0 */
+    int depth;              /* Number of path segments | 路径段数 */
+    const char* attributes; /* Attribute text of start tag, not NUL terminated | 开始标签的属性文本，不以NUL结尾 */
+    size_t attributes_len;
+    const char* text;       /* Raw text of leaf elements, NULL otherwise | 叶子元素的原始文本，其他情况为NULL */
+    size_t text_len;
+    long line;              /* 1-based line of start tag if lines are tracked, else 0 | 跟踪行号时为开始标签所在行（从1开始），否则为0 */
+    int level;              /* Element nesting, root element is 1 | 元素嵌套层级，根元素为1 */
+} ArxmlScanEntry;
+
+/* Callback results | 回调返回值 */
+typedef enum {
+    ARXML_SCAN_ERROR = 0,     /* Abort, arxml_scan fails | 中止，arxml_scan返回失败 */
+    ARXML_SCAN_CONTINUE = 1,
+    ARXML_SCAN_SKIP = 2,      /* From on_open: no callbacks inside element | 在on_open中返回：不再回调元素内部 */
+    ARXML_SCAN_STOP = 3       /* Finish early, arxml_scan succeeds | 提前结束，arxml_scan返回成功 */
+} ArxmlScanResult;
+
+typedef ArxmlScanResult (*ArxmlScanCallback)(const ArxmlScanEntry* entry, void* user_data);
+
+/* Callbacks of a scan, any may be NULL | 扫描回调，均可为NULL */
+typedef struct {
+    ArxmlScanCallback on_open;   /* After SHORT-NAME of identifiable is read | 读取到可标识元素的SHORT-NAME后 */
+    ArxmlScanCallback on_close;  /* When identifiable element ends | 可标识元素结束时 */
+    ArxmlScanCallback on_leaf;   /* When element without child elements ends, path is the enclosing identifiable
+                                  * 无子元素的元素结束时，路径为其所在的可标识元素 */
+    ArxmlScanCallback on_element; /* When any element ends, including empty ones; container is not filled
+                                   * 任意元素（包括空元素）结束时；不填写容器路径 */
+    int track_lines;             /* Fill line for on_open and on_leaf | 为on_open和on_leaf填写行号 */
+} ArxmlScanHandler;
+
+/* Scan ARXML bytes without building a tree | 不构建文档树直接扫描ARXML数据
+ * Tracks SHORT-NAMEs to know the AUTOSAR path of every element, far faster than a full parse.
+ * Container paths leave out the document root element.
+ * 跟踪SHORT-NAME以得到每个元素的AUTOSAR路径，比完整解析快得多；容器路径不包含文档根元素
+ * Returns 1 on success or early stop, 0 if document is malformed or a callback failed
+ * 成功或提前结束时返回1，文档格式错误或回调失败时返回0 */
+int arxml_scan(const char* data, size_t size, const ArxmlScanHandler* handler, void* user_data);
+
+/* Find attribute value in attribute text | 在属性文本中查找属性值
+ * Returns 1 and the raw value if found, 0 otherwise | 找到时返回1和原始值，否则返回0 */
+int arxml_scan_attribute(const char* attributes, size_t len, const char* name, const char** value, size_t* value_len);
+
+/* Find first element start tag, returns its '<' or NULL | 查找第一个元素的开始标签，返回其'<'位置或NULL
+ * tag_end receives the position after its '>' | tag_end接收其'>'之后的位置 */
+const char* arxml_find_root_tag(const char* data, size_t size, const char** tag_end);
+
+#endif /* ARXML_SCANNER_H */
@@ -0,0 +1,692 @@
+#include "arxml_snapshot.h"
+#include "hash_utils.h"
+#include "xml_utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <libxml/parser.h>
+
+#define ARXML_SNAPSHOT_BYTE_ORDER 0x01020304u
+
+/* Counts stay below the two reserved numbers | 数量始终小于两个保留编号 */
+#define SNAPSHOT_MAX_COUNT 0xFFFFFFF0u
+
+/* Parse options of the merge base | merge基础文件的解析选项 */
+#define SNAPSHOT_PARSE_OPTIONS (XML_PARSE_NOBLANKS | XML_PARSE_COMPACT)
+
+/* Tables collected while walking the tree | 遍历文档树时收集的表 */
+typedef struct {
+    ArxmlSnapshotNode* nodes;
+    size_t node_count;
+    size_t node_capacity;
+    ArxmlSnapshotAttr* attrs;
+    size_t attr_count;
+    size_t attr_capacity;
+    ArxmlSnapshotNs* namespaces;
+    xmlNsPtr* ns_sources;     /* Declaration of each namespace, to number references | 每个命名空间的声明，用于为引用编号 */
+    size_t ns_count;
+    size_t ns_capacity;
+    uint64_t* string_offsets;
+    size_t string_count;
+    size_t string_capacity;
+    char* strings;
+    size_t strings_size;
+    size_t strings_capacity;
+    uint32_t* buckets;        /* String number + 1, 0 for empty | 字符串编号+1，0表示空 */
+    size_t bucket_count;      /* Power of two | 2的幂 */
+} SnapshotBuilder;
+
+/* Offsets of the parts after the header | 文件头之后各部分的偏移 */
+typedef struct {
+    uint64_t attrs;
+    uint64_t namespaces;
+    uint64_t string_offsets;
+    uint64_t strings;
+    uint64_t end;
+} SnapshotLayout;
+
+static uint64_t align8(uint64_t size) {
+    return (size + 7) & ~(uint64_t)7;
+}
+
+static SnapshotLayout snapshot_layout(const ArxmlSnapshotHeader* header) {
+    SnapshotLayout layout;
+    layout.attrs = sizeof(ArxmlSnapshotHeader) + (uint64_t)header->node_count * sizeof(ArxmlSnapshotNode);
+    layout.namespaces = layout.attrs + align8((uint64_t)header->attr_count * sizeof(ArxmlSnapshotAttr));
+    layout.string_offsets = layout.namespaces + (uint64_t)header->ns_count * sizeof(ArxmlSnapshotNs);
+    layout.strings = layout.string_offsets + (uint64_t)header->string_count * sizeof(uint64_t);
+    layout.end = layout.strings + header->strings_size;
+    return layout;
+}
+
+/* Make room for one more item | 为一个新元素腾出空间 */
+static int reserve(void** items, size_t* capacity, size_t count, size_t item_size) {
+    if (count >= SNAPSHOT_MAX_COUNT) {
+        return 0;
+    }
+    if (count < *capacity) {
+        return 1;
+    }
+    size_t new_capacity = *capacity ? *capacity * 2 : 1024;
+    void* new_items = realloc(*items, new_capacity * item_size);
+    if (!new_items) {
+        return 0;
+    }
+    *items = new_items;
+    *capacity = new_capacity;
+    return 1;
+}
+
+/* Rebuild buckets at twice the size | 以两倍大小重建哈希桶 */
+static int grow_buckets(SnapshotBuilder* builder) {
+    size_t bucket_count = builder->bucket_count ? builder->bucket_count * 2 : 4096;
+    uint32_t* buckets = (uint32_t*)calloc(bucket_count, sizeof(uint32_t));
+    if (!buckets) {
+        return 0;
+    }
+    for (size_t i = 0; i < builder->string_count; i++) {
+        const char* str = builder->strings + builder->string_offsets[i];
+        size_t slot = (size_t)hash64(str, strlen(str), 0) & (bucket_count - 1);
+        while (buckets[slot] != 0) {
+            slot = (slot + 1) & (bucket_count - 1);
+        }
+        buckets[slot] = (uint32_t)(i + 1);
+    }
+    free(builder->buckets);
+    builder->buckets = buckets;
+    builder->bucket_count = bucket_count;
+    return 1;
+}
+
+/* Get number of string, adding it if new | 获取字符串的编号，新字符串会被加入 */
+static int intern_string(SnapshotBuilder* builder, const xmlChar* value, uint32_t* number) {
+    const char* str = value ? (const char*)value : "";
+    size_t len = strlen(str);
+    if (len >= INT_MAX) {
+        return 0;
+    }
+    if ((builder->string_count + 1) * 2 > builder->bucket_count && !grow_buckets(builder)) {
+        return 0;
+    }
+
+    size_t mask = builder->bucket_count - 1;
+    size_t slot = (size_t)hash64(str, len, 0) & mask;
+    while (builder->buckets[slot] != 0) {
+        uint32_t found = builder->buckets[slot] - 1;
+        if (strcmp(builder->strings + builder->string_offsets[found], str) == 0) {
+            *number = found;
+            return 1;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    if (!reserve((void**)&builder->string_offsets, &builder->string_capacity, builder->string_count, sizeof(uint64_t))) {
+        return 0;
+    }
+    if (builder->strings_size + len + 1 > builder->strings_capacity) {
+        size_t capacity = builder->strings_capacity ? builder->strings_capacity : 65536;
+        while (capacity < builder->strings_size + len + 1) capacity *= 2;
+        char* strings = (char*)realloc(builder->strings, capacity);
+        if (!strings) {
+            return 0;
+        }
+        builder->strings = strings;
+        builder->strings_capacity = capacity;
+    }
+    memcpy(builder->strings + builder->strings_size, str, len + 1);
+    builder->string_offsets[builder->string_count] = builder->strings_size;
+    builder->strings_size += len + 1;
+    *number = (uint32_t)builder->string_count++;
+    builder->buckets[slot] = *number + 1;
+    return 1;
+}
+
+/* Number namespace reference by its declaration, innermost first | 按声明为命名空间引用编号，由内向外查找 */
+static int namespace_number(const SnapshotBuilder* builder, xmlNsPtr ns, uint32_t* number) {
+    if (!ns) {
+        *number = ARXML_SNAPSHOT_NONE;
+        return 1;
+    }
+    for (size_t i = builder->ns_count; i > 0; i--) {
+        if (builder->ns_sources[i - 1] == ns) {
+            *number = (uint32_t)(i - 1);
+            return 1;
+        }
+    }
+    if (ns->prefix && xmlStrEqual(ns->prefix, BAD_CAST "xml")) {
+        *number = ARXML_SNAPSHOT_XML_NS;
+        return 1;
+    }
+    return 0;
+}
+
+/* Value of attribute, entity references are not supported | 属性值，不支持实体引用 */
+static int attribute_value(xmlAttrPtr attr, const xmlChar** value) {
+    xmlNodePtr child = attr->children;
+    if (!child) {
+        *value = BAD_CAST "";
+        return 1;
+    }
+    if (child->type != XML_TEXT_NODE || child->next) {
+        return 0;
+    }
+    *value = child->content;
+    return 1;
+}
+
+/* Add declarations and attributes of element | 添加元素的命名空间声明和属性 */
+static int add_element_fields(SnapshotBuilder* builder, xmlNodePtr node, ArxmlSnapshotNode* record) {
+    if (!intern_string(builder, node->name, &record->name)) {
+        return 0;
+    }
+
+    record->ns_first = (uint32_t)builder->ns_count;
+    for (xmlNsPtr ns = node->nsDef; ns; ns = ns->next) {
+        ArxmlSnapshotNs entry = {ARXML_SNAPSHOT_NONE, 0};
+        if (!reserve((void**)&builder->namespaces, &builder->ns_capacity, builder->ns_count, sizeof(ArxmlSnapshotNs))) {
+            return 0;
+        }
+        /* Sources grow with namespaces, the capacity is shared | 声明数组与命名空间一起增长，共用容量 */
+        xmlNsPtr* sources = (xmlNsPtr*)realloc(builder->ns_sources, builder->ns_capacity * sizeof(xmlNsPtr));
+        if (!sources) {
+            return 0;
+        }
+        builder->ns_sources = sources;
+        if ((ns->prefix && !intern_string(builder, ns->prefix, &entry.prefix)) || !intern_string(builder, ns->href, &entry.href)) {
+            return 0;
+        }
+        builder->namespaces[builder->ns_count] = entry;
+        builder->ns_sources[builder->ns_count++] = ns;
+    }
+    record->ns_count = (uint32_t)builder->ns_count - record->ns_first;
+    if (!namespace_number(builder, node->ns, &record->ns)) {
+        return 0;
+    }
+
+    record->attr_first = (uint32_t)builder->attr_count;
+    for (xmlAttrPtr attr = node->properties; attr; attr = attr->next) {
+        ArxmlSnapshotAttr entry;
+        const xmlChar* value;
+        if (!reserve((void**)&builder->attrs, &builder->attr_capacity, builder->attr_count, sizeof(ArxmlSnapshotAttr)) ||
+            !attribute_value(attr, &value) || !intern_string(builder, attr->name, &entry.name) ||
+            !namespace_number(builder, attr->ns, &entry.ns) || !intern_string(builder, value, &entry.value)) {
+            return 0;
+        }
+        builder->attrs[builder->attr_count++] = entry;
+    }
+    record->attr_count = (uint32_t)builder->attr_count - record->attr_first;
+    return 1;
+}
+
+/* Add node and its subtree in document order | 按文档顺序添加节点及其子树 */
+static int add_node(SnapshotBuilder* builder, xmlNodePtr node, uint32_t* number) {
+    ArxmlSnapshotNode record;
+    memset(&record, 0xFF, sizeof(record));
+    record.type = (uint32_t)node->type;
+    record.attr_first = record.ns_first = 0;
+    record.attr_count = record.ns_count = 0;
+
+    int ok = 1;
+    switch (node->type) {
+        case XML_DOCUMENT_NODE:
+            break;
+        case XML_ELEMENT_NODE:
+            ok = add_element_fields(builder, node, &record);
+            break;
+        case XML_TEXT_NODE:
+        case XML_CDATA_SECTION_NODE:
+        case XML_COMMENT_NODE:
+            ok = intern_string(builder, node->content, &record.content);
+            break;
+        case XML_PI_NODE:
+            ok = intern_string(builder, node->name, &record.name) && intern_string(builder, node->content, &record.content);
+            break;
+        default:
+            /* DTD, entity references and the like are not part of ARXML | DTD、实体引用等不属于ARXML */
+            ok = 0;
+            break;
+    }
+    if (!ok || !reserve((void**)&builder->nodes, &builder->node_capacity, builder->node_count, sizeof(ArxmlSnapshotNode))) {
+        return 0;
+    }
+    *number = (uint32_t)builder->node_count;
+    builder->nodes[builder->node_count++] = record;
+
+    /* Children follow their parent, the array may move meanwhile | 子节点紧随父节点，期间数组可能移动 */
+    uint32_t previous = ARXML_SNAPSHOT_NONE;
+    for (xmlNodePtr child = node->children; child; child = child->next) {
+        uint32_t child_number;
+        if (!add_node(builder, child, &child_number)) {
+            return 0;
+        }
+        if (previous == ARXML_SNAPSHOT_NONE) {
+            builder->nodes[*number].first_child = child_number;
+        } else {
+            builder->nodes[previous].next_sibling = child_number;
+        }
+        previous = child_number;
+    }
+    return 1;
+}
+
+static int write_part(FILE* file, const void* data, size_t size) {
+    return size == 0 || fwrite(data, 1, size, file) == size;
+}
+
+/* Write header and tables | 写出文件头和各表 */
+static int write_snapshot(FILE* file, const ArxmlSnapshotHeader* header, const SnapshotBuilder* builder) {
+    static const char padding[8] = {0};
+    size_t attrs_size = builder->attr_count * sizeof(ArxmlSnapshotAttr);
+    return write_part(file, header, sizeof(ArxmlSnapshotHeader)) &&
+           write_part(file, builder->nodes, builder->node_count * sizeof(ArxmlSnapshotNode)) &&
+           write_part(file, builder->attrs, attrs_size) &&
+           write_part(file, padding, (size_t)(align8(attrs_size) - attrs_size)) &&
+           write_part(file, builder->namespaces, builder->ns_count * sizeof(ArxmlSnapshotNs)) &&
+           write_part(file, builder->string_offsets, builder->string_count * sizeof(uint64_t)) &&
+           write_part(file, builder->strings, builder->strings_size);
+}
+
+static void free_builder(SnapshotBuilder* builder) {
+    free(builder->nodes);
+    free(builder->attrs);
+    free(builder->namespaces);
+    free(builder->ns_sources);
+    free(builder->string_offsets);
+    free(builder->strings);
+    free(builder->buckets);
+}
+
+/* Get sidecar snapshot path of source | 获取源文件的旁路快照路径 */
+char* arxml_snapshot_sidecar_path(const char* source_path) {
+    size_t size = strlen(source_path) + sizeof(ARXML_SNAPSHOT_SUFFIX);
+    char* snapshot_path = (char*)malloc(size);
+    if (snapshot_path) {
+        snprintf(snapshot_path, size, "%s%s", source_path, ARXML_SNAPSHOT_SUFFIX);
+    }
+    return snapshot_path;
+}
+
+/* Parse source and write snapshot file | 解析源文件并写出快照文件 */
+int arxml_snapshot_build(const char* source_path, const char* snapshot_path, uint64_t* node_count) {
+    ArxmlSnapshotHeader header;
+    SnapshotBuilder builder;
+    memset(&header, 0, sizeof(header));
+    memset(&builder, 0, sizeof(builder));
+    memcpy(header.magic, ARXML_SNAPSHOT_MAGIC, sizeof(ARXML_SNAPSHOT_MAGIC));
+    header.version = ARXML_SNAPSHOT_VERSION;
+    header.byte_order = ARXML_SNAPSHOT_BYTE_ORDER;
+
+    if (!get_file_size(source_path, &header.source_size) || !hash_file(source_path, &header.source_hash)) {
+        return 0;
+    }
+    DetectedIndentStyle detected = detect_indent_style(source_path);
+    header.indent_style = (uint32_t)detected.style;
+    header.indent_width = (uint32_t)detected.width;
+
+    xmlDocPtr doc = xmlReadFile(source_path, NULL, SNAPSHOT_PARSE_OPTIONS);
+    if (!doc) {
+        return 0;
+    }
+    uint32_t root = 0;
+    header.xml_version = ARXML_SNAPSHOT_NONE;
+    int ok = (!doc->version || intern_string(&builder, doc->version, &header.xml_version)) &&
+             add_node(&builder, (xmlNodePtr)doc, &root);
+    xmlFreeDoc(doc);
+    header.node_count = (uint32_t)builder.node_count;
+    header.attr_count = (uint32_t)builder.attr_count;
+    header.ns_count = (uint32_t)builder.ns_count;
+    header.string_count = (uint32_t)builder.string_count;
+    header.strings_size = builder.strings_size;
+
+    /* Write to temporary file, then replace snapshot atomically | 先写临时文件，再原子替换快照 */
+    if (ok) {
+        size_t tmp_len = strlen(snapshot_path) + 5;
+        char* tmp_path = (char*)malloc(tmp_len);
+        FILE* file = NULL;
+        if (tmp_path) {
+            snprintf(tmp_path, tmp_len, "%s.tmp", snapshot_path);
+            file = fopen(tmp_path, "wb");
+        }
+        ok = file != NULL;
+        if (ok) {
+            ok = write_snapshot(file, &header, &builder);
+            if (fclose(file) != 0) ok = 0;
+#ifdef _WIN32
+            if (ok) remove(snapshot_path);
+#endif
+            if (ok && rename(tmp_path, snapshot_path) != 0) ok = 0;
+            if (!ok) remove(tmp_path);
+        }
+        free(tmp_path);
+    }
+
+    if (ok && node_count) {
+        *node_count = builder.node_count;
+    }
+    free_builder(&builder);
+    return ok;
+}
+
+static int valid_string(const ArxmlSnapshotHeader* header, uint32_t number) {
+    return number < header->string_count;
+}
+
+/* Namespace reference resolves to a declaration of node or one of its ancestors | 命名空间引用指向节点自身或其祖先的声明 */
+static int valid_namespace(const ArxmlSnapshotHeader* header, const uint32_t* ns_owner, const uint32_t* subtree_end,
+                           uint32_t ns, uint32_t node) {
+    if (ns == ARXML_SNAPSHOT_NONE || ns == ARXML_SNAPSHOT_XML_NS) {
+        return 1;
+    }
+    return ns < header->ns_count && ns_owner[ns] <= node && subtree_end[ns_owner[ns]] >= node;
+}
+
+/* Check strings: ascending offsets, each ended by NUL | 检查字符串：偏移递增，每个都以NUL结尾 */
+static int check_strings(const ArxmlSnapshot* snapshot) {
+    const ArxmlSnapshotHeader* header = snapshot->header;
+    if (header->string_count == 0) {
+        return header->strings_size == 0;
+    }
+    if (snapshot->string_offsets[0] != 0 || snapshot->strings[header->strings_size - 1] != '\0') {
+        return 0;
+    }
+    for (uint32_t i = 0; i < header->string_count; i++) {
+        uint64_t start = snapshot->string_offsets[i];
+        uint64_t end = i + 1 < header->string_count ? snapshot->string_offsets[i + 1] : header->strings_size;
+        if (end <= start || end > header->strings_size || end - start > INT_MAX || snapshot->strings[end - 1] != '\0') {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* Check node fields and that nodes form one tree in document order | 检查节点字段，以及节点是否按文档顺序构成一棵树 */
+static int check_nodes(const ArxmlSnapshot* snapshot) {
+    const ArxmlSnapshotHeader* header = snapshot->header;
+    uint32_t count = header->node_count;
+    if (count == 0 || snapshot->nodes[0].type != XML_DOCUMENT_NODE || snapshot->nodes[0].next_sibling != ARXML_SNAPSHOT_NONE) {
+        return 0;
+    }
+
+    uint32_t* subtree_end = (uint32_t*)malloc((size_t)count * sizeof(uint32_t));
+    unsigned char* has_parent = (unsigned char*)calloc(count, 1);
+    uint32_t* ns_owner = (uint32_t*)malloc((size_t)(header->ns_count ? header->ns_count : 1) * sizeof(uint32_t));
+    int ok = subtree_end && has_parent && ns_owner;
+
+    /* Fields, attributes and declarations of consecutive nodes follow each other | 字段检查，相邻节点的属性和声明依次排列 */
+    uint32_t next_attr = 0;
+    uint32_t next_ns = 0;
+    for (uint32_t i = 0; ok && i < count; i++) {
+        const ArxmlSnapshotNode* node = &snapshot->nodes[i];
+        int element = node->type == XML_ELEMENT_NODE;
+        switch (node->type) {
+            case XML_DOCUMENT_NODE:
+                ok = i == 0;
+                break;
+            case XML_ELEMENT_NODE:
+                ok = valid_string(header, node->name);
+                break;
+            case XML_TEXT_NODE:
+            case XML_CDATA_SECTION_NODE:
+            case XML_COMMENT_NODE:
+                ok = valid_string(header, node->content);
+                break;
+            case XML_PI_NODE:
+                ok = valid_string(header, node->name) && valid_string(header, node->content);
+                break;
+            default:
+                ok = 0;
+                break;
+        }
+        if (!element) {
+            ok = ok && node->attr_count == 0 && node->ns_count == 0;
+            continue;
+        }
+        ok = ok && node->attr_first == next_attr && node->attr_count <= header->attr_count - next_attr &&
+             node->ns_first == next_ns && node->ns_count <= header->ns_count - next_ns;
+        for (uint32_t k = 0; ok && k < node->ns_count; k++) {
+            const ArxmlSnapshotNs* ns = &snapshot->namespaces[next_ns + k];
+            ok = (ns->prefix == ARXML_SNAPSHOT_NONE || valid_string(header, ns->prefix)) && valid_string(header, ns->href);
+            ns_owner[next_ns + k] = i;
+        }
+        for (uint32_t k = 0; ok && k < node->attr_count; k++) {
+            const ArxmlSnapshotAttr* attr = &snapshot->attrs[next_attr + k];
+            ok = valid_string(header, attr->name) && valid_string(header, attr->value);
+        }
+        next_attr += node->attr_count;
+        next_ns += node->ns_count;
+    }
+    ok = ok && next_attr == header->attr_count && next_ns == header->ns_count;
+
+    /* Subtrees from the back: children start right after their parent, siblings right after a subtree | 从后向前计算子树：子节点紧跟父节点，兄弟节点紧跟前一个子树 */
+    for (uint32_t i = count; ok && i > 0; i--) {
+        uint32_t parent = i - 1;
+        uint32_t child = snapshot->nodes[parent].first_child;
+        subtree_end[parent] = parent;
+        if (child == ARXML_SNAPSHOT_NONE) {
+            continue;
+        }
+        ok = child == i;
+        while (ok) {
+            ok = child < count && !has_parent[child];
+            if (!ok) break;
+            has_parent[child] = 1;
+            subtree_end[parent] = subtree_end[child];
+            child = snapshot->nodes[child].next_sibling;
+            if (child == ARXML_SNAPSHOT_NONE) break;
+            ok = child == subtree_end[parent] + 1;
+        }
+    }
+    ok = ok && subtree_end[0] == count - 1;
+    for (uint32_t i = 1; ok && i < count; i++) {
+        ok = has_parent[i];
+    }
+
+    /* Namespaces are used only where declared | 命名空间只在声明范围内使用 */
+    for (uint32_t i = 0; ok && i < count; i++) {
+        const ArxmlSnapshotNode* node = &snapshot->nodes[i];
+        if (node->type != XML_ELEMENT_NODE) continue;
+        ok = valid_namespace(header, ns_owner, subtree_end, node->ns, i);
+        for (uint32_t k = 0; ok && k < node->attr_count; k++) {
+            ok = valid_namespace(header, ns_owner, subtree_end, snapshot->attrs[node->attr_first + k].ns, i);
+        }
+    }
+
+    free(subtree_end);
+    free(has_parent);
+    free(ns_owner);
+    return ok;
+}
+
+/* Open snapshot and check it | 打开快照并检查 */
+int arxml_snapshot_open(const char* snapshot_path, ArxmlSnapshot* snapshot) {
+    memset(snapshot, 0, sizeof(ArxmlSnapshot));
+    if (!map_file(snapshot_path, &snapshot->file)) {
+        return 0;
+    }
+
+    /* Check structure before trusting any offset | 在使用任何偏移之前先检查结构 */
+    const ArxmlSnapshotHeader* header = (const ArxmlSnapshotHeader*)snapshot->file.data;
+    uint64_t size = snapshot->file.size;
+    if (size < sizeof(ArxmlSnapshotHeader) ||
+        memcmp(header->magic, ARXML_SNAPSHOT_MAGIC, sizeof(ARXML_SNAPSHOT_MAGIC)) != 0 ||
+        header->version != ARXML_SNAPSHOT_VERSION || header->byte_order != ARXML_SNAPSHOT_BYTE_ORDER ||
+        header->node_count >= SNAPSHOT_MAX_COUNT || header->attr_count >= SNAPSHOT_MAX_COUNT ||
+        header->ns_count >= SNAPSHOT_MAX_COUNT || header->string_count >= SNAPSHOT_MAX_COUNT ||
+        header->strings_size > size || snapshot_layout(header).end != size ||
+        (header->xml_version != ARXML_SNAPSHOT_NONE && header->xml_version >= header->string_count)) {
+        arxml_snapshot_close(snapshot);
+        return 0;
+    }
+    SnapshotLayout layout = snapshot_layout(header);
+    snapshot->header = header;
+    snapshot->nodes = (const ArxmlSnapshotNode*)(snapshot->file.data + sizeof(ArxmlSnapshotHeader));
+    snapshot->attrs = (const ArxmlSnapshotAttr*)(snapshot->file.data + layout.attrs);
+    snapshot->namespaces = (const ArxmlSnapshotNs*)(snapshot->file.data + layout.namespaces);
+    snapshot->string_offsets = (const uint64_t*)(snapshot->file.data + layout.string_offsets);
+    snapshot->strings = snapshot->file.data + layout.strings;
+
+    if (!check_strings(snapshot) || !check_nodes(snapshot)) {
+        arxml_snapshot_close(snapshot);
+        return 0;
+    }
+    return 1;
+}
+
+/* Read source size and hash from header | 从文件头读取源文件的大小和哈希 */
+int arxml_snapshot_source(const char* snapshot_path, uint64_t* source_size, uint64_t* source_hash) {
+    ArxmlSnapshotHeader header;
+    FILE* file = fopen(snapshot_path, "rb");
+    if (!file) {
+        return 0;
+    }
+    int ok = fread(&header, sizeof(header), 1, file) == 1 &&
+             memcmp(header.magic, ARXML_SNAPSHOT_MAGIC, sizeof(ARXML_SNAPSHOT_MAGIC)) == 0 &&
+             header.version == ARXML_SNAPSHOT_VERSION && header.byte_order == ARXML_SNAPSHOT_BYTE_ORDER;
+    fclose(file);
+    if (ok) {
+        *source_size = header.source_size;
+        *source_hash = header.source_hash;
+    }
+    return ok;
+}
+
+/* Close snapshot | 关闭快照 */
+void arxml_snapshot_close(ArxmlSnapshot* snapshot) {
+    unmap_file(&snapshot->file);
+    memset(snapshot, 0, sizeof(ArxmlSnapshot));
+}
+
+/* Get NUL terminated string | 获取以NUL结尾的字符串 */
+const char* arxml_snapshot_string(const ArxmlSnapshot* snapshot, uint32_t number) {
+    if (number >= snapshot->header->string_count) {
+        return NULL;
+    }
+    return snapshot->strings + snapshot->string_offsets[number];
+}
+
+/* Create node without children, strings come from the document dictionary | 创建不含子节点的节点，字符串来自文档字典 */
+static xmlNodePtr create_node(xmlDocPtr doc, const ArxmlSnapshot* snapshot, uint32_t number,
+                              const xmlChar** strings, xmlNsPtr* namespaces) {
+    const ArxmlSnapshotNode* record = &snapshot->nodes[number];
+    xmlNodePtr node = NULL;
+    switch (record->type) {
+        case XML_ELEMENT_NODE:
+            node = xmlNewDocNodeEatName(doc, NULL, (xmlChar*)strings[record->name], NULL);
+            break;
+        case XML_TEXT_NODE:
+            node = xmlNewDocText(doc, NULL);
+            break;
+        case XML_CDATA_SECTION_NODE:
+            node = xmlNewCDataBlock(doc, NULL, 0);
+            break;
+        case XML_COMMENT_NODE:
+            node = xmlNewDocComment(doc, NULL);
+            break;
+        case XML_PI_NODE:
+            node = xmlNewDocPI(doc, strings[record->name], NULL);
+            break;
+        default:
+            break;
+    }
+    if (!node) {
+        return NULL;
+    }
+    if (record->type != XML_ELEMENT_NODE) {
+        /* Owned by the dictionary, so freeing the node leaves it alone | 由字典持有，释放节点时不会释放它 */
+        node->content = (xmlChar*)strings[record->content];
+        return node;
+    }
+
+    for (uint32_t k = record->ns_first; k < record->ns_first + record->ns_count; k++) {
+        const ArxmlSnapshotNs* ns = &snapshot->namespaces[k];
+        namespaces[k] = xmlNewNs(node, strings[ns->href], ns->prefix == ARXML_SNAPSHOT_NONE ? NULL : strings[ns->prefix]);
+        if (!namespaces[k]) {
+            xmlFreeNode(node);
+            return NULL;
+        }
+    }
+    if (record->ns != ARXML_SNAPSHOT_NONE) {
+        node->ns = record->ns == ARXML_SNAPSHOT_XML_NS ? xmlSearchNs(doc, node, BAD_CAST "xml") : namespaces[record->ns];
+    }
+    for (uint32_t k = record->attr_first; k < record->attr_first + record->attr_count; k++) {
+        const ArxmlSnapshotAttr* entry = &snapshot->attrs[k];
+        xmlNsPtr ns = NULL;
+        if (entry->ns != ARXML_SNAPSHOT_NONE) {
+            ns = entry->ns == ARXML_SNAPSHOT_XML_NS ? xmlSearchNs(doc, node, BAD_CAST "xml") : namespaces[entry->ns];
+        }
+        xmlAttrPtr attr = xmlNewNsPropEatName(node, ns, (xmlChar*)strings[entry->name], NULL);
+        xmlNodePtr text = attr ? xmlNewDocText(doc, NULL) : NULL;
+        if (!text) {
+            xmlFreeNode(node);
+            return NULL;
+        }
+        text->content = (xmlChar*)strings[entry->value];
+        text->parent = (xmlNodePtr)attr;
+        attr->children = attr->last = text;
+    }
+    return node;
+}
+
+/* Build document from snapshot | 从快照构建文档 */
+xmlDocPtr arxml_snapshot_load(const ArxmlSnapshot* snapshot) {
+    const ArxmlSnapshotHeader* header = snapshot->header;
+    const char* version = arxml_snapshot_string(snapshot, header->xml_version);
+    xmlDocPtr doc = xmlNewDoc(BAD_CAST (version ? version : "1.0"));
+    if (!doc) {
+        return NULL;
+    }
+    doc->dict = xmlDictCreate();
+    const xmlChar** strings = (const xmlChar**)malloc((size_t)(header->string_count ? header->string_count : 1) * sizeof(xmlChar*));
+    xmlNodePtr* nodes = (xmlNodePtr*)calloc(header->node_count, sizeof(xmlNodePtr));
+    xmlNsPtr* namespaces = (xmlNsPtr*)malloc((size_t)(header->ns_count ? header->ns_count : 1) * sizeof(xmlNsPtr));
+    int ok = doc->dict && strings && nodes && namespaces;
+
+    /* Each distinct string is hashed once, nodes only take pointers | 每个不同的字符串只哈希一次，节点只取指针 */
+    for (uint32_t i = 0; ok && i < header->string_count; i++) {
+        uint64_t start = snapshot->string_offsets[i];
+        uint64_t end = i + 1 < header->string_count ? snapshot->string_offsets[i + 1] : header->strings_size;
+        strings[i] = xmlDictLookup(doc->dict, BAD_CAST (snapshot->strings + start), (int)(end - start - 1));
+        ok = strings[i] != NULL;
+    }
+
+    if (ok) {
+        nodes[0] = (xmlNodePtr)doc;
+    }
+    for (uint32_t i = 1; ok && i < header->node_count; i++) {
+        nodes[i] = create_node(doc, snapshot, i, strings, namespaces);
+        ok = nodes[i] != NULL;
+    }
+
+    /* Link children only once all nodes exist, so a failure frees single nodes | 所有节点创建后再链接子节点，失败时只需释放单个节点 */
+    for (uint32_t i = 0; ok && i < header->node_count; i++) {
+        xmlNodePtr parent = nodes[i];
+        xmlNodePtr previous = NULL;
+        for (uint32_t c = snapshot->nodes[i].first_child; c != ARXML_SNAPSHOT_NONE; c = snapshot->nodes[c].next_sibling) {
+            xmlNodePtr child = nodes[c];
+            child->parent = parent;
+            child->prev = previous;
+            if (previous) {
+                previous->next = child;
+            } else {
+                parent->children = child;
+            }
+            previous = child;
+        }
+        parent->last = previous;
+    }
+
+    if (!ok && nodes) {
+        for (uint32_t i = 1; i < header->node_count; i++) {
+            if (nodes[i]) xmlFreeNode(nodes[i]);
+        }
+    }
+    free(strings);
+    free(nodes);
+    free(namespaces);
+    if (!ok) {
+        xmlFreeDoc(doc);
+        return NULL;
+    }
+    return doc;
+}
@@ -0,0 +1,103 @@
+#ifndef ARXML_SNAPSHOT_H
+#define ARXML_SNAPSHOT_H
+
+#include <stdint.h>
+#include <libxml/tree.h>
+#include "fs_utils.h"
+
+/* Binary snapshot of a parsed document | 已解析文档的二进制快照
+ * Layout (host byte order, every part 8 byte aligned) | 布局（主机字节序，各部分8字节对齐）:
+ *   header | nodes in document order | attributes | namespaces | string offsets | strings
+ *   文件头 | 按文档顺序排列的节点 | 属性 | 命名空间 | 字符串偏移 | 字符串
+ * Nodes refer to strings, attributes and namespaces by number, so the file is used in place through mmap.
+ * Every distinct string is stored once, names and repeated values cost four bytes per use.
+ * 节点通过编号引用字符串、属性和命名空间，因此文件通过mmap直接使用；每个不同的字符串只保存一次，重复的名称和值每次只占四个字节 */
+#define ARXML_SNAPSHOT_MAGIC "ARXSNP1"
+#define ARXML_SNAPSHOT_VERSION 1
+#define ARXML_SNAPSHOT_SUFFIX ".snap"
+
+/* No string, node or namespace | 无字符串、节点或命名空间 */
+#define ARXML_SNAPSHOT_NONE 0xFFFFFFFFu
+/* The predefined xml: namespace, declared nowhere | 预定义的xml:命名空间，不在任何位置声明 */
+#define ARXML_SNAPSHOT_XML_NS 0xFFFFFFFEu
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;      /* 0x01020304 as written | 写入时的0x01020304 */
+    uint64_t source_size;
+    uint64_t source_hash;     /* XXH64 of source file, a snapshot stands for its source | 源文件的XXH64，快照代表其源文件 */
+    uint32_t node_count;      /* Node 0 is the document | 节点0为文档本身 */
+    uint32_t attr_count;
+    uint32_t ns_count;
+    uint32_t string_count;
+    uint64_t strings_size;
+    uint32_t xml_version;     /* String of the XML declaration version | XML声明中版本号的字符串 */
+    uint32_t indent_style;    /* Detected in source, 't' or 's' | 在源文件中检测到的缩进，'t'或's' */
+    uint32_t indent_width;
+    uint32_t reserved;
+} ArxmlSnapshotHeader;
+
+/* Node in document order, a subtree is the node and the nodes up to its next sibling | 按文档顺序排列的节点，子树由该节点及其下一个兄弟之前的节点组成 */
+typedef struct {
+    uint32_t type;            /* xmlElementType of element, text, CDATA, comment or PI | 元素、文本、CDATA、注释或PI的xmlElementType */
+    uint32_t name;            /* String of element and PI | 元素和PI的字符串 */
+    uint32_t content;         /* String of text, CDATA, comment and PI | 文本、CDATA、注释和PI的字符串 */
+    uint32_t ns;              /* Namespace of element | 元素的命名空间 */
+    uint32_t first_child;     /* Always the next node when present | 存在时总是下一个节点 */
+    uint32_t next_sibling;
+    uint32_t attr_first;      /* Attributes and declared namespaces of consecutive nodes follow each other | 相邻节点的属性和声明的命名空间依次排列 */
+    uint32_t attr_count;
+    uint32_t ns_first;
+    uint32_t ns_count;
+} ArxmlSnapshotNode;
+
+typedef struct {
+    uint32_t name;
+    uint32_t ns;
+    uint32_t value;
+} ArxmlSnapshotAttr;
+
+typedef struct {
+    uint32_t prefix;          /* ARXML_SNAPSHOT_NONE for the default namespace | 默认命名空间为ARXML_SNAPSHOT_NONE */
+    uint32_t href;
+} ArxmlSnapshotNs;
+
+/* Opened snapshot, all pointers refer to the mapping | 已打开的快照，所有指针都指向映射内存 */
+typedef struct {
+    MappedFile file;
+    const ArxmlSnapshotHeader* header;
+    const ArxmlSnapshotNode* nodes;
+    const ArxmlSnapshotAttr* attrs;
+    const ArxmlSnapshotNs* namespaces;
+    const uint64_t* string_offsets;
+    const char* strings;
+} ArxmlSnapshot;
+
+/* Get sidecar snapshot path of source, "<source>.snap" | 获取源文件的旁路快照路径"<source>.snap"
+ * Caller frees it, NULL if out of memory | 由调用者释放，内存不足时返回NULL */
+char* arxml_snapshot_sidecar_path(const char* source_path);
+
+/* Parse source like the merge base and write snapshot file | 与merge的基础文件相同地解析源文件并写出快照文件
+ * Returns 1 on success, 0 on error; node_count may be NULL | 成功返回1，出错返回0；node_count可为NULL */
+int arxml_snapshot_build(const char* source_path, const char* snapshot_path, uint64_t* node_count);
+
+/* Map snapshot and check every number in it, so readers need no further checks | 映射快照并检查其中的每个编号，读取时无需再检查
+ * Returns 0 if missing or corrupt | 文件不存在或已损坏时返回0 */
+int arxml_snapshot_open(const char* snapshot_path, ArxmlSnapshot* snapshot);
+
+/* Read size and hash of the source from the header only | 只读取文件头中源文件的大小和哈希
+ * Returns 0 if missing or not a snapshot | 文件不存在或不是快照时返回0 */
+int arxml_snapshot_source(const char* snapshot_path, uint64_t* source_size, uint64_t* source_hash);
+
+/* Close snapshot opened by arxml_snapshot_open | 关闭arxml_snapshot_open打开的快照 */
+void arxml_snapshot_close(ArxmlSnapshot* snapshot);
+
+/* Get NUL terminated string, NULL for ARXML_SNAPSHOT_NONE | 获取以NUL结尾的字符串，ARXML_SNAPSHOT_NONE时返回NULL */
+const char* arxml_snapshot_string(const ArxmlSnapshot* snapshot, uint32_t number);
+
+/* Build libxml2 document from snapshot without parsing, names and texts are interned in its dictionary | 不经解析直接从快照构建libxml2文档，名称和文本保存在文档字典中
+ * The document is independent of the mapping, NULL if out of memory | 文档与映射无关，内存不足时返回NULL */
+xmlDocPtr arxml_snapshot_load(const ArxmlSnapshot* snapshot);
+
+#endif /* ARXML_SNAPSHOT_H */
@@ -0,0 +1,648 @@
+#include "compressed_io.h"
+#include "thread_pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <zlib.h>
+#include <lzma.h>
+#include <libxml/parser.h>
+#include <libxml/xmlsave.h>
+#include <libxml/encoding.h>
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#else
+#include <unistd.h>
+#endif
+
+/* Decompressed data handed from the decompressing thread to the parser | 从解压线程交给解析器的解压数据 */
+#define INPUT_BLOCK_SIZE (256 * 1024)
+#define INPUT_BLOCKS 4
+/* Compressed bytes read at once | 每次读取的压缩数据字节数 */
+#define PACKED_READ_SIZE (256 * 1024)
+
+/* gzip output is cut into blocks of this size, each compressed on its own | gzip输出按此大小分块，各块独立压缩 */
+#define GZIP_BLOCK_SIZE (1024 * 1024)
+#define GZIP_LEVEL 6
+/* Window bits selecting the gzip wrapper | 选择gzip封装的窗口位数 */
+#define GZIP_WINDOW_BITS (15 + 16)
+
+#define XZ_PRESET 6
+/* xz blocks are compressed in parallel, the preset's default of three dictionaries rarely splits an ARXML file | xz块并行压缩，预设默认的三倍字典大小很少能把一个ARXML文件分成多块 */
+#define XZ_BLOCK_SIZE (8 * 1024 * 1024)
+/* Threads of the xz encoder are reduced until it needs less memory than this | 减少xz编码器的线程数，直到所需内存低于此值 */
+#define XZ_MEMORY_LIMIT ((uint64_t)1 << 30)
+#define XZ_BUFFER_SIZE (1024 * 1024)
+
+/* Standard output kept for data by reserve_stdout | 由reserve_stdout保留给数据的标准输出 */
+static FILE* data_output;
+
+struct CompressedInput {
+    FILE* file;
+    CompressionKind kind;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    char* blocks[INPUT_BLOCKS];
+    size_t lengths[INPUT_BLOCKS];
+    int first;          /* Oldest filled block | 最早填充的块 */
+    int filled;
+    size_t position;    /* Read position in the oldest block | 在最早的块中的读取位置 */
+    int finished;       /* No further blocks will be filled | 不会再填充新的块 */
+    int failed;         /* Finished because of corrupt or truncated data | 因数据损坏或不完整而结束 */
+    int closing;
+};
+
+typedef struct CompressedOutput CompressedOutput;
+
+/* gzip block, owned by a worker between submitting and done | gzip块，提交后到完成前归工作线程所有 */
+typedef struct {
+    CompressedOutput* output;
+    char* data;
+    size_t len;
+    unsigned char* packed;
+    size_t packed_capacity;
+    size_t packed_len;
+    int done;
+    int failed;
+} OutputBlock;
+
+struct CompressedOutput {
+    FILE* file;
+    CompressionKind kind;
+    int failed;
+    /* gzip: blocks are compressed by the pool and written in order | gzip：块由线程池压缩并按顺序写出 */
+    ThreadPool* pool;
+    OutputBlock* blocks;
+    int block_count;
+    int first;          /* Oldest submitted block, the one after the submitted ones is being filled | 最早提交的块，已提交块之后的块正在填充 */
+    int submitted;
+    pthread_mutex_t lock;
+    pthread_cond_t done;
+    /* xz: liblzma compresses blocks on its own threads | xz：liblzma在自己的线程中压缩各块 */
+    lzma_stream xz;
+    unsigned char* xz_buffer;
+};
+
+static int has_suffix(const char* path, const char* suffix) {
+    size_t len = strlen(path);
+    size_t suffix_len = strlen(suffix);
+    if (len < suffix_len) return 0;
+    for (size_t i = 0; i < suffix_len; i++) {
+        if (tolower((unsigned char)path[len - suffix_len + i]) != suffix[i]) return 0;
+    }
+    return 1;
+}
+
+CompressionKind compression_of_path(const char* path) {
+    if (has_suffix(path, ".gz")) return COMPRESSION_GZIP;
+    if (has_suffix(path, ".xz")) return COMPRESSION_XZ;
+    return COMPRESSION_NONE;
+}
+
+/* Wait for a free block, NULL once the reader closes | 等待空闲块，读取者关闭后返回NULL */
+static char* claim_block(CompressedInput* input) {
+    pthread_mutex_lock(&input->lock);
+    while (input->filled == INPUT_BLOCKS && !input->closing) {
+        pthread_cond_wait(&input->changed, &input->lock);
+    }
+    /* The free block stays the same while the reader consumes older ones | 读取者消费较早的块时，空闲块的位置不变 */
+    char* block = input->closing ? NULL : input->blocks[(input->first + input->filled) % INPUT_BLOCKS];
+    pthread_mutex_unlock(&input->lock);
+    return block;
+}
+
+static void publish_block(CompressedInput* input, size_t len) {
+    pthread_mutex_lock(&input->lock);
+    input->lengths[(input->first + input->filled) % INPUT_BLOCKS] = len;
+    input->filled++;
+    pthread_cond_broadcast(&input->changed);
+    pthread_mutex_unlock(&input->lock);
+}
+
+/* Decompress file into free blocks until the end, an error or the reader closing | 将文件解压到空闲块中，直到结束、出错或读取者关闭 */
+static void* decompress_thread(void* arg) {
+    CompressedInput* input = (CompressedInput*)arg;
+    z_stream gz;
+    lzma_stream xz = LZMA_STREAM_INIT;
+    memset(&gz, 0, sizeof(gz));
+    unsigned char* packed = (unsigned char*)malloc(PACKED_READ_SIZE);
+    int ok = packed != NULL;
+    if (ok) {
+        ok = input->kind == COMPRESSION_GZIP ? inflateInit2(&gz, GZIP_WINDOW_BITS) == Z_OK
+                                             : lzma_stream_decoder(&xz, UINT64_MAX, LZMA_CONCATENATED) == LZMA_OK;
+    }
+
+    const unsigned char* next_in = packed;
+    size_t avail_in = 0;
+    int at_eof = 0;
+    int member_end = 0;     /* gzip member complete, another may follow | gzip成员已完整，后面可能还有成员 */
+    char* block = NULL;
+    size_t block_len = 0;
+    while (ok) {
+        if (avail_in == 0 && !at_eof) {
+            avail_in = fread(packed, 1, PACKED_READ_SIZE, input->file);
+            next_in = packed;
+            if (avail_in < PACKED_READ_SIZE) {
+                at_eof = 1;
+                if (ferror(input->file)) ok = 0;
+            }
+        }
+        if (!block) {
+            block = claim_block(input);
+            if (!block) break;
+            block_len = 0;
+        }
+
+        int end = 0;
+        if (input->kind == COMPRESSION_GZIP) {
+            if (member_end) {
+                end = avail_in == 0 && at_eof;
+                if (!end) {
+                    inflateReset(&gz);
+                    member_end = 0;
+                }
+            }
+            if (!end) {
+                gz.next_in = (Bytef*)next_in;
+                gz.avail_in = (uInt)avail_in;
+                gz.next_out = (Bytef*)(block + block_len);
+                gz.avail_out = (uInt)(INPUT_BLOCK_SIZE - block_len);
+                /* Z_BUF_ERROR means truncated here, input and output space are always available | 此处Z_BUF_ERROR表示文件不完整，因为输入和输出空间总是可用 */
+                int ret = inflate(&gz, Z_NO_FLUSH);
+                if (ret == Z_STREAM_END) member_end = 1;
+                else if (ret != Z_OK) ok = 0;
+                next_in = gz.next_in;
+                avail_in = gz.avail_in;
+                block_len = INPUT_BLOCK_SIZE - gz.avail_out;
+            }
+        } else {
+            xz.next_in = next_in;
+            xz.avail_in = avail_in;
+            xz.next_out = (uint8_t*)(block + block_len);
+            xz.avail_out = INPUT_BLOCK_SIZE - block_len;
+            lzma_ret ret = lzma_code(&xz, at_eof ? LZMA_FINISH : LZMA_RUN);
+            if (ret == LZMA_STREAM_END) end = 1;
+            else if (ret != LZMA_OK) ok = 0;
+            next_in = xz.next_in;
+            avail_in = xz.avail_in;
+            block_len = INPUT_BLOCK_SIZE - xz.avail_out;
+        }
+
+        if (block_len == INPUT_BLOCK_SIZE || (end && block_len > 0)) {
+            publish_block(input, block_len);
+            block = NULL;
+        }
+        if (end) break;
+    }
+
+    if (input->kind == COMPRESSION_GZIP) inflateEnd(&gz);
+    else lzma_end(&xz);
+    free(packed);
+
+    pthread_mutex_lock(&input->lock);
+    input->finished = 1;
+    input->failed = !ok;
+    pthread_cond_broadcast(&input->changed);
+    pthread_mutex_unlock(&input->lock);
+    return NULL;
+}
+
+/* Start decompressing file, which is closed unless it is standard input | 开始解压文件，文件随后关闭，标准输入除外 */
+static CompressedInput* start_input(FILE* file, CompressionKind kind) {
+    CompressedInput* input = (CompressedInput*)calloc(1, sizeof(CompressedInput));
+    if (!input) {
+        return NULL;
+    }
+    input->kind = kind;
+    input->file = file;
+    int ok = 1;
+    for (int i = 0; ok && i < INPUT_BLOCKS; i++) {
+        input->blocks[i] = (char*)malloc(INPUT_BLOCK_SIZE);
+        ok = input->blocks[i] != NULL;
+    }
+    if (ok) {
+        pthread_mutex_init(&input->lock, NULL);
+        pthread_cond_init(&input->changed, NULL);
+        ok = pthread_create(&input->thread, NULL, decompress_thread, input) == 0;
+        if (!ok) {
+            pthread_mutex_destroy(&input->lock);
+            pthread_cond_destroy(&input->changed);
+        }
+    }
+    if (!ok) {
+        for (int i = 0; i < INPUT_BLOCKS; i++) free(input->blocks[i]);
+        free(input);
+        return NULL;
+    }
+    return input;
+}
+
+CompressedInput* compressed_input_open(const char* path) {
+    CompressionKind kind = compression_of_path(path);
+    if (kind == COMPRESSION_NONE) {
+        return NULL;
+    }
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        return NULL;
+    }
+    CompressedInput* input = start_input(file, kind);
+    if (!input) {
+        fclose(file);
+    }
+    return input;
+}
+
+/* Wait for decompressed data with the lock held, NULL at the end | 持有锁时等待解压数据，结束时返回NULL */
+static const char* wait_data(CompressedInput* input, size_t* available) {
+    while (input->filled == 0 && !input->finished) {
+        pthread_cond_wait(&input->changed, &input->lock);
+    }
+    if (input->filled == 0) {
+        return NULL;
+    }
+    *available = input->lengths[input->first] - input->position;
+    return input->blocks[input->first] + input->position;
+}
+
+/* Consume bytes with the lock held, handing an emptied block back | 持有锁时消费数据，读完的块交还给解压线程 */
+static void consume_data(CompressedInput* input, size_t len) {
+    input->position += len;
+    if (input->position == input->lengths[input->first]) {
+        input->first = (input->first + 1) % INPUT_BLOCKS;
+        input->filled--;
+        input->position = 0;
+        pthread_cond_broadcast(&input->changed);
+    }
+}
+
+long compressed_input_read(CompressedInput* input, char* buffer, size_t len) {
+    size_t done = 0;
+    const char* data;
+    size_t available;
+    pthread_mutex_lock(&input->lock);
+    while (done < len && (data = wait_data(input, &available)) != NULL) {
+        size_t count = available < len - done ? available : len - done;
+        memcpy(buffer + done, data, count);
+        consume_data(input, count);
+        done += count;
+    }
+    /* Data before an error is still returned, the error with the next call | 出错前的数据仍然返回，错误在下一次调用时返回 */
+    int failed = done == 0 && input->filled == 0 && input->failed;
+    pthread_mutex_unlock(&input->lock);
+    return failed ? -1 : (long)done;
+}
+
+void compressed_input_close(CompressedInput* input) {
+    if (!input) return;
+    pthread_mutex_lock(&input->lock);
+    input->closing = 1;
+    pthread_cond_broadcast(&input->changed);
+    pthread_mutex_unlock(&input->lock);
+    pthread_join(input->thread, NULL);
+
+    pthread_mutex_destroy(&input->lock);
+    pthread_cond_destroy(&input->changed);
+    if (input->file != stdin) fclose(input->file);
+    for (int i = 0; i < INPUT_BLOCKS; i++) free(input->blocks[i]);
+    free(input);
+}
+
+int is_stdio_path(const char* path) {
+    return strcmp(path, STDIO_PATH) == 0;
+}
+
+int has_stdio_path(const PathList* paths) {
+    for (int i = 0; i < paths->count; i++) {
+        if (is_stdio_path(paths->items[i])) return 1;
+    }
+    return 0;
+}
+
+int reserve_stdout(void) {
+    fflush(stdout);
+    int fd = dup(fileno(stdout));
+    if (fd < 0) {
+        return 0;
+    }
+#ifdef _WIN32
+    _setmode(fd, _O_BINARY);
+#endif
+    data_output = fdopen(fd, "wb");
+    if (!data_output) {
+        close(fd);
+        return 0;
+    }
+    if (dup2(fileno(stderr), fileno(stdout)) < 0) {
+        return 0;
+    }
+    /* Messages now share standard error, keep them in order with its own | 消息现在与标准错误共用，保持与其自身输出的顺序 */
+    setvbuf(stdout, NULL, _IOLBF, BUFSIZ);
+    return 1;
+}
+
+FILE* stdout_data(void) {
+    return data_output ? data_output : stdout;
+}
+
+/* Data being parsed, its indentation is detected on the way if detector is set | 正在解析的数据，设置detector时同时检测其缩进 */
+typedef struct {
+    FILE* file;
+    CompressedInput* input;
+    IndentDetector* detector;
+} ParseSource;
+
+static int read_callback(void* context, char* buffer, int len) {
+    ParseSource* source = (ParseSource*)context;
+    long count = source->input ? compressed_input_read(source->input, buffer, (size_t)len)
+                               : (long)fread(buffer, 1, (size_t)len, source->file);
+    if (count == 0 && source->file && ferror(source->file)) {
+        return -1;
+    }
+    if (count > 0 && source->detector && !source->detector->done) {
+        indent_detector_feed(source->detector, buffer, (size_t)count);
+    }
+    return (int)count;
+}
+
+xmlDocPtr read_xml_file(const char* path, int options) {
+    if (compression_of_path(path) == COMPRESSION_NONE && !is_stdio_path(path)) {
+        return xmlReadFile(path, NULL, options);
+    }
+    return read_xml_file_detect(path, options, NULL);
+}
+
+xmlDocPtr read_xml_file_detect(const char* path, int options, DetectedIndentStyle* detected) {
+    return read_xml_file_filtered(path, options, NULL, detected);
+}
+
+/* Parse data of source, through filter if set | 解析数据源中的数据，设置filter时经过过滤 */
+static xmlDocPtr parse_source(ParseSource* source, const char* path, int options, const ArPathFilter* filter) {
+    if (!filter) {
+        return xmlReadIO(read_callback, NULL, source, path, NULL, options);
+    }
+    xmlParserCtxtPtr ctxt = xmlCreateIOParserCtxt(NULL, NULL, read_callback, NULL, source, XML_CHAR_ENCODING_NONE);
+    if (!ctxt) {
+        return NULL;
+    }
+    /* Set up like xmlReadIO, messages name the file | 与xmlReadIO相同地设置，消息中显示文件名 */
+    xmlCtxtUseOptions(ctxt, options);
+    if (ctxt->input && !ctxt->input->filename) {
+        ctxt->input->filename = (char*)xmlStrdup((const xmlChar*)path);
+    }
+    xmlDocPtr doc = ar_path_filter_parse(filter, ctxt);
+    xmlFreeParserCtxt(ctxt);
+    return doc;
+}
+
+xmlDocPtr read_xml_file_filtered(const char* path, int options, const ArPathFilter* filter, DetectedIndentStyle* detected) {
+    IndentDetector detector;
+    indent_detector_init(&detector);
+    ParseSource source = {NULL, NULL, detected ? &detector : NULL};
+    if (is_stdio_path(path)) {
+#ifdef _WIN32
+        _setmode(_fileno(stdin), _O_BINARY);
+#endif
+        /* Standard input has no suffix, compressed data is told by its first byte, which never starts XML | 标准输入没有后缀，压缩数据由其首字节识别，XML不会以该字节开头 */
+        int first = getc(stdin);
+        if (first != EOF) ungetc(first, stdin);
+        if (first == 0x1F || first == 0xFD) {
+            source.input = start_input(stdin, first == 0x1F ? COMPRESSION_GZIP : COMPRESSION_XZ);
+        } else {
+            source.file = stdin;
+        }
+    } else if (compression_of_path(path) != COMPRESSION_NONE) {
+        source.input = compressed_input_open(path);
+    } else {
+        source.file = fopen(path, "rb");
+    }
+    if (!source.file && !source.input) {
+        return NULL;
+    }
+
+    xmlDocPtr doc = parse_source(&source, path, options, filter);
+    if (source.input) compressed_input_close(source.input);
+    else if (source.file != stdin) fclose(source.file);
+    if (doc && detected) {
+        *detected = indent_detector_finish(&detector);
+    }
+    return doc;
+}
+
+/* Compress one gzip block into a complete gzip member | 将一个gzip块压缩为完整的gzip成员 */
+static void deflate_block(void* arg) {
+    OutputBlock* block = (OutputBlock*)arg;
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    int ok = deflateInit2(&stream, GZIP_LEVEL, Z_DEFLATED, GZIP_WINDOW_BITS, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+    if (ok) {
+        stream.next_in = (Bytef*)block->data;
+        stream.avail_in = (uInt)block->len;
+        stream.next_out = block->packed;
+        stream.avail_out = (uInt)block->packed_capacity;
+        ok = deflate(&stream, Z_FINISH) == Z_STREAM_END;
+        block->packed_len = block->packed_capacity - stream.avail_out;
+        deflateEnd(&stream);
+    }
+
+    CompressedOutput* output = block->output;
+    pthread_mutex_lock(&output->lock);
+    block->failed = !ok;
+    block->done = 1;
+    pthread_cond_broadcast(&output->done);
+    pthread_mutex_unlock(&output->lock);
+}
+
+/* Write compressed blocks in order, waiting for the oldest if wait is set | 按顺序写出已压缩的块，wait非0时等待最早的块 */
+static void write_blocks(CompressedOutput* output, int wait) {
+    while (output->submitted > 0) {
+        OutputBlock* block = &output->blocks[output->first];
+        pthread_mutex_lock(&output->lock);
+        while (wait && !block->done) {
+            pthread_cond_wait(&output->done, &output->lock);
+        }
+        int done = block->done;
+        pthread_mutex_unlock(&output->lock);
+        if (!done) break;
+
+        if (block->failed || fwrite(block->packed, 1, block->packed_len, output->file) != block->packed_len) {
+            output->failed = 1;
+        }
+        block->len = 0;
+        output->first = (output->first + 1) % output->block_count;
+        output->submitted--;
+        wait = 0;
+    }
+}
+
+/* Hand the block being filled to the pool, keeping one block free for filling | 将正在填充的块交给线程池，并保留一个空闲块用于填充 */
+static void submit_block(CompressedOutput* output) {
+    OutputBlock* block = &output->blocks[(output->first + output->submitted) % output->block_count];
+    block->done = 0;
+    block->failed = 0;
+    output->submitted++;
+    if (!thread_pool_submit(output->pool, deflate_block, block)) {
+        block->done = 1;
+        block->failed = 1;
+    }
+    write_blocks(output, output->submitted == output->block_count);
+}
+
+/* Run xz encoder, until input is consumed or with LZMA_FINISH until the end | 运行xz编码器，直到输入被消费完，或在LZMA_FINISH时直到结束 */
+static void encode_xz(CompressedOutput* output, lzma_action action) {
+    while (!output->failed) {
+        lzma_ret ret = lzma_code(&output->xz, action);
+        if (output->xz.avail_out == 0 || ret == LZMA_STREAM_END) {
+            size_t len = XZ_BUFFER_SIZE - output->xz.avail_out;
+            if (fwrite(output->xz_buffer, 1, len, output->file) != len) output->failed = 1;
+            output->xz.next_out = output->xz_buffer;
+            output->xz.avail_out = XZ_BUFFER_SIZE;
+        }
+        if (ret == LZMA_STREAM_END) return;
+        if (ret != LZMA_OK) output->failed = 1;
+        if (action == LZMA_RUN && output->xz.avail_in == 0) return;
+    }
+}
+
+static int write_callback(void* context, const char* buffer, int len) {
+    CompressedOutput* output = (CompressedOutput*)context;
+    if (output->kind == COMPRESSION_GZIP) {
+        size_t left = (size_t)len;
+        while (left > 0 && !output->failed) {
+            OutputBlock* block = &output->blocks[(output->first + output->submitted) % output->block_count];
+            size_t count = GZIP_BLOCK_SIZE - block->len < left ? GZIP_BLOCK_SIZE - block->len : left;
+            memcpy(block->data + block->len, buffer, count);
+            block->len += count;
+            buffer += count;
+            left -= count;
+            if (block->len == GZIP_BLOCK_SIZE) {
+                submit_block(output);
+            }
+        }
+    } else {
+        output->xz.next_in = (const uint8_t*)buffer;
+        output->xz.avail_in = (size_t)len;
+        encode_xz(output, LZMA_RUN);
+    }
+    return output->failed ? -1 : len;
+}
+
+static int open_gzip_output(CompressedOutput* output, int threads) {
+    output->pool = thread_pool_create(threads);
+    if (!output->pool) {
+        return 0;
+    }
+    /* Two blocks per worker keep every worker busy while finished blocks wait for writing | 每个工作线程两个块，使已完成的块等待写出时所有线程仍然忙碌 */
+    output->block_count = 2 * (threads > 0 ? threads : get_cpu_count());
+    output->blocks = (OutputBlock*)calloc((size_t)output->block_count, sizeof(OutputBlock));
+    if (!output->blocks) {
+        return 0;
+    }
+    for (int i = 0; i < output->block_count; i++) {
+        OutputBlock* block = &output->blocks[i];
+        block->output = output;
+        block->packed_capacity = compressBound(GZIP_BLOCK_SIZE) + 32;   /* Plus gzip header and trailer | 加上gzip头和尾 */
+        block->data = (char*)malloc(GZIP_BLOCK_SIZE);
+        block->packed = (unsigned char*)malloc(block->packed_capacity);
+        if (!block->data || !block->packed) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int open_xz_output(CompressedOutput* output, int threads) {
+    lzma_mt mt;
+    memset(&mt, 0, sizeof(mt));
+    mt.threads = (uint32_t)(threads > 0 ? threads : get_cpu_count());
+    mt.preset = XZ_PRESET;
+    mt.check = LZMA_CHECK_CRC64;
+    /* A fixed block size keeps the output independent of the thread count | 固定的块大小使输出与线程数无关 */
+    mt.block_size = XZ_BLOCK_SIZE;
+    while (mt.threads > 1 && lzma_stream_encoder_mt_memusage(&mt) > XZ_MEMORY_LIMIT) {
+        mt.threads--;
+    }
+    output->xz_buffer = (unsigned char*)malloc(XZ_BUFFER_SIZE);
+    if (!output->xz_buffer || lzma_stream_encoder_mt(&output->xz, &mt) != LZMA_OK) {
+        return 0;
+    }
+    output->xz.next_out = output->xz_buffer;
+    output->xz.avail_out = XZ_BUFFER_SIZE;
+    return 1;
+}
+
+/* Finish compressing, write remaining data and free output, returns 0 if anything failed | 完成压缩，写出剩余数据并释放输出，任何步骤失败时返回0 */
+static int close_output(CompressedOutput* output) {
+    if (output->kind == COMPRESSION_GZIP) {
+        if (output->blocks) {
+            if (output->blocks[(output->first + output->submitted) % output->block_count].len > 0) {
+                submit_block(output);
+            }
+            while (output->submitted > 0) {
+                write_blocks(output, 1);
+            }
+        }
+        if (output->pool) thread_pool_destroy(output->pool);
+        for (int i = 0; output->blocks && i < output->block_count; i++) {
+            free(output->blocks[i].data);
+            free(output->blocks[i].packed);
+        }
+        free(output->blocks);
+    } else {
+        if (output->xz_buffer) {
+            output->xz.next_in = NULL;
+            output->xz.avail_in = 0;
+            encode_xz(output, LZMA_FINISH);
+        }
+        lzma_end(&output->xz);
+        free(output->xz_buffer);
+    }
+
+    int ok = !output->failed;
+    if (output->file && fclose(output->file) != 0) ok = 0;
+    pthread_mutex_destroy(&output->lock);
+    pthread_cond_destroy(&output->done);
+    free(output);
+    return ok;
+}
+
+int save_xml_file(const char* path, xmlDocPtr doc, int threads) {
+    if (is_stdio_path(path)) {
+        FILE* file = stdout_data();
+        xmlOutputBufferPtr buffer = xmlOutputBufferCreateFile(file, xmlFindCharEncodingHandler("UTF-8"));
+        int saved = buffer != NULL && xmlSaveFormatFileTo(buffer, doc, "UTF-8", 1) >= 0;
+        return fflush(file) == 0 && saved;
+    }
+    CompressionKind kind = compression_of_path(path);
+    if (kind == COMPRESSION_NONE) {
+        return xmlSaveFormatFileEnc(path, doc, "UTF-8", 1) >= 0;
+    }
+
+    CompressedOutput* output = (CompressedOutput*)calloc(1, sizeof(CompressedOutput));
+    if (!output) {
+        return 0;
+    }
+    lzma_stream initial = LZMA_STREAM_INIT;
+    output->xz = initial;
+    output->kind = kind;
+    pthread_mutex_init(&output->lock, NULL);
+    pthread_cond_init(&output->done, NULL);
+    output->file = fopen(path, "wb");
+    int ok = output->file != NULL;
+    if (ok) {
+        ok = kind == COMPRESSION_GZIP ? open_gzip_output(output, threads) : open_xz_output(output, threads);
+    }
+    if (ok) {
+        /* Same as xmlSaveFormatFileEnc, with the compressor instead of the file | 与xmlSaveFormatFileEnc相同，只是写入压缩器而不是文件 */
+        xmlOutputBufferPtr buffer = xmlOutputBufferCreateIO(write_callback, NULL, output, xmlFindCharEncodingHandler("UTF-8"));
+        ok = buffer != NULL && xmlSaveFormatFileTo(buffer, doc, "UTF-8", 1) >= 0;
+    } else {
+        output->failed = 1;
+    }
+    return close_output(output) && ok;
+}
@@ -0,0 +1,70 @@
+#ifndef COMPRESSED_IO_H
+#define COMPRESSED_IO_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <libxml/tree.h>
+#include "xml_utils.h"
+#include "fs_utils.h"
+#include "ar_path_filter.h"
+
+/* Path standing for standard input or standard output | 表示标准输入或标准输出的路径 */
+#define STDIO_PATH "-"
+
+/* Compression of a file, given by its suffix | 文件的压缩格式，由后缀决定 */
+typedef enum {
+    COMPRESSION_NONE,
+    COMPRESSION_GZIP,   /* .gz */
+    COMPRESSION_XZ      /* .xz */
+} CompressionKind;
+
+/* Decompressing reader, another thread decompresses ahead while the caller consumes | 解压读取器，调用者读取的同时另一个线程提前解压 */
+typedef struct CompressedInput CompressedInput;
+
+/* Get compression of path from its suffix, ignoring case | 根据后缀获取路径的压缩格式，不区分大小写 */
+CompressionKind compression_of_path(const char* path);
+
+/* Open .gz or .xz file and start decompressing it, NULL if not compressed or not readable | 打开.gz或.xz文件并开始解压，未压缩或无法读取时返回NULL
+ * Concatenated gzip members and xz streams are read as one file | 连接在一起的多个gzip成员和xz流作为一个文件读取 */
+CompressedInput* compressed_input_open(const char* path);
+
+/* Read up to len decompressed bytes | 读取最多len字节的解压数据
+ * Returns bytes read, 0 at the end, -1 if the file is corrupt or truncated | 返回读取的字节数，结束时返回0，文件损坏或不完整时返回-1 */
+long compressed_input_read(CompressedInput* input, char* buffer, size_t len);
+
+/* Stop decompressing and close, also before the end | 停止解压并关闭，可以在读完之前调用 */
+void compressed_input_close(CompressedInput* input);
+
+/* Check whether path is "-" | 检查路径是否为"-" */
+int is_stdio_path(const char* path);
+
+/* Check whether list contains "-" | 检查列表中是否包含"-" */
+int has_stdio_path(const PathList* paths);
+
+/* Keep standard output for document data written to "-", messages go to standard error from now on | 将标准输出留给写入"-"的文档数据，此后的消息输出到标准错误
+ * Call before anything is printed, returns 0 on failure | 需在输出任何内容之前调用，失败时返回0 */
+int reserve_stdout(void);
+
+/* Get stream receiving data written to "-" | 获取接收写入"-"的数据的流 */
+FILE* stdout_data(void);
+
+/* Parse file like xmlReadFile, .gz and .xz files are parsed while another thread decompresses them | 与xmlReadFile相同地解析文件，.gz和.xz文件在另一个线程解压的同时进行解析
+ * "-" reads standard input. Returns NULL if file cannot be read or parsed | "-"读取标准输入；无法读取或解析时返回NULL */
+xmlDocPtr read_xml_file(const char* path, int options);
+
+/* Parse like read_xml_file and detect the indentation of the same bytes, reading the file once | 与read_xml_file相同地解析，并从同一份数据检测缩进，文件只读取一次
+ * Standard input cannot be read twice, so it needs this instead of detect_indent_style | 标准输入无法读取两次，因此需要用此函数代替detect_indent_style */
+xmlDocPtr read_xml_file_detect(const char* path, int options, DetectedIndentStyle* detected);
+
+/* Parse like read_xml_file_detect, keeping only what filter selects (everything if NULL) | 与read_xml_file_detect相同地解析，只保留filter选中的内容（为NULL时全部保留）
+ * detected may be NULL | detected可以为NULL */
+xmlDocPtr read_xml_file_filtered(const char* path, int options, const ArPathFilter* filter, DetectedIndentStyle* detected);
+
+/* Save document formatted as UTF-8 like xmlSaveFormatFileEnc, compressed by the suffix of path, "-" writes standard output | 与xmlSaveFormatFileEnc相同地以UTF-8格式化保存文档，按路径后缀压缩，"-"写出到标准输出
+ * Compression runs on up to threads workers (<= 0 means one per CPU) while the document is serialized,
+ * gzip output is a series of independently compressed members, xz output a multi-block stream.
+ * 文档序列化的同时由最多threads个线程压缩（<=0表示每个CPU一个），gzip输出为一系列独立压缩的成员，xz输出为多块的流
+ * Returns 1 on success, 0 on error | 成功返回1，出错返回0 */
+int save_xml_file(const char* path, xmlDocPtr doc, int threads);
+
+#endif /* COMPRESSED_IO_H */
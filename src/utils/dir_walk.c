@@ -0,0 +1,273 @@
+#include "dir_walk.h"
+#include "thread_pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <pthread.h>
+
+/* Shared state of one walk | 一次遍历的共享状态 */
+typedef struct {
+    const char* root;
+    const DirWalkFilter* filter;
+    ThreadPool* pool;
+    pthread_mutex_t lock;       /* Guards list and ok | 保护list和ok */
+    PathList* list;
+    int ok;
+} DirWalk;
+
+/* One directory to list, relative to root | 待列出的目录，相对于根目录 */
+typedef struct {
+    DirWalk* walk;
+    char* relative;
+} WalkTask;
+
+/* Match one character against [...] class, advances pattern past it | 用[...]字符类匹配单个字符，并将模式移到类之后
+ * Returns -1 if the class is not closed | 字符类未闭合时返回-1 */
+static int match_class(const char** pattern, char c) {
+    const char* p = *pattern + 1;
+    int negate = 0;
+    int matched = 0;
+    if (*p == '!' || *p == '^') {
+        negate = 1;
+        p++;
+    }
+    /* A ']' right after '[' is a literal | 紧跟在'['之后的']'是普通字符 */
+    const char* first = p;
+    while (*p && (*p != ']' || p == first)) {
+        if (p[1] == '-' && p[2] && p[2] != ']') {
+            if (c >= p[0] && c <= p[2]) matched = 1;
+            p += 3;
+        } else {
+            if (c == *p) matched = 1;
+            p++;
+        }
+    }
+    if (*p != ']') return -1;
+    *pattern = p + 1;
+    return matched != negate;
+}
+
+static int match_here(const char* p, const char* s) {
+    while (*p) {
+        if (p[0] == '*' && p[1] == '*') {
+            p += 2;
+            /* "**" followed by '/' also matches no directory at all | "**"后跟'/'时也可以不匹配任何目录 */
+            if (*p == '/' && match_here(p + 1, s)) return 1;
+            for (;; s++) {
+                if (match_here(p, s)) return 1;
+                if (!*s) return 0;
+            }
+        }
+        if (*p == '*') {
+            p++;
+            for (;; s++) {
+                if (match_here(p, s)) return 1;
+                if (!*s || *s == '/') return 0;
+            }
+        }
+        if (!*s) return 0;
+        if (*p == '?') {
+            if (*s == '/') return 0;
+            p++;
+            s++;
+            continue;
+        }
+        if (*p == '[' && *s != '/') {
+            const char* next = p;
+            int matched = match_class(&next, *s);
+            if (matched >= 0) {
+                if (!matched) return 0;
+                p = next;
+                s++;
+                continue;
+            }
+        }
+        if (*p != *s) return 0;
+        p++;
+        s++;
+    }
+    return *s == '\0';
+}
+
+int glob_match(const char* pattern, const char* path) {
+    if (!strchr(pattern, '/')) {
+        const char* name = strrchr(path, '/');
+        path = name ? name + 1 : path;
+    }
+    return match_here(pattern, path);
+}
+
+static int match_any(const PathList* globs, const char* path) {
+    if (!globs) return 0;
+    for (int i = 0; i < globs->count; i++) {
+        if (glob_match(globs->items[i], path)) return 1;
+    }
+    return 0;
+}
+
+/* Check extension of first name_len bytes ignoring case | 忽略大小写检查前name_len个字节的扩展名 */
+static int has_extension(const char* name, size_t name_len, const char* extension) {
+    size_t ext_len = strlen(extension);
+    if (name_len < ext_len) return 0;
+    for (size_t i = 0; i < ext_len; i++) {
+        if (tolower((unsigned char)name[name_len - ext_len + i]) != tolower((unsigned char)extension[i])) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int keep_file(const DirWalkFilter* filter, const char* name, const char* relative) {
+    if (filter->extension) {
+        size_t len = strlen(name);
+        int kept = has_extension(name, len, filter->extension);
+        if (!kept && filter->compressed && (has_extension(name, len, ".gz") || has_extension(name, len, ".xz"))) {
+            kept = has_extension(name, len - 3, filter->extension);
+        }
+        if (!kept) return 0;
+    }
+    if (filter->includes && filter->includes->count > 0 && !match_any(filter->includes, relative)) return 0;
+    return !match_any(filter->excludes, relative);
+}
+
+static void fail_walk(DirWalk* walk) {
+    pthread_mutex_lock(&walk->lock);
+    walk->ok = 0;
+    pthread_mutex_unlock(&walk->lock);
+}
+
+static void list_directory(DirWalk* walk, const char* relative);
+
+/* Worker task: list one directory | 工作线程任务：列出一个目录 */
+static void walk_task(void* arg) {
+    WalkTask* task = (WalkTask*)arg;
+    list_directory(task->walk, task->relative);
+    free(task->relative);
+    free(task);
+}
+
+/* Hand subdirectory to the pool, or list it right away | 将子目录交给线程池，或立即列出 */
+static void queue_directory(DirWalk* walk, const char* relative) {
+    WalkTask* task = (WalkTask*)malloc(sizeof(WalkTask));
+    if (task) {
+        task->walk = walk;
+        task->relative = strdup(relative);
+    }
+    if (!task || !task->relative) {
+        if (task) free(task);
+        fail_walk(walk);
+        return;
+    }
+    if (!walk->pool || !thread_pool_submit(walk->pool, walk_task, task)) {
+        walk_task(task);
+    }
+}
+
+/* List one directory level, files are added under the lock in one batch | 列出一层目录，文件在锁内一次性加入 */
+static void list_directory(DirWalk* walk, const char* relative) {
+    size_t path_len = strlen(walk->root) + strlen(relative) + 2;
+    char* dir_path = (char*)malloc(path_len);
+    if (!dir_path) {
+        fail_walk(walk);
+        return;
+    }
+    snprintf(dir_path, path_len, relative[0] ? "%s/%s" : "%s", walk->root, relative);
+
+    DIR* dir = opendir(dir_path);
+    if (!dir) {
+        printf("Error: Cannot open directory '%s'\n", dir_path);
+        free(dir_path);
+        fail_walk(walk);
+        return;
+    }
+
+    PathList found = {0};
+    int ok = 1;
+    struct dirent* entry;
+    while (ok && (entry = readdir(dir)) != NULL) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+            continue;
+        }
+
+        /* Build relative path of entry | 构建条目的相对路径 */
+        size_t rel_len = strlen(relative) + strlen(entry->d_name) + 2;
+        char* rel_path = (char*)malloc(rel_len);
+        if (!rel_path) {
+            ok = 0;
+            break;
+        }
+        snprintf(rel_path, rel_len, relative[0] ? "%s/%s" : "%s%s", relative, entry->d_name);
+
+        /* Entry type from readdir when known, stat only for links and unknown types | 类型已知时直接使用readdir的结果，仅对链接和未知类型调用stat */
+        int is_dir = 0;
+        int is_file = 0;
+#ifdef _DIRENT_HAVE_D_TYPE
+        if (entry->d_type == DT_DIR) {
+            is_dir = 1;
+        } else if (entry->d_type == DT_REG) {
+            is_file = 1;
+        } else if (entry->d_type == DT_LNK || entry->d_type == DT_UNKNOWN)
+#endif
+        {
+            char* full_path = (char*)malloc(strlen(dir_path) + strlen(entry->d_name) + 2);
+            struct stat st;
+            if (!full_path) {
+                free(rel_path);
+                ok = 0;
+                break;
+            }
+            sprintf(full_path, "%s/%s", dir_path, entry->d_name);
+            if (stat(full_path, &st) == 0) {
+                is_dir = S_ISDIR(st.st_mode);
+                is_file = S_ISREG(st.st_mode);
+            }
+            free(full_path);
+        }
+
+        if (is_dir && !match_any(walk->filter->excludes, rel_path)) {
+            queue_directory(walk, rel_path);
+        } else if (is_file && keep_file(walk->filter, entry->d_name, rel_path)) {
+            ok = path_list_add(&found, rel_path);
+        }
+        free(rel_path);
+    }
+    closedir(dir);
+    free(dir_path);
+
+    pthread_mutex_lock(&walk->lock);
+    for (int i = 0; ok && i < found.count; i++) {
+        ok = path_list_add(walk->list, found.items[i]);
+    }
+    if (!ok) walk->ok = 0;
+    pthread_mutex_unlock(&walk->lock);
+    path_list_free(&found);
+}
+
+/* Collect files below directory | 收集目录下的文件 */
+int dir_walk(const char* dir, const DirWalkFilter* filter, PathList* list) {
+    DirWalk walk;
+    walk.root = dir;
+    walk.filter = filter;
+    walk.list = list;
+    walk.ok = 1;
+    pthread_mutex_init(&walk.lock, NULL);
+
+    /* Pool may be NULL, then directories are listed depth first on this thread | 线程池可以为NULL，此时在当前线程中深度优先列出目录 */
+    walk.pool = thread_pool_create(filter->jobs);
+    queue_directory(&walk, "");
+    if (walk.pool) {
+        thread_pool_wait(walk.pool);
+        thread_pool_destroy(walk.pool);
+    }
+    pthread_mutex_destroy(&walk.lock);
+
+    if (!walk.ok) {
+        return 0;
+    }
+    /* Workers finish in any order | 工作线程完成顺序不确定 */
+    path_list_sort(list);
+    return 1;
+}
@@ -0,0 +1,25 @@
+#ifndef DIR_WALK_H
+#define DIR_WALK_H
+
+#include "fs_utils.h"
+
+/* Filters of a directory walk | 目录遍历的过滤条件 */
+typedef struct {
+    const char* extension;       /* Ignores case, NULL keeps every file | 忽略大小写，NULL保留所有文件 */
+    int compressed;              /* Also keep extension followed by .gz or .xz | 同时保留扩展名后跟.gz或.xz的文件 */
+    const PathList* includes;    /* Globs, file kept if one matches, NULL or empty keeps all | 通配符，匹配任意一个时保留文件，为NULL或空时全部保留 */
+    const PathList* excludes;    /* Globs, matching files are dropped and matching directories skipped | 通配符，丢弃匹配的文件并跳过匹配的目录 */
+    int jobs;                    /* Worker threads, 0 means one per CPU | 工作线程数，0表示每个CPU一个 */
+} DirWalkFilter;
+
+/* Match path against glob | 用通配符匹配路径
+ * '*' and '?' stay inside one path segment, '**' also crosses '/', [a-z] and [!a-z] match one character.
+ * A glob without '/' is matched against the last segment only.
+ * '*'和'?'只匹配单个路径段内的字符，'**'还可以跨越'/'，[a-z]和[!a-z]匹配单个字符；不含'/'的通配符只匹配最后一段 */
+int glob_match(const char* pattern, const char* path);
+
+/* Collect files below directory as sorted paths relative to it | 收集目录下的文件，保存为排好序的相对路径
+ * Subdirectories are listed and stat'ed concurrently | 并发列出和检查各子目录 */
+int dir_walk(const char* dir, const DirWalkFilter* filter, PathList* list);
+
+#endif /* DIR_WALK_H */
@@ -0,0 +1,352 @@
+#include "doc_cache.h"
+#include "fs_utils.h"
+#include "hash_utils.h"
+#include "compressed_io.h"
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+#include <pthread.h>
+#include <libxml/parser.h>
+
+/* Files changed this recently may change again within the same mtime second, their hash is checked | 最近修改的文件可能在同一秒内再次变化，需要校验哈希 */
+#define RECENT_SECONDS 2
+
+/* One cached document | 一个缓存的文档 */
+typedef struct DocEntry {
+    char* path;
+    xmlDocPtr doc;           /* Never modified after parsing | 解析后不再修改 */
+    uint64_t size;
+    int64_t mtime;
+    uint64_t hash;
+    int refs;                /* Cache itself and every caller using doc | 缓存本身以及每个正在使用doc的调用者 */
+    int reads_left;          /* Kept output: reads still expected, the last one takes doc over | 保留的输出：预期的剩余读取次数，最后一次读取接管doc */
+    struct DocEntry* prev;   /* LRU list, most recently used first | LRU链表，最近使用的在前 */
+    struct DocEntry* next;
+} DocEntry;
+
+static pthread_mutex_t cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static DocEntry* lru_head;
+static DocEntry* lru_tail;
+static uint64_t max_cache_bytes;
+static int installed;
+static DocCacheStats counters;
+
+/* Path saved by one job and read by later ones, sorted by path | 由一个任务保存、由后续任务读取的路径，按路径排序 */
+typedef struct {
+    char* path;
+    int reads;
+} ExpectedOutput;
+
+static int outputs_only;
+static ExpectedOutput* expected;
+static int expected_count;
+
+int doc_cache_install(uint64_t max_bytes) {
+    xmlInitParser();
+    max_cache_bytes = max_bytes;
+    installed = 1;
+    return 1;
+}
+
+int doc_cache_install_outputs(uint64_t max_bytes) {
+    doc_cache_install(max_bytes);
+    outputs_only = 1;
+    return 1;
+}
+
+int doc_cache_enabled(void) {
+    return installed;
+}
+
+static void unlink_entry(DocEntry* entry) {
+    if (entry->prev) entry->prev->next = entry->next;
+    else lru_head = entry->next;
+    if (entry->next) entry->next->prev = entry->prev;
+    else lru_tail = entry->prev;
+    entry->prev = entry->next = NULL;
+}
+
+static void push_front(DocEntry* entry) {
+    entry->prev = NULL;
+    entry->next = lru_head;
+    if (lru_head) lru_head->prev = entry;
+    lru_head = entry;
+    if (!lru_tail) lru_tail = entry;
+}
+
+/* Drop one reference, caller holds the lock | 释放一个引用，调用者持有锁 */
+static void unref_entry(DocEntry* entry) {
+    if (--entry->refs == 0) {
+        xmlFreeDoc(entry->doc);
+        free(entry->path);
+        free(entry);
+    }
+}
+
+/* Remove entry from cache, callers still using it keep it alive | 从缓存中移除条目，仍在使用它的调用者会使其保持有效 */
+static void remove_entry(DocEntry* entry) {
+    unlink_entry(entry);
+    counters.documents--;
+    counters.bytes -= entry->size;
+    unref_entry(entry);
+}
+
+static DocEntry* find_entry(const char* path) {
+    for (DocEntry* entry = lru_head; entry; entry = entry->next) {
+        if (strcmp(entry->path, path) == 0) return entry;
+    }
+    return NULL;
+}
+
+/* Take a reference on a current entry, NULL if the file must be parsed | 获取有效条目的引用，需要解析文件时返回NULL */
+static DocEntry* lookup(const char* path, uint64_t size, int64_t mtime, int check_hash, uint64_t hash) {
+    pthread_mutex_lock(&cache_lock);
+    DocEntry* entry = find_entry(path);
+    if (entry && entry->size == size && (check_hash ? entry->hash == hash : entry->mtime == mtime)) {
+        if (check_hash) {
+            if (entry->mtime == mtime) counters.hits++;
+            else counters.revalidated++;
+            entry->mtime = mtime;
+        } else {
+            counters.hits++;
+        }
+        unlink_entry(entry);
+        push_front(entry);
+        entry->refs++;
+    } else {
+        entry = NULL;
+    }
+    pthread_mutex_unlock(&cache_lock);
+    return entry;
+}
+
+/* Insert document owned by the cache plus the caller if refs is 2, replacing an older version | 插入文档，refs为2时由缓存和调用者共同持有，替换旧版本 */
+static DocEntry* add_entry(const char* path, xmlDocPtr doc, uint64_t size, int64_t mtime, uint64_t hash, int refs) {
+    DocEntry* entry = (DocEntry*)calloc(1, sizeof(DocEntry));
+    if (entry) entry->path = strdup(path);
+    if (!entry || !entry->path) {
+        free(entry);
+        return NULL;
+    }
+    entry->doc = doc;
+    entry->size = size;
+    entry->mtime = mtime;
+    entry->hash = hash;
+    entry->refs = refs;
+    doc->_private = entry;
+
+    pthread_mutex_lock(&cache_lock);
+    DocEntry* old = find_entry(path);
+    if (old) remove_entry(old);
+    push_front(entry);
+    counters.documents++;
+    counters.bytes += entry->size;
+    while (counters.bytes > max_cache_bytes && lru_tail != entry) {
+        remove_entry(lru_tail);
+        counters.evicted++;
+    }
+    pthread_mutex_unlock(&cache_lock);
+    return entry;
+}
+
+/* Parse mapped file and insert it | 解析映射的文件并加入缓存 */
+static DocEntry* insert(const char* path, const MappedFile* file, int64_t mtime, uint64_t hash) {
+    /* Master copies have no dictionary, so copies and readers in other threads share nothing mutable | 主副本不使用字典，其他线程中的副本和读取者不共享任何可变数据
+     * A compressed file was mapped for its hash only | 压缩文件的映射只用于计算哈希 */
+    xmlDocPtr doc = compression_of_path(path) == COMPRESSION_NONE
+                        ? xmlReadMemory(file->data, (int)file->size, path, NULL, XML_PARSE_NOBLANKS | XML_PARSE_NODICT)
+                        : read_xml_file(path, XML_PARSE_NOBLANKS | XML_PARSE_NODICT);
+    if (!doc) return NULL;
+
+    DocEntry* entry = add_entry(path, doc, file->size, mtime, hash, 2);
+    if (!entry) {
+        xmlFreeDoc(doc);
+        return NULL;
+    }
+    pthread_mutex_lock(&cache_lock);
+    counters.parsed++;
+    pthread_mutex_unlock(&cache_lock);
+    return entry;
+}
+
+/* Position of path in expected outputs, or where it would be inserted | path在预期输出中的位置，或应插入的位置 */
+static int find_expected(const char* path, int* found) {
+    int low = 0;
+    int high = expected_count;
+    while (low < high) {
+        int mid = (low + high) / 2;
+        int cmp = strcmp(expected[mid].path, path);
+        if (cmp == 0) {
+            *found = 1;
+            return mid;
+        }
+        if (cmp < 0) low = mid + 1;
+        else high = mid;
+    }
+    *found = 0;
+    return low;
+}
+
+/* Read kept output, a path without one is parsed like read_xml_file | 读取保留的输出，没有保留输出的路径与read_xml_file相同直接解析 */
+static xmlDocPtr read_output(const char* path, int options, int shared) {
+    pthread_mutex_lock(&cache_lock);
+    DocEntry* entry = find_entry(path);
+    if (!entry) {
+        counters.parsed++;
+        pthread_mutex_unlock(&cache_lock);
+        return read_xml_file(path, options);
+    }
+    counters.hits++;
+    if (--entry->reads_left > 0) {
+        entry->refs++;
+        unlink_entry(entry);
+        push_front(entry);
+    } else {
+        /* Last expected read, the reference of the cache passes to the caller | 最后一次预期读取，缓存持有的引用转交给调用者 */
+        unlink_entry(entry);
+        counters.documents--;
+        counters.bytes -= entry->size;
+        if (!shared && entry->refs == 1) {
+            /* Nobody else uses the tree, hand it over instead of copying | 没有其他使用者，直接交出文档树而不复制 */
+            xmlDocPtr doc = entry->doc;
+            doc->_private = NULL;
+            free(entry->path);
+            free(entry);
+            pthread_mutex_unlock(&cache_lock);
+            return doc;
+        }
+    }
+    pthread_mutex_unlock(&cache_lock);
+
+    if (shared) {
+        return entry->doc;
+    }
+    xmlDocPtr copy = xmlCopyDoc(entry->doc, 1);
+    if (copy) copy->_private = NULL;
+    doc_cache_release(entry->doc);
+    return copy;
+}
+
+xmlDocPtr doc_cache_read(const char* path, int options, int shared) {
+    uint64_t size;
+    int64_t mtime;
+    if (installed && outputs_only) {
+        return read_output(path, options, shared);
+    }
+    if (!installed || is_stdio_path(path) || !get_file_size(path, &size) || !get_file_mtime(path, &mtime) || size > INT_MAX) {
+        return read_xml_file(path, options);
+    }
+
+    /* Same size and an older mtime is trusted without reading the file | 大小相同且修改时间较早时无需读取文件 */
+    DocEntry* entry = NULL;
+    int recent = (int64_t)time(NULL) - mtime < RECENT_SECONDS;
+    if (!recent) {
+        entry = lookup(path, size, mtime, 0, 0);
+    }
+    if (!entry) {
+        MappedFile file;
+        if (!map_file(path, &file)) {
+            return read_xml_file(path, options);
+        }
+        uint64_t hash = hash64(file.data, (size_t)file.size, 0);
+        entry = lookup(path, file.size, mtime, 1, hash);
+        if (!entry) {
+            entry = insert(path, &file, mtime, hash);
+        }
+        unmap_file(&file);
+        if (!entry) return NULL;
+    }
+
+    if (shared) {
+        return entry->doc;
+    }
+    xmlDocPtr copy = xmlCopyDoc(entry->doc, 1);
+    if (copy) copy->_private = NULL;
+    doc_cache_release(entry->doc);
+    return copy;
+}
+
+void doc_cache_release(xmlDocPtr doc) {
+    if (!doc) return;
+    if (!installed || !doc->_private) {
+        xmlFreeDoc(doc);
+        return;
+    }
+    pthread_mutex_lock(&cache_lock);
+    unref_entry((DocEntry*)doc->_private);
+    pthread_mutex_unlock(&cache_lock);
+}
+
+int doc_cache_expect(const char* path, int reads) {
+    int found;
+    int pos = find_expected(path, &found);
+    if (found) {
+        expected[pos].reads += reads;
+        return 1;
+    }
+    ExpectedOutput* grown = (ExpectedOutput*)realloc(expected, (size_t)(expected_count + 1) * sizeof(ExpectedOutput));
+    if (!grown) return 0;
+    expected = grown;
+    char* copy = strdup(path);
+    if (!copy) return 0;
+    memmove(&expected[pos + 1], &expected[pos], (size_t)(expected_count - pos) * sizeof(ExpectedOutput));
+    expected[pos].path = copy;
+    expected[pos].reads = reads;
+    expected_count++;
+    return 1;
+}
+
+int doc_cache_store(const char* path, xmlDocPtr doc) {
+    int found;
+    uint64_t size;
+    if (!installed || !outputs_only) {
+        return 0;
+    }
+    int pos = find_expected(path, &found);
+    if (!found || !get_file_size(path, &size)) {
+        return 0;
+    }
+
+    /* Kept trees are only read or handed over whole, so even a dictionary is never written by two threads.
+     * A tree shared with other readers is copied. | 保留的文档树只会被读取或整体交出，因此字典不会被两个线程同时写入；与其他读取者共享的文档树会被复制 */
+    xmlDocPtr kept = doc;
+    if (doc->_private) {
+        kept = xmlCopyDoc(doc, 1);
+        if (!kept) return 0;
+        kept->_private = NULL;
+    }
+    DocEntry* entry = add_entry(path, kept, size, 0, 0, 1);
+    if (!entry) {
+        if (kept != doc) xmlFreeDoc(kept);
+        return 0;
+    }
+    /* No job reads path before this one has finished | 在本任务完成之前没有任务读取path */
+    pthread_mutex_lock(&cache_lock);
+    entry->reads_left = expected[pos].reads;
+    counters.stored++;
+    pthread_mutex_unlock(&cache_lock);
+    return kept == doc;
+}
+
+void doc_cache_get_stats(DocCacheStats* stats) {
+    pthread_mutex_lock(&cache_lock);
+    *stats = counters;
+    pthread_mutex_unlock(&cache_lock);
+}
+
+void doc_cache_shutdown(void) {
+    pthread_mutex_lock(&cache_lock);
+    while (lru_head) {
+        remove_entry(lru_head);
+    }
+    pthread_mutex_unlock(&cache_lock);
+    installed = 0;
+    outputs_only = 0;
+    for (int i = 0; i < expected_count; i++) {
+        free(expected[i].path);
+    }
+    free(expected);
+    expected = NULL;
+    expected_count = 0;
+}
@@ -0,0 +1,53 @@
+#ifndef DOC_CACHE_H
+#define DOC_CACHE_H
+
+#include <stdint.h>
+#include <libxml/tree.h>
+
+/* Counters of the document cache | 文档缓存的计数 */
+typedef struct {
+    uint64_t hits;           /* Size and mtime unchanged | 大小和修改时间未变 */
+    uint64_t revalidated;    /* mtime changed but same hash, not parsed again | 修改时间变化但哈希相同，未重新解析 */
+    uint64_t parsed;         /* Not cached or content changed | 未缓存或内容已变化 */
+    uint64_t evicted;
+    uint64_t stored;         /* Outputs kept for later jobs | 为后续任务保留的输出 */
+    int documents;
+    uint64_t bytes;          /* Source bytes of cached documents | 已缓存文档的源文件字节数 */
+} DocCacheStats;
+
+/* Keep parsed documents in memory, least recently used dropped above max_bytes of source files | 在内存中保留已解析的文档，源文件总字节数超过max_bytes时丢弃最久未使用的文档
+ * Call before starting threads, documents are checked by size, mtime and content hash | 需在启动线程前调用，文档通过大小、修改时间和内容哈希校验 */
+int doc_cache_install(uint64_t max_bytes);
+
+/* Check whether the document cache is installed | 检查是否已安装文档缓存 */
+int doc_cache_enabled(void);
+
+/* Read document, from the cache if installed, else like read_xml_file | 读取文档，已安装缓存时从缓存读取，否则等同于read_xml_file
+ * shared != 0 returns the cached tree itself which must not be modified, otherwise a private copy.
+ * Release the result with doc_cache_release in both cases, NULL if file cannot be parsed.
+ * shared非0时返回缓存中的文档树本身，不能修改，否则返回私有副本；两种情况都用doc_cache_release释放，无法解析时返回NULL */
+xmlDocPtr doc_cache_read(const char* path, int options, int shared);
+
+/* Release document returned by doc_cache_read | 释放doc_cache_read返回的文档 */
+void doc_cache_release(xmlDocPtr doc);
+
+/* Keep only outputs of jobs for the jobs reading them, other files are parsed as usual | 只为读取任务输出的任务保留这些输出，其他文件照常解析
+ * Each kept output is dropped after its last expected read, which takes the tree over without copying.
+ * 每个保留的输出在最后一次预期读取后移除，最后一次读取直接接管文档树而不复制 */
+int doc_cache_install_outputs(uint64_t max_bytes);
+
+/* Expect path to be saved by one job and read reads times by others, call before starting threads | 预期path由一个任务保存并被其他任务读取reads次，需在启动线程前调用 */
+int doc_cache_expect(const char* path, int reads);
+
+/* Offer document just saved to an expected path, so reading it needs no parsing | 提供刚保存到预期路径的文档，使读取它时无需解析
+ * Returns 1 if the cache took doc, otherwise the caller still frees or releases it, a shared tree is copied.
+ * 缓存接管doc时返回1，否则仍由调用者释放；共享的文档树会被复制 */
+int doc_cache_store(const char* path, xmlDocPtr doc);
+
+/* Get counters of the cache | 获取缓存计数 */
+void doc_cache_get_stats(DocCacheStats* stats);
+
+/* Free all cached documents, none may be in use | 释放所有缓存的文档，此时不能有文档仍在使用 */
+void doc_cache_shutdown(void);
+
+#endif /* DOC_CACHE_H */
@@ -1,5 +1,8 @@
+/* copy_file_range of glibc | glibc的copy_file_range */
+#define _GNU_SOURCE
 #include "fs_utils.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <errno.h>
 #include <sys/stat.h>
@@ -7,27 +10,35 @@
 
 #ifdef _WIN32
 #include <direct.h>
+#include <windows.h>
 #define mkdir(path, mode) _mkdir(path)
+#define getcwd _getcwd
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
 #endif
 
 /* Get directory path from file path | 从文件路径中获取目录路径 */
-void get_directory_path(const char* file_path, char* dir_path, size_t size) {
-    strncpy(dir_path, file_path, size);
-    dir_path[size - 1] = '\0';
-    
-    char* last_slash = strrchr(dir_path, '/');
-    char* last_backslash = strrchr(dir_path, '\\');
+char* get_directory_path(const char* file_path) {
+    const char* last_slash = strrchr(file_path, '/');
+    const char* last_backslash = strrchr(file_path, '\\');
     
     /* Use the rightmost slash or backslash | 使用最右边的斜杠或反斜杠 */
-    char* last_separator = last_slash > last_backslash ? last_slash : last_backslash;
+    const char* last_separator = last_slash > last_backslash ? last_slash : last_backslash;
     
-    if (last_separator) {
-        /* Terminate string at separator | 在分隔符处截断字符串 */
-        *(last_separator) = '\0';
-    } else {
+    if (!last_separator) {
         /* No directory part, use current directory | 没有目录部分，使用当前目录 */
-        strncpy(dir_path, ".", size);
+        return strdup(".");
     }
+
+    /* Copy up to the separator | 复制到分隔符为止 */
+    size_t len = (size_t)(last_separator - file_path);
+    char* dir_path = (char*)malloc(len + 1);
+    if (!dir_path) return NULL;
+    memcpy(dir_path, file_path, len);
+    dir_path[len] = '\0';
+    return dir_path;
 }
 
 /* Create directory recursively | 递归创建目录 */
@@ -36,11 +47,11 @@ int create_directories(const char* path) {
         return 1;  /* Current directory always exists | 当前目录总是存在的 */
     }
 
-    char tmp[256];
+    char* tmp = strdup(path);
     char* p = NULL;
     size_t len;
 
-    snprintf(tmp, sizeof(tmp), "%s", path);
+    if (!tmp) return 0;
     len = strlen(tmp);
     
     /* Remove trailing slash | 移除末尾的斜杠 */
@@ -57,6 +68,7 @@ int create_directories(const char* path) {
             #else
             if (mkdir(tmp, 0755) != 0 && errno != EEXIST) {
             #endif
+                free(tmp);
                 return 0;
             }
             *p = '/';
@@ -69,8 +81,267 @@ int create_directories(const char* path) {
     #else
     if (mkdir(tmp, 0755) != 0 && errno != EEXIST) {
     #endif
+        free(tmp);
         return 0;
     }
     
+    free(tmp);
     return 1;
-} 
\ No newline at end of file
+}
+
+/* Create directory holding file | 创建存放文件的目录 */
+int create_parent_directories(const char* file_path) {
+    char* dir_path = get_directory_path(file_path);
+    if (!dir_path) return 0;
+    int ok = create_directories(dir_path);
+    free(dir_path);
+    return ok;
+}
+
+/* Get current directory, buffer grows until it fits | 获取当前目录，缓冲区按需增长 */
+char* get_current_directory(void) {
+    size_t size = 256;
+    for (;;) {
+        char* buffer = (char*)malloc(size);
+        if (!buffer) return NULL;
+        if (getcwd(buffer, (int)size)) return buffer;
+        free(buffer);
+        if (errno != ERANGE) return NULL;
+        size *= 2;
+    }
+}
+
+/* Build output file path from -m file and -o directory | 根据-m文件和-o目录构建输出文件路径 */
+char* build_output_path(const char* output_file, const char* output_dir) {
+    /* Standard output "-" in either stays "-" | 任一方为标准输出"-"时结果仍为"-" */
+    if (strcmp(output_file, "-") == 0 || strcmp(output_dir, "-") == 0) {
+        return strdup("-");
+    }
+    if (strcmp(output_dir, ".") == 0) {
+        /* No -o parameter, use path from -m directly | 没有-o参数，直接使用-m的路径 */
+        return strdup(output_file);
+    }
+
+    /* -o parameter exists, combine output_dir with filename from -m | 存在-o参数，将output_dir与-m的文件名组合 */
+    const char *last_slash = strrchr(output_file, '/');
+    const char *last_backslash = strrchr(output_file, '\\');
+    const char *last_separator = last_slash > last_backslash ? last_slash : last_backslash;
+    const char *filename = last_separator ? last_separator + 1 : output_file;
+
+    /* Combine output_dir with filename | 组合output_dir和文件名 */
+    size_t size = strlen(output_dir) + strlen(filename) + 2;
+    char* final_path = (char*)malloc(size);
+    if (final_path) {
+        snprintf(final_path, size, "%s/%s", output_dir, filename);
+    }
+    return final_path;
+}
+
+/* Read one line of arbitrary length, buffer grows as needed | 读取任意长度的一行，缓冲区按需增长 */
+long read_line(FILE* file, char** buffer, size_t* capacity) {
+    size_t len = 0;
+
+    if (*buffer == NULL || *capacity == 0) {
+        *capacity = 4096;
+        *buffer = (char*)malloc(*capacity);
+        if (!*buffer) return -1;
+    }
+
+    while (fgets(*buffer + len, (int)(*capacity - len), file)) {
+        len += strlen(*buffer + len);
+        if (len > 0 && (*buffer)[len - 1] == '\n') {
+            break;
+        }
+
+        /* Line did not fit, double the buffer | 行未读完，缓冲区加倍 */
+        if (len + 1 >= *capacity) {
+            char* grown = (char*)realloc(*buffer, *capacity * 2);
+            if (!grown) return -1;
+            *buffer = grown;
+            *capacity *= 2;
+        }
+    }
+
+    if (len == 0 && feof(file)) {
+        return -1;
+    }
+
+    /* Remove trailing newline | 移除行尾的换行符 */
+    while (len > 0 && ((*buffer)[len - 1] == '\n' || (*buffer)[len - 1] == '\r')) {
+        len--;
+    }
+    (*buffer)[len] = '\0';
+    return (long)len;
+}
+
+/* Append copy of path to list | 向列表追加路径副本 */
+int path_list_add(PathList* list, const char* path) {
+    if (list->count == list->capacity) {
+        int capacity = list->capacity ? list->capacity * 2 : 64;
+        char** items = (char**)realloc(list->items, (size_t)capacity * sizeof(char*));
+        if (!items) return 0;
+        list->items = items;
+        list->capacity = capacity;
+    }
+    list->items[list->count] = strdup(path);
+    if (!list->items[list->count]) return 0;
+    list->count++;
+    return 1;
+}
+
+static int compare_paths(const void* a, const void* b) {
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+/* Sort list in byte order | 按字节顺序排序列表 */
+void path_list_sort(PathList* list) {
+    if (list->count > 1) {
+        qsort(list->items, (size_t)list->count, sizeof(char*), compare_paths);
+    }
+}
+
+/* Free all paths in list | 释放列表中的所有路径 */
+void path_list_free(PathList* list) {
+    for (int i = 0; i < list->count; i++) {
+        free(list->items[i]);
+    }
+    free(list->items);
+    list->items = NULL;
+    list->count = 0;
+    list->capacity = 0;
+}
+
+/* Check whether path is a directory | 检查路径是否为目录 */
+int is_directory(const char* path) {
+    struct stat st;
+    return stat(path, &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+/* Get file size | 获取文件大小 */
+int get_file_size(const char* path, uint64_t* size) {
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        return 0;
+    }
+    *size = (uint64_t)st.st_size;
+    return 1;
+}
+
+/* Get file modification time in seconds | 获取文件修改时间（秒） */
+int get_file_mtime(const char* path, int64_t* mtime) {
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        return 0;
+    }
+    *mtime = (int64_t)st.st_mtime;
+    return 1;
+}
+
+/* Copy file contents, creating or truncating target | 复制文件内容，创建或截断目标文件 */
+int copy_file(const char* from, const char* to) {
+#ifdef _WIN32
+    return CopyFileA(from, to, FALSE) != 0;
+#else
+    int in = open(from, O_RDONLY);
+    if (in < 0) {
+        return 0;
+    }
+    int out = open(to, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (out < 0) {
+        close(in);
+        return 0;
+    }
+    int ok = 1;
+    int done = 0;
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 27)
+    /* Copy inside the kernel, a reflink on copy-on-write file systems | 在内核中复制，在写时复制文件系统上为reflink */
+    uint64_t copied = 0;
+    ssize_t n;
+    while ((n = copy_file_range(in, NULL, out, NULL, (size_t)1 << 30, 0)) > 0) {
+        copied += (uint64_t)n;
+    }
+    /* Failing before the first byte means unsupported here, copy through user space | 在第一个字节前失败表示此处不支持，改为经用户空间复制 */
+    done = n == 0;
+    ok = n == 0 || copied == 0;
+#endif
+    if (ok && !done) {
+        char* buffer = (char*)malloc(1 << 20);
+        ok = buffer != NULL;
+        ssize_t got;
+        while (ok && (got = read(in, buffer, 1 << 20)) != 0) {
+            ok = got > 0 && write(out, buffer, (size_t)got) == got;
+        }
+        free(buffer);
+    }
+    close(in);
+    if (close(out) != 0) {
+        ok = 0;
+    }
+    return ok;
+#endif
+}
+
+/* Map whole file read-only | 以只读方式映射整个文件 */
+int map_file(const char* path, MappedFile* file) {
+    memset(file, 0, sizeof(MappedFile));
+#ifdef _WIN32
+    HANDLE handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                                FILE_ATTRIBUTE_NORMAL, NULL);
+    if (handle == INVALID_HANDLE_VALUE) {
+        return 0;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(handle, &size)) {
+        CloseHandle(handle);
+        return 0;
+    }
+    file->size = (uint64_t)size.QuadPart;
+    if (file->size > 0) {
+        file->mapping = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (file->mapping) {
+            file->data = (const char*)MapViewOfFile(file->mapping, FILE_MAP_READ, 0, 0, 0);
+        }
+        if (!file->data) {
+            if (file->mapping) CloseHandle(file->mapping);
+            CloseHandle(handle);
+            return 0;
+        }
+    }
+    CloseHandle(handle);  /* Mapping keeps file open | 映射会保持文件打开 */
+    return 1;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return 0;
+    }
+    file->size = (uint64_t)st.st_size;
+    if (file->size > 0) {
+        void* data = mmap(NULL, (size_t)file->size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            close(fd);
+            return 0;
+        }
+        file->data = (const char*)data;
+    }
+    close(fd);  /* Mapping keeps file open | 映射会保持文件打开 */
+    return 1;
+#endif
+}
+
+/* Release mapping created by map_file | 释放map_file创建的映射 */
+void unmap_file(MappedFile* file) {
+    if (file->data) {
+#ifdef _WIN32
+        UnmapViewOfFile((void*)file->data);
+        CloseHandle(file->mapping);
+#else
+        munmap((void*)file->data, (size_t)file->size);
+#endif
+    }
+    memset(file, 0, sizeof(MappedFile));
+}
@@ -1,12 +1,74 @@
 #ifndef FS_UTILS_H
 #define FS_UTILS_H
 
+#include <stdio.h>
 #include <stddef.h>
+#include <stdint.h>
+
+/* Growable list of paths | 可增长的路径列表 */
+typedef struct {
+    char** items;
+    int count;
+    int capacity;
+} PathList;
+
+/* Read-only memory mapped file | 只读内存映射文件 */
+typedef struct {
+    const char* data;
+    uint64_t size;
+#ifdef _WIN32
+    void* mapping;  /* Windows file mapping handle | Windows文件映射句柄 */
+#endif
+} MappedFile;
 
 /* Create directory recursively | 递归创建目录 */
 int create_directories(const char* path);
 
-/* Get directory path from file path | 从文件路径中获取目录路径 */
-void get_directory_path(const char* file_path, char* dir_path, size_t size);
+/* Create directory holding file, "." needs nothing | 创建存放文件的目录，"."无需创建 */
+int create_parent_directories(const char* file_path);
+
+/* Get directory path from file path, caller frees it, NULL if out of memory | 从文件路径中获取目录路径，由调用者释放，内存不足时返回NULL */
+char* get_directory_path(const char* file_path);
+
+/* Get current directory, caller frees it, NULL on failure | 获取当前目录，由调用者释放，失败时返回NULL */
+char* get_current_directory(void);
+
+/* Build output file path from -m file and -o directory, caller frees it | 根据-m文件和-o目录构建输出文件路径，由调用者释放
+ * If output_dir is not ".", only the file name of output_file is kept | 若output_dir不为"."，仅保留output_file的文件名
+ * Standard output "-" as either gives "-" | 任一方为标准输出"-"时返回"-"
+ * Returns NULL if out of memory | 内存不足时返回NULL */
+char* build_output_path(const char* output_file, const char* output_dir);
+
+/* Read one line of arbitrary length, buffer grows as needed | 读取任意长度的一行，缓冲区按需增长
+ * Returns line length without newline, or -1 at end of file | 返回不含换行符的行长度，文件结束时返回-1 */
+long read_line(FILE* file, char** buffer, size_t* capacity);
+
+/* Append copy of path to list | 向列表追加路径副本 */
+int path_list_add(PathList* list, const char* path);
+
+/* Sort list in byte order | 按字节顺序排序列表 */
+void path_list_sort(PathList* list);
+
+/* Free all paths in list | 释放列表中的所有路径 */
+void path_list_free(PathList* list);
+
+/* Check whether path is a directory | 检查路径是否为目录 */
+int is_directory(const char* path);
+
+/* Get file size, returns 0 if file cannot be accessed | 获取文件大小，无法访问文件时返回0 */
+int get_file_size(const char* path, uint64_t* size);
+
+/* Get file modification time in seconds, returns 0 if file cannot be accessed | 获取文件修改时间（秒），无法访问文件时返回0 */
+int get_file_mtime(const char* path, int64_t* mtime);
+
+/* Copy file contents, creating or truncating target, returns 0 on failure | 复制文件内容，创建或截断目标文件，失败时返回0 */
+int copy_file(const char* from, const char* to);
+
+/* Map whole file read-only, empty files give data NULL | 以只读方式映射整个文件，空文件的data为NULL
+ * Returns 0 if file cannot be mapped | 无法映射文件时返回0 */
+int map_file(const char* path, MappedFile* file);
+
+/* Release mapping created by map_file | 释放map_file创建的映射 */
+void unmap_file(MappedFile* file);
 
 #endif /* FS_UTILS_H */ 
\ No newline at end of file
@@ -0,0 +1,165 @@
+#include "hash_utils.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+/* XXH64 primes | XXH64质数常量 */
+#define PRIME64_1 0x9E3779B185EBCA87ULL
+#define PRIME64_2 0xC2B2AE3D27D4EB4FULL
+#define PRIME64_3 0x165667B19E3779F9ULL
+#define PRIME64_4 0x85EBCA77C2B2AE63ULL
+#define PRIME64_5 0x27D4EB2F165667C5ULL
+
+#define HASH_FILE_BUFFER (1 << 20)
+
+static uint64_t rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+/* Read little endian values independent of alignment | 与对齐无关地读取小端数值 */
+static uint64_t read64(const unsigned char* p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static uint32_t read32(const unsigned char* p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static uint64_t round64(uint64_t acc, uint64_t input) {
+    acc += input * PRIME64_2;
+    acc = rotl64(acc, 31);
+    return acc * PRIME64_1;
+}
+
+static uint64_t merge_round64(uint64_t acc, uint64_t val) {
+    acc ^= round64(0, val);
+    return acc * PRIME64_1 + PRIME64_4;
+}
+
+/* Initialize hash state | 初始化哈希状态 */
+void hash64_init(Hash64State* state, uint64_t seed) {
+    memset(state, 0, sizeof(Hash64State));
+    state->seed = seed;
+    state->v[0] = seed + PRIME64_1 + PRIME64_2;
+    state->v[1] = seed + PRIME64_2;
+    state->v[2] = seed;
+    state->v[3] = seed - PRIME64_1;
+}
+
+/* Feed bytes into hash | 向哈希输入数据 */
+void hash64_update(Hash64State* state, const void* data, size_t len) {
+    const unsigned char* p = (const unsigned char*)data;
+    const unsigned char* end = p + len;
+
+    state->total_len += len;
+
+    /* Not enough for a full stripe yet | 数据不足一个完整条带 */
+    if (state->mem_size + len < 32) {
+        memcpy(state->mem + state->mem_size, p, len);
+        state->mem_size += len;
+        return;
+    }
+
+    /* Complete buffered stripe | 补全缓存中的条带 */
+    if (state->mem_size > 0) {
+        size_t fill = 32 - state->mem_size;
+        memcpy(state->mem + state->mem_size, p, fill);
+        for (int i = 0; i < 4; i++) {
+            state->v[i] = round64(state->v[i], read64(state->mem + i * 8));
+        }
+        p += fill;
+        state->mem_size = 0;
+    }
+
+    /* Process full stripes | 处理完整条带 */
+    while (p + 32 <= end) {
+        for (int i = 0; i < 4; i++) {
+            state->v[i] = round64(state->v[i], read64(p + i * 8));
+        }
+        p += 32;
+    }
+
+    /* Keep remainder | 保存剩余数据 */
+    if (p < end) {
+        state->mem_size = (size_t)(end - p);
+        memcpy(state->mem, p, state->mem_size);
+    }
+}
+
+/* Get final hash value | 获取最终哈希值 */
+uint64_t hash64_digest(const Hash64State* state) {
+    uint64_t h;
+    const unsigned char* p = state->mem;
+    const unsigned char* end = p + state->mem_size;
+
+    if (state->total_len >= 32) {
+        h = rotl64(state->v[0], 1) + rotl64(state->v[1], 7) + rotl64(state->v[2], 12) + rotl64(state->v[3], 18);
+        for (int i = 0; i < 4; i++) {
+            h = merge_round64(h, state->v[i]);
+        }
+    } else {
+        h = state->seed + PRIME64_5;
+    }
+    h += state->total_len;
+
+    while (p + 8 <= end) {
+        h ^= round64(0, read64(p));
+        h = rotl64(h, 27) * PRIME64_1 + PRIME64_4;
+        p += 8;
+    }
+    if (p + 4 <= end) {
+        h ^= (uint64_t)read32(p) * PRIME64_1;
+        h = rotl64(h, 23) * PRIME64_2 + PRIME64_3;
+        p += 4;
+    }
+    while (p < end) {
+        h ^= (*p) * PRIME64_5;
+        h = rotl64(h, 11) * PRIME64_1;
+        p++;
+    }
+
+    /* Final avalanche | 最终混合 */
+    h ^= h >> 33;
+    h *= PRIME64_2;
+    h ^= h >> 29;
+    h *= PRIME64_3;
+    h ^= h >> 32;
+    return h;
+}
+
+/* Hash memory block in one call | 一次性计算内存块的哈希 */
+uint64_t hash64(const void* data, size_t len, uint64_t seed) {
+    Hash64State state;
+    hash64_init(&state, seed);
+    hash64_update(&state, data, len);
+    return hash64_digest(&state);
+}
+
+/* Hash file contents | 计算文件内容的哈希 */
+int hash_file(const char* path, uint64_t* hash) {
+    FILE* file = fopen(path, "rb");
+    if (!file) return 0;
+
+    unsigned char* buffer = (unsigned char*)malloc(HASH_FILE_BUFFER);
+    if (!buffer) {
+        fclose(file);
+        return 0;
+    }
+
+    Hash64State state;
+    hash64_init(&state, 0);
+    size_t n;
+    while ((n = fread(buffer, 1, HASH_FILE_BUFFER, file)) > 0) {
+        hash64_update(&state, buffer, n);
+    }
+    int ok = !ferror(file);
+
+    free(buffer);
+    fclose(file);
+    *hash = hash64_digest(&state);
+    return ok;
+}
@@ -0,0 +1,31 @@
+#ifndef HASH_UTILS_H
+#define HASH_UTILS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* Streaming XXH64 state | 流式XXH64哈希状态 */
+typedef struct {
+    uint64_t total_len;
+    uint64_t v[4];
+    unsigned char mem[32];
+    size_t mem_size;
+    uint64_t seed;
+} Hash64State;
+
+/* Initialize hash state | 初始化哈希状态 */
+void hash64_init(Hash64State* state, uint64_t seed);
+
+/* Feed bytes into hash | 向哈希输入数据 */
+void hash64_update(Hash64State* state, const void* data, size_t len);
+
+/* Get final hash value | 获取最终哈希值 */
+uint64_t hash64_digest(const Hash64State* state);
+
+/* Hash memory block in one call | 一次性计算内存块的哈希 */
+uint64_t hash64(const void* data, size_t len, uint64_t seed);
+
+/* Hash file contents, returns 0 if file cannot be read | 计算文件内容的哈希，无法读取文件时返回0 */
+int hash_file(const char* path, uint64_t* hash);
+
+#endif /* HASH_UTILS_H */
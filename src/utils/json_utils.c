@@ -0,0 +1,230 @@
+#include "json_utils.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+/* Write string of given length as JSON string | 将指定长度的字符串写为JSON字符串 */
+void json_write_string_len(FILE* out, const char* str, size_t len) {
+    const char* run = str;
+    const char* end = str + len;
+
+    fputc('"', out);
+    for (const char* p = str; p < end; p++) {
+        unsigned char c = (unsigned char)*p;
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+
+        /* Flush unescaped run before the special character | 输出特殊字符之前的未转义部分 */
+        fwrite(run, 1, (size_t)(p - run), out);
+        run = p + 1;
+
+        switch (c) {
+            case '"':  fputs("\\\"", out); break;
+            case '\\': fputs("\\\\", out); break;
+            case '\n': fputs("\\n", out); break;
+            case '\r': fputs("\\r", out); break;
+            case '\t': fputs("\\t", out); break;
+            default:   fprintf(out, "\\u%04x", c); break;
+        }
+    }
+    fwrite(run, 1, (size_t)(end - run), out);
+    fputc('"', out);
+}
+
+/* Write string as quoted and escaped JSON string | 将字符串写为带引号并转义的JSON字符串 */
+void json_write_string(FILE* out, const char* str) {
+    json_write_string_len(out, str ? str : "", str ? strlen(str) : 0);
+}
+
+/* Skip whitespace | 跳过空白字符 */
+static const char* skip_ws(const char* p) {
+    while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') p++;
+    return p;
+}
+
+/* Parse 4 hex digits | 解析4位十六进制数 */
+static int parse_hex4(const char* p, unsigned* value) {
+    *value = 0;
+    for (int i = 0; i < 4; i++) {
+        char c = p[i];
+        *value <<= 4;
+        if (c >= '0' && c <= '9') *value |= (unsigned)(c - '0');
+        else if (c >= 'a' && c <= 'f') *value |= (unsigned)(c - 'a' + 10);
+        else if (c >= 'A' && c <= 'F') *value |= (unsigned)(c - 'A' + 10);
+        else return 0;
+    }
+    return 1;
+}
+
+/* Encode code point as UTF-8 | 将码点编码为UTF-8 */
+static char* put_utf8(char* out, unsigned cp) {
+    if (cp < 0x80) {
+        *out++ = (char)cp;
+    } else if (cp < 0x800) {
+        *out++ = (char)(0xC0 | (cp >> 6));
+        *out++ = (char)(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        *out++ = (char)(0xE0 | (cp >> 12));
+        *out++ = (char)(0x80 | ((cp >> 6) & 0x3F));
+        *out++ = (char)(0x80 | (cp & 0x3F));
+    } else {
+        *out++ = (char)(0xF0 | (cp >> 18));
+        *out++ = (char)(0x80 | ((cp >> 12) & 0x3F));
+        *out++ = (char)(0x80 | ((cp >> 6) & 0x3F));
+        *out++ = (char)(0x80 | (cp & 0x3F));
+    }
+    return out;
+}
+
+/* Parse quoted JSON string, returns position after closing quote | 解析带引号的JSON字符串，返回结束引号之后的位置 */
+static const char* parse_string(const char* p, char** result, size_t* result_len) {
+    const char* start = ++p;  /* Skip opening quote | 跳过起始引号 */
+    size_t raw_len = 0;
+
+    /* Find closing quote to size the buffer | 查找结束引号以确定缓冲区大小 */
+    while (*p && *p != '"') {
+        if (*p == '\\' && p[1]) p++;
+        p++;
+    }
+    if (*p != '"') return NULL;
+    raw_len = (size_t)(p - start);
+
+    /* Unescaped text is never longer than the raw text | 反转义后的文本不会比原文更长 */
+    char* buf = (char*)malloc(raw_len + 1);
+    if (!buf) return NULL;
+
+    char* out = buf;
+    for (const char* q = start; q < p; q++) {
+        if (*q != '\\') {
+            *out++ = *q;
+            continue;
+        }
+        q++;
+        switch (*q) {
+            case 'n': *out++ = '\n'; break;
+            case 'r': *out++ = '\r'; break;
+            case 't': *out++ = '\t'; break;
+            case 'b': *out++ = '\b'; break;
+            case 'f': *out++ = '\f'; break;
+            case 'u': {
+                unsigned cp;
+                if (q + 4 >= p || !parse_hex4(q + 1, &cp)) {
+                    free(buf);
+                    return NULL;
+                }
+                q += 4;
+                /* Combine surrogate pair | 合并代理对 */
+                if (cp >= 0xD800 && cp <= 0xDBFF && q + 6 < p && q[1] == '\\' && q[2] == 'u') {
+                    unsigned low;
+                    if (parse_hex4(q + 3, &low) && low >= 0xDC00 && low <= 0xDFFF) {
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                        q += 6;
+                    }
+                }
+                out = put_utf8(out, cp);
+                break;
+            }
+            default: *out++ = *q; break;  /* \" \\ \/ | 其他转义字符 */
+        }
+    }
+    *out = '\0';
+
+    *result = buf;
+    *result_len = (size_t)(out - buf);
+    return p + 1;
+}
+
+/* Parse one flat JSON object (no nesting) | 解析一个扁平JSON对象（不支持嵌套） */
+int json_parse_flat_object(const char* text, JsonField* fields, int max_fields) {
+    int count = 0;
+    const char* p = skip_ws(text);
+
+    if (*p != '{') return -1;
+    p = skip_ws(p + 1);
+    if (*p == '}') return 0;
+
+    while (*p) {
+        char* key = NULL;
+        char* value = NULL;
+        size_t key_len = 0;
+        size_t value_len = 0;
+
+        /* Key | 键 */
+        if (*p != '"' || !(p = parse_string(p, &key, &key_len))) {
+            json_free_fields(fields, count);
+            return -1;
+        }
+        p = skip_ws(p);
+        if (*p != ':') {
+            free(key);
+            json_free_fields(fields, count);
+            return -1;
+        }
+        p = skip_ws(p + 1);
+
+        /* Value: string or raw literal | 值：字符串或原始字面量 */
+        if (*p == '"') {
+            p = parse_string(p, &value, &value_len);
+        } else {
+            const char* start = p;
+            while (*p && *p != ',' && *p != '}' && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n') p++;
+            value_len = (size_t)(p - start);
+            if (value_len > 0 && *start != '{' && *start != '[' && (value = (char*)malloc(value_len + 1))) {
+                memcpy(value, start, value_len);
+                value[value_len] = '\0';
+            } else {
+                p = NULL;
+            }
+        }
+        if (!p || !value) {
+            free(key);
+            free(value);
+            json_free_fields(fields, count);
+            return -1;
+        }
+
+        /* Store field, extra fields beyond max_fields are dropped | 保存字段，超出max_fields的字段被忽略 */
+        if (count < max_fields) {
+            fields[count].key = key;
+            fields[count].value = value;
+            fields[count].value_len = value_len;
+            count++;
+        } else {
+            free(key);
+            free(value);
+        }
+
+        p = skip_ws(p);
+        if (*p == ',') {
+            p = skip_ws(p + 1);
+        } else if (*p == '}') {
+            return count;
+        } else {
+            break;
+        }
+    }
+
+    json_free_fields(fields, count);
+    return -1;
+}
+
+/* Free fields returned by json_parse_flat_object | 释放json_parse_flat_object返回的字段 */
+void json_free_fields(JsonField* fields, int count) {
+    for (int i = 0; i < count; i++) {
+        free(fields[i].key);
+        free(fields[i].value);
+        fields[i].key = NULL;
+        fields[i].value = NULL;
+    }
+}
+
+/* Find field value by key | 按键名查找字段值 */
+const char* json_get_field(const JsonField* fields, int count, const char* key) {
+    for (int i = 0; i < count; i++) {
+        if (strcmp(fields[i].key, key) == 0) {
+            return fields[i].value;
+        }
+    }
+    return NULL;
+}
@@ -0,0 +1,32 @@
+#ifndef JSON_UTILS_H
+#define JSON_UTILS_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+#define JSON_MAX_FIELDS 16
+
+/* One key/value pair of a flat JSON object | 扁平JSON对象中的一个键值对 */
+typedef struct {
+    char* key;
+    char* value;        /* Unescaped string, or raw text for numbers/literals | 反转义后的字符串，数字/字面量保留原文 */
+    size_t value_len;
+} JsonField;
+
+/* Write string as quoted and escaped JSON string | 将字符串写为带引号并转义的JSON字符串 */
+void json_write_string(FILE* out, const char* str);
+
+/* Write string of given length as JSON string | 将指定长度的字符串写为JSON字符串 */
+void json_write_string_len(FILE* out, const char* str, size_t len);
+
+/* Parse one flat JSON object (no nesting) | 解析一个扁平JSON对象（不支持嵌套）
+ * Returns number of fields, or -1 on syntax error | 返回字段数量，语法错误时返回-1 */
+int json_parse_flat_object(const char* text, JsonField* fields, int max_fields);
+
+/* Free fields returned by json_parse_flat_object | 释放json_parse_flat_object返回的字段 */
+void json_free_fields(JsonField* fields, int count);
+
+/* Find field value by key | 按键名查找字段值 */
+const char* json_get_field(const JsonField* fields, int count, const char* key);
+
+#endif /* JSON_UTILS_H */
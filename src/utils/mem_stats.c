@@ -0,0 +1,94 @@
+#include "mem_stats.h"
+#include <string.h>
+#include <libxml/xmlmemory.h>
+
+/* Block header keeping the size, 16 bytes so payload alignment is unchanged | 记录大小的块头，16字节以保持数据对齐不变 */
+#define MEM_HEADER_SIZE 16
+
+static MemStats stats;
+static int installed;
+
+/* Hooks in place before install, e.g. the arena | 安装前已有的钩子，例如arena */
+static xmlFreeFunc base_free;
+static xmlMallocFunc base_malloc;
+static xmlReallocFunc base_realloc;
+
+static int size_class_of(size_t size) {
+    int size_class = 0;
+    size_t limit = 16;
+    while (size > limit && size_class < MEM_SIZE_CLASSES - 1) {
+        limit <<= 1;
+        size_class++;
+    }
+    return size_class;
+}
+
+static void count_alloc(size_t size) {
+    stats.bytes += size;
+    stats.live_bytes += size;
+    if (stats.live_bytes > stats.high_water) stats.high_water = stats.live_bytes;
+    stats.size_classes[size_class_of(size)]++;
+}
+
+static void* counting_malloc(size_t size) {
+    char* block = (char*)base_malloc(size + MEM_HEADER_SIZE);
+    if (!block) return NULL;
+    *(size_t*)block = size;
+    stats.allocs++;
+    count_alloc(size);
+    return block + MEM_HEADER_SIZE;
+}
+
+static void counting_free(void* ptr) {
+    if (!ptr) return;
+    char* block = (char*)ptr - MEM_HEADER_SIZE;
+    stats.frees++;
+    stats.live_bytes -= *(size_t*)block;
+    base_free(block);
+}
+
+static void* counting_realloc(void* ptr, size_t size) {
+    if (!ptr) return counting_malloc(size);
+    char* block = (char*)ptr - MEM_HEADER_SIZE;
+    size_t old_size = *(size_t*)block;
+    char* new_block = (char*)base_realloc(block, size + MEM_HEADER_SIZE);
+    if (!new_block) return NULL;
+    *(size_t*)new_block = size;
+    stats.reallocs++;
+    stats.live_bytes -= old_size;
+    count_alloc(size);
+    return new_block + MEM_HEADER_SIZE;
+}
+
+static char* counting_strdup(const char* str) {
+    size_t len = strlen(str) + 1;
+    char* copy = (char*)counting_malloc(len);
+    if (copy) memcpy(copy, str, len);
+    return copy;
+}
+
+/* Install counting hooks | 安装计数钩子 */
+int mem_stats_install(void) {
+    if (installed) return 1;
+    xmlStrdupFunc base_strdup;
+    if (xmlMemGet(&base_free, &base_malloc, &base_realloc, &base_strdup) != 0) return 0;
+    if (xmlMemSetup(counting_free, counting_malloc, counting_realloc, counting_strdup) != 0) return 0;
+    installed = 1;
+    return 1;
+}
+
+int mem_stats_enabled(void) {
+    return installed;
+}
+
+void mem_stats_snapshot(MemStats* out) {
+    *out = stats;
+}
+
+void mem_stats_reset_high_water(void) {
+    stats.high_water = stats.live_bytes;
+}
+
+uint64_t mem_size_class_limit(int size_class) {
+    return size_class < MEM_SIZE_CLASSES - 1 ? (uint64_t)16 << size_class : 0;
+}
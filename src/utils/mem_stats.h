@@ -0,0 +1,39 @@
+#ifndef MEM_STATS_H
+#define MEM_STATS_H
+
+#include <stdint.h>
+
+/* Size classes: up to 16, 32, ... 512K bytes, last one is larger | 大小分级：不超过16、32……512K字节，最后一级为更大的分配 */
+#define MEM_SIZE_CLASSES 17
+
+/* Counters of libxml2 allocations | libxml2内存分配计数 */
+typedef struct {
+    uint64_t allocs;           /* malloc and strdup calls | malloc和strdup调用次数 */
+    uint64_t reallocs;
+    uint64_t frees;
+    uint64_t bytes;            /* Requested bytes, reallocs count their new size | 请求的字节数，realloc按新大小计 */
+    uint64_t live_bytes;       /* Currently allocated | 当前已分配 */
+    uint64_t high_water;       /* Highest live_bytes since install or last reset | 自安装或上次重置以来live_bytes的最大值 */
+    uint64_t size_classes[MEM_SIZE_CLASSES];
+} MemStats;
+
+/* Route libxml2 allocations through counting hooks with xmlMemSetup | 通过xmlMemSetup让libxml2的内存分配经过计数钩子
+ * Must run before libxml2 allocates anything. Counters are not atomic, so only modes that call
+ * libxml2 from one thread (merge, format) install it.
+ * Wraps hooks installed earlier, so it composes with the arena.
+ * 必须在libxml2分配任何内存之前调用；会包装之前安装的钩子，因此可与arena组合使用；计数器不是原子的，因此只有在单线程中调用libxml2的模式（merge、format）才安装 */
+int mem_stats_install(void);
+
+/* Whether hooks are installed | 是否已安装钩子 */
+int mem_stats_enabled(void);
+
+/* Copy current counters | 复制当前计数 */
+void mem_stats_snapshot(MemStats* stats);
+
+/* Restart high-water mark at the current live bytes | 从当前已分配字节数重新开始统计最高水位 */
+void mem_stats_reset_high_water(void);
+
+/* Upper size limit of a class in bytes, 0 for the last open class | 分级的字节上限，最后一个不设上限的分级返回0 */
+uint64_t mem_size_class_limit(int size_class);
+
+#endif /* MEM_STATS_H */
@@ -0,0 +1,344 @@
+#include "perf_utils.h"
+#include "fs_utils.h"
+#include "json_utils.h"
+#include "mem_stats.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#define PSAPI_VERSION 2
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <time.h>
+#include <sys/resource.h>
+#endif
+
+/* Monotonic wall clock in seconds | 单调递增的时钟（秒） */
+double perf_now(void) {
+#ifdef _WIN32
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    if (frequency.QuadPart == 0) QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+#endif
+}
+
+#ifndef _WIN32
+/* Read "<key>: <n> kB" from /proc/self/status, 0 if missing | 从/proc/self/status读取"<key>: <n> kB"，不存在时为0 */
+static uint64_t read_status_kb(const char* key) {
+    FILE* file = fopen("/proc/self/status", "r");
+    if (!file) return 0;
+    char line[256];
+    size_t key_len = strlen(key);
+    unsigned long long kb = 0;
+    while (fgets(line, sizeof(line), file)) {
+        if (strncmp(line, key, key_len) == 0 && line[key_len] == ':') {
+            sscanf(line + key_len + 1, "%llu", &kb);
+            break;
+        }
+    }
+    fclose(file);
+    return (uint64_t)kb * 1024;
+}
+#endif
+
+/* Peak resident set size in bytes | 峰值常驻内存（字节） */
+uint64_t perf_peak_rss(void) {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+    return (uint64_t)counters.PeakWorkingSetSize;
+#else
+    /* VmHWM follows resets through clear_refs, ru_maxrss does not | VmHWM会随clear_refs重置，ru_maxrss不会 */
+    uint64_t peak = read_status_kb("VmHWM");
+    if (peak == 0) {
+        struct rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef __APPLE__
+            peak = (uint64_t)usage.ru_maxrss;
+#else
+            peak = (uint64_t)usage.ru_maxrss * 1024;
+#endif
+        }
+    }
+    return peak;
+#endif
+}
+
+/* Current resident set size in bytes | 当前常驻内存（字节） */
+uint64_t perf_current_rss(void) {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+    return (uint64_t)counters.WorkingSetSize;
+#else
+    return read_status_kb("VmRSS");
+#endif
+}
+
+/* Reset peak RSS | 重置峰值内存 */
+int perf_reset_peak_rss(void) {
+#ifdef _WIN32
+    return 0;
+#else
+    /* Linux 4.0+: writing 5 resets VmHWM to the current RSS | Linux 4.0+：写入5会将VmHWM重置为当前常驻内存 */
+    FILE* file = fopen("/proc/self/clear_refs", "w");
+    if (!file) return 0;
+    int ok = fputs("5", file) >= 0;
+    if (fclose(file) != 0) ok = 0;
+    return ok;
+#endif
+}
+
+/* Set once before jobs start, read only afterwards | 在任务开始前设置一次，之后只读 */
+static int shared_process;
+
+void perf_set_shared_process(void) {
+    shared_process = 1;
+}
+
+/* Throughput in MB/s | 吞吐量（MB/s） */
+double perf_mb_per_s(uint64_t bytes, double seconds) {
+    return seconds > 0 ? (double)bytes / (1024.0 * 1024.0) / seconds : 0.0;
+}
+
+/* One finished phase | 一个已完成的阶段 */
+typedef struct {
+    const char* phase;      /* Static name | 静态名称 */
+    char* file;
+    double seconds;
+    uint64_t bytes_in;
+    uint64_t bytes_out;
+    uint64_t peak_rss;
+    MemStats alloc;         /* libxml2 allocations of the phase, if counted | 该阶段的libxml2内存分配（若已统计） */
+} PerfRecord;
+
+struct PerfProfile {
+    const char* mode;
+    double start;
+    int peak_resets;        /* Peak RSS is per phase | 峰值内存按阶段统计 */
+    int shared;             /* Peak RSS includes other jobs of the process | 峰值内存包含本进程的其他任务 */
+    int count_allocs;       /* mem_stats hooks installed | 已安装mem_stats钩子 */
+    MemStats phase_alloc;   /* Counters at phase start | 阶段开始时的计数 */
+    PerfRecord* records;
+    size_t count;
+    size_t capacity;
+};
+
+/* Create profile | 创建性能记录 */
+PerfProfile* perf_profile_create(const char* mode) {
+    PerfProfile* profile = (PerfProfile*)calloc(1, sizeof(PerfProfile));
+    if (!profile) return NULL;
+    profile->mode = mode;
+    profile->shared = shared_process;
+    profile->count_allocs = mem_stats_enabled();
+    profile->start = perf_now();
+    return profile;
+}
+
+/* Start a phase | 开始一个阶段 */
+double perf_phase_begin(PerfProfile* profile) {
+    if (!profile) return 0.0;
+    profile->peak_resets = !profile->shared && perf_reset_peak_rss();
+    if (profile->count_allocs) {
+        mem_stats_reset_high_water();
+        mem_stats_snapshot(&profile->phase_alloc);
+    }
+    return perf_now();
+}
+
+/* Record finished phase | 记录已完成的阶段 */
+void perf_phase_end(PerfProfile* profile, const char* phase, const char* file, double start,
+                    uint64_t bytes_in, uint64_t bytes_out) {
+    if (!profile) return;
+    double seconds = perf_now() - start;
+    MemStats alloc;
+    memset(&alloc, 0, sizeof(alloc));
+    if (profile->count_allocs) {
+        /* Difference to phase start, live and high water stay absolute | 与阶段开始时的差值，live和high_water保持绝对值 */
+        const MemStats* begin = &profile->phase_alloc;
+        mem_stats_snapshot(&alloc);
+        alloc.allocs -= begin->allocs;
+        alloc.reallocs -= begin->reallocs;
+        alloc.frees -= begin->frees;
+        alloc.bytes -= begin->bytes;
+        for (int i = 0; i < MEM_SIZE_CLASSES; i++) {
+            alloc.size_classes[i] -= begin->size_classes[i];
+        }
+    }
+    if (profile->count == profile->capacity) {
+        size_t capacity = profile->capacity ? profile->capacity * 2 : 64;
+        PerfRecord* records = (PerfRecord*)realloc(profile->records, capacity * sizeof(PerfRecord));
+        if (!records) return;  /* Profiling must not fail the run | 性能记录不能导致运行失败 */
+        profile->records = records;
+        profile->capacity = capacity;
+    }
+    PerfRecord* record = &profile->records[profile->count++];
+    record->phase = phase;
+    record->file = file ? strdup(file) : NULL;
+    record->seconds = seconds;
+    record->bytes_in = bytes_in;
+    record->bytes_out = bytes_out;
+    record->peak_rss = perf_peak_rss();
+    record->alloc = alloc;
+}
+
+static void write_size_class(FILE* out, int size_class) {
+    uint64_t limit = mem_size_class_limit(size_class);
+    if (limit == 0) {
+        fprintf(out, ">%lluK", (unsigned long long)(mem_size_class_limit(size_class - 1) / 1024));
+    } else if (limit >= 1024) {
+        fprintf(out, "%lluK", (unsigned long long)(limit / 1024));
+    } else {
+        fprintf(out, "%llu", (unsigned long long)limit);
+    }
+}
+
+/* Write allocation counters of a phase as JSON object | 以JSON对象写出一个阶段的内存分配计数 */
+static void write_alloc_json(FILE* out, const MemStats* alloc) {
+    fprintf(out, "{\"allocs\":%llu,\"reallocs\":%llu,\"frees\":%llu,\"bytes\":%llu,\"live_bytes\":%llu,"
+            "\"high_water\":%llu,\"size_classes\":{", (unsigned long long)alloc->allocs,
+            (unsigned long long)alloc->reallocs, (unsigned long long)alloc->frees, (unsigned long long)alloc->bytes,
+            (unsigned long long)alloc->live_bytes, (unsigned long long)alloc->high_water);
+    for (int i = 0; i < MEM_SIZE_CLASSES; i++) {
+        fprintf(out, "%s\"", i ? "," : "");
+        write_size_class(out, i);
+        fprintf(out, "\":%llu", (unsigned long long)alloc->size_classes[i]);
+    }
+    fprintf(out, "}}");
+}
+
+/* Print allocation table and size classes per phase name | 打印内存分配表以及按阶段名汇总的大小分级 */
+static void print_allocs(const PerfProfile* profile) {
+    printf("Allocations (libxml2):\n");
+    printf("  %-14s %12s %10s %12s %10s %10s  %s\n", "phase", "allocs", "reallocs", "frees", "alloc MB",
+           "high MB", "file");
+    for (size_t i = 0; i < profile->count; i++) {
+        const PerfRecord* record = &profile->records[i];
+        printf("  %-14s %12llu %10llu %12llu %10.1f %10.1f  %s\n", record->phase,
+               (unsigned long long)record->alloc.allocs, (unsigned long long)record->alloc.reallocs,
+               (unsigned long long)record->alloc.frees, (double)record->alloc.bytes / (1024.0 * 1024.0),
+               (double)record->alloc.high_water / (1024.0 * 1024.0), record->file ? record->file : "");
+    }
+    printf("Size classes (allocations up to n bytes):\n");
+    for (size_t i = 0; i < profile->count; i++) {
+        const char* phase = profile->records[i].phase;
+        int seen = 0;
+        for (size_t j = 0; j < i && !seen; j++) {
+            seen = strcmp(profile->records[j].phase, phase) == 0;
+        }
+        if (seen) continue;
+        uint64_t classes[MEM_SIZE_CLASSES] = {0};
+        for (size_t j = i; j < profile->count; j++) {
+            if (strcmp(profile->records[j].phase, phase) != 0) continue;
+            for (int c = 0; c < MEM_SIZE_CLASSES; c++) {
+                classes[c] += profile->records[j].alloc.size_classes[c];
+            }
+        }
+        printf("  %-14s", phase);
+        for (int c = 0; c < MEM_SIZE_CLASSES; c++) {
+            if (classes[c] == 0) continue;
+            printf(" ");
+            write_size_class(stdout, c);
+            printf(":%llu", (unsigned long long)classes[c]);
+        }
+        printf("\n");
+    }
+}
+
+/* Size of file for byte counts | 用于字节统计的文件大小 */
+uint64_t perf_profile_file_size(const PerfProfile* profile, const char* path) {
+    uint64_t size = 0;
+    if (!profile || !get_file_size(path, &size)) return 0;
+    return size;
+}
+
+/* Print or write profile | 打印或写出性能记录 */
+int perf_profile_report(const PerfProfile* profile, const char* json_path) {
+    if (!profile) return 1;
+    double total = perf_now() - profile->start;
+    uint64_t peak = 0;
+    uint64_t bytes_in = 0;
+    uint64_t bytes_out = 0;
+    for (size_t i = 0; i < profile->count; i++) {
+        const PerfRecord* record = &profile->records[i];
+        if (record->peak_rss > peak) peak = record->peak_rss;
+        if (strcmp(record->phase, "parse") == 0) bytes_in += record->bytes_in;
+        if (strcmp(record->phase, "save") == 0) bytes_out += record->bytes_out;
+    }
+
+    if (json_path && json_path[0] != '\0') {
+        FILE* out = fopen(json_path, "w");
+        if (!out) {
+            printf("Error: Cannot create profile file '%s'\n", json_path);
+            return 0;
+        }
+        fprintf(out, "{\"mode\":\"%s\",\"total_s\":%.6f,\"bytes_in\":%llu,\"bytes_out\":%llu,\"peak_rss\":%llu,"
+                "\"peak_rss_per_phase\":%s,\"peak_rss_shared\":%s,\"phases\":[", profile->mode, total,
+                (unsigned long long)bytes_in, (unsigned long long)bytes_out, (unsigned long long)peak,
+                profile->peak_resets ? "true" : "false", profile->shared ? "true" : "false");
+        for (size_t i = 0; i < profile->count; i++) {
+            const PerfRecord* record = &profile->records[i];
+            uint64_t bytes = record->bytes_out > record->bytes_in ? record->bytes_out : record->bytes_in;
+            fprintf(out, "%s\n{\"phase\":\"%s\",\"file\":", i ? "," : "", record->phase);
+            if (record->file) {
+                json_write_string(out, record->file);
+            } else {
+                fprintf(out, "null");
+            }
+            fprintf(out, ",\"seconds\":%.6f,\"bytes_in\":%llu,\"bytes_out\":%llu,\"mb_per_s\":%.2f,\"peak_rss\":%llu",
+                    record->seconds, (unsigned long long)record->bytes_in, (unsigned long long)record->bytes_out,
+                    perf_mb_per_s(bytes, record->seconds), (unsigned long long)record->peak_rss);
+            if (profile->count_allocs) {
+                fprintf(out, ",\"alloc\":");
+                write_alloc_json(out, &record->alloc);
+            }
+            fprintf(out, "}");
+        }
+        fprintf(out, "\n]}\n");
+        if (fclose(out) != 0) {
+            printf("Error: Cannot write profile file '%s'\n", json_path);
+            return 0;
+        }
+        printf("Profile written: %s\n", json_path);
+        return 1;
+    }
+
+    printf("Profile (%s):\n", profile->mode);
+    printf("  %-14s %10s %12s %12s %9s %9s  %s\n", "phase", "seconds", "bytes in", "bytes out", "MB/s", "peak MB",
+           "file");
+    for (size_t i = 0; i < profile->count; i++) {
+        const PerfRecord* record = &profile->records[i];
+        uint64_t bytes = record->bytes_out > record->bytes_in ? record->bytes_out : record->bytes_in;
+        printf("  %-14s %10.4f %12llu %12llu %9.2f %9.1f  %s\n", record->phase, record->seconds,
+               (unsigned long long)record->bytes_in, (unsigned long long)record->bytes_out,
+               perf_mb_per_s(bytes, record->seconds), (double)record->peak_rss / (1024.0 * 1024.0),
+               record->file ? record->file : "");
+    }
+    printf("  %-14s %10.4f %12llu %12llu %9.2f %9.1f\n", "total", total, (unsigned long long)bytes_in,
+           (unsigned long long)bytes_out, perf_mb_per_s(bytes_in, total), (double)peak / (1024.0 * 1024.0));
+    if (profile->shared) {
+        printf("  Peak MB is process-wide and includes other jobs running in this process\n");
+    }
+    if (profile->count_allocs) {
+        print_allocs(profile);
+    }
+    return 1;
+}
+
+/* Free profile | 释放性能记录 */
+void perf_profile_free(PerfProfile* profile) {
+    if (!profile) return;
+    for (size_t i = 0; i < profile->count; i++) {
+        free(profile->records[i].file);
+    }
+    free(profile->records);
+    free(profile);
+}
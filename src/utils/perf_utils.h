@@ -0,0 +1,53 @@
+#ifndef PERF_UTILS_H
+#define PERF_UTILS_H
+
+#include <stdint.h>
+
+/* Monotonic wall clock in seconds | 单调递增的时钟（秒） */
+double perf_now(void);
+
+/* Peak resident set size in bytes since start or last reset, 0 if unknown | 自启动或上次重置以来的峰值常驻内存（字节），未知时为0 */
+uint64_t perf_peak_rss(void);
+
+/* Current resident set size in bytes, 0 if unknown | 当前常驻内存（字节），未知时为0 */
+uint64_t perf_current_rss(void);
+
+/* Reset peak RSS so the next phase reports its own peak | 重置峰值内存，使下一阶段报告自己的峰值
+ * Returns 0 if the system cannot reset it, peaks then cover the whole process
+ * 系统不支持重置时返回0，此时峰值为整个进程的峰值 */
+int perf_reset_peak_rss(void);
+
+/* Mark that jobs of serve or batch mode share this process, call before they start | 标记serve或batch模式的任务共用本进程，在任务开始前调用
+ * Profiles then never reset peak RSS, which would disturb the other jobs, and label it as process-wide
+ * 此后性能记录不再重置峰值内存（会干扰其他任务），并将其标注为整个进程的峰值 */
+void perf_set_shared_process(void);
+
+/* Throughput in MB/s, 0 for empty time | 吞吐量（MB/s），时间为0时返回0 */
+double perf_mb_per_s(uint64_t bytes, double seconds);
+
+/* Phase timings of one run, enabled by --profile | 单次运行的阶段耗时，由--profile启用
+ * All functions accept a NULL profile and then do nothing, so disabled profiling costs one test per phase
+ * 所有函数都接受NULL，此时不做任何事，因此关闭时每个阶段只多一次判断 */
+typedef struct PerfProfile PerfProfile;
+
+/* Create profile of a mode run, NULL if allocation fails | 为一次模式运行创建性能记录，分配失败时返回NULL
+ * Phases also record libxml2 allocations if mem_stats hooks are installed | 若已安装mem_stats钩子，各阶段还会记录libxml2的内存分配 */
+PerfProfile* perf_profile_create(const char* mode);
+
+/* Start a phase, returns its start time | 开始一个阶段，返回开始时间 */
+double perf_phase_begin(PerfProfile* profile);
+
+/* Record phase started at start, file may be NULL | 记录从start开始的阶段，file可以为NULL */
+void perf_phase_end(PerfProfile* profile, const char* phase, const char* file, double start,
+                    uint64_t bytes_in, uint64_t bytes_out);
+
+/* Size of file for byte counts, 0 without profile | 用于字节统计的文件大小，没有性能记录时为0 */
+uint64_t perf_profile_file_size(const PerfProfile* profile, const char* path);
+
+/* Print profile as table, or write JSON to json_path if not empty | 以表格打印性能记录，json_path非空时写出JSON */
+int perf_profile_report(const PerfProfile* profile, const char* json_path);
+
+/* Free profile | 释放性能记录 */
+void perf_profile_free(PerfProfile* profile);
+
+#endif /* PERF_UTILS_H */
@@ -0,0 +1,226 @@
+#include "result_cache.h"
+#include "hash_utils.h"
+#include "dir_walk.h"
+#include "arxml_snapshot.h"
+#include "compressed_io.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <libxml/xmlversion.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <process.h>
+#include <sys/utime.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#include <utime.h>
+#endif
+
+/* Changed when the key or the entry layout changes | 键或条目布局变化时修改 */
+#define RESULT_CACHE_FORMAT 1
+
+/* Temporary files this old were left by a killed process | 存在这么久的临时文件是被终止的进程遗留的 */
+#define STALE_TEMP_SECONDS 3600
+
+/* Entry found while evicting | 淘汰时找到的条目 */
+typedef struct {
+    char* path;
+    uint64_t size;
+    int64_t mtime;
+} CacheEntry;
+
+/* Temporary names of threads of one process differ by this counter | 同一进程中各线程的临时文件名通过此计数器区分 */
+static pthread_mutex_t temp_lock = PTHREAD_MUTEX_INITIALIZER;
+static unsigned long temp_count;
+
+/* Feed value with its length, so fields cannot run into each other | 连同长度输入值，使字段之间不会混淆 */
+static void hash_field(Hash64State* first, Hash64State* second, const void* data, size_t len) {
+    uint64_t len64 = (uint64_t)len;
+    hash64_update(first, &len64, sizeof(len64));
+    hash64_update(first, data, len);
+    hash64_update(second, &len64, sizeof(len64));
+    hash64_update(second, data, len);
+}
+
+int result_cache_key(const ProgramOptions* opts, char key[RESULT_KEY_LENGTH + 1]) {
+    Hash64State first, second;
+    hash64_init(&first, 0);
+    hash64_init(&second, 0x9E3779B97F4A7C15ULL);
+
+    /* Everything besides the inputs that changes the output bytes | 除输入外所有会改变输出内容的因素 */
+    char header[512];
+    int len = snprintf(header, sizeof(header), "arXmlTool %s libxml2 %s format %d merge indent %d %d sort %d tag %s compression %d",
+                       ARXML_TOOL_VERSION, LIBXML_DOTTED_VERSION, RESULT_CACHE_FORMAT, (int)opts->indent_style,
+                       opts->indent_width, (int)opts->sort_order, opts->sort_specific_tag ? opts->target_tag : "",
+                       (int)compression_of_path(opts->output_file));
+    hash_field(&first, &second, header, (size_t)len);
+
+    /* Path patterns select what the output holds | 路径模式决定输出包含的内容 */
+    for (int i = 0; i < opts->only_paths.count; i++) {
+        hash_field(&first, &second, "only-path", 9);
+        hash_field(&first, &second, opts->only_paths.items[i], strlen(opts->only_paths.items[i]));
+    }
+    for (int i = 0; i < opts->skip_paths.count; i++) {
+        hash_field(&first, &second, "skip-path", 9);
+        hash_field(&first, &second, opts->skip_paths.items[i], strlen(opts->skip_paths.items[i]));
+    }
+
+    /* A snapshot stands for its source, so both share entries | 快照代表其源文件，两者共用条目 */
+    if (opts->snapshot_file[0] != '\0') {
+        uint64_t base[2];
+        if (!arxml_snapshot_source(opts->snapshot_file, &base[0], &base[1])) {
+            return 0;
+        }
+        hash_field(&first, &second, base, sizeof(base));
+    }
+
+    /* Inputs by content in merge order, their paths do not matter | 按merge顺序使用输入的内容，与其路径无关 */
+    for (int i = 0; i < opts->input_files.count; i++) {
+        uint64_t input[2];
+        if (!get_file_size(opts->input_files.items[i], &input[0]) || !hash_file(opts->input_files.items[i], &input[1])) {
+            return 0;
+        }
+        hash_field(&first, &second, input, sizeof(input));
+    }
+
+    snprintf(key, RESULT_KEY_LENGTH + 1, "%016llx%016llx",
+             (unsigned long long)hash64_digest(&first), (unsigned long long)hash64_digest(&second));
+    return 1;
+}
+
+/* Entries are spread over subdirectories named by the first two key digits | 条目按键的前两位分布在各子目录中 */
+static char* entry_path(const char* dir, const char* key, const char* suffix) {
+    size_t size = strlen(dir) + RESULT_KEY_LENGTH + strlen(suffix) + 5;
+    char* path = (char*)malloc(size);
+    if (path) {
+        snprintf(path, size, "%s/%.2s/%s%s", dir, key, key, suffix);
+    }
+    return path;
+}
+
+int result_cache_fetch(const char* dir, const char* key, const char* output_path) {
+    char* entry = entry_path(dir, key, ".arxml");
+    if (!entry) {
+        return 0;
+    }
+    /* An entry evicted meanwhile stays readable once opened, otherwise this is a miss | 已打开的条目即使被同时淘汰也仍可读取，否则视为未命中 */
+    int hit = copy_file(entry, output_path);
+    if (hit) {
+        /* Modification time orders entries for eviction | 修改时间决定条目的淘汰顺序 */
+        utime(entry, NULL);
+    }
+    free(entry);
+    return hit;
+}
+
+static int compare_entries(const void* a, const void* b) {
+    const CacheEntry* x = (const CacheEntry*)a;
+    const CacheEntry* y = (const CacheEntry*)b;
+    return (x->mtime > y->mtime) - (x->mtime < y->mtime);
+}
+
+static int has_suffix(const char* name, const char* suffix) {
+    size_t len = strlen(name);
+    size_t suffix_len = strlen(suffix);
+    return len >= suffix_len && strcmp(name + len - suffix_len, suffix) == 0;
+}
+
+/* Remove least recently used entries until the cache fits, and stale temporary files | 删除最久未使用的条目直到缓存不超过上限，并删除过期的临时文件
+ * Processes evicting at the same time may remove a little more, never a file being written | 同时淘汰的进程可能多删除一些，但不会删除正在写入的文件 */
+static void evict_entries(const char* dir, uint64_t max_bytes) {
+    PathList files = {0};
+    DirWalkFilter filter = {NULL, 0, NULL, NULL, 1};
+    if (!dir_walk(dir, &filter, &files)) {
+        path_list_free(&files);
+        return;
+    }
+
+    CacheEntry* entries = (CacheEntry*)calloc(files.count > 0 ? (size_t)files.count : 1, sizeof(CacheEntry));
+    if (!entries) {
+        path_list_free(&files);
+        return;
+    }
+    int count = 0;
+    uint64_t total = 0;
+    int64_t now = (int64_t)time(NULL);
+    for (int i = 0; i < files.count; i++) {
+        size_t size = strlen(dir) + strlen(files.items[i]) + 2;
+        char* path = (char*)malloc(size);
+        if (!path) break;
+        snprintf(path, size, "%s/%s", dir, files.items[i]);
+
+        CacheEntry entry = {path, 0, 0};
+        if (!get_file_size(path, &entry.size) || !get_file_mtime(path, &entry.mtime)) {
+            free(path);
+        } else if (has_suffix(path, ".tmp")) {
+            if (now - entry.mtime > STALE_TEMP_SECONDS) {
+                remove(path);
+            }
+            free(path);
+        } else if (has_suffix(path, ".arxml")) {
+            entries[count++] = entry;
+            total += entry.size;
+        } else {
+            free(path);
+        }
+    }
+
+    qsort(entries, (size_t)count, sizeof(CacheEntry), compare_entries);
+    for (int i = 0; i < count && total > max_bytes; i++) {
+        if (remove(entries[i].path) == 0) {
+            total -= entries[i].size;
+        }
+    }
+
+    for (int i = 0; i < count; i++) {
+        free(entries[i].path);
+    }
+    free(entries);
+    path_list_free(&files);
+}
+
+/* Move finished file over entry, replacing one stored meanwhile | 将写好的文件移动到条目位置，替换期间存入的条目 */
+static int install_entry(const char* temp, const char* entry) {
+#ifdef _WIN32
+    return MoveFileExA(temp, entry, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    return rename(temp, entry) == 0;
+#endif
+}
+
+void result_cache_store(const char* dir, const char* key, const char* output_path, uint64_t max_bytes) {
+    uint64_t size;
+    if (!get_file_size(output_path, &size) || size > max_bytes) {
+        return;
+    }
+
+    pthread_mutex_lock(&temp_lock);
+    unsigned long count = ++temp_count;
+    pthread_mutex_unlock(&temp_lock);
+    char suffix[64];
+    snprintf(suffix, sizeof(suffix), ".%ld.%lu.tmp", (long)getpid(), count);
+
+    char* entry = entry_path(dir, key, ".arxml");
+    char* temp = entry_path(dir, key, suffix);
+    int ok = entry && temp && create_parent_directories(entry);
+    if (ok) {
+        ok = copy_file(output_path, temp) && install_entry(temp, entry);
+        if (!ok) {
+            remove(temp);
+        }
+    }
+    if (!ok) {
+        printf("Warning: Cannot store '%s' in result cache '%s'\n", output_path, dir);
+    }
+    free(entry);
+    free(temp);
+
+    if (ok) {
+        evict_entries(dir, max_bytes);
+    }
+}
@@ -0,0 +1,26 @@
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include "../main/common.h"
+
+/* Hex digits of a result key | 结果键的十六进制位数 */
+#define RESULT_KEY_LENGTH 32
+
+/* On-disk cache of merge outputs shared by processes | 多个进程共享的merge输出磁盘缓存
+ * Entries are named by a hash of the inputs, written to a temporary file and renamed into place,
+ * so readers never see a partial entry and concurrent writers of one key store the same bytes.
+ * 条目以输入的哈希命名，先写入临时文件再重命名，因此读取者不会看到不完整的条目，并发写入同一键的内容也相同 */
+
+/* Key of a merge from tool and libxml2 version, output options and input contents | 根据工具和libxml2版本、输出选项及输入内容计算merge的键
+ * Returns 0 if an input cannot be read | 无法读取输入时返回0 */
+int result_cache_key(const ProgramOptions* opts, char key[RESULT_KEY_LENGTH + 1]);
+
+/* Copy cached output of key to output_path and mark it as recently used | 将键对应的缓存输出复制到output_path，并标记为最近使用
+ * Returns 0 on a miss, the caller then does the work | 未命中时返回0，由调用者完成实际工作 */
+int result_cache_fetch(const char* dir, const char* key, const char* output_path);
+
+/* Add copy of output_path under key, then evict least recently used entries above max_bytes | 以键保存output_path的副本，然后淘汰超过max_bytes的最久未使用条目
+ * Failures only print a warning, the output itself is already written | 失败时只打印警告，输出文件本身已写好 */
+void result_cache_store(const char* dir, const char* key, const char* output_path, uint64_t max_bytes);
+
+#endif /* RESULT_CACHE_H */
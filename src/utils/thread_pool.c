@@ -0,0 +1,158 @@
+#include "thread_pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+/* Queued task | 队列中的任务 */
+typedef struct PoolTask {
+    ThreadTask func;
+    void* arg;
+    struct PoolTask* next;
+} PoolTask;
+
+struct ThreadPool {
+    pthread_t* threads;
+    int thread_count;
+    PoolTask* head;
+    PoolTask* tail;
+    int pending;             /* Queued plus running tasks | 排队中和执行中的任务数 */
+    int stopping;
+    pthread_mutex_t lock;
+    pthread_cond_t task_ready;
+    pthread_cond_t all_done;
+};
+
+/* Get number of online CPUs | 获取在线CPU数量 */
+int get_cpu_count(void) {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (int)count : 1;
+#endif
+}
+
+/* Worker loop | 工作线程主循环 */
+static void* worker_main(void* data) {
+    ThreadPool* pool = (ThreadPool*)data;
+
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (pool->head == NULL && !pool->stopping) {
+            pthread_cond_wait(&pool->task_ready, &pool->lock);
+        }
+        if (pool->head == NULL && pool->stopping) {
+            break;
+        }
+
+        /* Take task from queue head | 从队列头部取出任务 */
+        PoolTask* task = pool->head;
+        pool->head = task->next;
+        if (pool->head == NULL) {
+            pool->tail = NULL;
+        }
+        pthread_mutex_unlock(&pool->lock);
+
+        task->func(task->arg);
+        free(task);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->pending == 0) {
+            pthread_cond_broadcast(&pool->all_done);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+/* Create pool with given number of workers | 创建指定线程数的线程池 */
+ThreadPool* thread_pool_create(int workers) {
+    ThreadPool* pool = (ThreadPool*)calloc(1, sizeof(ThreadPool));
+    if (!pool) return NULL;
+
+    if (workers <= 0) {
+        workers = get_cpu_count();
+    }
+    pool->threads = (pthread_t*)calloc((size_t)workers, sizeof(pthread_t));
+    if (!pool->threads) {
+        free(pool);
+        return NULL;
+    }
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->task_ready, NULL);
+    pthread_cond_init(&pool->all_done, NULL);
+
+    for (int i = 0; i < workers; i++) {
+        if (pthread_create(&pool->threads[i], NULL, worker_main, pool) != 0) {
+            break;
+        }
+        pool->thread_count++;
+    }
+    if (pool->thread_count == 0) {
+        thread_pool_destroy(pool);
+        return NULL;
+    }
+    return pool;
+}
+
+/* Queue task for execution | 将任务加入队列 */
+int thread_pool_submit(ThreadPool* pool, ThreadTask task, void* arg) {
+    PoolTask* item = (PoolTask*)malloc(sizeof(PoolTask));
+    if (!item) return 0;
+
+    item->func = task;
+    item->arg = arg;
+    item->next = NULL;
+
+    pthread_mutex_lock(&pool->lock);
+    if (pool->tail) {
+        pool->tail->next = item;
+    } else {
+        pool->head = item;
+    }
+    pool->tail = item;
+    pool->pending++;
+    pthread_cond_signal(&pool->task_ready);
+    pthread_mutex_unlock(&pool->lock);
+    return 1;
+}
+
+/* Wait until all queued tasks are finished | 等待所有已提交任务完成 */
+void thread_pool_wait(ThreadPool* pool) {
+    pthread_mutex_lock(&pool->lock);
+    while (pool->pending > 0) {
+        pthread_cond_wait(&pool->all_done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+/* Wait for queued tasks, stop workers and free pool | 等待任务完成，停止工作线程并释放线程池 */
+void thread_pool_destroy(ThreadPool* pool) {
+    if (!pool) return;
+
+    thread_pool_wait(pool);
+
+    pthread_mutex_lock(&pool->lock);
+    pool->stopping = 1;
+    pthread_cond_broadcast(&pool->task_ready);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (int i = 0; i < pool->thread_count; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+
+    pthread_cond_destroy(&pool->all_done);
+    pthread_cond_destroy(&pool->task_ready);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->threads);
+    free(pool);
+}
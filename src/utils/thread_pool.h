@@ -0,0 +1,25 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+/* Fixed size worker pool with a FIFO task queue | 固定大小的工作线程池，任务按先进先出顺序执行 */
+typedef struct ThreadPool ThreadPool;
+
+/* Task function executed by a worker | 工作线程执行的任务函数 */
+typedef void (*ThreadTask)(void* arg);
+
+/* Get number of online CPUs (at least 1) | 获取在线CPU数量（至少为1） */
+int get_cpu_count(void);
+
+/* Create pool with given number of workers, <= 0 means one per CPU | 创建指定线程数的线程池，<=0表示每个CPU一个线程 */
+ThreadPool* thread_pool_create(int workers);
+
+/* Queue task for execution | 将任务加入队列 */
+int thread_pool_submit(ThreadPool* pool, ThreadTask task, void* arg);
+
+/* Wait until all queued tasks are finished | 等待所有已提交任务完成 */
+void thread_pool_wait(ThreadPool* pool);
+
+/* Wait for queued tasks, stop workers and free pool | 等待任务完成，停止工作线程并释放线程池 */
+void thread_pool_destroy(ThreadPool* pool);
+
+#endif /* THREAD_POOL_H */
@@ -0,0 +1,202 @@
+#include "xml_arena.h"
+#include <stdlib.h>
+#include <string.h>
+#include <libxml/parser.h>
+#include <libxml/xmlerror.h>
+#include <libxml/xmlmemory.h>
+
+/* Default chunk size, larger requests get a chunk of their own size | 默认内存块大小，更大的请求使用与其大小相同的块 */
+#define ARENA_CHUNK_SIZE ((size_t)4 << 20)
+/* Block header keeping size and origin, 16 bytes so payload alignment is unchanged | 记录大小和来源的块头，16字节以保持数据对齐不变 */
+#define ARENA_HEADER_SIZE 16
+#define ARENA_ALIGN(size) (((size) + 15) & ~(size_t)15)
+/* Freed blocks up to this size are kept in per-size lists for reuse | 不超过该大小的已释放块按大小保存在链表中以便复用 */
+#define ARENA_SMALL_MAX 512
+#define ARENA_SMALL_CLASSES (ARENA_SMALL_MAX / 16)
+/* Larger requests, mostly growing buffers, stay on the heap so realloc stays cheap | 更大的请求（主要是增长的缓冲区）留在堆上，使realloc保持低开销 */
+#define ARENA_LARGE_MIN ((size_t)64 << 10)
+
+#define MAGIC_HEAP ((size_t)0x48454150u)
+#define MAGIC_ARENA ((size_t)0x4152454eu)
+
+typedef struct {
+    size_t size;
+    size_t magic;
+} BlockHeader;
+
+typedef struct ArenaChunk {
+    struct ArenaChunk* next;
+    size_t size;
+    size_t used;
+    size_t pad;                /* Keep data 16-byte aligned | 保持数据16字节对齐 */
+} ArenaChunk;
+
+typedef struct FreeBlock {
+    struct FreeBlock* next;
+} FreeBlock;
+
+static ArenaChunk* first_chunk;
+static ArenaChunk* current_chunk;
+static FreeBlock* free_lists[ARENA_SMALL_CLASSES];
+static int installed;
+static int arena_active;
+
+static char* chunk_data(ArenaChunk* chunk) {
+    return (char*)(chunk + 1);
+}
+
+static BlockHeader* header_of(void* ptr) {
+    return (BlockHeader*)((char*)ptr - ARENA_HEADER_SIZE);
+}
+
+static void* heap_alloc(size_t size) {
+    BlockHeader* block = (BlockHeader*)malloc(size + ARENA_HEADER_SIZE);
+    if (!block) return NULL;
+    block->size = size;
+    block->magic = MAGIC_HEAP;
+    return (char*)block + ARENA_HEADER_SIZE;
+}
+
+static ArenaChunk* new_chunk(size_t need) {
+    size_t size = need > ARENA_CHUNK_SIZE ? need : ARENA_CHUNK_SIZE;
+    ArenaChunk* chunk = (ArenaChunk*)malloc(sizeof(ArenaChunk) + size);
+    if (!chunk) return NULL;
+    chunk->next = NULL;
+    chunk->size = size;
+    chunk->used = 0;
+    return chunk;
+}
+
+/* Free list of a rounded block size, -1 when too large | 按取整后块大小对应的空闲链表，过大时返回-1 */
+static int small_class_of(size_t need) {
+    return need <= ARENA_SMALL_MAX ? (int)(need / 16) - 1 : -1;
+}
+
+static void* arena_alloc(size_t size) {
+    if (size >= ARENA_LARGE_MIN) return heap_alloc(size);
+
+    size_t need = ARENA_ALIGN(size + ARENA_HEADER_SIZE);
+    int size_class = small_class_of(need);
+    if (size_class >= 0 && free_lists[size_class]) {
+        FreeBlock* reused = free_lists[size_class];
+        free_lists[size_class] = reused->next;
+        BlockHeader* block = header_of(reused);
+        block->size = size;
+        return reused;
+    }
+
+    /* Chunks after the current one are unused, move on until one fits | 当前块之后的块均未使用，向后查找能容纳的块 */
+    while (current_chunk && current_chunk->size - current_chunk->used < need && current_chunk->next) {
+        current_chunk = current_chunk->next;
+    }
+    if (!current_chunk || current_chunk->size - current_chunk->used < need) {
+        ArenaChunk* chunk = new_chunk(need);
+        if (!chunk) return NULL;
+        if (current_chunk) current_chunk->next = chunk;
+        else first_chunk = chunk;
+        current_chunk = chunk;
+    }
+
+    BlockHeader* block = (BlockHeader*)(chunk_data(current_chunk) + current_chunk->used);
+    current_chunk->used += need;
+    block->size = size;
+    block->magic = MAGIC_ARENA;
+    return (char*)block + ARENA_HEADER_SIZE;
+}
+
+/* Whether the block is the latest allocation of the current chunk | 块是否为当前块中最近一次分配 */
+static int is_last_block(BlockHeader* block) {
+    if (!current_chunk) return 0;
+    char* end = (char*)block + ARENA_ALIGN(block->size + ARENA_HEADER_SIZE);
+    return end == chunk_data(current_chunk) + current_chunk->used;
+}
+
+static void* arena_malloc(size_t size) {
+    return arena_active ? arena_alloc(size) : heap_alloc(size);
+}
+
+static void arena_free(void* ptr) {
+    if (!ptr) return;
+    BlockHeader* block = header_of(ptr);
+    if (block->magic == MAGIC_HEAP) {
+        block->magic = 0;
+        free(block);
+        return;
+    }
+    /* The latest allocation is given back, small blocks wait for reuse | 最近一次分配直接归还，小块等待复用 */
+    size_t need = ARENA_ALIGN(block->size + ARENA_HEADER_SIZE);
+    if (is_last_block(block)) {
+        current_chunk->used -= need;
+        return;
+    }
+    int size_class = small_class_of(need);
+    if (size_class >= 0) {
+        FreeBlock* freed = (FreeBlock*)ptr;
+        freed->next = free_lists[size_class];
+        free_lists[size_class] = freed;
+    }
+}
+
+static void* arena_realloc(void* ptr, size_t size) {
+    if (!ptr) return arena_malloc(size);
+    BlockHeader* block = header_of(ptr);
+    if (block->magic == MAGIC_HEAP) {
+        BlockHeader* grown = (BlockHeader*)realloc(block, size + ARENA_HEADER_SIZE);
+        if (!grown) return NULL;
+        grown->size = size;
+        return (char*)grown + ARENA_HEADER_SIZE;
+    }
+
+    /* Grow or shrink in place when nothing was allocated after the block | 块之后没有新分配时原地扩大或缩小 */
+    if (is_last_block(block)) {
+        size_t old_need = ARENA_ALIGN(block->size + ARENA_HEADER_SIZE);
+        size_t new_need = ARENA_ALIGN(size + ARENA_HEADER_SIZE);
+        size_t start = current_chunk->used - old_need;
+        if (new_need <= current_chunk->size - start) {
+            current_chunk->used = start + new_need;
+            block->size = size;
+            return ptr;
+        }
+    }
+
+    void* copy = arena_malloc(size);
+    if (!copy) return NULL;
+    memcpy(copy, ptr, block->size < size ? block->size : size);
+    arena_free(ptr);
+    return copy;
+}
+
+static char* arena_strdup(const char* str) {
+    size_t len = strlen(str) + 1;
+    char* copy = (char*)arena_malloc(len);
+    if (copy) memcpy(copy, str, len);
+    return copy;
+}
+
+/* Install arena hooks | 安装arena钩子 */
+int xml_arena_install(void) {
+    if (installed) return 1;
+    if (xmlMemSetup(arena_free, arena_malloc, arena_realloc, arena_strdup) != 0) return 0;
+    installed = 1;
+
+    /* Global parser state lives for the whole run, keep it on the heap | 全局解析器状态贯穿整个运行过程，保留在堆上 */
+    xmlInitParser();
+    arena_active = 1;
+    return 1;
+}
+
+int xml_arena_enabled(void) {
+    return installed;
+}
+
+void xml_arena_reset(void) {
+    if (!installed) return;
+
+    /* The last error keeps strings that would be freed on the next error | 最近的错误保存了在下一次出错时才释放的字符串 */
+    xmlResetLastError();
+    memset(free_lists, 0, sizeof(free_lists));
+    for (ArenaChunk* chunk = first_chunk; chunk; chunk = chunk->next) {
+        chunk->used = 0;
+    }
+    current_chunk = first_chunk;
+}
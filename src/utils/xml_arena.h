@@ -0,0 +1,22 @@
+#ifndef XML_ARENA_H
+#define XML_ARENA_H
+
+/* Bump allocator for libxml2, used by merge and format with --arena | libxml2使用的顺序分配器，merge和format在--arena时使用
+ * Nodes are carved from large chunks and free() does nothing except undo the latest allocation,
+ * so a whole document is dropped by xml_arena_reset() instead of xmlFreeDoc().
+ * 节点从大块内存中顺序分配，free()除撤销最近一次分配外不做任何事，因此整个文档通过xml_arena_reset()而不是xmlFreeDoc()丢弃 */
+
+/* Install hooks with xmlMemSetup and initialize libxml2 | 通过xmlMemSetup安装钩子并初始化libxml2
+ * Must run before libxml2 allocates anything. Global state created by xmlInitParser stays on the heap.
+ * Not thread safe, libxml2 must be used from one thread only.
+ * 必须在libxml2分配任何内存之前调用；xmlInitParser创建的全局状态仍在堆上；非线程安全，只能在单个线程中使用libxml2 */
+int xml_arena_install(void);
+
+/* Whether arena hooks are installed | 是否已安装arena钩子 */
+int xml_arena_enabled(void);
+
+/* Drop all arena allocations, chunks are kept for reuse | 丢弃arena中的所有分配，保留内存块以便复用
+ * No libxml2 object allocated since install or the last reset may be used afterwards | 此后不能再使用自安装或上次重置以来分配的任何libxml2对象 */
+void xml_arena_reset(void);
+
+#endif /* XML_ARENA_H */
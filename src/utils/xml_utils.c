@@ -1,4 +1,5 @@
 #include "xml_utils.h"
+#include "compressed_io.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
@@ -189,61 +190,98 @@ static int get_line_indent(const char* line, char* style) {
     return count;
 }
 
-DetectedIndentStyle detect_indent_style(const char* filename) {
-    DetectedIndentStyle style = {.style = 's', .width = 4};  /* Default: 4 spaces | 默认4空格 */
-    FILE* file = fopen(filename, "r");
-    if (!file) {
-        return style;
-    }
+void indent_detector_init(IndentDetector* detector) {
+    memset(detector, 0, sizeof(*detector));
+    detector->style.style = 's';  /* Default: 4 spaces | 默认4空格 */
+    detector->style.width = 4;
+}
 
-    char prev_line[1024] = "";
-    char curr_line[1024];
-    int found_indent = 0;
-    int line_num = 0;
-    
-    /* Get first line | 获取第一行 */
-    if (!fgets(prev_line, sizeof(prev_line), file)) {
-        fclose(file);
-        return style;
+/* Handle one complete line | 处理一个完整的行 */
+static void detect_line(IndentDetector* detector) {
+    detector->curr_line[detector->curr_len] = '\0';
+    detector->curr_len = 0;
+
+    /* First line only becomes the previous one | 第一行只作为前一行 */
+    if (detector->lines++ == 0) {
+        strcpy(detector->prev_line, detector->curr_line);
+        return;
     }
-    line_num++;
-    
-    /* Compare consecutive lines | 比较连续的行 */
-    while (fgets(curr_line, sizeof(curr_line), file)) {
-        line_num++;
-        
-        /* If both lines are elements | 如果两行都是元素 */
-        if (is_element_line(prev_line) && is_element_line(curr_line)) {
-            char prev_style, curr_style;
-            int prev_indent = get_line_indent(prev_line, &prev_style);
-            int curr_indent = get_line_indent(curr_line, &curr_style);
-            
-            /* If current line is more indented | 如果当前行缩进更多 */
-            if (curr_indent > prev_indent) {
-                if (curr_style == 't') {
-                    style.style = 't';
-                    style.width = 1;
-                    found_indent = 1;
-                    break;
-                } else if (!found_indent) {
-                    int width = curr_indent - prev_indent;
-                    if (width > 0 && width <= 8) {
-                        style.style = 's';
-                        style.width = width;
-                        found_indent = 1;
-                        break;
-                    }
-                }
+
+    /* If both lines are elements | 如果两行都是元素 */
+    if (is_element_line(detector->prev_line) && is_element_line(detector->curr_line)) {
+        char prev_style, curr_style;
+        int prev_indent = get_line_indent(detector->prev_line, &prev_style);
+        int curr_indent = get_line_indent(detector->curr_line, &curr_style);
+
+        /* If current line is more indented | 如果当前行缩进更多 */
+        if (curr_indent > prev_indent) {
+            if (curr_style == 't') {
+                detector->style.style = 't';
+                detector->style.width = 1;
+                detector->done = 1;
+                return;
+            }
+            int width = curr_indent - prev_indent;
+            if (width > 0 && width <= 8) {
+                detector->style.style = 's';
+                detector->style.width = width;
+                detector->done = 1;
+                return;
             }
         }
-        
-        /* Move current line to previous | 当前行移动到前一行 */
-        strcpy(prev_line, curr_line);
     }
-    
-    fclose(file);
-    return style;
-} 
+
+    /* Move current line to previous | 当前行移动到前一行 */
+    strcpy(detector->prev_line, detector->curr_line);
+}
+
+void indent_detector_feed(IndentDetector* detector, const char* data, size_t len) {
+    const int line_max = (int)sizeof(detector->curr_line) - 1;
+    while (len > 0 && !detector->done) {
+        /* Take up to the newline or a full buffer, like fgets | 与fgets相同，读取到换行符或缓冲区已满为止 */
+        size_t count = (size_t)(line_max - detector->curr_len);
+        if (count > len) count = len;
+        const char* newline = (const char*)memchr(data, '\n', count);
+        if (newline) count = (size_t)(newline - data) + 1;
+        memcpy(detector->curr_line + detector->curr_len, data, count);
+        detector->curr_len += (int)count;
+        data += count;
+        len -= count;
+        if (newline || detector->curr_len == line_max) {
+            detect_line(detector);
+        }
+    }
+}
+
+DetectedIndentStyle indent_detector_finish(IndentDetector* detector) {
+    if (!detector->done && detector->curr_len > 0) {
+        detect_line(detector);
+    }
+    return detector->style;
+}
+
+DetectedIndentStyle detect_indent_style(const char* filename) {
+    IndentDetector detector;
+    indent_detector_init(&detector);
+
+    /* Compressed files are decompressed only up to the lines needed | 压缩文件只解压到所需的行为止 */
+    CompressedInput* input = compressed_input_open(filename);
+    FILE* file = input ? NULL : fopen(filename, "r");
+    if (!input && !file) {
+        return detector.style;
+    }
+
+    char buffer[16384];
+    while (!detector.done) {
+        long len = input ? compressed_input_read(input, buffer, sizeof(buffer)) : (long)fread(buffer, 1, sizeof(buffer), file);
+        if (len <= 0) break;
+        indent_detector_feed(&detector, buffer, (size_t)len);
+    }
+
+    if (input) compressed_input_close(input);
+    else fclose(file);
+    return indent_detector_finish(&detector);
+}
 
 /* Sort children of specific tag by SHORT-NAME | 对特定标签的子节点按SHORT-NAME排序 */
 int sort_specific_tag_children(xmlNodePtr root, const char* tag_name, SortOrder order) {
@@ -268,4 +306,35 @@ int sort_specific_tag_children(xmlNodePtr root, const char* tag_name, SortOrder
     }
 
     return count;
-}
\ No newline at end of file
+}
+
+/* Create a string with n spaces for indentation | 创建包含n个空格的缩进字符串
+ * Points into a constant string, so threads using different widths do not interfere | 指向常量字符串，使用不同宽度的线程互不影响 */
+static const char* create_space_indent(int n) {
+    static const char spaces[] = "                               ";  /* 31 spaces | 31个空格 */
+    if (n <= 0) n = 4;  /* 如果指定无效数值，使用4空格 */
+    if (n > 31) n = 31; /* 限制最大空格数 */
+
+    return spaces + (sizeof(spaces) - 1 - (size_t)n);
+}
+
+/* Set libxml2 output indentation from options or detected style | 根据选项或检测到的风格设置libxml2输出缩进 */
+void set_output_indent(const ProgramOptions *opts, DetectedIndentStyle detected) {
+    if (opts->indent_style == INDENT_DEFAULT) {
+        /* Use detected indentation | 使用检测到的缩进 */
+        set_output_indent_style(detected.style, detected.width);
+    } else if (opts->indent_style == INDENT_TAB) {
+        /* Use tab indentation | 使用制表符缩进 */
+        set_output_indent_style('t', 1);
+    } else {
+        /* Use specified number of spaces | 使用指定数量的空格 */
+        set_output_indent_style('s', opts->indent_width);
+    }
+}
+
+/* Set libxml2 output indentation of this thread | 设置当前线程的libxml2输出缩进 */
+void set_output_indent_style(char style, int width) {
+    xmlKeepBlanksDefault(0);
+    xmlIndentTreeOutput = 1;
+    xmlTreeIndentString = (style == 't') ? "\t" : create_space_indent(width);
+}
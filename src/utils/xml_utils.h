@@ -22,10 +22,36 @@ int count_short_names(xmlNodePtr node);
 /* Sort nodes by SHORT-NAME | 按SHORT-NAME对节点进行排序 */
 void sort_nodes_by_short_name(xmlNodePtr parent, SortOrder order);
 
-/* Detect indentation style from XML file | 从XML文件中检测缩进风格 */
+/* Indentation detection over data fed in pieces, e.g. while parsing a stream | 对分段提供的数据检测缩进，例如在解析流的同时检测
+ * Lines are cut like fgets with this buffer, so the result equals detect_indent_style | 行的切分方式与使用此缓冲区的fgets相同，因此结果与detect_indent_style一致 */
+typedef struct {
+    DetectedIndentStyle style;
+    char prev_line[1024];
+    char curr_line[1024];
+    int curr_len;
+    int lines;
+    int done;           /* Style found, further data is ignored | 已找到缩进，之后的数据被忽略 */
+} IndentDetector;
+
+/* Start detection with the default of 4 spaces | 以默认的4空格开始检测 */
+void indent_detector_init(IndentDetector* detector);
+
+/* Feed next piece of data | 提供下一段数据 */
+void indent_detector_feed(IndentDetector* detector, const char* data, size_t len);
+
+/* Finish with the last unterminated line and get the style | 处理最后一个未结束的行并获取缩进风格 */
+DetectedIndentStyle indent_detector_finish(IndentDetector* detector);
+
+/* Detect indentation style from XML file, compressed files are decompressed | 从XML文件中检测缩进风格，压缩文件会被解压 */
 DetectedIndentStyle detect_indent_style(const char* filename);
 
 /* Sort children of specific tag by SHORT-NAME | 对特定标签的子节点按SHORT-NAME排序 */
 int sort_specific_tag_children(xmlNodePtr root, const char* tag_name, SortOrder order);
 
+/* Set libxml2 output indentation from options or detected style | 根据选项或检测到的风格设置libxml2输出缩进 */
+void set_output_indent(const ProgramOptions *opts, DetectedIndentStyle detected);
+
+/* Set libxml2 output indentation of this thread, style 't' for tab or 's' for width spaces | 设置当前线程的libxml2输出缩进，style为't'表示tab，为's'表示width个空格 */
+void set_output_indent_style(char style, int width);
+
 #endif /* XML_UTILS_H */ 
\ No newline at end of file